@@ -0,0 +1,249 @@
+#include "adaptive_sampler.hpp"
+
+#include <benchmark/benchmark.h>
+
+#ifdef YODAU_OPENCV
+#include "opencv_client.hpp"
+#include "stream_manager.hpp"
+
+#include <thread>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+using yodau::backend::adaptive_sampler;
+using yodau::backend::line_set;
+using yodau::backend::make_line;
+using yodau::backend::point;
+using yodau::backend::sampling_config;
+
+namespace {
+using clock_type = adaptive_sampler::clock;
+using namespace std::chrono_literals;
+
+// one object crossing the vertical line x = 50 from left to right; it is
+// visible (produces motion) from x = start until it leaves at x = 60
+struct pass {
+    clock_type::duration appear;
+    float start;
+    float speed; // percent per second
+};
+
+// synthetic stream: @p length of 30 fps video with passes of random speed
+// separated by quiet gaps
+std::vector<pass> make_passes(const clock_type::duration length = 60s) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> start(0.0f, 40.0f);
+    std::uniform_real_distribution<float> speed(20.0f, 200.0f);
+    std::uniform_int_distribution<int> gap_ms(1000, 6000);
+
+    std::vector<pass> out;
+    clock_type::duration t = 1s;
+    while (t < length) {
+        const pass p { t, start(rng), speed(rng) };
+        out.push_back(p);
+        const auto visible = std::chrono::duration<float>(
+            (60.0f - p.start) / p.speed
+        );
+        t += std::chrono::duration_cast<clock_type::duration>(visible)
+            + std::chrono::milliseconds(gap_ms(rng));
+    }
+    return out;
+}
+
+struct outcome {
+    long analyses { 0 };
+    long missed { 0 };
+};
+
+// a crossing is detected when two consecutive analyses see the object on
+// both sides of the line, as the centroid tripwire test does; like the
+// motion processor, every analysis tests the lines and feeds the sampler,
+// whatever the motion rate limit lets through as events
+outcome simulate(const std::vector<pass>& passes, const bool adaptive) {
+    const line_set lines({ make_line({ { 50, 0 }, { 50, 100 } }, "door") });
+    sampling_config cfg;
+    cfg.enabled = adaptive;
+    const clock_type::duration base = 200ms;
+    const clock_type::duration frame = 33ms;
+    const auto t0 = clock_type::time_point {} + 1h;
+
+    adaptive_sampler sampler;
+    outcome out;
+    auto last = t0 - 1h;
+    auto interval = base;
+    std::size_t cur = 0;
+    float prev_x = -1.0f;
+    bool detected = false;
+    for (auto t = clock_type::duration {}; t < 60s; t += frame) {
+        if (t0 + t - last < interval) {
+            continue;
+        }
+        last = t0 + t;
+        ++out.analyses;
+
+        while (cur < passes.size()) {
+            const auto& p = passes[cur];
+            const float x = p.start
+                + p.speed * std::chrono::duration<float>(t - p.appear).count();
+            if (t < p.appear) {
+                prev_x = -1.0f;
+                break;
+            }
+            if (x >= 60.0f) {
+                out.missed += detected ? 0 : 1;
+                detected = false;
+                prev_x = -1.0f;
+                ++cur;
+                continue;
+            }
+            if (prev_x >= 0.0f && prev_x < 50.0f && x >= 50.0f) {
+                detected = true;
+            }
+            prev_x = x;
+            sampler.observe(point { x, 50.0f }, t0 + t, cfg);
+            break;
+        }
+
+        if (adaptive) {
+            sampler.update(lines, cfg, base, t0 + t);
+            interval = sampler.interval();
+        }
+    }
+    return out;
+}
+
+void bm_sampling(benchmark::State& state) {
+    const auto passes = make_passes();
+    const bool adaptive = state.range(0) != 0;
+    outcome last;
+    for (auto _ : state) {
+        last = simulate(passes, adaptive);
+        benchmark::DoNotOptimize(last);
+    }
+    state.counters["passes"] = static_cast<double>(passes.size());
+    state.counters["analyses"] = static_cast<double>(last.analyses);
+    state.counters["missed"] = static_cast<double>(last.missed);
+}
+// 0: fixed 200 ms interval, 1: adaptive sampling
+BENCHMARK(bm_sampling)->Arg(0)->Arg(1);
+
+#ifdef YODAU_OPENCV
+constexpr int frame_w = 320;
+constexpr int frame_h = 180;
+constexpr int block_px = 24;
+
+// gray frame with the object of @p p drawn at @p t, if it is visible
+yodau::backend::frame render(const pass* p, const clock_type::duration t) {
+    yodau::backend::frame f;
+    f.width = frame_w;
+    f.height = frame_h;
+    f.stride = frame_w;
+    f.format = yodau::backend::pixel_format::gray8;
+    f.data.assign(static_cast<std::size_t>(frame_w * frame_h), 50);
+    if (p) {
+        const float x = p->start
+            + p->speed * std::chrono::duration<float>(t - p->appear).count();
+        const int cx = static_cast<int>(x * frame_w / 100.0f);
+        const int x0 = std::max(0, cx - block_px / 2);
+        const int x1 = std::min(frame_w, cx + block_px / 2);
+        const int y0 = (frame_h - block_px) / 2;
+        for (int y = y0; y < y0 + block_px; ++y) {
+            for (int xx = x0; xx < x1; ++xx) {
+                f.data[static_cast<std::size_t>(y * frame_w + xx)] = 200;
+            }
+        }
+    }
+    f.ts = clock_type::now();
+    return f;
+}
+
+// the passes rendered and pushed in real time through a stream manager
+// running the OpenCV motion processor, so that sampling, the motion rate
+// limit and the tripwire test interact as in a live stream; a pass is
+// detected if any tripwire event is emitted while it is visible
+outcome run_pipeline(const std::vector<pass>& passes, const bool adaptive) {
+    using yodau::backend::event_kind;
+    using yodau::backend::opencv_client;
+
+    opencv_client client;
+    // every crossing counts, however close to the previous one
+    client.set_rate_rule(
+        opencv_client::rate_target::tripwire, {}, {}, rate_rule {}
+    );
+
+    outcome out;
+    yodau::backend::stream_manager mgr;
+    mgr.add_stream("synthetic.mp4", "synthetic", "file");
+    mgr.add_line("50,0;50,100", false, "door");
+    mgr.set_line("synthetic", "door");
+    mgr.set_analysis_interval_ms(200);
+    mgr.set_batch_processor(
+        [&](const yodau::backend::stream& s, const yodau::backend::frame& f,
+            yodau::backend::event_batch& events) {
+            ++out.analyses;
+            client.motion_processor(s, f, events);
+        }
+    );
+    sampling_config cfg;
+    cfg.enabled = adaptive;
+    mgr.set_sampling(cfg);
+
+    // the slowest object is visible for 3 s after it appears
+    const auto length = passes.empty() ? 0s : passes.back().appear + 4s;
+    const auto start = clock_type::now();
+    std::size_t cur = 0;
+    bool detected = false;
+    yodau::backend::event_batch events;
+    for (auto t = clock_type::duration {}; t < length; t += 33ms) {
+        std::this_thread::sleep_until(start + t);
+
+        const pass* visible = nullptr;
+        while (cur < passes.size() && t >= passes[cur].appear) {
+            const auto& p = passes[cur];
+            const float x = p.start
+                + p.speed * std::chrono::duration<float>(t - p.appear).count();
+            if (x < 60.0f) {
+                visible = &p;
+                break;
+            }
+            out.missed += detected ? 0 : 1;
+            detected = false;
+            ++cur;
+        }
+
+        events.clear();
+        mgr.process_frame("synthetic", render(visible, t), events);
+        for (const auto kind : events.kinds()) {
+            detected = detected || kind == event_kind::tripwire;
+        }
+    }
+    return out;
+}
+
+void bm_sampling_pipeline(benchmark::State& state) {
+    const auto passes = make_passes(20s);
+    const bool adaptive = state.range(0) != 0;
+    outcome last;
+    for (auto _ : state) {
+        last = run_pipeline(passes, adaptive);
+        benchmark::DoNotOptimize(last);
+    }
+    state.counters["passes"] = static_cast<double>(passes.size());
+    state.counters["analyses"] = static_cast<double>(last.analyses);
+    state.counters["missed"] = static_cast<double>(last.missed);
+}
+// runs in real time (about 20 s per argument)
+BENCHMARK(bm_sampling_pipeline)
+    ->Arg(0)
+    ->Arg(1)
+    ->Iterations(1)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+#endif
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,147 @@
+#include "bit_mask.hpp"
+
+#include <benchmark/benchmark.h>
+
+#ifdef YODAU_OPENCV
+#include <opencv2/opencv.hpp>
+#endif
+
+#include <random>
+#include <vector>
+
+using yodau::backend::bit_mask;
+
+namespace {
+// blobby mask: a few filled rectangles plus sparse noise, close to what a
+// thresholded frame difference looks like
+std::vector<std::uint8_t> make_mask(const int w, const int h) {
+    std::mt19937 rng(42);
+    std::vector<std::uint8_t> out(static_cast<size_t>(w * h), 0);
+
+    std::uniform_int_distribution<int> px(0, w - 1);
+    std::uniform_int_distribution<int> py(0, h - 1);
+    for (int i = 0; i < 8; ++i) {
+        const int x0 = px(rng);
+        const int y0 = py(rng);
+        const int x1 = std::min(w, x0 + w / 10);
+        const int y1 = std::min(h, y0 + h / 8);
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                out[static_cast<size_t>(y * w + x)] = 255;
+            }
+        }
+    }
+    for (int i = 0; i < w * h / 200; ++i) {
+        out[static_cast<size_t>(py(rng) * w + px(rng))] = 255;
+    }
+
+    return out;
+}
+
+void set_resolution_args(benchmark::internal::Benchmark* b) {
+    b->Args({ 1280, 720 })->Args({ 1920, 1080 })->Args({ 3840, 2160 });
+}
+
+void bm_bit_pack(benchmark::State& state) {
+    const auto w = static_cast<int>(state.range(0));
+    const auto h = static_cast<int>(state.range(1));
+    const auto bytes = make_mask(w, h);
+    for (auto _ : state) {
+        auto m = bit_mask::from_bytes(
+            bytes.data(), w, h, static_cast<size_t>(w)
+        );
+        benchmark::DoNotOptimize(m);
+    }
+}
+BENCHMARK(bm_bit_pack)->Apply(set_resolution_args);
+
+void bm_bit_morphology(benchmark::State& state) {
+    const auto w = static_cast<int>(state.range(0));
+    const auto h = static_cast<int>(state.range(1));
+    const auto bytes = make_mask(w, h);
+    const auto m
+        = bit_mask::from_bytes(bytes.data(), w, h, static_cast<size_t>(w));
+    for (auto _ : state) {
+        auto out = dilate(erode(m, 1), 2);
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(bm_bit_morphology)->Apply(set_resolution_args);
+
+void bm_bit_count(benchmark::State& state) {
+    const auto w = static_cast<int>(state.range(0));
+    const auto h = static_cast<int>(state.range(1));
+    const auto bytes = make_mask(w, h);
+    const auto m
+        = bit_mask::from_bytes(bytes.data(), w, h, static_cast<size_t>(w));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m.count());
+    }
+}
+BENCHMARK(bm_bit_count)->Apply(set_resolution_args);
+
+void bm_bit_components(benchmark::State& state) {
+    const auto w = static_cast<int>(state.range(0));
+    const auto h = static_cast<int>(state.range(1));
+    const auto bytes = make_mask(w, h);
+    const auto m = dilate(
+        erode(
+            bit_mask::from_bytes(bytes.data(), w, h, static_cast<size_t>(w))
+        ),
+        2
+    );
+    for (auto _ : state) {
+        auto labels = label_components(m);
+        benchmark::DoNotOptimize(labels);
+    }
+}
+BENCHMARK(bm_bit_components)->Apply(set_resolution_args);
+
+#ifdef YODAU_OPENCV
+cv::Mat make_cv_mask(const int w, const int h) {
+    auto bytes = make_mask(w, h);
+    return cv::Mat(h, w, CV_8UC1, bytes.data()).clone();
+}
+
+void bm_cv_morphology(benchmark::State& state) {
+    const auto w = static_cast<int>(state.range(0));
+    const auto h = static_cast<int>(state.range(1));
+    const cv::Mat src = make_cv_mask(w, h);
+    cv::Mat out;
+    for (auto _ : state) {
+        cv::erode(src, out, cv::Mat(), cv::Point(-1, -1), 1);
+        cv::dilate(out, out, cv::Mat(), cv::Point(-1, -1), 2);
+        benchmark::DoNotOptimize(out.data);
+    }
+}
+BENCHMARK(bm_cv_morphology)->Apply(set_resolution_args);
+
+void bm_cv_count(benchmark::State& state) {
+    const auto w = static_cast<int>(state.range(0));
+    const auto h = static_cast<int>(state.range(1));
+    const cv::Mat src = make_cv_mask(w, h);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cv::countNonZero(src));
+    }
+}
+BENCHMARK(bm_cv_count)->Apply(set_resolution_args);
+
+void bm_cv_components(benchmark::State& state) {
+    const auto w = static_cast<int>(state.range(0));
+    const auto h = static_cast<int>(state.range(1));
+    cv::Mat src = make_cv_mask(w, h);
+    cv::erode(src, src, cv::Mat(), cv::Point(-1, -1), 1);
+    cv::dilate(src, src, cv::Mat(), cv::Point(-1, -1), 2);
+    std::vector<std::vector<cv::Point>> contours;
+    for (auto _ : state) {
+        cv::findContours(
+            src, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE
+        );
+        benchmark::DoNotOptimize(contours.data());
+    }
+}
+BENCHMARK(bm_cv_components)->Apply(set_resolution_args);
+#endif
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,298 @@
+#include "capture_engine.hpp"
+
+#include <benchmark/benchmark.h>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#endif
+
+#ifdef __linux__
+using yodau::backend::capture_engine;
+using yodau::backend::capture_source;
+using yodau::backend::frame;
+using yodau::backend::http_mjpeg_source;
+#endif
+
+namespace {
+#ifdef __linux__
+// one byte on the socket stands in for one captured frame
+class byte_source final : public capture_source {
+public:
+    explicit byte_source(const int read_fd)
+        : rd(read_fd) { }
+
+    ~byte_source() override { ::close(rd); }
+
+    byte_source(const byte_source&) = delete;
+    byte_source& operator=(const byte_source&) = delete;
+
+    int fd() const override { return rd; }
+
+    read_result read(frame& out, const bool wanted) override {
+        unsigned char value = 0;
+        const auto n = ::read(rd, &value, 1);
+        if (n == 0) {
+            return read_result::end;
+        }
+        if (n < 0) {
+            return errno == EAGAIN ? read_result::none : read_result::end;
+        }
+        if (!wanted) {
+            return read_result::none;
+        }
+        out = frame {};
+        out.width = value;
+        return read_result::frame;
+    }
+
+private:
+    int rd;
+};
+
+// returns {read end, write end}; the read end is non-blocking if asked to
+std::pair<int, int> make_socket_pair(const bool nonblocking) {
+    int fds[2] = { -1, -1 };
+    const int type = SOCK_STREAM | (nonblocking ? SOCK_NONBLOCK : 0);
+    if (::socketpair(AF_UNIX, type, 0, fds) != 0) {
+        return { -1, -1 };
+    }
+    return { fds[0], fds[1] };
+}
+
+void send_byte(const int fd) {
+    const unsigned char value = 1;
+    [[maybe_unused]] const auto n = ::send(fd, &value, 1, MSG_NOSIGNAL);
+}
+
+void wait_count(const std::atomic<int>& count, const int expected) {
+    while (count.load() < expected) {
+        std::this_thread::yield();
+    }
+}
+
+// every iteration: each source produces one frame, wait until all arrived
+void bm_capture_engine(benchmark::State& state) {
+    const auto sources = static_cast<int>(state.range(0));
+    const auto io_threads = static_cast<int>(state.range(1));
+
+    std::atomic<int> delivered { 0 };
+    capture_engine engine({ io_threads, 2 });
+    std::vector<int> writers;
+    for (int i = 0; i < sources; ++i) {
+        const auto [rd, wr] = make_socket_pair(true);
+        if (rd < 0) {
+            state.SkipWithError("socketpair failed");
+            return;
+        }
+        engine.add(
+            std::to_string(i), std::make_unique<byte_source>(rd),
+            [&delivered](frame&&) { ++delivered; }
+        );
+        writers.push_back(wr);
+    }
+
+    int expected = 0;
+    for (auto _ : state) {
+        for (const int wr : writers) {
+            send_byte(wr);
+        }
+        expected += sources;
+        wait_count(delivered, expected - static_cast<int>(engine.dropped()));
+    }
+    state.SetItemsProcessed(state.iterations() * sources);
+    state.counters["threads"] = io_threads + 2;
+
+    for (const int wr : writers) {
+        ::close(wr);
+    }
+}
+BENCHMARK(bm_capture_engine)
+    ->ArgsProduct({ { 100, 300 }, { 1, 2, 4 } })
+    ->UseRealTime();
+
+// baseline: one blocking reader thread per source
+void bm_thread_per_source(benchmark::State& state) {
+    const auto sources = static_cast<int>(state.range(0));
+
+    std::atomic<int> delivered { 0 };
+    std::vector<int> writers;
+    std::vector<std::jthread> readers;
+    for (int i = 0; i < sources; ++i) {
+        const auto [rd, wr] = make_socket_pair(false);
+        if (rd < 0) {
+            state.SkipWithError("socketpair failed");
+            break;
+        }
+        readers.emplace_back([&delivered, rd] {
+            byte_source src(rd);
+            frame f;
+            while (src.read(f, true) == capture_source::read_result::frame) {
+                ++delivered;
+            }
+        });
+        writers.push_back(wr);
+    }
+
+    int expected = 0;
+    for (auto _ : state) {
+        for (const int wr : writers) {
+            send_byte(wr);
+        }
+        expected += sources;
+        wait_count(delivered, expected);
+    }
+    state.SetItemsProcessed(state.iterations() * sources);
+    state.counters["threads"] = sources;
+
+    // closing the write ends lets the blocked readers see end of input
+    for (const int wr : writers) {
+        ::close(wr);
+    }
+}
+BENCHMARK(bm_thread_per_source)->Arg(100)->Arg(300)->UseRealTime();
+
+// network cameras: one 8 KiB MJPEG part per source and iteration, parsed
+// from an HTTP multipart response; decoding is stubbed out, so this
+// measures the socket and parsing side only
+const std::string mjpeg_header = "HTTP/1.0 200 OK\r\n"
+                                 "Content-Type: multipart/x-mixed-replace;"
+                                 "boundary=frame\r\n\r\n";
+
+std::string mjpeg_part() {
+    std::string image(8 * 1024, 'x');
+    image[0] = '\xFF';
+    image[1] = '\xD8';
+    return "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: "
+        + std::to_string(image.size()) + "\r\n\r\n" + image + "\r\n";
+}
+
+bool stub_decode(const std::uint8_t*, const std::size_t size, frame& out) {
+    out = frame {};
+    out.width = static_cast<int>(size);
+    return true;
+}
+
+void send_text(const int fd, const std::string& text) {
+    std::size_t sent = 0;
+    while (sent < text.size()) {
+        const auto n = ::send(
+            fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL
+        );
+        if (n > 0) {
+            sent += static_cast<std::size_t>(n);
+        } else if (n < 0 && errno != EAGAIN) {
+            return;
+        }
+    }
+}
+
+void bm_http_mjpeg_engine(benchmark::State& state) {
+    const auto sources = static_cast<int>(state.range(0));
+    const auto io_threads = static_cast<int>(state.range(1));
+    const auto part = mjpeg_part();
+
+    std::atomic<int> delivered { 0 };
+    capture_engine engine({ io_threads, 2 });
+    std::vector<int> writers;
+    for (int i = 0; i < sources; ++i) {
+        const auto [rd, wr] = make_socket_pair(true);
+        if (rd < 0) {
+            state.SkipWithError("socketpair failed");
+            return;
+        }
+        send_text(wr, mjpeg_header);
+        engine.add(
+            std::to_string(i),
+            http_mjpeg_source::from_socket(rd, stub_decode),
+            [&delivered](frame&&) { ++delivered; }
+        );
+        writers.push_back(wr);
+    }
+
+    int expected = 0;
+    for (auto _ : state) {
+        for (const int wr : writers) {
+            send_text(wr, part);
+        }
+        expected += sources;
+        wait_count(delivered, expected - static_cast<int>(engine.dropped()));
+    }
+    state.SetItemsProcessed(state.iterations() * sources);
+    state.SetBytesProcessed(
+        state.iterations() * sources * static_cast<std::int64_t>(part.size())
+    );
+    state.counters["threads"] = io_threads + 2;
+
+    for (const int wr : writers) {
+        ::close(wr);
+    }
+}
+BENCHMARK(bm_http_mjpeg_engine)
+    ->ArgsProduct({ { 100, 300 }, { 1, 2, 4 } })
+    ->UseRealTime();
+
+// baseline: one thread per camera blocking on its socket
+void bm_http_mjpeg_threads(benchmark::State& state) {
+    const auto sources = static_cast<int>(state.range(0));
+    const auto part = mjpeg_part();
+
+    std::atomic<int> delivered { 0 };
+    std::vector<int> writers;
+    std::vector<std::jthread> readers;
+    for (int i = 0; i < sources; ++i) {
+        const auto [rd, wr] = make_socket_pair(false);
+        if (rd < 0) {
+            state.SkipWithError("socketpair failed");
+            break;
+        }
+        send_text(wr, mjpeg_header);
+        readers.emplace_back([&delivered, rd] {
+            auto src = http_mjpeg_source::from_socket(rd, stub_decode);
+            frame f;
+            while (true) {
+                const auto res = src->read(f, true);
+                if (res == capture_source::read_result::end) {
+                    break;
+                }
+                if (res == capture_source::read_result::frame
+                    && src->finish(f)) {
+                    ++delivered;
+                }
+            }
+        });
+        writers.push_back(wr);
+    }
+
+    int expected = 0;
+    for (auto _ : state) {
+        for (const int wr : writers) {
+            send_text(wr, part);
+        }
+        expected += sources;
+        wait_count(delivered, expected);
+    }
+    state.SetItemsProcessed(state.iterations() * sources);
+    state.SetBytesProcessed(
+        state.iterations() * sources * static_cast<std::int64_t>(part.size())
+    );
+    state.counters["threads"] = sources;
+
+    for (const int wr : writers) {
+        ::close(wr);
+    }
+}
+BENCHMARK(bm_http_mjpeg_threads)->Arg(100)->Arg(300)->UseRealTime();
+#endif
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,36 @@
+#include "frame_signature.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+using yodau::backend::compute_frame_signature;
+
+namespace {
+void bm_frame_signature(benchmark::State& state) {
+    const auto w = static_cast<int>(state.range(0));
+    const auto h = static_cast<int>(state.range(1));
+    const auto stride = static_cast<size_t>(w * 3);
+
+    std::mt19937 rng(1);
+    std::vector<std::uint8_t> img(stride * static_cast<size_t>(h));
+    for (auto& v : img) {
+        v = static_cast<std::uint8_t>(rng());
+    }
+
+    const auto ref = compute_frame_signature(img.data(), w, h, stride, 3);
+    for (auto _ : state) {
+        const auto sig = compute_frame_signature(img.data(), w, h, stride, 3);
+        benchmark::DoNotOptimize(
+            yodau::backend::same_scene(ref, sig, 2, 25)
+        );
+    }
+}
+BENCHMARK(bm_frame_signature)
+    ->Args({ 1280, 720 })
+    ->Args({ 1920, 1080 })
+    ->Args({ 3840, 2160 });
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,91 @@
+#include "geometry.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using yodau::backend::point;
+using yodau::backend::segment_batch;
+using yodau::backend::segment_hits;
+
+namespace {
+// jagged closed contour around the frame center, like an approximated
+// motion blob, plus a set of random tripwire segments
+struct scene {
+    std::vector<point> contour;
+    std::vector<point> lines;
+};
+
+scene make_scene(const int edges) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> radius(10.0f, 30.0f);
+    std::uniform_real_distribution<float> coord(0.0f, 100.0f);
+
+    scene out;
+    for (int i = 0; i < edges; ++i) {
+        const float angle = 6.2831853f * static_cast<float>(i)
+            / static_cast<float>(edges);
+        const float r = radius(rng);
+        out.contour.push_back(
+            { 50.0f + r * std::cos(angle), 50.0f + r * std::sin(angle) }
+        );
+    }
+    for (int i = 0; i < 64; ++i) {
+        out.lines.push_back({ coord(rng), coord(rng) });
+        out.lines.push_back({ coord(rng), coord(rng) });
+    }
+    return out;
+}
+
+void bm_segments_scalar(benchmark::State& state) {
+    const auto sc = make_scene(static_cast<int>(state.range(0)));
+    const auto& c = sc.contour;
+    for (auto _ : state) {
+        int hits = 0;
+        for (std::size_t l = 0; l < sc.lines.size(); l += 2) {
+            const auto& a = sc.lines[l];
+            const auto& b = sc.lines[l + 1];
+            for (std::size_t j = 0; j < c.size(); ++j) {
+                const auto& q1 = c[j];
+                const auto& q2 = c[(j + 1) % c.size()];
+                if (yodau::backend::segments_intersect(a, b, q1, q2)) {
+                    const auto ip
+                        = yodau::backend::segment_intersection(a, b, q1, q2);
+                    benchmark::DoNotOptimize(ip);
+                    ++hits;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(hits);
+    }
+    state.SetItemsProcessed(
+        state.iterations() * static_cast<std::int64_t>(sc.lines.size() / 2)
+    );
+}
+BENCHMARK(bm_segments_scalar)->Arg(8)->Arg(32)->Arg(128)->Arg(512);
+
+void bm_segments_batch(benchmark::State& state) {
+    const auto sc = make_scene(static_cast<int>(state.range(0)));
+    segment_batch edges;
+    edges.assign_chain(sc.contour, true);
+    segment_hits out;
+    for (auto _ : state) {
+        std::size_t hits = 0;
+        for (std::size_t l = 0; l < sc.lines.size(); l += 2) {
+            hits += yodau::backend::intersect_segments(
+                sc.lines[l], sc.lines[l + 1], edges, out
+            );
+            benchmark::DoNotOptimize(out.t.data());
+        }
+        benchmark::DoNotOptimize(hits);
+    }
+    state.SetItemsProcessed(
+        state.iterations() * static_cast<std::int64_t>(sc.lines.size() / 2)
+    );
+}
+BENCHMARK(bm_segments_batch)->Arg(8)->Arg(32)->Arg(128)->Arg(512);
+}
+
+BENCHMARK_MAIN();
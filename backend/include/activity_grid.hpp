@@ -0,0 +1,85 @@
+#ifndef YODAU_BACKEND_ACTIVITY_GRID_HPP
+#define YODAU_BACKEND_ACTIVITY_GRID_HPP
+
+#include "bit_mask.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace yodau::backend {
+
+/**
+ * @brief Fixed-size coarse summary of a binary motion mask.
+ *
+ * The frame is split into @ref cols x @ref rows cells of (almost) equal size.
+ * Every cell stores the share of changed (non-zero) mask pixels inside it,
+ * scaled to a byte:
+ * - 0   means no changed pixels,
+ * - 255 means every pixel of the cell changed.
+ *
+ * Cells are stored row-major, top-left cell first. The grid does not depend
+ * on frame resolution, so it can be drawn directly as a heatmap/overlay in
+ * percentage coordinates.
+ */
+struct activity_grid {
+    /** @brief Number of cells horizontally. */
+    static constexpr int cols { 32 };
+
+    /** @brief Number of cells vertically. */
+    static constexpr int rows { 18 };
+
+    /**
+     * @brief Per-cell activity levels (row-major).
+     */
+    std::array<std::uint8_t, cols * rows> cells {};
+
+    /**
+     * @brief Activity level of a single cell.
+     *
+     * @param cx Cell column in [0; cols).
+     * @param cy Cell row in [0; rows).
+     * @return Scaled share of changed pixels in the cell.
+     */
+    std::uint8_t at(int cx, int cy) const;
+
+    /**
+     * @brief Count cells whose level is at least @p min_level.
+     *
+     * @param min_level Minimal level for a cell to count as active.
+     * @return Number of active cells.
+     */
+    int active_cells(std::uint8_t min_level = 1) const;
+};
+
+/**
+ * @brief Build an @ref activity_grid from a binary 8-bit mask in one pass.
+ *
+ * Any non-zero mask byte counts as a changed pixel. Each mask row is split
+ * into contiguous per-cell spans, so the inner counting loop runs over plain
+ * byte ranges and is vectorized by the compiler.
+ *
+ * @param mask Pointer to the first mask row.
+ * @param width Mask width in pixels.
+ * @param height Mask height in pixels.
+ * @param stride Number of bytes between two consecutive rows.
+ * @return Computed grid; all zeros if the mask is empty.
+ */
+activity_grid compute_activity_grid(
+    const std::uint8_t* mask, int width, int height, std::size_t stride
+);
+
+/**
+ * @brief Build an @ref activity_grid from a packed mask.
+ *
+ * Same cell layout and scaling as the byte-mask overload; per-cell spans are
+ * counted with popcount.
+ *
+ * @param mask Packed binary mask.
+ * @return Computed grid; all zeros if the mask is empty.
+ */
+activity_grid compute_activity_grid(const bit_mask& mask);
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_ACTIVITY_GRID_HPP
@@ -0,0 +1,123 @@
+#ifndef YODAU_BACKEND_ADAPTIVE_SAMPLER_HPP
+#define YODAU_BACKEND_ADAPTIVE_SAMPLER_HPP
+
+#include "geometry.hpp"
+#include "line_set.hpp"
+
+#include <chrono>
+
+namespace yodau::backend {
+
+/**
+ * @brief Parameters of content-driven analysis sampling.
+ *
+ * The regular analysis interval (see
+ * @ref stream_manager::set_analysis_interval_ms) applies while motion is
+ * far from every line. It shrinks down to @ref min_interval while motion
+ * approaches or touches a line, and grows to @ref idle_interval once the
+ * scene has been quiet for @ref quiet.
+ */
+struct sampling_config {
+    /** @brief Whether sampling adapts at all (off: fixed interval). */
+    bool enabled { false };
+
+    /** @brief Interval while motion is at or about to reach a line. */
+    std::chrono::milliseconds min_interval { 40 };
+
+    /** @brief Interval of quiet scenes; never below the regular one. */
+    std::chrono::milliseconds idle_interval { 400 };
+
+    /** @brief How far ahead approaching motion is anticipated. */
+    std::chrono::milliseconds lookahead { 1000 };
+
+    /** @brief Time without motion after which a scene is quiet. */
+    std::chrono::milliseconds quiet { 2000 };
+
+    /** @brief Distance to a line, in percent, that counts as at the line. */
+    float near_pct { 5.0f };
+};
+
+/**
+ * @brief Motion tracker choosing the analysis interval of one stream.
+ *
+ * Fed with the positions of motion events, it keeps the last position and
+ * a smoothed velocity, and plans the next interval from the distance to
+ * the connected lines and the speed at which the motion closes in on them:
+ * motion that would reach a line within the lookahead is sampled about
+ * twice before it gets there, and at @ref sampling_config::min_interval
+ * once it is there. Newly appeared motion is looked at again after two
+ * minimum intervals to measure its velocity.
+ *
+ * Thread-safety:
+ * - Not synchronized; the owner serializes access.
+ */
+class adaptive_sampler {
+public:
+    /** @brief Time source of timestamps. */
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Record a motion position.
+     *
+     * @param pos Position in percentage coordinates.
+     * @param ts Time of the analyzed frame; non-decreasing across calls.
+     * @param cfg Sampling parameters (a gap longer than
+     * @ref sampling_config::quiet restarts the velocity estimate).
+     */
+    void observe(point pos, clock::time_point ts, const sampling_config& cfg);
+
+    /**
+     * @brief Interval to wait before the next analysis.
+     *
+     * @param lines Lines connected to the stream.
+     * @param cfg Sampling parameters.
+     * @param base Regular analysis interval.
+     * @param now Current time.
+     * @return Value in [@ref sampling_config::min_interval; max(base,
+     * @ref sampling_config::idle_interval)].
+     */
+    clock::duration plan(
+        const line_set& lines, const sampling_config& cfg, clock::duration base,
+        clock::time_point now
+    ) const;
+
+    /**
+     * @brief Plan and remember the next interval (see @ref interval).
+     */
+    void update(
+        const line_set& lines, const sampling_config& cfg, clock::duration base,
+        clock::time_point now
+    );
+
+    /** @brief Interval chosen by the last @ref update (zero before). */
+    clock::duration interval() const { return next; }
+
+    /** @brief Last observed position. */
+    point position() const { return pos; }
+
+    /** @brief Smoothed velocity, in percent per second. */
+    point velocity() const { return vel; }
+
+private:
+    /** @brief Last observed position. */
+    point pos {};
+
+    /** @brief Smoothed velocity, in percent per second. */
+    point vel {};
+
+    /** @brief Time of @ref pos. */
+    clock::time_point last {};
+
+    /** @brief Whether a position was observed. */
+    bool seen { false };
+
+    /** @brief Whether @ref vel holds an estimate. */
+    bool moving { false };
+
+    /** @brief Interval chosen by the last @ref update. */
+    clock::duration next {};
+};
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_ADAPTIVE_SAMPLER_HPP
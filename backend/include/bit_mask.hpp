@@ -0,0 +1,211 @@
+#ifndef YODAU_BACKEND_BIT_MASK_HPP
+#define YODAU_BACKEND_BIT_MASK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace yodau::backend {
+
+/**
+ * @brief Binary image stored with one bit per pixel.
+ *
+ * Every row is padded to a whole number of 64-bit words. Pixel @c x of a row
+ * is bit <tt>x % 64</tt> of word <tt>x / 64</tt> (least significant bit is the
+ * leftmost pixel). Padding bits past @ref width are always zero.
+ *
+ * Compared to a 0/255 byte mask, morphology and counting touch 8x less
+ * memory and process 64 pixels per instruction.
+ */
+class bit_mask {
+public:
+    /**
+     * @brief Construct an empty (0x0) mask.
+     */
+    bit_mask() = default;
+
+    /**
+     * @brief Construct a cleared mask of the given size.
+     *
+     * @param width Width in pixels (negative values are treated as 0).
+     * @param height Height in pixels (negative values are treated as 0).
+     */
+    bit_mask(int width, int height);
+
+    /**
+     * @brief Pack a byte mask; any non-zero byte becomes a set bit.
+     *
+     * @param data Pointer to the first byte row.
+     * @param width Width in pixels.
+     * @param height Height in pixels.
+     * @param stride Number of bytes between two consecutive rows.
+     * @return Packed mask.
+     */
+    static bit_mask from_bytes(
+        const std::uint8_t* data, int width, int height, std::size_t stride
+    );
+
+    /**
+     * @brief Unpack into a byte mask (set bits become 255, others 0).
+     *
+     * @param dst Pointer to the first destination row.
+     * @param stride Number of bytes between two consecutive rows.
+     */
+    void to_bytes(std::uint8_t* dst, std::size_t stride) const;
+
+    /** @brief Width in pixels. */
+    int width() const;
+
+    /** @brief Height in pixels. */
+    int height() const;
+
+    /** @brief Number of 64-bit words per row. */
+    int words_per_row() const;
+
+    /** @brief Whether the mask has no pixels. */
+    bool empty() const;
+
+    /**
+     * @brief Pointer to the first word of row @p y.
+     */
+    std::uint64_t* row(int y);
+
+    /**
+     * @brief Pointer to the first word of row @p y.
+     */
+    const std::uint64_t* row(int y) const;
+
+    /**
+     * @brief Read a single pixel; out-of-range coordinates read as unset.
+     */
+    bool test(int x, int y) const;
+
+    /**
+     * @brief Set or clear a single pixel; out-of-range coordinates are ignored.
+     */
+    void set(int x, int y, bool value = true);
+
+    /**
+     * @brief Number of set pixels (popcount over all words).
+     */
+    long long count() const;
+
+    /**
+     * @brief Number of set pixels in row @p y within [@p x0; @p x1).
+     */
+    long long count_span(int y, int x0, int x1) const;
+
+    /**
+     * @brief Mask of valid bits in the last word of every row.
+     */
+    std::uint64_t tail_mask() const;
+
+private:
+    /** @brief Width in pixels. */
+    int w { 0 };
+
+    /** @brief Height in pixels. */
+    int h { 0 };
+
+    /** @brief Words per row. */
+    int wpr { 0 };
+
+    /** @brief Row-major packed words. */
+    std::vector<std::uint64_t> words;
+};
+
+/**
+ * @brief Erode with a 3x3 square structuring element.
+ *
+ * Matches @c cv::erode with the default kernel and border: pixels outside
+ * the image do not clear their neighbours. Each pass shifts whole words left
+ * and right (carrying bits across word borders) and ANDs three rows.
+ *
+ * @param src Input mask.
+ * @param iterations Number of passes.
+ * @return Eroded mask.
+ */
+bit_mask erode(const bit_mask& src, int iterations = 1);
+
+/**
+ * @brief Dilate with a 3x3 square structuring element.
+ *
+ * Matches @c cv::dilate with the default kernel and border: pixels outside
+ * the image are unset.
+ *
+ * @param src Input mask.
+ * @param iterations Number of passes.
+ * @return Dilated mask.
+ */
+bit_mask dilate(const bit_mask& src, int iterations = 1);
+
+/**
+ * @brief Horizontal run of set pixels in a single row.
+ */
+struct bit_run {
+    /** @brief Row index. */
+    int y { 0 };
+
+    /** @brief First pixel of the run. */
+    int x0 { 0 };
+
+    /** @brief One past the last pixel of the run. */
+    int x1 { 0 };
+
+    /** @brief Index of the owning component in @ref bit_labels::components. */
+    int label { 0 };
+};
+
+/**
+ * @brief Statistics of a single 8-connected component.
+ */
+struct bit_component {
+    /** @brief Number of pixels. */
+    long long area { 0 };
+
+    /** @brief Left edge of the bounding box. */
+    int x0 { 0 };
+
+    /** @brief Top edge of the bounding box. */
+    int y0 { 0 };
+
+    /** @brief One past the right edge of the bounding box. */
+    int x1 { 0 };
+
+    /** @brief One past the bottom edge of the bounding box. */
+    int y1 { 0 };
+};
+
+/**
+ * @brief Result of @ref label_components.
+ */
+struct bit_labels {
+    /** @brief All runs in row-major order. */
+    std::vector<bit_run> runs;
+
+    /** @brief Components referenced by @ref bit_run::label. */
+    std::vector<bit_component> components;
+
+    /**
+     * @brief Index of the component with the largest area.
+     *
+     * @return -1 if there are no components.
+     */
+    int largest() const;
+};
+
+/**
+ * @brief Label 8-connected components of a mask.
+ *
+ * Runs are extracted with bit scans (count trailing zeros/ones) instead of
+ * visiting every pixel, then runs overlapping (diagonally included) a run
+ * of the previous row are merged with a union-find.
+ *
+ * @param mask Input mask.
+ * @return Runs and per-component statistics.
+ */
+bit_labels label_components(const bit_mask& mask);
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_BIT_MASK_HPP
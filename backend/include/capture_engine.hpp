@@ -0,0 +1,365 @@
+#ifndef YODAU_BACKEND_CAPTURE_ENGINE_HPP
+#define YODAU_BACKEND_CAPTURE_ENGINE_HPP
+
+#ifdef __linux__
+
+#include "frame.hpp"
+#include "stream.hpp"
+#include "v4l2_capture.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace yodau::backend {
+
+/**
+ * @brief Non-blocking frame source driven by @ref capture_engine.
+ *
+ * A source exposes a file descriptor (socket, V4L2 device, pipe...) that
+ * becomes readable when input is available. The engine waits on many such
+ * descriptors at once and calls @ref read only when the descriptor is ready,
+ * so @ref read must never block.
+ *
+ * Work that is too heavy for the I/O threads (e.g. decoding) belongs in
+ * @ref finish, which runs on a worker only for frames that are delivered.
+ */
+class capture_source {
+public:
+    /**
+     * @brief Outcome of @ref read.
+     */
+    enum class read_result {
+        /** A frame was produced. */
+        frame,
+        /** Input was consumed but no complete frame is available yet. */
+        none,
+        /** The source ended or failed; it is removed from the engine. */
+        end
+    };
+
+    virtual ~capture_source() = default;
+
+    /**
+     * @brief Descriptor the engine waits on for readability.
+     */
+    virtual int fd() const = 0;
+
+    /**
+     * @brief Consume available input.
+     *
+     * @param out Receives the frame on @ref read_result::frame.
+     * @param wanted Whether the frame will be consumed; if not, the source
+     * should advance without decoding or copying.
+     * @return Read outcome.
+     */
+    virtual read_result read(frame& out, bool wanted) = 0;
+
+    /**
+     * @brief Complete a frame returned by @ref read before it is delivered.
+     *
+     * Runs on a worker thread, never concurrently for one source, and only
+     * for frames that were not replaced by a newer one meanwhile.
+     *
+     * @param f Frame to complete in place.
+     * @return false to drop the frame.
+     */
+    virtual bool finish([[maybe_unused]] frame& f) { return true; }
+};
+
+/**
+ * @brief @ref capture_source over a memory-mapped @ref v4l2_capture.
+ */
+class v4l2_source final : public capture_source {
+public:
+    /**
+     * @brief Open a local stream with its requested capture format.
+     *
+     * The negotiated format is reported back to @p s.
+     *
+     * @param s Local stream ("/dev/videoN").
+     * @param io System call layer (defaults to libc).
+     * @return Source, or nullptr if the stream is not a local device or the
+     * device cannot stream a directly supported format.
+     */
+    static std::unique_ptr<capture_source>
+    open(const stream& s, std::shared_ptr<v4l2_io> io = system_v4l2_io());
+
+    int fd() const override;
+
+    read_result read(frame& out, bool wanted) override;
+
+private:
+    /** @brief Open capture. */
+    v4l2_capture cap;
+
+    explicit v4l2_source(std::shared_ptr<v4l2_io> io);
+};
+
+/**
+ * @brief @ref capture_source reading Motion JPEG over HTTP.
+ *
+ * Network cameras commonly serve their video as a
+ * `multipart/x-mixed-replace` response, one JPEG image per part. The source
+ * connects and sends the request when opened, then only reads its
+ * non-blocking socket when the engine reports it readable, splitting the
+ * body into images. If several images arrived at once only the newest is
+ * kept. Images are decoded by @ref finish, on a worker thread.
+ *
+ * Only plain `http://` URLs are supported; credentials in the URL are sent
+ * as HTTP basic authentication.
+ */
+class http_mjpeg_source final : public capture_source {
+public:
+    /**
+     * @brief Decodes one JPEG image into a frame.
+     *
+     * @param data Encoded image.
+     * @param size Number of bytes in @p data.
+     * @param out Receives the decoded frame.
+     * @return false if the image cannot be decoded.
+     */
+    using decoder_fn = std::function<bool(
+        const std::uint8_t* data, std::size_t size, frame& out
+    )>;
+
+    /**
+     * @brief Connect to an HTTP stream and request its video.
+     *
+     * Blocks for the connection, the request and the response header, each
+     * for at most @ref connect_timeout, so that other streams can be
+     * handed to a daemon thread instead.
+     *
+     * @param s Stream whose path is an `http://` URL.
+     * @param decode Image decoder (e.g. @ref opencv_client::decode_jpeg).
+     * @return Source, or nullptr if the path is not an HTTP URL, the
+     * connection fails or the response is not a multipart stream.
+     */
+    static std::unique_ptr<capture_source>
+    open(const stream& s, decoder_fn decode);
+
+    /**
+     * @brief Read a response from a socket the request was already sent on.
+     *
+     * @param fd Socket; owned by the source from now on.
+     * @param decode Image decoder.
+     * @return Source.
+     */
+    static std::unique_ptr<http_mjpeg_source>
+    from_socket(int fd, decoder_fn decode);
+
+    /** @brief Longest wait for each step of @ref open. */
+    static constexpr std::chrono::milliseconds connect_timeout { 5000 };
+
+    /** @brief Largest response header, part header or image accepted. */
+    static constexpr std::size_t max_part = 16 * 1024 * 1024;
+
+    ~http_mjpeg_source() override;
+
+    http_mjpeg_source(const http_mjpeg_source&) = delete;
+    http_mjpeg_source& operator=(const http_mjpeg_source&) = delete;
+
+    int fd() const override;
+
+    read_result read(frame& out, bool wanted) override;
+
+    /** @brief Decode the image read into @p f. */
+    bool finish(frame& f) override;
+
+private:
+    /** @brief Outcome of parsing buffered input. */
+    enum class parse_result { more, done, bad };
+
+    /** @brief Parse the response header, setting @ref delimiter. */
+    parse_result parse_response();
+
+    /**
+     * @brief Receive and parse the response header.
+     *
+     * @param timeout Longest wait for more input.
+     * @return Whether it announces a multipart stream.
+     */
+    bool await_response(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Parse the next complete image.
+     *
+     * @param begin Receives the offset of the image in @ref buf.
+     * @param end Receives the offset past the image.
+     */
+    parse_result next_image(std::size_t& begin, std::size_t& end);
+
+    http_mjpeg_source(int fd, decoder_fn decode);
+
+    /** @brief Connected socket. */
+    int sock { -1 };
+
+    /** @brief Image decoder. */
+    decoder_fn decode;
+
+    /** @brief Received input not yet discarded. */
+    std::vector<std::uint8_t> buf;
+
+    /** @brief Offset of the first unparsed byte in @ref buf. */
+    std::size_t pos { 0 };
+
+    /**
+     * @brief Part delimiter ("--" and the boundary); empty until the
+     * response header is parsed.
+     */
+    std::string delimiter;
+};
+
+/**
+ * @brief Multiplexed capture for many sources on a few threads.
+ *
+ * Instead of one blocking thread per stream, sources are spread over a small
+ * number of I/O threads, each waiting on its sources with epoll(7). A ready
+ * source is read on its I/O thread; the resulting frame is handed to a pool
+ * of worker threads that run the frame callback (decode-heavy work and
+ * analysis).
+ *
+ * Per source, callbacks are never run concurrently and frames are delivered
+ * in order. If the workers fall behind, a pending frame is replaced by the
+ * newer one (and counted, see @ref dropped) instead of queueing up, so one
+ * slow stream cannot grow memory or delay the others.
+ *
+ * The engine is independent of @ref stream_manager::daemon_start_fn: sources
+ * it cannot serve can still run on dedicated daemon threads (see
+ * @ref stream_manager::set_capture_engine).
+ *
+ * Thread-safety:
+ * - All public methods may be called concurrently, but not from inside the
+ *   callbacks of the source being removed.
+ */
+class capture_engine {
+public:
+    /**
+     * @brief Thread counts.
+     */
+    struct config {
+        /** @brief Threads waiting on sources. */
+        int io_threads { 2 };
+
+        /** @brief Threads running frame callbacks; 0 = one per core. */
+        int workers { 0 };
+    };
+
+    /**
+     * @brief Start the I/O and worker threads.
+     *
+     * @param cfg Thread counts.
+     */
+    explicit capture_engine(config cfg);
+
+    /** @brief Start with default thread counts. */
+    capture_engine();
+
+    /**
+     * @brief Stop all threads; running sources are dropped without their
+     * callbacks being called again.
+     */
+    ~capture_engine();
+
+    capture_engine(const capture_engine&) = delete;
+    capture_engine& operator=(const capture_engine&) = delete;
+
+    /**
+     * @brief Start serving a source.
+     *
+     * @p wants_frame runs on an I/O thread before each read, @p on_frame on a
+     * worker thread, mirroring the callbacks of
+     * @ref stream_manager::daemon_start_fn.
+     *
+     * @param key Unique source key (e.g. stream name).
+     * @param src Source to read.
+     * @param on_frame Frame callback.
+     * @param wants_frame Demand query; empty means every frame is wanted.
+     * @return false if @p key is already served or @p src is unusable.
+     */
+    bool add(
+        const std::string& key, std::unique_ptr<capture_source> src,
+        std::function<void(frame&&)> on_frame,
+        std::function<bool()> wants_frame = {}
+    );
+
+    /**
+     * @brief Stop serving a source.
+     *
+     * Returns once no callback of the source is running anymore; none is
+     * called afterwards.
+     *
+     * @param key Source key.
+     */
+    void remove(const std::string& key);
+
+    /**
+     * @brief Whether a source is served (it may have ended already).
+     */
+    bool contains(const std::string& key) const;
+
+    /** @brief Number of served sources. */
+    std::size_t size() const;
+
+    /** @brief Frames replaced before a worker picked them up, all sources. */
+    std::uint64_t dropped() const;
+
+private:
+    struct entry;
+    struct io_thread;
+
+    /** @brief Hand a read frame over to the workers. */
+    void deliver(const std::shared_ptr<entry>& e, frame&& f);
+
+    /** @brief Wait loop of one I/O thread. */
+    void run_io(io_thread& t, const std::stop_token& st);
+
+    /** @brief Loop of one worker thread. */
+    void run_worker(const std::stop_token& st);
+
+    /** @brief I/O threads; sources are assigned to the least loaded one. */
+    std::vector<std::unique_ptr<io_thread>> io;
+
+    /** @brief Served sources keyed by their key; guarded by @ref mtx. */
+    std::unordered_map<std::string, std::shared_ptr<entry>> entries;
+
+    /** @brief Next entry id (epoll cookie). */
+    std::uint64_t next_id { 1 };
+
+    /** @brief Mutex guarding @ref entries and @ref next_id. */
+    mutable std::mutex mtx;
+
+    /** @brief Entries with a pending frame, in arrival order. */
+    std::deque<std::shared_ptr<entry>> ready;
+
+    /** @brief Mutex guarding @ref ready. */
+    std::mutex ready_mtx;
+
+    /** @brief Signalled when @ref ready gets an entry. */
+    std::condition_variable_any ready_cv;
+
+    /** @brief Replaced frame count, see @ref dropped. */
+    std::atomic<std::uint64_t> drops { 0 };
+
+    /**
+     * @brief Worker threads; declared last so that they are joined before
+     * the queue they wait on is destroyed.
+     */
+    std::vector<std::jthread> workers;
+};
+
+} // namespace yodau::backend
+
+#endif // __linux__
+#endif // YODAU_BACKEND_CAPTURE_ENGINE_HPP
@@ -17,6 +17,7 @@ namespace yodau::backend {
  * - list/add/start/stop streams,
  * - list/add lines,
  * - connect lines to streams,
+ * - configure motion detection,
  * using cxxopts-style option parsing.
  *
  * The client does not own the manager; it holds a reference and issues
@@ -107,6 +108,9 @@ private:
      * - type (optional: local/file/rtsp/http)
      * - loop (optional: true/false)
      *
+     * Options: --size, --fps, --fourcc request a capture format (see
+     * @ref capture_format).
+     *
      * @param args Tokenized arguments.
      */
     void cmd_add_stream(const std::vector<std::string>& args) const;
@@ -168,6 +172,206 @@ private:
      */
     void cmd_set_line(const std::vector<std::string>& args) const;
 
+    /**
+     * @brief Handler for `set-detection`.
+     *
+     * Positional argument:
+     * - mode (optional: full/pyramid)
+     *
+     * Options:
+     * - --levels to set the pyramid depth,
+     * - --activation to set the coarse tile activation ratio,
+     * - --parallel-min-pixels to set the row-band parallelism threshold,
+     * - --packed to toggle bit-packed mask post-processing,
+     * - --static-tolerance to tune/disable the static-scene early-out,
+     * - --vector-area to tune/disable the motion vector pre-filter,
+     * - --analysis-width to decode Motion JPEG streams at reduced scale.
+     *
+     * Prints the resulting detection mode.
+     *
+     * @param args Tokenized arguments.
+     */
+    void cmd_set_detection(const std::vector<std::string>& args) const;
+
+    /**
+     * @brief Handler for `list-stats`.
+     *
+     * Prints per-stream analysis counters (frames skipped as static) and
+     * capture-to-event latency (last/average/max, ms).
+     *
+     * @param args Tokenized arguments.
+     */
+    void cmd_list_stats(const std::vector<std::string>& args) const;
+
+    /**
+     * @brief Handler for `set-playback`.
+     *
+     * Positional argument:
+     * - mode (optional: realtime/max)
+     *
+     * Prints the resulting file playback mode.
+     *
+     * @param args Tokenized arguments.
+     */
+    void cmd_set_playback(const std::vector<std::string>& args) const;
+
+    /**
+     * @brief Handler for `set-backend`.
+     *
+     * Positional argument:
+     * - backend (required: opencv/ffmpeg)
+     *
+     * Selects the capture daemon for streams started afterwards.
+     *
+     * @param args Tokenized arguments.
+     */
+    void cmd_set_backend(const std::vector<std::string>& args) const;
+
+    /**
+     * @brief Handler for `set-decoder`.
+     *
+     * Positional argument:
+     * - name (required)
+     *
+     * Options: --threads, --motion-vectors. Settings apply to the FFmpeg
+     * backend the next time the stream starts.
+     *
+     * @param args Tokenized arguments.
+     */
+    void cmd_set_decoder(const std::vector<std::string>& args) const;
+
+    /**
+     * @brief Handler for `set-ingest`.
+     *
+     * Positional argument:
+     * - mode (optional: buffered/low-latency)
+     *
+     * Applies to RTSP/HTTP streams started afterwards. Prints the resulting
+     * ingest mode.
+     *
+     * @param args Tokenized arguments.
+     */
+    void cmd_set_ingest(const std::vector<std::string>& args) const;
+
+    /**
+     * @brief Handler for `set-capture`.
+     *
+     * Positional argument:
+     * - mode (threads/engine)
+     *
+     * Options: --io-threads, --workers. `engine` serves local capture
+     * devices and MJPEG-over-HTTP cameras (see @ref http_mjpeg_source) on a
+     * shared @ref capture_engine; other streams keep their daemon threads.
+     * Applies to streams started afterwards (Linux only).
+     *
+     * @param args Tokenized arguments.
+     */
+    void cmd_set_capture(const std::vector<std::string>& args) const;
+
+    /**
+     * @brief Handler for `set-decode-budget`.
+     *
+     * Positional argument:
+     * - threads (optional; 0 = one per core)
+     *
+     * Applies to decoders opened afterwards. Prints the budget and the
+     * threads leased by each running stream.
+     *
+     * @param args Tokenized arguments.
+     */
+    void cmd_set_decode_budget(const std::vector<std::string>& args) const;
+
+    /**
+     * @brief Handler for `set-tripwire`.
+     *
+     * Positional argument:
+     * - name
+     *
+     * Options:
+     * - --mode (vector/raster)
+     *
+     * Prints the hit testing mode of the stream.
+     *
+     * @param args Tokenized arguments.
+     */
+    void cmd_set_tripwire(const std::vector<std::string>& args) const;
+
+    /**
+     * @brief Handler for `set-roi`.
+     *
+     * Options:
+     * - --enter, --exit (share of region pixels with motion)
+     * - --enter-frames, --exit-frames
+     * - --interval-ms
+     *
+     * Prints the resulting thresholds.
+     *
+     * @param args Tokenized arguments.
+     */
+    void cmd_set_roi(const std::vector<std::string>& args) const;
+
+    /**
+     * @brief Handler for `list-crossings`.
+     *
+     * Positional argument:
+     * - name (optional; all streams if omitted)
+     *
+     * Prints tripwire crossing counts per line over sliding windows, split
+     * by direction.
+     *
+     * @param args Tokenized arguments.
+     */
+    void cmd_list_crossings(const std::vector<std::string>& args) const;
+
+    /**
+     * @brief Handler for `set-rate`.
+     *
+     * Positional argument:
+     * - target (required: motion/tripwire/budget)
+     *
+     * Options:
+     * - --stream, --line to scope motion/tripwire limits,
+     * - --interval-ms, --burst to set the token bucket.
+     *
+     * Prints the resulting limit; for `budget` also the dropped events.
+     *
+     * @param args Tokenized arguments.
+     */
+    void cmd_set_rate(const std::vector<std::string>& args) const;
+
+    /**
+     * @brief Handler for `set-sampling`.
+     *
+     * Positional argument:
+     * - mode (optional: adaptive/fixed)
+     *
+     * Options:
+     * - --min-ms, --idle-ms, --lookahead-ms, --quiet-ms, --near-pct to tune
+     * adaptive sampling.
+     *
+     * Prints the resulting configuration.
+     *
+     * @param args Tokenized arguments.
+     */
+    void cmd_set_sampling(const std::vector<std::string>& args) const;
+
+    /**
+     * @brief Handler for `show-heatmap`.
+     *
+     * Positional argument:
+     * - name (stream name; required unless only --half-life-min is given)
+     *
+     * Options:
+     * - --output to write the map as a PGM image instead of printing it,
+     * - --half-life-min to set the decay of all maps,
+     * - --clear to forget the stream's map.
+     *
+     * Prints the map as text, one character per cell.
+     *
+     * @param args Tokenized arguments.
+     */
+    void cmd_show_heatmap(const std::vector<std::string>& args) const;
+
     /**
      * @brief Stream manager controlled by this CLI.
      *
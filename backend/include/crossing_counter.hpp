@@ -0,0 +1,212 @@
+#ifndef YODAU_BACKEND_CROSSING_COUNTER_HPP
+#define YODAU_BACKEND_CROSSING_COUNTER_HPP
+
+#include "event_batch.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace yodau::backend {
+
+/**
+ * @brief Tripwire crossings split by direction.
+ *
+ * Directions follow @ref crossing_dir: `neg_to_pos`, `pos_to_neg`, and
+ * `flat` for crossings without a clear side change.
+ */
+struct crossing_count {
+    /** @brief Crossings from the negative to the positive side. */
+    std::uint64_t neg_to_pos { 0 };
+
+    /** @brief Crossings from the positive to the negative side. */
+    std::uint64_t pos_to_neg { 0 };
+
+    /** @brief Crossings without a direction. */
+    std::uint64_t flat { 0 };
+
+    /** @brief Sum over all directions. */
+    std::uint64_t total() const { return neg_to_pos + pos_to_neg + flat; }
+
+    /**
+     * @brief Count one crossing in direction @p dir.
+     */
+    void add(crossing_dir dir);
+
+    /** @brief Add counts fieldwise. */
+    crossing_count& operator+=(const crossing_count& o);
+
+    /** @brief Subtract counts fieldwise. */
+    crossing_count& operator-=(const crossing_count& o);
+};
+
+/**
+ * @brief Sliding windows reported for every line.
+ */
+enum class crossing_window {
+    /** Last minute. */
+    minute,
+    /** Last 15 minutes. */
+    quarter_hour,
+    /** Last hour. */
+    hour,
+    /** Last 24 hours. */
+    day
+};
+
+/** @brief Number of @ref crossing_window values. */
+inline constexpr std::size_t crossing_window_count = 4;
+
+/** @brief Length of window @p w. */
+std::chrono::seconds crossing_window_span(crossing_window w);
+
+/** @brief Short label of window @p w ("1m", "15m", "1h", "24h"). */
+std::string_view crossing_window_name(crossing_window w);
+
+/**
+ * @brief Crossing counts of a sliding time window kept in a ring of buckets.
+ *
+ * The window is split into a fixed number of buckets of equal width; each
+ * bucket holds the counts of its time slice. Adding a crossing touches one
+ * bucket and a running sum, and buckets that slide out of the window are
+ * cleared lazily when time advances, so the cost per crossing is O(1) and
+ * memory does not depend on the crossing rate. The window boundary is
+ * resolved to one bucket width.
+ */
+class sliding_counter {
+public:
+    /** @brief Time source of timestamps. */
+    using clock = std::chrono::steady_clock;
+
+    /** @brief Counter without buckets; ignores all crossings. */
+    sliding_counter() = default;
+
+    /**
+     * @brief Counter of window @p span split into @p buckets buckets.
+     *
+     * @param span Window length.
+     * @param buckets Number of buckets (at least 1).
+     */
+    sliding_counter(clock::duration span, std::size_t buckets);
+
+    /**
+     * @brief Add @p delta at time @p ts.
+     *
+     * Timestamps older than the current bucket are accepted while they are
+     * still inside the window; older ones are dropped.
+     */
+    void add(const crossing_count& delta, clock::time_point ts);
+
+    /**
+     * @brief Counts of the window ending at @p now.
+     *
+     * Does not modify the counter; costs at most one pass over the buckets.
+     */
+    crossing_count total(clock::time_point now) const;
+
+    /** @brief Number of buckets. */
+    std::size_t bucket_count() const { return ring.size(); }
+
+private:
+    /** @brief Absolute index of the bucket containing @p t. */
+    long long bucket_of(clock::time_point t) const;
+
+    /** @brief Ring slot of absolute bucket @p b. */
+    std::size_t slot_of(long long b) const;
+
+    /** @brief Width of one bucket. */
+    clock::duration width { 0 };
+
+    /** @brief Per-bucket counts, indexed by @ref slot_of. */
+    std::vector<crossing_count> ring;
+
+    /** @brief Absolute index of the newest bucket. */
+    long long head { 0 };
+
+    /** @brief Sum of all buckets in @ref ring. */
+    crossing_count sum;
+};
+
+/**
+ * @brief Crossing counters of every (stream, line) pair.
+ *
+ * Each pair keeps one @ref sliding_counter per @ref crossing_window plus a
+ * lifetime total, about 6 KiB per line, allocated on its first crossing.
+ *
+ * Thread-safety:
+ * - Not synchronized; the owner serializes access.
+ */
+class crossing_counters {
+public:
+    /** @brief Time source of timestamps. */
+    using clock = sliding_counter::clock;
+
+    /** @brief Buckets per window. */
+    static constexpr std::size_t buckets_per_window = 60;
+
+    /**
+     * @brief Counts of one line of one stream.
+     */
+    struct row {
+        /** @brief Stream name. */
+        std::string stream_name;
+
+        /** @brief Line name. */
+        std::string line_name;
+
+        /** @brief Counts per window, indexed by @ref crossing_window. */
+        std::array<crossing_count, crossing_window_count> windows {};
+
+        /** @brief Counts since the first crossing. */
+        crossing_count total;
+    };
+
+    /**
+     * @brief Count one crossing.
+     *
+     * @param stream_name Stream name.
+     * @param line_name Line name.
+     * @param dir Crossing direction.
+     * @param ts Crossing time.
+     */
+    void add(
+        const std::string& stream_name, const std::string& line_name,
+        crossing_dir dir, clock::time_point ts
+    );
+
+    /**
+     * @brief Counts of all lines, sorted by stream and line name.
+     *
+     * @param stream_name Only this stream; all streams if empty.
+     * @param now End of the windows.
+     */
+    std::vector<row>
+    snapshot(const std::string& stream_name, clock::time_point now) const;
+
+private:
+    /**
+     * @brief Counters of one line.
+     */
+    struct line_counters {
+        line_counters();
+
+        /** @brief One counter per @ref crossing_window. */
+        std::array<sliding_counter, crossing_window_count> windows;
+
+        /** @brief Counts since the first crossing. */
+        crossing_count total;
+    };
+
+    /** @brief Counters keyed by stream name, then line name. */
+    std::unordered_map<
+        std::string, std::unordered_map<std::string, line_counters>>
+        streams;
+};
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_CROSSING_COUNTER_HPP
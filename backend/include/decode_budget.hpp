@@ -0,0 +1,204 @@
+#ifndef YODAU_BACKEND_DECODE_BUDGET_HPP
+#define YODAU_BACKEND_DECODE_BUDGET_HPP
+
+#include "stream.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace yodau::backend {
+
+/**
+ * @brief Process-wide budget of decoder threads shared by all streams.
+ *
+ * Left alone, every decoder starts one thread per core, so a few dozen
+ * streams oversubscribe the machine many times over. Instead, each stream
+ * @ref acquire "leases" its thread count from the budget when its decoder is
+ * opened:
+ *
+ * @code
+ * threads = max(1, min(ceil(pixels / pixels_per_thread), max_per_stream,
+ *                      total * pixels / (pixels + active pixels),
+ *                      total - leased))
+ * @endcode
+ *
+ * i.e. higher resolutions get more threads, a stream never takes more than
+ * its resolution-weighted share of the budget, and the leases stay within
+ * the budget until it is used up. Past that point every further stream still
+ * gets one thread, so at most budget + (streams beyond it) threads run.
+ *
+ * The resolution of files and network streams is often only known once the
+ * source is probed; such streams @ref reacquire their lease with the probed
+ * size before the decoder starts.
+ *
+ * A decoder cannot change its thread count while running, so leases are
+ * fixed for their lifetime; a stream picks up a changed budget the next time
+ * it starts.
+ *
+ * Thread-safety:
+ * - All methods may be called concurrently.
+ */
+class decode_budget {
+public:
+    /** @brief Decoded pixels per frame one thread is sized for (1080p / 4). */
+    static constexpr std::int64_t pixels_per_thread { 1920 * 1080 / 4 };
+
+    /**
+     * @brief Upper bound per stream; frame threading delays every frame by
+     * one frame per thread, for diminishing throughput gains.
+     */
+    static constexpr std::int64_t max_per_stream { 8 };
+
+    /** @brief Resolution assumed for streams that did not report one. */
+    static constexpr int default_width { 1920 };
+
+    /** @brief See @ref default_width. */
+    static constexpr int default_height { 1080 };
+
+    /**
+     * @brief One stream's lease, as reported by @ref allocations.
+     */
+    struct allocation {
+        /** @brief Stream name. */
+        std::string name;
+
+        /** @brief Frame width the lease was sized for. */
+        int width { 0 };
+
+        /** @brief Frame height the lease was sized for. */
+        int height { 0 };
+
+        /** @brief Leased decoder threads. */
+        int threads { 0 };
+    };
+
+    /**
+     * @brief Decoder thread lease; returned to the budget on destruction.
+     */
+    class lease {
+    public:
+        lease() = default;
+        ~lease();
+
+        lease(lease&& other) noexcept;
+        lease& operator=(lease&& other) noexcept;
+
+        lease(const lease&) = delete;
+        lease& operator=(const lease&) = delete;
+
+        /** @brief Leased thread count; 0 for an empty lease. */
+        int threads() const;
+
+    private:
+        friend class decode_budget;
+
+        lease(decode_budget* from, std::uint64_t lease_id, int threads);
+
+        /** @brief Return the threads to the owner, if any. */
+        void release();
+
+        /** @brief Budget the threads were leased from. */
+        decode_budget* owner { nullptr };
+
+        /** @brief Lease id within @ref owner. */
+        std::uint64_t id { 0 };
+
+        /** @brief Leased thread count. */
+        int count { 0 };
+    };
+
+    /**
+     * @brief Construct a budget.
+     *
+     * @param total Thread budget; 0 = one thread per core.
+     */
+    explicit decode_budget(int total = 0);
+
+    /**
+     * @brief Change the budget for leases acquired afterwards.
+     *
+     * @param total Thread budget; 0 = one thread per core.
+     */
+    void set_total(int total);
+
+    /** @brief Current thread budget. */
+    int total() const;
+
+    /**
+     * @brief Lease decoder threads for a stream.
+     *
+     * @param name Stream name (for reporting).
+     * @param width Frame width, or 0 if unknown.
+     * @param height Frame height, or 0 if unknown.
+     * @param fixed Thread count chosen by the user; counted against the
+     * budget as is. 0 lets the budget decide.
+     * @return Lease; keep it alive as long as the decoder runs.
+     */
+    lease
+    acquire(const std::string& name, int width, int height, int fixed = 0);
+
+    /**
+     * @brief Lease decoder threads for a stream sized by its requested
+     * capture format, or by the format negotiated on its previous start.
+     *
+     * @param s Stream.
+     * @param fixed See above.
+     * @return Lease.
+     */
+    lease acquire(const stream& s, int fixed = 0);
+
+    /**
+     * @brief Replace a lease by one sized for a probed resolution.
+     *
+     * The threads of @p held are returned first, so the stream does not
+     * compete with its own earlier lease.
+     *
+     * @param held In/out: lease to replace; may be empty.
+     * @param name Stream name.
+     * @param width Probed frame width, or 0 if unknown.
+     * @param height Probed frame height, or 0 if unknown.
+     * @param fixed See @ref acquire.
+     */
+    void reacquire(
+        lease& held, const std::string& name, int width, int height,
+        int fixed = 0
+    );
+
+    /** @brief Threads currently leased, all streams. */
+    int leased() const;
+
+    /** @brief Current leases in acquisition order. */
+    std::vector<allocation> allocations() const;
+
+private:
+    struct record {
+        std::uint64_t id;
+        allocation alloc;
+    };
+
+    /** @brief Drop a lease record. */
+    void release(std::uint64_t id);
+
+    /** @brief Mutex guarding all fields. */
+    mutable std::mutex mtx;
+
+    /** @brief Thread budget. */
+    int budget { 1 };
+
+    /** @brief Live leases. */
+    std::vector<record> records;
+
+    /** @brief Next lease id. */
+    std::uint64_t next_id { 1 };
+};
+
+/**
+ * @brief Budget shared by all capture backends of the process.
+ */
+decode_budget& global_decode_budget();
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_DECODE_BUDGET_HPP
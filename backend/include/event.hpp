@@ -5,6 +5,7 @@
 #include <optional>
 #include <string>
 
+#include "activity_grid.hpp"
 #include "geometry.hpp"
 
 namespace yodau::backend {
@@ -19,6 +20,8 @@ namespace yodau::backend {
 enum class event_kind {
     /** Motion was detected in the stream. */
     motion,
+    /** Coarse per-frame motion summary carried in @ref event::grid. */
+    motion_grid,
     /** A tripwire (line crossing) condition was triggered. */
     tripwire,
     /** A region-of-interest related event was triggered. */
@@ -84,6 +87,14 @@ struct event {
      * Used primarily for tripwire / ROI events; may be empty otherwise.
      */
     std::string line_name;
+
+    /**
+     * @brief Optional coarse activity grid of the analyzed frame.
+     *
+     * Filled for @ref event_kind::motion_grid events, one per analyzed frame
+     * with motion, and usable directly as a heatmap/overlay.
+     */
+    std::optional<activity_grid> grid;
 };
 
 } // namespace yodau::backend
@@ -0,0 +1,317 @@
+#ifndef YODAU_BACKEND_EVENT_BATCH_HPP
+#define YODAU_BACKEND_EVENT_BATCH_HPP
+
+#include "activity_grid.hpp"
+#include "event.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace yodau::backend {
+
+/**
+ * @brief Interned names (streams, lines, event messages).
+ *
+ * Every distinct string gets a small stable id; id 0 is the empty string.
+ * Names are never removed, so the table grows with the number of distinct
+ * names (configuration), not with the number of events.
+ *
+ * Thread-safety:
+ * - All methods are safe to call concurrently; lookups of known names take
+ *   a shared lock and do not allocate.
+ */
+class name_table {
+public:
+    /** @brief Id of the empty name. */
+    static constexpr std::uint32_t empty_id { 0 };
+
+    /** @brief Table holding only the empty name. */
+    name_table();
+
+    name_table(const name_table&) = delete;
+    name_table& operator=(const name_table&) = delete;
+
+    /**
+     * @brief Id of @p s, adding it on first use.
+     */
+    std::uint32_t intern(std::string_view s);
+
+    /**
+     * @brief Name of @p id.
+     *
+     * The reference stays valid for the lifetime of the table.
+     *
+     * @param id Id returned by @ref intern (the empty name otherwise).
+     */
+    const std::string& name(std::uint32_t id) const;
+
+    /** @brief Number of names, including the empty one. */
+    std::size_t size() const;
+
+private:
+    /** @brief Names by id; a deque keeps references stable. */
+    std::deque<std::string> names;
+
+    /** @brief Ids by name; keys view @ref names. */
+    std::unordered_map<std::string_view, std::uint32_t> ids;
+
+    /** @brief Guards @ref names and @ref ids. */
+    mutable std::shared_mutex mtx;
+};
+
+/**
+ * @brief Access the process-wide @ref name_table used by event batches.
+ */
+name_table& global_names();
+
+/**
+ * @brief Direction of a tripwire crossing.
+ */
+enum class crossing_dir : std::uint8_t {
+    /** No clear side change. */
+    flat,
+    /** From the negative to the positive side. */
+    neg_to_pos,
+    /** From the positive to the negative side. */
+    pos_to_neg
+};
+
+/**
+ * @brief Message of a tripwire event for @p d ("flat", "neg_to_pos",
+ * "pos_to_neg").
+ */
+std::string_view crossing_dir_name(crossing_dir d);
+
+/**
+ * @brief Direction named by a tripwire event message; unknown names are
+ * @ref crossing_dir::flat.
+ */
+crossing_dir parse_crossing_dir(std::string_view s);
+
+/**
+ * @brief Fixed-size form of an @ref event.
+ *
+ * Strings are replaced by @ref name_table ids, the tripwire direction by
+ * an enum, the optional position by NaN coordinates and the activity grid
+ * by an index into the owning @ref event_batch. Trivially copyable.
+ */
+struct compact_event {
+    /** @brief Id of @ref grid when there is no activity grid. */
+    static constexpr std::uint32_t no_grid {
+        std::numeric_limits<std::uint32_t>::max()
+    };
+
+    /** @brief Event time. */
+    std::chrono::steady_clock::time_point ts {};
+
+    /** @brief Interned stream name. */
+    std::uint32_t stream { name_table::empty_id };
+
+    /** @brief Interned line name. */
+    std::uint32_t line { name_table::empty_id };
+
+    /**
+     * @brief Interned message; empty for tripwires, whose message is
+     * @ref dir.
+     */
+    std::uint32_t message { name_table::empty_id };
+
+    /** @brief Activity grid index in the batch, or @ref no_grid. */
+    std::uint32_t grid { no_grid };
+
+    /** @brief Position in percentage coordinates; NaN if absent. */
+    float x { std::numeric_limits<float>::quiet_NaN() };
+
+    /** @brief Position in percentage coordinates; NaN if absent. */
+    float y { std::numeric_limits<float>::quiet_NaN() };
+
+    /** @brief Event kind. */
+    event_kind kind { event_kind::info };
+
+    /** @brief Crossing direction of tripwire events. */
+    crossing_dir dir { crossing_dir::flat };
+
+    /** @brief Whether the event carries a position. */
+    bool has_pos() const { return !std::isnan(x); }
+};
+
+/**
+ * @brief Activity of one analyzed frame (see @ref event_batch::add_activity).
+ */
+struct frame_activity {
+    /** @brief Activity of the frame's motion mask. */
+    activity_grid grid;
+
+    /** @brief Frame time. */
+    std::chrono::steady_clock::time_point ts {};
+
+    /**
+     * @brief Motion position in percentage coordinates; NaN if the frame has
+     * no motion (see @ref event_batch::set_activity_pos).
+     */
+    float x { std::numeric_limits<float>::quiet_NaN() };
+
+    /** @brief Motion position in percentage coordinates; NaN if absent. */
+    float y { std::numeric_limits<float>::quiet_NaN() };
+
+    /** @brief Whether the frame has a motion position. */
+    bool has_pos() const { return !std::isnan(x); }
+};
+
+/**
+ * @brief Events of one delivery stored as a struct of arrays.
+ *
+ * Each field of @ref compact_event is a separate column, so consumers that
+ * only look at a few fields (kind, stream, time) scan dense arrays, and a
+ * batch reused across frames reaches a steady state without allocations.
+ * Activity grids are stored once in a side array.
+ *
+ * @ref to_event converts back to the string-based @ref event for consumers
+ * such as the GUI.
+ *
+ * Thread-safety:
+ * - Not synchronized.
+ */
+class event_batch {
+public:
+    /** @brief Number of events. */
+    std::size_t size() const { return kind.size(); }
+
+    /** @brief Whether the batch holds no events. */
+    bool empty() const { return kind.empty(); }
+
+    /** @brief Remove all events and activity records; capacity is kept. */
+    void clear();
+
+    /**
+     * @brief Keep only the first @p n events.
+     */
+    void truncate(std::size_t n);
+
+    /**
+     * @brief Append an event.
+     *
+     * @param e Event; its @ref compact_event::grid must be an index returned
+     * by @ref add_grid or @ref compact_event::no_grid.
+     */
+    void push_back(const compact_event& e);
+
+    /**
+     * @brief Append an @ref event, interning its strings in @p names.
+     */
+    void push_back(const event& e, name_table& names = global_names());
+
+    /**
+     * @brief Store an activity grid for a following @ref push_back.
+     *
+     * @return Index to put in @ref compact_event::grid.
+     */
+    std::uint32_t add_grid(const activity_grid& g);
+
+    /**
+     * @brief Record the activity of an analyzed frame.
+     *
+     * Unlike motion grid events, which only follow frames passing the
+     * event cutoffs and rate limits, a record is added for every analyzed
+     * frame. Records are not events: @ref truncate keeps them and they never
+     * reach event sinks (see @ref stream_manager::heatmap).
+     */
+    void add_activity(
+        const activity_grid& g, std::chrono::steady_clock::time_point ts
+    );
+
+    /**
+     * @brief Set the motion position of the last activity record.
+     *
+     * Like the record itself it is set for every analyzed frame with motion,
+     * also when the motion event is dropped by a rate limit (see
+     * @ref stream_manager::set_sampling). No-op without a record.
+     */
+    void set_activity_pos(float px, float py);
+
+    /** @brief Activity records in insertion order. */
+    std::span<const frame_activity> activity() const { return frames; }
+
+    /** @brief Event @p i in compact form. */
+    compact_event at(std::size_t i) const;
+
+    /**
+     * @brief Event @p i as an @ref event, with names from @p names.
+     */
+    event
+    to_event(std::size_t i, const name_table& names = global_names()) const;
+
+    /**
+     * @brief All events as @ref event objects.
+     */
+    std::vector<event>
+    to_events(const name_table& names = global_names()) const;
+
+    /** @brief Activity grid @p i (see @ref add_grid). */
+    const activity_grid& grid_at(std::uint32_t i) const { return grids[i]; }
+
+    /** @brief Column of event kinds. */
+    std::span<const event_kind> kinds() const { return kind; }
+
+    /** @brief Column of crossing directions. */
+    std::span<const crossing_dir> dirs() const { return dir; }
+
+    /** @brief Column of interned stream names. */
+    std::span<const std::uint32_t> streams() const { return stream_id; }
+
+    /** @brief Column of interned line names. */
+    std::span<const std::uint32_t> lines() const { return line_id; }
+
+    /** @brief Column of event times. */
+    std::span<const std::chrono::steady_clock::time_point> times() const {
+        return ts;
+    }
+
+private:
+    /** @brief Event kinds. */
+    std::vector<event_kind> kind;
+
+    /** @brief Crossing directions. */
+    std::vector<crossing_dir> dir;
+
+    /** @brief Interned stream names. */
+    std::vector<std::uint32_t> stream_id;
+
+    /** @brief Interned line names. */
+    std::vector<std::uint32_t> line_id;
+
+    /** @brief Interned messages. */
+    std::vector<std::uint32_t> message_id;
+
+    /** @brief Activity grid indices. */
+    std::vector<std::uint32_t> grid_id;
+
+    /** @brief Event times. */
+    std::vector<std::chrono::steady_clock::time_point> ts;
+
+    /** @brief Horizontal positions. */
+    std::vector<float> x;
+
+    /** @brief Vertical positions. */
+    std::vector<float> y;
+
+    /** @brief Activity grids referenced by @ref grid_id. */
+    std::vector<activity_grid> grids;
+
+    /** @brief Activity records of analyzed frames. */
+    std::vector<frame_activity> frames;
+};
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_EVENT_BATCH_HPP
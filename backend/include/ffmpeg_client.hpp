@@ -0,0 +1,317 @@
+#ifndef YODAU_BACKEND_FFMPEG_CLIENT_HPP
+#define YODAU_BACKEND_FFMPEG_CLIENT_HPP
+
+#ifdef YODAU_FFMPEG
+
+#include "frame.hpp"
+#include "stream.hpp"
+#include "stream_manager.hpp"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <unordered_map>
+
+namespace yodau::backend {
+
+/**
+ * @brief Demuxer + decoder for one source built directly on libavformat and
+ * libavcodec.
+ *
+ * Compared to @c cv::VideoCapture this gives control over decoder threading,
+ * exposes the source presentation timestamps and can export the codec's
+ * motion vectors (@c AV_FRAME_DATA_MOTION_VECTORS) into
+ * @ref frame::motion_vectors.
+ *
+ * Frames are delivered as @ref pixel_format::gray8, which is all the motion
+ * analysis reads. For planar/semi-planar YUV and grey decoder output the luma
+ * plane is referenced without copying (@ref frame::external holds a
+ * reference to the decoded picture); other formats are converted with
+ * libswscale.
+ */
+class ffmpeg_capture {
+public:
+    /**
+     * @brief Decoder settings.
+     */
+    struct config {
+        /**
+         * @brief Decoder threads; 0 lets libavcodec choose per core count.
+         *
+         * Frame threading adds one frame of latency per thread, so live
+         * sources that care about latency should use small values.
+         */
+        int threads { 0 };
+
+        /**
+         * @brief Called with the coded frame size once the source is
+         * probed; its result replaces @ref threads.
+         *
+         * Lets the thread count depend on a resolution that is unknown
+         * before opening (see @ref decode_budget::reacquire).
+         */
+        std::function<int(int width, int height)> size_threads;
+
+        /** @brief Export codec motion vectors with each frame. */
+        bool motion_vectors { true };
+
+        /**
+         * @brief Minimize demuxer and decoder buffering.
+         *
+         * Disables input buffering and reordering delay in the demuxer,
+         * enables the decoder's low-delay mode and restricts threading to
+         * slices, which add no frame delay.
+         */
+        bool low_delay { false };
+
+        /**
+         * @brief Frame width analysis needs; 0 decodes at full size.
+         *
+         * Decoders that can scale in the DCT domain (Motion JPEG) then
+         * decode at 1/2, 1/4 or 1/8 size (@c AVCodecContext::lowres), the
+         * largest reduction still at least this wide (see
+         * @ref jpeg_reduction).
+         */
+        int analysis_width { 0 };
+
+        /**
+         * @brief Format requested from the source.
+         *
+         * Passed to the demuxer as @c video_size, @c framerate and
+         * @c input_format; only capture device inputs use them.
+         */
+        capture_format format;
+    };
+
+    /**
+     * @brief Outcome of @ref read / @ref skip.
+     */
+    enum class read_result {
+        /** A frame was decoded. */
+        ok,
+        /** The source ended and the decoder is drained. */
+        end,
+        /** Demuxing or decoding failed. */
+        error
+    };
+
+    ffmpeg_capture();
+
+    ~ffmpeg_capture();
+
+    ffmpeg_capture(const ffmpeg_capture&) = delete;
+    ffmpeg_capture& operator=(const ffmpeg_capture&) = delete;
+
+    /**
+     * @brief Open a file or URL and its best video stream.
+     *
+     * @param url File path or URL understood by libavformat.
+     * @param cfg Decoder settings.
+     * @return true on success.
+     */
+    bool open(const std::string& url, const config& cfg);
+
+    /** @brief Release the demuxer and decoder. */
+    void close();
+
+    /** @brief Whether a source is open. */
+    bool is_open() const;
+
+    /**
+     * @brief Decode the next frame.
+     *
+     * @param out Receives the frame on @ref read_result::ok.
+     * @return Read outcome.
+     */
+    read_result read(frame& out);
+
+    /**
+     * @brief Consume the next video packet without producing a frame.
+     *
+     * Frames no other frame depends on (@c AVDISCARD_NONREF) are not
+     * decoded at all; reference frames are decoded to keep the decoder state
+     * valid and dropped.
+     *
+     * @return Read outcome.
+     */
+    read_result skip();
+
+    /**
+     * @brief Seek back to the first frame, keeping demuxer and decoder.
+     *
+     * @return false if the source is not seekable.
+     */
+    bool rewind();
+
+    /** @brief Average frame rate of the video stream, 0 if unknown. */
+    double fps() const;
+
+    /**
+     * @brief Format of the opened video stream: coded size, frame rate and
+     * the container's codec tag (empty if it has none).
+     */
+    capture_format format() const;
+
+    /**
+     * @brief Timestamp of the last packet sent to the decoder, ms.
+     *
+     * Uses the decode timestamp, which (unlike the presentation timestamp)
+     * increases monotonically in the order packets are read; negative if
+     * unknown. Suitable for pacing both decoded and skipped packets.
+     */
+    double packet_ms() const;
+
+private:
+    struct state;
+
+    /**
+     * @brief Send the next video packet (or the flush packet at the end of
+     * input) to the decoder.
+     */
+    read_result feed();
+
+    /** @brief Fill @p out from the decoded picture in the state. */
+    bool to_frame(frame& out);
+
+    /** @brief Demuxer/decoder state; null when closed. */
+    std::unique_ptr<state> impl;
+};
+
+/**
+ * @brief Capture daemon using @ref ffmpeg_capture.
+ *
+ * Mirrors the capture side of @ref opencv_client: one instance holds
+ * per-stream decoder settings and provides a hook for
+ * @ref stream_manager::set_daemon_start_hook.
+ *
+ * Thread-safety:
+ * - Public methods are safe to call concurrently.
+ */
+class ffmpeg_client {
+public:
+    /**
+     * @brief Set decoder settings used the next time a stream starts.
+     *
+     * @param stream_name Stream name.
+     * @param cfg Decoder settings.
+     */
+    void set_decoder_config(
+        const std::string& stream_name, const ffmpeg_capture::config& cfg
+    );
+
+    /**
+     * @brief Decoder settings of a stream (defaults if none were set).
+     */
+    ffmpeg_capture::config decoder_config(const std::string& stream_name
+    ) const;
+
+    /**
+     * @brief Set whether file streams are paced to their timestamps.
+     *
+     * @param enabled false delivers file frames as fast as they decode.
+     */
+    void set_realtime_files(bool enabled);
+
+    /** @brief Whether file streams are paced to their timestamps. */
+    bool realtime_files() const;
+
+    /**
+     * @brief Enable low-latency ingest for network (RTSP/HTTP) streams.
+     *
+     * Network streams started afterwards open with
+     * @ref ffmpeg_capture::config::low_delay, are read on a separate thread
+     * with newest-frame handoff (see @ref deliver_latest) and stamped from
+     * source timestamps (see @ref source_clock).
+     *
+     * @param enabled Whether the mode is on (default: off).
+     */
+    void set_low_latency(bool enabled);
+
+    /** @brief Whether low-latency ingest is enabled. */
+    bool low_latency() const;
+
+    /**
+     * @brief Set the frame width analysis needs for streams started
+     * afterwards (see @ref ffmpeg_capture::config::analysis_width).
+     *
+     * @param px Width in pixels; 0 or less decodes at full size (default).
+     */
+    void set_analysis_width(int px);
+
+    /** @brief Current analysis width (0 = full size). */
+    int analysis_width() const;
+
+    /**
+     * @brief Capture loop for a stream.
+     *
+     * Local devices are opened by path like any other input. File streams
+     * are paced with a @ref playback_clock driven by packet timestamps
+     * (@ref ffmpeg_capture::packet_ms) and rewound on end-of-file if
+     * looping is enabled. Frames @p wants_frame declines are skipped with
+     * @ref ffmpeg_capture::skip.
+     *
+     * Unless the stream's decoder threads were set explicitly, they are
+     * leased from @ref global_decode_budget for as long as the loop runs.
+     *
+     * @param s Stream describing the source.
+     * @param on_frame Callback invoked for each frame (frame is moved).
+     * @param wants_frame Demand query; may be empty.
+     * @param st Stop token used for cooperative cancellation.
+     */
+    void daemon_start(
+        const stream& s, const std::function<void(frame&&)>& on_frame,
+        const std::function<bool()>& wants_frame, const std::stop_token& st
+    );
+
+    /**
+     * @brief Create a @ref stream_manager::daemon_start_fn bound to this
+     * instance.
+     */
+    stream_manager::daemon_start_fn daemon_start_fn();
+
+private:
+    /** @brief Mutex guarding the settings below. */
+    mutable std::mutex mtx;
+
+    /** @brief Decoder settings per stream name. */
+    std::unordered_map<std::string, ffmpeg_capture::config> config_by_stream;
+
+    /** @brief Whether file streams are paced. */
+    bool realtime { true };
+
+    /** @brief Whether network streams use low-latency ingest. */
+    bool low_latency_ingest { false };
+
+    /** @brief Analysis width applied to decoders; 0 = full size. */
+    int target_width { 0 };
+};
+
+/**
+ * @brief Access the global @ref ffmpeg_client instance.
+ *
+ * This is the instance used by @ref ffmpeg_daemon_start.
+ */
+ffmpeg_client& global_ffmpeg_client();
+
+/**
+ * @brief Global FFmpeg daemon start wrapper.
+ *
+ * Forwards to the @ref global_ffmpeg_client instance; usable as a
+ * @ref stream_manager::daemon_start_fn.
+ *
+ * @param s Stream to capture.
+ * @param on_frame Callback invoked with captured frames.
+ * @param wants_frame Demand query for the next frame.
+ * @param st Stop token.
+ */
+void ffmpeg_daemon_start(
+    const stream& s, const std::function<void(frame&&)>& on_frame,
+    const std::function<bool()>& wants_frame, const std::stop_token& st
+);
+
+} // namespace yodau::backend
+
+#endif // YODAU_FFMPEG
+#endif // YODAU_BACKEND_FFMPEG_CLIENT_HPP
@@ -1,8 +1,12 @@
 #ifndef YODAU_BACKEND_FRAME_HPP
 #define YODAU_BACKEND_FRAME_HPP
 
+#include "motion_vectors.hpp"
+
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace yodau::backend {
@@ -23,7 +27,9 @@ enum class pixel_format {
     /** RGBA, 8-bit per channel, 4 bytes per pixel. */
     rgba32,
     /** BGRA, 8-bit per channel, 4 bytes per pixel. */
-    bgra32
+    bgra32,
+    /** Packed YUV 4:2:2 (Y0 U Y1 V), 2 bytes per pixel. */
+    yuyv422
 };
 
 /**
@@ -73,10 +79,84 @@ struct frame {
      */
     std::vector<std::uint8_t> data;
 
+    /**
+     * @brief Externally owned pixel bytes (zero-copy capture).
+     *
+     * When set, pixels live in a buffer owned by the capture backend (e.g. a
+     * mapped V4L2 buffer) instead of @ref data. Releasing the last reference
+     * hands the buffer back to the backend, so consumers should not keep
+     * frames longer than needed.
+     *
+     * Use @ref bytes, @ref size and @ref empty to access pixels regardless
+     * of where they are stored.
+     */
+    std::shared_ptr<const std::uint8_t> external;
+
+    /**
+     * @brief Number of valid bytes in @ref external.
+     */
+    std::size_t external_size { 0 };
+
     /**
      * @brief Monotonic timestamp when the frame was captured/produced.
      */
     std::chrono::steady_clock::time_point ts;
+
+    /**
+     * @brief Presentation timestamp of the source, ms; negative if unknown.
+     */
+    double pts_ms { -1.0 };
+
+    /**
+     * @brief Decoder motion vectors of an inter-coded frame.
+     *
+     * Only meaningful if @ref has_motion_vectors is set.
+     */
+    std::vector<motion_vector> motion_vectors;
+
+    /**
+     * @brief Whether the decoder exported @ref motion_vectors for this frame.
+     *
+     * False for intra-coded frames and for sources that do not provide
+     * vectors.
+     */
+    bool has_motion_vectors { false };
+
+    /**
+     * @brief Pointer to the first pixel row.
+     */
+    const std::uint8_t* bytes() const {
+        return external ? external.get() : data.data();
+    }
+
+    /**
+     * @brief Number of pixel bytes available through @ref bytes.
+     */
+    std::size_t size() const { return external ? external_size : data.size(); }
+
+    /**
+     * @brief Whether the frame has no pixel bytes.
+     */
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Move owned pixels into a reference-counted buffer.
+     *
+     * Afterwards copies of the frame share one pixel buffer through
+     * @ref external instead of copying @ref data, e.g. when one capture
+     * feeds several consumers. Frames that already use @ref external are
+     * left as they are.
+     */
+    void share() {
+        if (external || data.empty()) {
+            return;
+        }
+        using buffer = const std::vector<std::uint8_t>;
+        auto owner = std::make_shared<buffer>(std::move(data));
+        data = {};
+        external_size = owner->size();
+        external = std::shared_ptr<const std::uint8_t>(owner, owner->data());
+    }
 };
 
 } // namespace yodau::backend
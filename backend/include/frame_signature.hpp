@@ -0,0 +1,77 @@
+#ifndef YODAU_BACKEND_FRAME_SIGNATURE_HPP
+#define YODAU_BACKEND_FRAME_SIGNATURE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace yodau::backend {
+
+/**
+ * @brief Sparse luma fingerprint of a frame.
+ *
+ * The frame is split into @ref cols x @ref rows cells and the approximate
+ * luma of the pixel in the centre of every cell is stored. Computing it reads
+ * only a couple of thousand pixels regardless of resolution, so comparing two
+ * signatures is a cheap way to tell that a scene did not change before paying
+ * for full motion analysis.
+ *
+ * With the default grid a 1080p frame is sampled every 30 pixels, which is
+ * finer than the minimal motion area @ref opencv_client reports.
+ */
+struct frame_signature {
+    /** @brief Number of samples horizontally. */
+    static constexpr int cols { 64 };
+
+    /** @brief Number of samples vertically. */
+    static constexpr int rows { 36 };
+
+    /** @brief Width of the sampled frame. */
+    int width { 0 };
+
+    /** @brief Height of the sampled frame. */
+    int height { 0 };
+
+    /** @brief Sampled luma values (row-major). */
+    std::array<std::uint8_t, cols * rows> samples {};
+};
+
+/**
+ * @brief Sample a packed 8-bit frame into a @ref frame_signature.
+ *
+ * For 3/4-channel pixels luma is approximated as (c0 + 2*c1 + c2) / 4, which
+ * is symmetric in the first and third channel and therefore the same for RGB
+ * and BGR layouts. 2-channel input is packed YUYV; its Y bytes are sampled
+ * directly.
+ *
+ * @param data Pointer to the first pixel row.
+ * @param width Frame width in pixels.
+ * @param height Frame height in pixels.
+ * @param stride Number of bytes between two consecutive rows.
+ * @param channels Bytes per pixel (1, 2, 3 or 4).
+ * @return Signature; width/height stay 0 if the input is invalid.
+ */
+frame_signature compute_frame_signature(
+    const std::uint8_t* data, int width, int height, std::size_t stride,
+    int channels
+);
+
+/**
+ * @brief Check whether two signatures describe the same (static) scene.
+ *
+ * Signatures of different frame sizes (or invalid ones) never match.
+ *
+ * @param a First signature.
+ * @param b Second signature.
+ * @param mean_tolerance Maximal mean absolute sample difference.
+ * @param max_tolerance Maximal absolute difference of any single sample.
+ * @return true if both limits hold.
+ */
+bool same_scene(
+    const frame_signature& a, const frame_signature& b, int mean_tolerance,
+    int max_tolerance
+);
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_FRAME_SIGNATURE_HPP
@@ -1,7 +1,10 @@
 #ifndef YODAU_BACKEND_GEOMETRY_HPP
 #define YODAU_BACKEND_GEOMETRY_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <string_view>
@@ -56,6 +59,148 @@ struct point {
     bool compare(const point& other) const;
 };
 
+/**
+ * @brief Z-component of cross product (AB x AC).
+ *
+ * Positive when @p c lies to the left of the directed line a -> b.
+ */
+float cross_z(const point& a, const point& b, const point& c);
+
+/**
+ * @brief Orientation of triangle (a,b,c).
+ *
+ * @return 1 if counter-clockwise, -1 if clockwise, 0 if collinear
+ *         within @ref point::epsilon.
+ */
+int orient(const point& a, const point& b, const point& c);
+
+/**
+ * @brief Test if two 2D segments intersect.
+ *
+ * Handles proper intersections and collinear overlaps, with tolerance
+ * @ref point::epsilon.
+ */
+bool segments_intersect(
+    const point& p1, const point& p2, const point& q1, const point& q2
+);
+
+/**
+ * @brief Compute intersection point of two segments if they intersect.
+ *
+ * Uses parametric line intersection with epsilon checks; parallel and
+ * collinear segments have no intersection point.
+ *
+ * @return Intersection point in percentage coordinates, or std::nullopt.
+ */
+std::optional<point> segment_intersection(
+    const point& p1, const point& p2, const point& q1, const point& q2
+);
+
+/**
+ * @brief Segments stored as a structure of arrays.
+ *
+ * Segment i runs from (x0()[i], y0()[i]) to (x1()[i], y1()[i]). Used as the
+ * operand of @ref intersect_segments, whose loop over the arrays is free of
+ * branches so that the compiler can vectorize it.
+ *
+ * The arrays are padded with NaN to a multiple of @ref block entries, so
+ * that the loop never needs a scalar remainder; NaN segments never hit.
+ */
+class segment_batch {
+public:
+    /** @brief Padding granularity (a multiple of every SIMD width). */
+    static constexpr std::size_t block = 16;
+
+    /** @brief Number of segments. */
+    std::size_t size() const { return count; }
+
+    /** @brief Whether there are no segments. */
+    bool empty() const { return count == 0; }
+
+    /** @brief Remove all segments, keeping the capacity. */
+    void clear();
+
+    /** @brief Append segment a -> b. */
+    void push_back(const point& a, const point& b);
+
+    /**
+     * @brief Replace the contents with the edges of a polyline.
+     *
+     * @param pts Polyline vertices.
+     * @param closed Also add the edge from the last vertex back to the
+     * first (for two or more vertices).
+     */
+    void assign_chain(const std::vector<point>& pts, bool closed);
+
+    /** @brief Start x of each segment, padded. */
+    const std::vector<float>& x0() const { return sx; }
+
+    /** @brief Start y of each segment, padded. */
+    const std::vector<float>& y0() const { return sy; }
+
+    /** @brief End x of each segment, padded. */
+    const std::vector<float>& x1() const { return ex; }
+
+    /** @brief End y of each segment, padded. */
+    const std::vector<float>& y1() const { return ey; }
+
+private:
+    /** @brief Start x. */
+    std::vector<float> sx;
+
+    /** @brief Start y. */
+    std::vector<float> sy;
+
+    /** @brief End x. */
+    std::vector<float> ex;
+
+    /** @brief End y. */
+    std::vector<float> ey;
+
+    /** @brief Number of segments (the rest is padding). */
+    std::size_t count { 0 };
+};
+
+/**
+ * @brief Per-segment results of @ref intersect_segments.
+ */
+struct segment_hits {
+    /**
+     * @brief 1 where the segments intersect (@ref segments_intersect).
+     */
+    std::vector<std::uint32_t> hit;
+
+    /**
+     * @brief 1 where an intersection point exists
+     * (@ref segment_intersection).
+     */
+    std::vector<std::uint32_t> has_t;
+
+    /**
+     * @brief Intersection parameter along the tested segment a -> b: the
+     * point is `a + t * (b - a)`. Only meaningful where @ref has_t is set.
+     */
+    std::vector<float> t;
+};
+
+/**
+ * @brief Test segment a -> b against every segment of a batch.
+ *
+ * Gives the same answers as @ref segments_intersect and
+ * @ref segment_intersection called with (a, b) and each batch segment, at a
+ * fraction of the cost for longer batches.
+ *
+ * @param a Tested segment start.
+ * @param b Tested segment end.
+ * @param batch Segments to test against.
+ * @param out Receives one entry per batch segment; resized as needed.
+ * @return Number of intersecting segments.
+ */
+std::size_t intersect_segments(
+    const point& a, const point& b, const segment_batch& batch,
+    segment_hits& out
+);
+
 /**
  * @brief Allowed crossing direction for a tripwire.
  */
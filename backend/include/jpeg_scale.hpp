@@ -0,0 +1,41 @@
+#ifndef YODAU_BACKEND_JPEG_SCALE_HPP
+#define YODAU_BACKEND_JPEG_SCALE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace yodau::backend {
+
+/**
+ * @brief Read the image size from a JPEG header without decoding it.
+ *
+ * Walks the marker segments up to the first start-of-frame marker.
+ *
+ * @param data Encoded image.
+ * @param size Number of bytes in @p data.
+ * @param width Receives the image width.
+ * @param height Receives the image height.
+ * @return false if @p data is not a JPEG image or is truncated before the
+ * frame header.
+ */
+bool jpeg_dimensions(
+    const std::uint8_t* data, std::size_t size, int& width, int& height
+);
+
+/**
+ * @brief Pick the DCT scaling denominator for decoding a JPEG image.
+ *
+ * JPEG decoders can produce 1/2, 1/4 and 1/8 scale output directly from the
+ * DCT coefficients, skipping most of the inverse transform and all of the
+ * downscaling. The largest reduction is chosen whose output is still at
+ * least @p target_width wide.
+ *
+ * @param width Full image width.
+ * @param target_width Width analysis needs; 0 or less keeps full size.
+ * @return 1, 2, 4 or 8.
+ */
+int jpeg_reduction(int width, int target_width);
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_JPEG_SCALE_HPP
@@ -0,0 +1,95 @@
+#ifndef YODAU_BACKEND_LATEST_FRAME_HPP
+#define YODAU_BACKEND_LATEST_FRAME_HPP
+
+#include "frame.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+
+namespace yodau::backend {
+
+/**
+ * @brief Single-slot frame handoff that always keeps the newest frame.
+ *
+ * A reader thread @ref put "puts" frames as fast as the source delivers them;
+ * the consumer @ref take "takes" whatever is newest when it is ready for the
+ * next one. Frames the consumer was too slow for are replaced (and counted)
+ * instead of queueing up, so the consumer never works on stale frames.
+ *
+ * Thread-safety:
+ * - All methods may be called concurrently.
+ */
+class latest_frame {
+public:
+    /**
+     * @brief Store a frame, replacing one that was not taken yet.
+     *
+     * @param f Frame to hand over.
+     */
+    void put(frame&& f);
+
+    /**
+     * @brief Wait for the next frame.
+     *
+     * @param out Receives the frame.
+     * @param st Stop token interrupting the wait.
+     * @return false if stop was requested, or if the producer closed the
+     * slot and no frame is left.
+     */
+    bool take(frame& out, const std::stop_token& st);
+
+    /**
+     * @brief Mark the end of input; a pending frame can still be taken.
+     */
+    void close();
+
+    /** @brief Number of frames replaced before they were taken. */
+    std::uint64_t dropped() const;
+
+private:
+    /** @brief Mutex guarding the slot. */
+    mutable std::mutex mtx;
+
+    /** @brief Signalled on put/close. */
+    std::condition_variable_any cv;
+
+    /** @brief Pending frame. */
+    std::optional<frame> slot;
+
+    /** @brief Replaced frame count. */
+    std::uint64_t drops { 0 };
+
+    /** @brief Whether the producer finished. */
+    bool closed { false };
+};
+
+/**
+ * @brief Run a frame source on a reader thread and deliver only the newest
+ * frame to a consumer on the calling thread.
+ *
+ * @p produce is called in a loop on a separate thread until it returns false
+ * (end of input or error) or stop is requested; leaving its argument empty
+ * reports "no frame this time". Each produced frame goes through a
+ * @ref latest_frame, and @p on_frame is called on the calling thread with the
+ * newest one whenever it is free.
+ *
+ * Returns once the source ended and the last frame was delivered, or stop
+ * was requested.
+ *
+ * @param produce Reader callback; fills its argument with the next frame.
+ * @param on_frame Consumer callback.
+ * @param st Stop token.
+ * @return Number of frames dropped because the consumer was busy.
+ */
+std::uint64_t deliver_latest(
+    const std::function<bool(std::optional<frame>&)>& produce,
+    const std::function<void(frame&&)>& on_frame, const std::stop_token& st
+);
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_LATEST_FRAME_HPP
@@ -0,0 +1,135 @@
+#ifndef YODAU_BACKEND_LINE_RASTER_HPP
+#define YODAU_BACKEND_LINE_RASTER_HPP
+
+#include "bit_mask.hpp"
+#include "line_set.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace yodau::backend {
+
+/**
+ * @brief Lines of a @ref line_set rasterized at one analysis resolution.
+ *
+ * Every segment is drawn once as a thin (8-connected, one pixel wide) line
+ * into a label mask whose labels name the segment. The mask is stored row
+ * compressed: per row, the line pixels sorted by x with their segment. A
+ * pixel crossed by several segments is listed once per segment.
+ *
+ * Hit testing is then a per-pixel AND of a motion mask with the label mask
+ * inside the motion's bounding box, touching only line pixels in that box:
+ * its cost does not depend on the motion contour or the number of line
+ * vertices.
+ *
+ * Thread-safety:
+ * - Immutable after construction; safe to query concurrently.
+ */
+class line_raster {
+public:
+    /**
+     * @brief Line pixel set in a motion mask.
+     */
+    struct hit {
+        /** @brief Segment index in the source @ref line_set. */
+        std::uint32_t segment { 0 };
+
+        /** @brief Pixel column. */
+        int x { 0 };
+
+        /** @brief Pixel row. */
+        int y { 0 };
+    };
+
+    /** @brief Empty raster. */
+    line_raster() = default;
+
+    /**
+     * @brief Rasterize @p lines for masks of @p width x @p height pixels.
+     *
+     * Percentage coordinates map to pixels as `x * width / 100`, the same
+     * mapping motion contours use; parts outside the frame are clipped.
+     *
+     * @param lines Compiled lines (kept alive by the raster).
+     * @param width Mask width in pixels.
+     * @param height Mask height in pixels.
+     */
+    line_raster(std::shared_ptr<const line_set> lines, int width, int height);
+
+    /**
+     * @brief Whether the raster was built from @p lines at this size.
+     */
+    bool matches(
+        const std::shared_ptr<const line_set>& lines, int width, int height
+    ) const;
+
+    /** @brief Source lines. */
+    const line_set& lines() const { return *source; }
+
+    /** @brief Mask width. */
+    int width() const { return w; }
+
+    /** @brief Mask height. */
+    int height() const { return h; }
+
+    /** @brief Number of line pixels (counting shared pixels per segment). */
+    std::size_t pixel_count() const { return pix_x.size(); }
+
+    /**
+     * @brief Line pixels set in a byte mask (non-zero = motion).
+     *
+     * @param mask First row of a @ref width x @ref height mask.
+     * @param stride Bytes between rows.
+     * @param x0 First column of the area.
+     * @param y0 First row of the area.
+     * @param x1 One past the last column.
+     * @param y1 One past the last row.
+     * @param out Receives the hits in row-major order; cleared first.
+     */
+    void hits(
+        const std::uint8_t* mask, std::size_t stride, int x0, int y0, int x1,
+        int y1, std::vector<hit>& out
+    ) const;
+
+    /**
+     * @brief Line pixels set in a packed mask of @ref width x @ref height.
+     *
+     * @see hits(const std::uint8_t*, std::size_t, int, int, int, int,
+     * std::vector<hit>&) const
+     */
+    void hits(
+        const bit_mask& mask, int x0, int y0, int x1, int y1,
+        std::vector<hit>& out
+    ) const;
+
+private:
+    /**
+     * @brief Visit the line pixels of rows [y0; y1) with x in [x0; x1).
+     */
+    template <typename Fn>
+    void for_pixels(int x0, int y0, int x1, int y1, Fn&& fn) const;
+
+    /** @brief Source lines. */
+    std::shared_ptr<const line_set> source;
+
+    /** @brief Mask width. */
+    int w { 0 };
+
+    /** @brief Mask height. */
+    int h { 0 };
+
+    /** @brief Offsets into @ref pix_x / @ref pix_segment per row, plus one. */
+    std::vector<std::uint32_t> row_start;
+
+    /** @brief Column of each line pixel, ascending within a row. */
+    std::vector<std::int32_t> pix_x;
+
+    /** @brief Segment (label) of each line pixel. */
+    std::vector<std::uint32_t> pix_segment;
+};
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_LINE_RASTER_HPP
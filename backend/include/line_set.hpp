@@ -0,0 +1,154 @@
+#ifndef YODAU_BACKEND_LINE_SET_HPP
+#define YODAU_BACKEND_LINE_SET_HPP
+
+#include "geometry.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace yodau::backend {
+
+/**
+ * @brief Axis-aligned box in percentage coordinates.
+ */
+struct bbox {
+    /** @brief Left edge. */
+    float min_x { 0.0f };
+
+    /** @brief Top edge. */
+    float min_y { 0.0f };
+
+    /** @brief Right edge. */
+    float max_x { 0.0f };
+
+    /** @brief Bottom edge. */
+    float max_y { 0.0f };
+
+    /**
+     * @brief Bounding box of a point list (empty box at 0,0 if empty).
+     */
+    static bbox of(const std::vector<point>& pts);
+
+    /**
+     * @brief Whether two boxes overlap; touching edges count.
+     */
+    bool overlaps(const bbox& other) const {
+        return !(max_x < other.min_x || min_x > other.max_x
+                 || max_y < other.min_y || min_y > other.max_y);
+    }
+};
+
+/**
+ * @brief Immutable, hit-test friendly compilation of a stream's lines.
+ *
+ * All segments of all lines (including the closing segment of closed lines)
+ * are flattened into structure-of-arrays form, grouped by line, together
+ * with per-line bounding boxes. A uniform @ref grid_size x @ref grid_size
+ * grid over the [0; 100] percentage plane lists the segments crossing each
+ * cell, so a query only visits segments near the area of interest instead
+ * of every segment of every line.
+ *
+ * Built once when the connected lines change (see
+ * @ref stream::compiled_lines) and shared read-only afterwards; the
+ * @ref version tells successive compilations of a stream apart.
+ *
+ * Thread-safety:
+ * - Immutable after construction; safe to query concurrently.
+ */
+class line_set {
+public:
+    /** @brief Grid cells per axis. */
+    static constexpr int grid_size { 16 };
+
+    /** @brief Empty set. */
+    line_set() = default;
+
+    /**
+     * @brief Compile lines; null lines and lines with fewer than two
+     * points are skipped.
+     *
+     * @param src Lines in the order they should be reported.
+     * @param version Version of the connections @p src was taken from.
+     */
+    explicit line_set(
+        const std::vector<line_ptr>& src, std::uint64_t version = 0
+    );
+
+    /** @brief Version given at construction. */
+    std::uint64_t version() const { return ver; }
+
+    /** @brief Whether the set has no segments. */
+    bool empty() const { return ax.empty(); }
+
+    /** @brief Number of compiled lines. */
+    std::size_t line_count() const { return lines.size(); }
+
+    /** @brief Number of compiled segments, all lines. */
+    std::size_t segment_count() const { return ax.size(); }
+
+    /** @brief Compiled line @p i. */
+    const line& line_at(const std::size_t i) const { return *lines[i]; }
+
+    /** @brief Bounding box of line @p i. */
+    const bbox& line_box(const std::size_t i) const { return boxes[i]; }
+
+    /** @brief Line index of segment @p s. */
+    std::uint32_t segment_line(const std::size_t s) const { return owner[s]; }
+
+    /** @brief Start point of segment @p s. */
+    point segment_a(const std::size_t s) const { return { ax[s], ay[s] }; }
+
+    /** @brief End point of segment @p s. */
+    point segment_b(const std::size_t s) const { return { bx[s], by[s] }; }
+
+    /**
+     * @brief Segments whose bounding box overlaps @p area.
+     *
+     * @param area Query box.
+     * @param out Receives segment indices in ascending order, i.e. grouped
+     * by line; cleared first.
+     */
+    void query(const bbox& area, std::vector<std::uint32_t>& out) const;
+
+private:
+    /** @brief Grid cell range [first; last] covering @p lo..@p hi. */
+    static void cell_range(float lo, float hi, int& first, int& last);
+
+    /** @brief Version of the source connections. */
+    std::uint64_t ver { 0 };
+
+    /** @brief Compiled lines. */
+    std::vector<line_ptr> lines;
+
+    /** @brief Bounding box per line. */
+    std::vector<bbox> boxes;
+
+    /** @brief Segment start x per segment. */
+    std::vector<float> ax;
+
+    /** @brief Segment start y per segment. */
+    std::vector<float> ay;
+
+    /** @brief Segment end x per segment. */
+    std::vector<float> bx;
+
+    /** @brief Segment end y per segment. */
+    std::vector<float> by;
+
+    /** @brief Line index per segment. */
+    std::vector<std::uint32_t> owner;
+
+    /**
+     * @brief Offsets into @ref cell_segments per cell (row-major), plus one
+     * past the end.
+     */
+    std::vector<std::uint32_t> cell_start;
+
+    /** @brief Segment indices per cell, ascending within a cell. */
+    std::vector<std::uint32_t> cell_segments;
+};
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_LINE_SET_HPP
@@ -0,0 +1,122 @@
+#ifndef YODAU_BACKEND_MOTION_HEATMAP_HPP
+#define YODAU_BACKEND_MOTION_HEATMAP_HPP
+
+#include "activity_grid.hpp"
+
+#include <array>
+#include <chrono>
+#include <ostream>
+
+namespace yodau::backend {
+
+/**
+ * @brief Long-term motion activity of one stream.
+ *
+ * Accumulates @ref activity_grid samples (one per analyzed frame) into a
+ * grid of the same layout, with exponential decay: a sample loses half of
+ * its weight every @ref half_life. The map shows where motion happens over
+ * hours or days without keeping any events, and an update costs one
+ * multiply-add per cell (576 in all), a negligible fraction of the
+ * per-pixel motion kernel.
+ *
+ * Decay is applied lazily: samples are added with a weight that grows over
+ * time instead of shrinking every cell, and the cells are rescaled only
+ * when the weight would lose precision.
+ *
+ * Thread-safety:
+ * - Not synchronized; the owner serializes access.
+ */
+class motion_heatmap {
+public:
+    /** @brief Time source of timestamps. */
+    using clock = std::chrono::steady_clock;
+
+    /** @brief Number of cells horizontally. */
+    static constexpr int cols { activity_grid::cols };
+
+    /** @brief Number of cells vertically. */
+    static constexpr int rows { activity_grid::rows };
+
+    /** @brief Cell values, row-major. */
+    using cells_type = std::array<float, cols * rows>;
+
+    /**
+     * @brief Empty map.
+     *
+     * @param half_life Time for a sample to lose half of its weight; zero
+     * or negative keeps every sample at full weight.
+     */
+    explicit motion_heatmap(
+        clock::duration half_life = std::chrono::hours(1)
+    );
+
+    /**
+     * @brief Change the decay; the accumulated map is kept.
+     */
+    void set_half_life(clock::duration half_life);
+
+    /** @brief Current decay. */
+    clock::duration get_half_life() const { return half_life; }
+
+    /**
+     * @brief Add one motion sample.
+     *
+     * @param grid Activity of an analyzed frame.
+     * @param ts Frame time; non-decreasing across calls.
+     */
+    void add(const activity_grid& grid, clock::time_point ts);
+
+    /**
+     * @brief Decayed activity per cell at @p now.
+     *
+     * Each value is the sum of the cell's activity levels (0..255) of all
+     * samples, each weighted by its remaining share at @p now.
+     */
+    cells_type values(clock::time_point now) const;
+
+    /**
+     * @brief Map scaled so that its hottest cell is 255.
+     *
+     * The scale does not depend on decay or sample count, so the result is
+     * directly viewable as an image; all zeros if no motion was seen.
+     */
+    activity_grid normalized() const;
+
+    /** @brief Number of samples added. */
+    long long samples() const { return count; }
+
+    /** @brief Time of the last sample (epoch if none). */
+    clock::time_point last_sample() const { return last; }
+
+    /**
+     * @brief Write @ref normalized as a binary PGM (portable graymap) image
+     * of @ref cols x @ref rows pixels.
+     */
+    void write_pgm(std::ostream& out) const;
+
+private:
+    /** @brief Weight of a sample at @p ts relative to @ref origin. */
+    float weight_at(clock::time_point ts) const;
+
+    /** @brief Move @ref origin to @p ts, rescaling the cells. */
+    void rebase(clock::time_point ts);
+
+    /** @brief Decay half-life; non-positive disables decay. */
+    clock::duration half_life;
+
+    /** @brief Cells scaled by the weight of a sample at @ref origin. */
+    cells_type acc {};
+
+    /** @brief Time at which samples have weight 1. */
+    clock::time_point origin {};
+
+    /** @brief Time of the last sample. */
+    clock::time_point last {};
+
+    /** @brief Number of samples. */
+    long long count { 0 };
+};
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_MOTION_HEATMAP_HPP
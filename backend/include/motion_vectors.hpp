@@ -0,0 +1,61 @@
+#ifndef YODAU_BACKEND_MOTION_VECTORS_HPP
+#define YODAU_BACKEND_MOTION_VECTORS_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace yodau::backend {
+
+/**
+ * @brief Motion vector of one coded block, as exported by a video decoder.
+ *
+ * Describes that the block centred at (@ref x, @ref y) of the current frame
+ * is predicted from the reference frame displaced by (@ref dx, @ref dy).
+ */
+struct motion_vector {
+    /** @brief Block centre x in the current frame, pixels. */
+    std::int16_t x { 0 };
+
+    /** @brief Block centre y in the current frame, pixels. */
+    std::int16_t y { 0 };
+
+    /** @brief Horizontal displacement to the reference block, pixels. */
+    float dx { 0.0f };
+
+    /** @brief Vertical displacement to the reference block, pixels. */
+    float dy { 0.0f };
+
+    /** @brief Block width in pixels. */
+    std::uint8_t w { 0 };
+
+    /** @brief Block height in pixels. */
+    std::uint8_t h { 0 };
+};
+
+/**
+ * @brief Share of the frame that moved or changed, from decoder vectors.
+ *
+ * A block counts as moving if its displacement length is at least
+ * @p min_magnitude. Frame area not covered by any vector was intra-coded
+ * (new content the encoder could not predict) and counts as changed too.
+ * Blocks predicted from several references are counted per vector, so the
+ * result is clamped to 1.
+ *
+ * This is a compressed-domain estimate: an encoder picks vectors to minimize
+ * residual cost, not to track objects, so it is only suitable for deciding
+ * whether a frame is worth analysing in the pixel domain.
+ *
+ * @param mvs Decoder motion vectors of one frame.
+ * @param width Frame width in pixels.
+ * @param height Frame height in pixels.
+ * @param min_magnitude Minimal displacement length in pixels.
+ * @return Moving area share in [0; 1]; 0 for an invalid frame size.
+ */
+double moving_area(
+    const std::vector<motion_vector>& mvs, int width, int height,
+    float min_magnitude
+);
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_MOTION_VECTORS_HPP
@@ -3,8 +3,22 @@
 
 #ifdef YODAU_OPENCV
 
+#include "activity_grid.hpp"
+#include "bit_mask.hpp"
+#include "decode_budget.hpp"
 #include "event.hpp"
+#include "event_batch.hpp"
 #include "frame.hpp"
+#include "frame_signature.hpp"
+#include "jpeg_scale.hpp"
+#include "latest_frame.hpp"
+#include "line_raster.hpp"
+#include "line_set.hpp"
+#include "motion_vectors.hpp"
+#include "playback_clock.hpp"
+#include "rate_limiter.hpp"
+#include "region_mask.hpp"
+#include "source_clock.hpp"
 #include "stream.hpp"
 #include "stream_manager.hpp"
 
@@ -12,11 +26,14 @@
 
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <stop_token>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -30,9 +47,9 @@ namespace yodau::backend {
  * - a motion / tripwire frame processor that returns @ref event objects,
  * - adapters returning hooks compatible with @ref stream_manager.
  *
- * The implementation keeps per-stream state (previous gray frame, last emit
- * time, last motion position, and per-tripwire cooldowns) protected by an
- * internal mutex.
+ * The implementation keeps per-stream state (previous gray frame, motion and
+ * tripwire rate limits, last motion position) protected by an internal
+ * mutex.
  *
  * Coordinate system:
  * - Motion and tripwire positions are reported as percentage-based points
@@ -44,6 +61,55 @@ namespace yodau::backend {
  */
 class opencv_client {
 public:
+    /**
+     * @brief How the per-frame motion mask is computed.
+     */
+    enum class detection_mode {
+        /** Blur and difference the whole frame at full resolution. */
+        full,
+        /**
+         * Difference a low-resolution pyramid level first and refine only
+         * tiles showing coarse activity at full resolution.
+         */
+        pyramid
+    };
+
+    /**
+     * @brief How lines are hit tested against motion.
+     */
+    enum class tripwire_mode {
+        /** Intersect line segments with the motion contour (default). */
+        vector,
+        /**
+         * AND the motion mask with lines rasterized once per analysis
+         * resolution (see @ref line_raster), inside the motion's bounding
+         * box. Reports the same crossings as @ref vector, and also hits a
+         * line lying entirely inside the motion, which has no outline
+         * intersection.
+         */
+        raster
+    };
+
+    /**
+     * @brief Delivery rate of file streams.
+     */
+    enum class playback_mode {
+        /** Deliver frames at the container frame rate (default). */
+        realtime,
+        /** Deliver frames as fast as they can be decoded (offline runs). */
+        max_speed
+    };
+
+    /**
+     * @brief Event source limited by a @ref rate_rule.
+     */
+    enum class rate_target {
+        /** Motion events of a stream (default: one per 150 ms). */
+        motion,
+        /** Tripwire events per line and direction (default: one per 1.2 s). */
+        tripwire
+    };
+
     /**
      * @brief Default constructor.
      *
@@ -55,48 +121,309 @@ public:
      * @brief Start capturing frames from a stream and push them to a callback.
      *
      * The daemon:
-     * - opens a @c cv::VideoCapture either by local index (for "/dev/videoN")
-     *   or directly by path/URL,
+     * - on Linux, opens local "/dev/videoN" devices with the zero-copy
+     *   @ref v4l2_capture (see @ref run_v4l2),
+     * - otherwise opens a @c cv::VideoCapture either by local index (for
+     *   "/dev/videoN") or directly by path/URL,
      * - reads frames until @p st requests stop or capture ends,
      * - converts each @c cv::Mat to @ref frame and calls @p on_frame.
      *
+     * File streams are paced to their presentation timestamps (see
+     * @ref playback_clock) unless @ref playback_mode::max_speed is selected.
      * If the stream is file-based and looping is enabled, the capture position
-     * is reset to frame 0 on end-of-file.
+     * is reset to frame 0 on end-of-file; the already opened demuxer and
+     * decoder are reused and the file is only reopened if seeking fails.
+     *
+     * Network streams use a reader thread and newest-frame handoff when
+     * low-latency ingest is enabled (see @ref set_low_latency).
+     *
+     * The requested @ref capture_format of local devices is applied on open;
+     * the format actually in effect is reported back to the stream (see
+     * @ref stream::report_negotiated_format).
+     *
+     * Sources decoded inside the backend (files and network streams) get
+     * their decoder thread count from @ref global_decode_budget, sized by
+     * the frame size read after opening; the source is reopened once if
+     * that size calls for a different count than the stream's format did.
+     *
+     * Before each frame @p wants_frame is asked whether the frame would be
+     * consumed. Unwanted frames are only grabbed (the source advances), but
+     * not retrieved, color-converted or copied into a @ref frame.
      *
      * @param s Stream describing the source.
      * @param on_frame Callback invoked for each captured frame (frame is
      * moved).
+     * @param wants_frame Demand query; an empty function means every frame
+     * is wanted.
      * @param st Stop token used for cooperative cancellation.
      */
     void daemon_start(
         const stream& s, const std::function<void(frame&&)>& on_frame,
-        const std::stop_token& st
+        const std::function<bool()>& wants_frame, const std::stop_token& st
     );
 
     /**
      * @brief Analyze a frame and produce motion/tripwire events.
      *
      * High-level algorithm (see implementation for exact thresholds):
-     * 1. Convert BGR frame to gray, blur, and diff against previous gray frame
-     *    per stream.
-     * 2. Threshold + morphology to obtain motion mask.
+     * 1. Convert the frame to gray, blur, and diff against previous gray frame
+     *    per stream (either for the whole frame or coarse-to-fine, see
+     *    @ref detection_mode).
+     * 2. Threshold + morphology to obtain motion mask; its
+     *    @ref activity_grid is recorded with @ref event_batch::add_activity
+     *    for every analyzed frame.
      * 3. Find contours, keep the largest, filter by minimum area and global
      *    non-zero ratio.
-     * 4. Enforce a per-stream cooldown to limit event rate.
-     * 5. Compute motion centroid, convert to percentage coordinates.
-     * 6. If a previous centroid is available, test connected lines from the
+     * 4. Compute motion centroid, convert to percentage coordinates.
+     * 5. If a previous centroid is available, test connected lines from the
      * stream for intersections with the motion contour and emit tripwire events
-     *    respecting @ref line::dir and a per-(stream,line,direction) cooldown.
+     *    respecting @ref line::dir and the tripwire @ref rate_rule of the
+     *    line, applied per direction.
+     * 6. Enforce the per-stream motion @ref rate_rule for the events below.
      * 7. Emit a primary motion event at centroid.
-     * 8. Emit additional "bubble" motion events on a coarse grid over the mask
-     *    (capped) to approximate motion shape.
+     * 8. Emit one @ref event_kind::motion_grid event carrying an
+     *    @ref activity_grid of the mask to approximate motion shape.
      *
      * @param s Stream context (used for connected lines and naming).
      * @param f Frame to analyze.
+     * @param out Batch to append produced events to.
+     */
+    void motion_processor(const stream& s, const frame& f, event_batch& out);
+
+    /**
+     * @brief Analyze a frame and return its events as @ref event objects.
+     *
+     * Converts the events of the batch overload.
+     *
+     * @param s Stream context.
+     * @param f Frame to analyze.
      * @return Vector of produced events; may be empty.
      */
     std::vector<event> motion_processor(const stream& s, const frame& f);
 
+    /**
+     * @brief Select how motion masks are computed.
+     *
+     * Switching modes drops all per-stream reference frames, so the next frame
+     * of every stream only re-initializes state.
+     *
+     * @param m New detection mode (default: @ref detection_mode::full).
+     */
+    void set_detection_mode(detection_mode m);
+
+    /**
+     * @brief Get the current detection mode.
+     */
+    detection_mode get_detection_mode() const;
+
+    /**
+     * @brief Select how a stream's lines are hit tested.
+     *
+     * Both modes report the closest hit to the motion centroid per line and
+     * share direction inference and rate limits.
+     *
+     * @param stream_name Stream name.
+     * @param m Tripwire mode (default: @ref tripwire_mode::vector).
+     */
+    void set_tripwire_mode(const std::string& stream_name, tripwire_mode m);
+
+    /**
+     * @brief Tripwire mode of a stream.
+     */
+    tripwire_mode get_tripwire_mode(const std::string& stream_name) const;
+
+    /**
+     * @brief Set the enter/exit thresholds of region (closed line) events.
+     *
+     * Applies to all streams from the next analyzed frame on.
+     *
+     * @param cfg Thresholds.
+     */
+    void set_roi_config(const occupancy_config& cfg);
+
+    /**
+     * @brief Current region thresholds.
+     */
+    occupancy_config get_roi_config() const;
+
+    /**
+     * @brief Set the rate limit of an event source.
+     *
+     * Rules are looked up from the most specific: (stream, line), then
+     * (stream), then the default. Limiter state is kept only for sources
+     * that fired recently (see @ref rate_limiter).
+     *
+     * @param t Limited events.
+     * @param stream_name Stream; empty sets the default of all streams.
+     * @param line_name Line (tripwire only); empty applies to the stream.
+     * @param rule Token bucket; an unlimited rule disables the limit.
+     */
+    void set_rate_rule(
+        rate_target t, const std::string& stream_name,
+        const std::string& line_name, const rate_rule& rule
+    );
+
+    /**
+     * @brief Rate limit in effect for an event source.
+     */
+    rate_rule get_rate_rule(
+        rate_target t, const std::string& stream_name,
+        const std::string& line_name
+    ) const;
+
+    /**
+     * @brief Set the number of pyramid levels used in pyramid mode.
+     *
+     * Each level halves the resolution of the coarse pass. Values outside
+     * [1; 5] are ignored.
+     *
+     * @param levels Number of @c cv::pyrDown steps (default: 2).
+     */
+    void set_pyramid_levels(int levels);
+
+    /**
+     * @brief Set the coarse activation threshold used in pyramid mode.
+     *
+     * A coarse tile is refined at full resolution when the share of its
+     * changed coarse pixels is at least @p ratio (and at least one pixel
+     * changed). Values outside [0.0; 1.0] are ignored.
+     *
+     * @param ratio Share of changed pixels in a tile (default: 0.02).
+     */
+    void set_pyramid_activation(double ratio);
+
+    /**
+     * @brief Set the frame size above which analysis runs in row bands.
+     *
+     * Frames with at least @p px pixels are split into horizontal bands
+     * (one per OpenCV worker thread) for gray conversion, blur, difference,
+     * threshold, morphology and connected-component labelling. Components
+     * crossing band borders are merged before the largest one is selected.
+     *
+     * @param px Minimal pixel count; values <= 0 disable band parallelism
+     * (default: 4000000, i.e. roughly 4K and above).
+     */
+    void set_parallel_min_pixels(long long px);
+
+    /**
+     * @brief Enable/disable bit-packed mask post-processing.
+     *
+     * When enabled (default), the thresholded motion mask of frames below
+     * the parallel threshold is packed to one bit per pixel; erosion,
+     * dilation, counting and component extraction then run on 64-pixel
+     * words instead of OpenCV byte masks.
+     *
+     * @param enabled Whether to use packed masks.
+     */
+    void set_packed_masks(bool enabled);
+
+    /**
+     * @brief Configure the static-scene early-out.
+     *
+     * Before analysis, a sparse luma signature of every frame is compared to
+     * the one of the last analyzed frame of the stream. If the mean absolute
+     * sample difference is at most @p mean_tolerance and no sample changed
+     * by more than the motion threshold, the frame is skipped and counted
+     * (see @ref skipped_frames).
+     *
+     * @param mean_tolerance Mean luma tolerance; negative values disable the
+     * early-out (default: 2).
+     */
+    void set_static_tolerance(int mean_tolerance);
+
+    /**
+     * @brief Configure the compressed-domain motion pre-filter.
+     *
+     * Frames carrying decoder motion vectors (@ref frame::has_motion_vectors)
+     * whose @ref moving_area is below @p min_area are skipped without
+     * looking at the pixels and counted (see @ref skipped_frames). Blocks
+     * count as moving from @ref vector_min_magnitude pixels.
+     *
+     * @param min_area Share of the frame in [0; 1]; negative values disable
+     * the pre-filter (default: 0.001).
+     */
+    void set_vector_prefilter(double min_area);
+
+    /**
+     * @brief Select how fast file streams are delivered.
+     *
+     * Applies to daemons started afterwards and to running ones on their
+     * next frame.
+     *
+     * @param m Playback mode.
+     */
+    void set_playback_mode(playback_mode m);
+
+    /**
+     * @brief Current file playback mode.
+     */
+    playback_mode get_playback_mode() const;
+
+    /**
+     * @brief Enable low-latency ingest for network (RTSP/HTTP) streams.
+     *
+     * When enabled, network daemons started afterwards read the source on a
+     * separate thread and hand only the newest frame to analysis (see
+     * @ref deliver_latest), so a slow consumer skips stale frames instead of
+     * falling behind the source. Frames are stamped from the source
+     * timestamps (see @ref source_clock) so that @ref stream_manager::latency
+     * includes buffering delay.
+     *
+     * @param enabled Whether the mode is on (default: off).
+     */
+    void set_low_latency(bool enabled);
+
+    /**
+     * @brief Whether low-latency ingest is enabled.
+     */
+    bool get_low_latency() const;
+
+    /**
+     * @brief Set the frame width motion analysis needs.
+     *
+     * Streams delivering Motion JPEG (MJPEG over HTTP, MJPEG files) are then
+     * read as encoded images and decoded straight to grayscale at 1/2, 1/4
+     * or 1/8 scale (see @ref jpeg_reduction), the largest reduction still at
+     * least this wide. Other streams are analyzed at full size. Events report
+     * percentages, so line coordinates are unaffected.
+     *
+     * Applies to daemons started afterwards.
+     *
+     * @param px Width in pixels; 0 or less decodes at full size (default).
+     */
+    void set_analysis_width(int px);
+
+    /**
+     * @brief Current analysis width (0 = full size).
+     */
+    int get_analysis_width() const;
+
+    /**
+     * @brief Decode one JPEG image to grayscale, reduced like MJPEG streams
+     * (see @ref set_analysis_width).
+     *
+     * Serves as the decoder of @ref http_mjpeg_source.
+     *
+     * @param data Encoded image.
+     * @param size Number of bytes in @p data.
+     * @param out Receives the frame.
+     * @return false if @p data is not a decodable JPEG image.
+     */
+    bool decode_jpeg(
+        const std::uint8_t* data, std::size_t size, frame& out
+    ) const;
+
+    /**
+     * @brief Number of frames skipped as static for a stream.
+     *
+     * Counts frames skipped by the static-scene early-out and by the motion
+     * vector pre-filter.
+     *
+     * @param stream_name Stream name.
+     * @return Skipped frame count (0 for unknown streams).
+     */
+    std::uint64_t skipped_frames(const std::string& stream_name) const;
+
     /**
      * @brief Create a @ref stream_manager::daemon_start_fn bound to this
      * instance.
@@ -117,7 +444,21 @@ public:
      */
     stream_manager::frame_processor_fn frame_processor_fn();
 
+    /**
+     * @brief Create a @ref stream_manager::batch_processor_fn bound to this
+     * instance.
+     *
+     * The returned functor forwards to the batch overload of
+     * @ref motion_processor.
+     *
+     * @return Compact frame processor hook for a manager.
+     */
+    stream_manager::batch_processor_fn batch_processor_fn();
+
 private:
+    /** @brief Unit test fixture reaching the mask helpers. */
+    friend class opencv_client_test;
+
     /**
      * @brief Parse local V4L2 index from a device path.
      *
@@ -139,61 +480,77 @@ private:
     frame mat_to_frame(const cv::Mat& m) const;
 
     /**
-     * @brief Z-component of cross product (AB x AC).
+     * @brief Switch a capture to delivering encoded JPEG images.
      *
-     * Used for orientation tests in 2D geometry.
-     */
-    float cross_z(const point& a, const point& b, const point& c) const;
-
-    /**
-     * @brief Orientation of triangle (a,b,c).
+     * Succeeds only if an analysis width is set, the source is Motion JPEG
+     * and the backend supports raw packet output.
      *
-     * @return 1 if counter-clockwise, -1 if clockwise, 0 if collinear
-     *         within @ref point::epsilon.
-     */
-    int orient(const point& a, const point& b, const point& c) const;
-
-    /**
-     * @brief Check whether c lies between a and b (inclusive with tolerance).
+     * @param cap Opened capture.
+     * @return true if @ref retrieve_frame should decode reduced images.
      */
-    bool between(float a, float b, float c) const;
+    bool use_reduced_jpeg(cv::VideoCapture& cap) const;
 
     /**
-     * @brief Check whether point c lies on segment ab.
-     */
-    bool on_segment(const point& a, const point& b, const point& c) const;
-
-    /**
-     * @brief Test if two 2D segments intersect.
+     * @brief Retrieve the grabbed frame of a capture.
      *
-     * Handles proper intersections and collinear overlaps.
+     * @param cap Capture after a successful @c grab().
+     * @param reduced_jpeg Result of @ref use_reduced_jpeg for @p cap; the
+     * grabbed packet is then decoded to reduced grayscale.
+     * @param m Scratch image reused across calls.
+     * @param out Receives the frame.
+     * @return false if nothing could be retrieved or decoded.
      */
-    bool segments_intersect(
-        const point& p1, const point& p2, const point& q1, const point& q2
+    bool retrieve_frame(
+        cv::VideoCapture& cap, bool reduced_jpeg, cv::Mat& m, frame& out
     ) const;
 
+#ifdef __linux__
     /**
-     * @brief Compute intersection point of two segments if they intersect.
+     * @brief Capture loop for a local device using @ref v4l2_capture.
+     *
+     * Frames reference the driver's mapped buffers directly; unwanted
+     * frames are handed back to the driver without being wrapped.
      *
-     * Uses parametric line intersection with epsilon checks.
+     * The stream's requested format is applied and the negotiated one
+     * reported back.
      *
-     * @return Intersection point in percentage coordinates, or std::nullopt.
+     * @param s Local stream ("/dev/videoN").
+     * @param on_frame Frame callback.
+     * @param wants_frame Demand query; may be empty.
+     * @param st Stop token.
+     * @return false if the device could not be opened for mmap streaming in
+     * a supported format (the caller falls back to @c cv::VideoCapture).
      */
-    std::optional<point> segment_intersection(
-        const point& p1, const point& p2, const point& q1, const point& q2
-    ) const;
+    bool run_v4l2(
+        const stream& s, const std::function<void(frame&&)>& on_frame,
+        const std::function<bool()>& wants_frame, const std::stop_token& st
+    );
+#endif
 
     /**
-     * @brief Append a motion event to the output vector.
+     * @brief Append a motion event to the output batch.
      *
      * @param out Output event list to append to.
-     * @param stream_name Source stream name.
+     * @param stream_id Interned source stream name.
      * @param ts Event timestamp.
      * @param pos_pct Motion position in percentage coordinates.
      */
     void add_motion_event(
-        std::vector<event>& out, const std::string& stream_name,
-        const std::chrono::steady_clock::time_point ts, const point& pos_pct
+        event_batch& out, std::uint32_t stream_id,
+        std::chrono::steady_clock::time_point ts, const point& pos_pct
+    ) const;
+
+    /**
+     * @brief Append a motion grid event summarizing a motion mask.
+     *
+     * @param out Output event list to append to.
+     * @param stream_id Interned source stream name.
+     * @param ts Event timestamp.
+     * @param grid Activity of the analyzed frame's motion mask.
+     */
+    void add_motion_grid_event(
+        event_batch& out, std::uint32_t stream_id,
+        std::chrono::steady_clock::time_point ts, const activity_grid& grid
     ) const;
 
     /**
@@ -210,7 +567,9 @@ private:
     /**
      * @brief Test a single line segment against a contour polyline.
      *
-     * Updates best intersection (if any) through @ref consider_hit.
+     * All contour edges are tested at once with @ref intersect_segments;
+     * hits update the best intersection through @ref consider_hit, in edge
+     * order.
      *
      * @param hit In/out: whether any hit was found.
      * @param best_dist2 In/out: best squared distance to current position.
@@ -218,36 +577,302 @@ private:
      * @param best_b In/out: line segment end of best hit.
      * @param best_pos In/out: intersection position for best hit.
      * @param cur_pos_pct Current motion centroid.
-     * @param contour_pct Motion contour in percentage coordinates.
+     * @param contour_edges Edges of the closed motion contour in percentage
+     * coordinates.
+     * @param scratch Reused per-edge results.
      * @param a Segment start.
      * @param b Segment end.
      */
     void test_line_segment_against_contour(
         bool& hit, float& best_dist2, point& best_a, point& best_b,
         point& best_pos, const point& cur_pos_pct,
-        const std::vector<point>& contour_pct, const point& a, const point& b
+        const segment_batch& contour_edges, segment_hits& scratch,
+        const point& a, const point& b
     ) const;
 
     /**
      * @brief Check a motion contour against a line and emit tripwire events.
      *
-     * Determines the closest intersecting segment of @p l, infers crossing
-     * direction from @p prev_pos to @p cur_pos_pct, applies direction
-     * constraint and cooldown, and appends a tripwire @ref event if allowed.
+     * Determines the closest intersecting segment among @p segments, infers
+     * crossing direction from @p prev_pos to @p cur_pos_pct, applies
+     * direction constraint and rate limit, and appends a tripwire event if
+     * allowed.
      *
      * @param out Output event list.
      * @param s Source stream.
-     * @param l Line to test.
+     * @param lines Compiled lines of @p s.
+     * @param segments Candidate segments of one line of @p lines (e.g. from
+     * @ref line_set::query); segments far from the motion can be left out.
      * @param prev_pos Previous centroid position.
      * @param cur_pos_pct Current centroid position.
-     * @param contour_pct Motion contour (percentage coordinates).
+     * @param contour_edges Edges of the closed motion contour (percentage
+     * coordinates).
+     * @param scratch Reused per-edge results.
      * @param now Current timestamp.
      */
     void process_tripwire_for_line(
-        std::vector<event>& out, const stream& s, const line& l,
+        event_batch& out, const stream& s, const line_set& lines,
+        std::span<const std::uint32_t> segments, const point& prev_pos,
+        const point& cur_pos_pct, const segment_batch& contour_edges,
+        segment_hits& scratch, std::chrono::steady_clock::time_point now
+    );
+
+    /**
+     * @brief Emit tripwire events for raster hits.
+     *
+     * Picks the hit closest to @p cur_pos_pct per line and hands it to
+     * @ref emit_tripwire, lines in @ref line_set order.
+     *
+     * @param out Output event list.
+     * @param s Source stream.
+     * @param raster Raster the hits come from.
+     * @param hits Line pixels set in the motion mask.
+     * @param prev_pos Previous centroid position.
+     * @param cur_pos_pct Current centroid position.
+     * @param now Current timestamp.
+     */
+    void process_raster_tripwires(
+        event_batch& out, const stream& s, const line_raster& raster,
+        const std::vector<line_raster::hit>& hits, const point& prev_pos,
+        const point& cur_pos_pct, std::chrono::steady_clock::time_point now
+    );
+
+    /**
+     * @brief Emit a tripwire event for a hit on segment @p a - @p b of @p l.
+     *
+     * Infers crossing direction from @p prev_pos to @p cur_pos_pct, applies
+     * the line's direction constraint and rate limit.
+     *
+     * @param out Output event list.
+     * @param s Source stream.
+     * @param l Line that was hit.
+     * @param a Hit segment start.
+     * @param b Hit segment end.
+     * @param pos Hit position.
+     * @param prev_pos Previous centroid position.
+     * @param cur_pos_pct Current centroid position.
+     * @param now Current timestamp.
+     */
+    void emit_tripwire(
+        event_batch& out, const stream& s, const line& l,
+        const point& a, const point& b, const point& pos,
         const point& prev_pos, const point& cur_pos_pct,
-        const std::vector<point>& contour_pct,
-        const std::chrono::steady_clock::time_point now
+        std::chrono::steady_clock::time_point now
+    );
+
+    /**
+     * @brief Rate limit of an event source. Requires @ref mtx held.
+     */
+    rate_rule rate_rule_locked(
+        rate_target t, std::string_view stream_name, std::string_view line_name
+    ) const;
+
+    /**
+     * @brief Raster of a stream's lines at the given size, rebuilt when the
+     * lines or the size changed.
+     */
+    std::shared_ptr<const line_raster> tripwire_raster(
+        const std::string& stream_name,
+        const std::shared_ptr<const line_set>& lines, int width, int height
+    );
+
+    /**
+     * @brief Region masks of a stream's closed lines at the given size,
+     * rebuilt when the lines or the size changed.
+     */
+    std::shared_ptr<const region_set> stream_regions(
+        const std::string& stream_name,
+        const std::shared_ptr<const line_set>& lines, int width, int height
+    );
+
+    /**
+     * @brief Update region occupancy and emit ROI events.
+     *
+     * Counts the motion pixels inside every region with a masked popcount
+     * and feeds the share to the region's @ref region_occupancy. Emits
+     * @ref event_kind::roi events with message `enter`, `exit` or
+     * `occupied` at the region centroid.
+     *
+     * @param out Output event list.
+     * @param s Source stream.
+     * @param regions Regions of @p s at the mask size.
+     * @param packed Packed motion mask, or nullptr to use @p mask.
+     * @param mask Byte motion mask (0/255).
+     * @param now Current timestamp.
+     */
+    void process_regions(
+        event_batch& out, const stream& s, const region_set& regions,
+        const bit_mask* packed, const cv::Mat& mask,
+        std::chrono::steady_clock::time_point now
+    );
+
+    /**
+     * @brief Update the cached regions of a stream for a frame without a
+     * motion mask.
+     *
+     * Frames skipped by the early-outs or only initializing the reference
+     * count as frames without motion, so occupied regions still exit when
+     * the scene turns static.
+     *
+     * @param out Output event list.
+     * @param s Source stream.
+     * @param now Current timestamp.
+     */
+    void process_regions(
+        event_batch& out, const stream& s,
+        std::chrono::steady_clock::time_point now
+    );
+
+    /**
+     * @brief Feed per-region motion shares to the occupancy of @p regions
+     * and emit the resulting ROI events.
+     *
+     * @param out Output event list.
+     * @param s Source stream.
+     * @param regions Cached regions of @p s; ignored if rebuilt meanwhile.
+     * @param ratios Motion share of each region.
+     * @param now Current timestamp.
+     */
+    void update_regions(
+        event_batch& out, const stream& s, const region_set& regions,
+        std::span<const double> ratios,
+        std::chrono::steady_clock::time_point now
+    );
+
+    /**
+     * @brief Compute a thresholded difference mask at full resolution.
+     *
+     * Blurs @p gray, differences it against the previous blurred frame of the
+     * stream and replaces the stored reference.
+     *
+     * @param stream_name Stream the frame belongs to.
+     * @param gray Grayscale frame.
+     * @param mask Out: binary 8-bit mask (0/255) of @p gray size.
+     * @return false if this frame only initialized the reference.
+     */
+    bool full_motion_mask(
+        const std::string& stream_name, const cv::Mat& gray, cv::Mat& mask
+    );
+
+    /**
+     * @brief Compute a thresholded difference mask coarse-to-fine.
+     *
+     * The frame is reduced by @ref pyramid_levels pyramid steps and
+     * differenced against the previous coarse frame. Only full-resolution
+     * tiles under active coarse tiles (and their neighbours) are blurred,
+     * differenced and thresholded; the rest of the mask stays zero.
+     *
+     * The full-resolution reference is the previous frame as captured; a
+     * refined tile is blurred in both frames, so the mask of a refined tile
+     * matches @ref full_motion_mask and inactive tiles never go stale.
+     *
+     * @param stream_name Stream the frame belongs to.
+     * @param gray Grayscale frame.
+     * @param mask Out: binary 8-bit mask (0/255) of @p gray size.
+     * @return false if this frame only initialized the references.
+     */
+    bool pyramid_motion_mask(
+        const std::string& stream_name, const cv::Mat& gray, cv::Mat& mask
+    );
+
+    /**
+     * @brief Static-scene pre-check for a frame.
+     *
+     * Updates the stored signature when the frame is going to be analyzed
+     * and the skip counter otherwise.
+     *
+     * @param stream_name Stream the frame belongs to.
+     * @param f Frame to check.
+     * @return true if the frame is unchanged and analysis can be skipped.
+     */
+    bool is_static_frame(const std::string& stream_name, const frame& f);
+
+    /**
+     * @brief Motion vector pre-check for a frame.
+     *
+     * Updates the skip counter when the frame is skipped.
+     *
+     * @param stream_name Stream the frame belongs to.
+     * @param f Frame to check.
+     * @return true if the frame has decoder motion vectors and they show
+     * (almost) no motion.
+     */
+    bool vectors_show_no_motion(const std::string& stream_name, const frame& f);
+
+    /**
+     * @brief Number of row bands to use for a frame of the given size.
+     *
+     * @return 1 when the frame is below the parallel threshold, otherwise the
+     * number of OpenCV threads capped so that each band has at least
+     * @ref min_band_rows rows.
+     */
+    int analysis_bands(int width, int height) const;
+
+    /**
+     * @brief Row range of band @p b when @p rows are split into @p bands.
+     */
+    static cv::Range band_rows(int rows, int bands, int b);
+
+    /**
+     * @brief Row-band parallel variant of @ref full_motion_mask.
+     *
+     * Produces the same mask as the sequential path.
+     *
+     * @param stream_name Stream the frame belongs to.
+     * @param gray Grayscale frame.
+     * @param mask Out: binary 8-bit mask (0/255) of @p gray size.
+     * @param bands Number of row bands.
+     * @return false if this frame only initialized the reference.
+     */
+    bool parallel_motion_mask(
+        const std::string& stream_name, const cv::Mat& gray, cv::Mat& mask,
+        int bands
+    );
+
+    /**
+     * @brief Row-band parallel erosion (1x) and dilation (2x) of a mask.
+     *
+     * @param mask In/out: binary mask.
+     * @param bands Number of row bands.
+     */
+    static void parallel_morphology(cv::Mat& mask, int bands);
+
+    /**
+     * @brief Label a mask in row bands and extract the largest component.
+     *
+     * Each band is labelled independently; labels of 8-connected pixels
+     * across band borders are merged with a union-find. The external contour
+     * of the largest merged component (by pixel area) is traced inside its
+     * bounding box only.
+     *
+     * @param mask Binary mask.
+     * @param bands Number of row bands.
+     * @param contours Out: contour(s) of the largest component in frame
+     * coordinates; empty if the mask is empty.
+     * @return Number of non-zero mask pixels.
+     */
+    int parallel_largest_component(
+        const cv::Mat& mask, int bands,
+        std::vector<std::vector<cv::Point>>& contours
+    ) const;
+
+    /**
+     * @brief Clean up a mask in packed form and extract its largest component.
+     *
+     * Packs @p mask to one bit per pixel, erodes once and dilates twice
+     * (same as the byte path), labels 8-connected components and traces the
+     * external contour of the largest one (by pixel area) inside its
+     * bounding box only.
+     *
+     * @param mask Binary 8-bit mask.
+     * @param packed Out: cleaned packed mask.
+     * @param contours Out: contour(s) of the largest component in frame
+     * coordinates; empty if the cleaned mask is empty.
+     * @return Number of set pixels of the cleaned mask.
+     */
+    static int packed_largest_component(
+        const cv::Mat& mask, bit_mask& packed,
+        std::vector<std::vector<cv::Point>>& contours
     );
 
     /**
@@ -265,19 +890,76 @@ private:
     mutable std::mutex mtx;
 
     /**
-     * @brief Previous blurred grayscale frame per stream.
+     * @brief Previous grayscale frame per stream.
      *
-     * Used for frame differencing.
+     * Used for frame differencing; blurred in @ref detection_mode::full, as
+     * captured in @ref detection_mode::pyramid.
      */
     std::unordered_map<std::string, cv::Mat> prev_gray_by_stream;
 
     /**
-     * @brief Last time a motion event was emitted per stream.
+     * @brief Previous coarse pyramid level per stream.
+     *
+     * Used for the coarse pass of @ref detection_mode::pyramid.
+     */
+    std::unordered_map<std::string, cv::Mat> prev_coarse_by_stream;
+
+    /** @brief Current motion mask computation mode. */
+    detection_mode mode { detection_mode::full };
+
+    /** @brief Number of pyramid levels for the coarse pass. */
+    int pyramid_levels { 2 };
+
+    /** @brief Share of changed coarse pixels activating a tile. */
+    double pyramid_activation { 0.02 };
+
+    /** @brief Tile edge length in coarse pixels. */
+    static constexpr int pyramid_tile_px { 8 };
+
+    /** @brief Pixel count from which analysis runs in row bands. */
+    long long parallel_min_px { 4'000'000 };
+
+    /** @brief Minimal number of rows per analysis band. */
+    static constexpr int min_band_rows { 64 };
+
+    /** @brief Whether mask post-processing runs on packed bits. */
+    bool packed_masks { true };
+
+    /** @brief Delivery rate of file streams. */
+    playback_mode file_playback { playback_mode::realtime };
+
+    /** @brief Whether network streams use low-latency ingest. */
+    bool low_latency { false };
+
+    /** @brief Width reduced JPEG decoding aims for; 0 = full size. */
+    int analysis_width { 0 };
+
+    /** @brief Mean luma tolerance of the static-scene early-out. */
+    int static_tolerance { 2 };
+
+    /** @brief Moving-area share below which vector pre-filter skips. */
+    double vector_min_area { 0.001 };
+
+    /** @brief Displacement from which a decoder block counts as moving. */
+    static constexpr float vector_min_magnitude { 0.5f };
+
+    /**
+     * @brief Per-pixel threshold of the motion mask.
      *
-     * Used for per-stream cooldown throttling.
+     * Also the largest single-sample change tolerated by the early-out.
+     */
+    static constexpr int diff_threshold { 25 };
+
+    /**
+     * @brief Signature of the last analyzed frame per stream.
      */
-    std::unordered_map<std::string, std::chrono::steady_clock::time_point>
-        last_emit_by_stream;
+    std::unordered_map<std::string, frame_signature> signature_by_stream;
+
+    /**
+     * @brief Number of frames skipped by the early-outs per stream.
+     */
+    std::unordered_map<std::string, std::uint64_t> skipped_by_stream;
+
 
     /**
      * @brief Last known motion centroid per stream.
@@ -287,33 +969,80 @@ private:
     std::unordered_map<std::string, point> last_pos_by_stream;
 
     /**
-     * @brief Last time a tripwire was emitted per (stream|line|direction) key.
-     *
-     * Used to enforce direction-specific tripwire cooldown.
+     * @brief Motion and tripwire buckets per (stream, line, direction) key.
+     */
+    rate_limiter limiter;
+
+    /** @brief Default motion rate limit. */
+    rate_rule motion_rate { std::chrono::milliseconds(150), 1 };
+
+    /** @brief Default tripwire rate limit. */
+    rate_rule tripwire_rate { std::chrono::milliseconds(1200), 1 };
+
+    /**
+     * @brief Rate limit overrides keyed by @ref rate_key of (stream, line,
+     * target).
+     */
+    std::unordered_map<std::uint64_t, rate_rule> rate_overrides;
+
+    /** @brief Tripwire mode per stream; absent = vector. */
+    std::unordered_map<std::string, tripwire_mode> tripwire_mode_by_stream;
+
+    /** @brief Line raster per stream in raster mode. */
+    std::unordered_map<std::string, std::shared_ptr<const line_raster>>
+        raster_by_stream;
+
+    /**
+     * @brief Region masks of a stream and the occupancy of each region.
      */
-    std::unordered_map<std::string, std::chrono::steady_clock::time_point>
-        last_tripwire_by_key;
+    struct stream_rois {
+        /** @brief Regions at the last analyzed size. */
+        std::shared_ptr<const region_set> regions;
+
+        /** @brief State of region i of @ref regions. */
+        std::vector<region_occupancy> occupancy;
+    };
+
+    /**
+     * @brief Regions per stream; a rebuilt set takes over the state of
+     * regions with the same line name.
+     */
+    std::unordered_map<std::string, stream_rois> rois_by_stream;
+
+    /** @brief Region enter/exit thresholds. */
+    occupancy_config roi_cfg;
 };
 
+/**
+ * @brief Access the global @ref opencv_client instance.
+ *
+ * This is the instance used by @ref opencv_daemon_start and
+ * @ref opencv_motion_processor; it can be used to configure them.
+ *
+ * @return Reference to the process-wide client.
+ */
+opencv_client& global_opencv_client();
+
 /**
  * @brief Global OpenCV daemon start wrapper.
  *
- * This function forwards to a hidden global @ref opencv_client instance.
+ * This function forwards to the @ref global_opencv_client instance.
  * It is provided for convenient use as a @ref stream_manager::daemon_start_fn.
  *
  * @param s Stream to capture.
  * @param on_frame Callback invoked with captured frames.
+ * @param wants_frame Demand query for the next frame.
  * @param st Stop token.
  */
 void opencv_daemon_start(
     const stream& s, const std::function<void(frame&&)>& on_frame,
-    const std::stop_token& st
+    const std::function<bool()>& wants_frame, const std::stop_token& st
 );
 
 /**
  * @brief Global OpenCV motion processor wrapper.
  *
- * This function forwards to a hidden global @ref opencv_client instance.
+ * This function forwards to the @ref global_opencv_client instance.
  * It is provided for convenient use as a
  * @ref stream_manager::frame_processor_fn.
  *
@@ -323,6 +1052,21 @@ void opencv_daemon_start(
  */
 std::vector<event> opencv_motion_processor(const stream& s, const frame& f);
 
+/**
+ * @brief Global OpenCV motion processor wrapper producing compact events.
+ *
+ * This function forwards to the @ref global_opencv_client instance.
+ * It is provided for convenient use as a
+ * @ref stream_manager::batch_processor_fn.
+ *
+ * @param s Stream context.
+ * @param f Frame to analyze.
+ * @param out Batch to append produced events to.
+ */
+void opencv_batch_processor(
+    const stream& s, const frame& f, event_batch& out
+);
+
 } // namespace yodau::backend
 
 #endif // YODAU_OPENCV
@@ -0,0 +1,93 @@
+#ifndef YODAU_BACKEND_PLAYBACK_CLOCK_HPP
+#define YODAU_BACKEND_PLAYBACK_CLOCK_HPP
+
+#include <chrono>
+#include <stop_token>
+
+namespace yodau::backend {
+
+/**
+ * @brief Schedules file frames at their presentation time.
+ *
+ * The clock maps presentation timestamps of a media file onto steady-clock
+ * deadlines so that a file stream is delivered at its native rate instead of
+ * as fast as it can be decoded.
+ *
+ * - The first frame after construction or @ref restart is due immediately
+ *   and anchors the timeline.
+ * - Later frames are due at anchor + (pts - first pts).
+ * - If timestamps are unknown (negative) or do not increase, the previous
+ *   offset plus one frame period (from the container fps) is used instead.
+ *   Such timestamps are ignored for later comparisons, and deadlines never
+ *   move backwards.
+ * - If the consumer falls behind by more than @ref max_lag, the anchor is
+ *   moved so that playback continues from "now" instead of bursting to
+ *   catch up.
+ */
+class playback_clock {
+public:
+    /** @brief Clock used for deadlines. */
+    using clock = std::chrono::steady_clock;
+
+    /** @brief Largest tolerated lag before the timeline is re-anchored. */
+    static constexpr std::chrono::milliseconds max_lag { 1000 };
+
+    /**
+     * @brief Construct a clock for a source with the given frame rate.
+     *
+     * @param fps Container frame rate; values outside (0; 1000] fall back to
+     * 30 fps for the frame-period estimate.
+     */
+    explicit playback_clock(double fps = 0.0);
+
+    /**
+     * @brief Forget the timeline (e.g. after a loop restart).
+     *
+     * The next frame passed to @ref due will be due immediately.
+     */
+    void restart();
+
+    /**
+     * @brief Deadline of the frame with presentation time @p pts_ms.
+     *
+     * @param pts_ms Presentation time in milliseconds, negative if unknown.
+     * @param now Current time.
+     * @return Time point at which the frame should be delivered.
+     */
+    clock::time_point due(double pts_ms, clock::time_point now);
+
+    /** @brief Nominal duration of one frame. */
+    clock::duration frame_period() const;
+
+    /**
+     * @brief Block until @p tp or until stop is requested.
+     *
+     * @param tp Deadline, e.g. from @ref due.
+     * @param st Stop token interrupting the wait.
+     * @return false if stop was requested.
+     */
+    static bool sleep_until(clock::time_point tp, const std::stop_token& st);
+
+private:
+    /** @brief Nominal frame duration. */
+    clock::duration period;
+
+    /** @brief Wall time of the first frame of the timeline. */
+    clock::time_point origin {};
+
+    /** @brief Presentation time of the first frame, ms. */
+    double first_pts_ms { 0.0 };
+
+    /** @brief Presentation time of the previous frame, ms. */
+    double last_pts_ms { -1.0 };
+
+    /** @brief Offset of the previous frame from @ref origin. */
+    clock::duration last_offset {};
+
+    /** @brief Whether @ref origin is set. */
+    bool started { false };
+};
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_PLAYBACK_CLOCK_HPP
@@ -0,0 +1,145 @@
+#ifndef YODAU_BACKEND_RATE_LIMITER_HPP
+#define YODAU_BACKEND_RATE_LIMITER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace yodau::backend {
+
+/**
+ * @brief Token bucket parameters.
+ *
+ * A bucket holds up to @ref burst tokens and regains one token every
+ * @ref interval; each admitted event takes one token. With a burst of 1
+ * this is a plain cooldown of @ref interval.
+ */
+struct rate_rule {
+    /** @brief Time to regain one token; zero or negative = unlimited. */
+    std::chrono::steady_clock::duration interval { 0 };
+
+    /** @brief Bucket capacity (at least 1). */
+    int burst { 1 };
+
+    /** @brief Whether the rule admits every event. */
+    bool unlimited() const { return interval.count() <= 0; }
+};
+
+/**
+ * @brief State of one token bucket.
+ *
+ * Stored as the theoretical arrival time of the next conforming event
+ * (generic cell rate algorithm), so a bucket is a single timestamp and
+ * needs no periodic refill. Once the clock passes @ref full_at the bucket
+ * is full again and indistinguishable from a fresh one.
+ */
+class token_bucket {
+public:
+    /** @brief Time source of timestamps. */
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Take a token at @p now if one is available.
+     *
+     * @param rule Bucket parameters; may change between calls.
+     * @param now Event time.
+     * @return true if the event is admitted.
+     */
+    bool take(const rate_rule& rule, clock::time_point now);
+
+    /** @brief Time from which the bucket is full. */
+    clock::time_point full_at() const { return tat; }
+
+private:
+    /** @brief Theoretical arrival time. */
+    clock::time_point tat {};
+};
+
+/**
+ * @brief Compact key of a rate-limited event source.
+ *
+ * Hashes the stream name, line name (may be empty) and a caller-defined
+ * channel (event kind, direction, ...) into 64 bits. Distinct sources may
+ * collide with negligible probability; they would then share a bucket.
+ */
+std::uint64_t rate_key(
+    std::string_view stream_name, std::string_view line_name,
+    std::uint32_t channel
+);
+
+/**
+ * @brief Token buckets per compact key with bounded, expiring state.
+ *
+ * A bucket is dropped once it is full again, which does not change any
+ * later decision, so only sources that fired recently are kept. Expiry is
+ * driven by a timer wheel advanced on every call: each bucket sits in the
+ * slot of its @ref token_bucket::full_at tick and is dropped or moved
+ * later when that slot comes up, which costs O(1) amortized per call and
+ * never scans the whole table.
+ *
+ * Thread-safety:
+ * - Not synchronized; the owner serializes access.
+ */
+class rate_limiter {
+public:
+    /** @brief Time source of timestamps. */
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Limiter whose wheel has @p slots slots of @p tick.
+     *
+     * Buckets expire up to one tick late.
+     */
+    explicit rate_limiter(
+        clock::duration tick = std::chrono::milliseconds(100),
+        std::size_t slots = 64
+    );
+
+    /**
+     * @brief Admit or reject an event of source @p key.
+     *
+     * @param key Source key (see @ref rate_key).
+     * @param rule Bucket parameters of the source.
+     * @param now Event time; expected to be non-decreasing across calls.
+     * @return true if the event is admitted.
+     */
+    bool allow(std::uint64_t key, const rate_rule& rule, clock::time_point now);
+
+    /** @brief Number of sources currently tracked. */
+    std::size_t size() const { return buckets.size(); }
+
+private:
+    /** @brief Absolute tick containing @p t. */
+    long long tick_of(clock::time_point t) const;
+
+    /** @brief Put @p key in the slot of tick @p t. */
+    void schedule(std::uint64_t key, long long t);
+
+    /** @brief Drop buckets that are full at @p now. */
+    void expire(clock::time_point now);
+
+    /** @brief Wheel resolution. */
+    clock::duration tick;
+
+    /** @brief Buckets keyed by source. */
+    std::unordered_map<std::uint64_t, token_bucket> buckets;
+
+    /** @brief Keys per slot; each tracked key is in exactly one slot. */
+    std::vector<std::vector<std::uint64_t>> wheel;
+
+    /** @brief Scratch for the slot being expired. */
+    std::vector<std::uint64_t> firing;
+
+    /** @brief Last tick whose slot was expired. */
+    long long done { 0 };
+
+    /** @brief Whether @ref done is initialized. */
+    bool started { false };
+};
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_RATE_LIMITER_HPP
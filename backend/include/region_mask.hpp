@@ -0,0 +1,235 @@
+#ifndef YODAU_BACKEND_REGION_MASK_HPP
+#define YODAU_BACKEND_REGION_MASK_HPP
+
+#include "bit_mask.hpp"
+#include "line_set.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace yodau::backend {
+
+/**
+ * @brief Polygon rasterized to an occupancy mask at one analysis resolution.
+ *
+ * A pixel belongs to the region when its center lies inside the polygon
+ * (even-odd rule). The mask is kept both packed (for a masked popcount
+ * against a @ref bit_mask) and as horizontal spans (for byte masks), so the
+ * per-frame cost is proportional to the region's bounding box and never
+ * involves a point-in-polygon test.
+ */
+class region_mask {
+public:
+    /** @brief Empty region. */
+    region_mask() = default;
+
+    /**
+     * @brief Rasterize @p polygon for masks of @p width x @p height pixels.
+     *
+     * @param polygon Vertices in percentage coordinates; implicitly closed.
+     * @param width Mask width in pixels.
+     * @param height Mask height in pixels.
+     */
+    region_mask(const std::vector<point>& polygon, int width, int height);
+
+    /** @brief Mask width. */
+    int width() const { return inside.width(); }
+
+    /** @brief Mask height. */
+    int height() const { return inside.height(); }
+
+    /** @brief Number of pixels inside the region. */
+    long long area() const { return pixels; }
+
+    /** @brief Mean of the inside pixel centers, in percentage coordinates. */
+    point centroid() const { return center; }
+
+    /**
+     * @brief Number of set pixels of @p motion inside the region.
+     *
+     * @param motion Mask of the same size (0 for other sizes).
+     */
+    long long count_in(const bit_mask& motion) const;
+
+    /**
+     * @brief Number of non-zero bytes of a motion mask inside the region.
+     *
+     * @param motion First row of a @ref width x @ref height byte mask.
+     * @param stride Bytes between rows.
+     */
+    long long count_in(const std::uint8_t* motion, std::size_t stride) const;
+
+private:
+    /**
+     * @brief Inside pixels of one row: [x0; x1).
+     */
+    struct span {
+        int y { 0 };
+        int x0 { 0 };
+        int x1 { 0 };
+    };
+
+    /** @brief Packed inside pixels. */
+    bit_mask inside;
+
+    /** @brief Inside pixels as row spans, row-major. */
+    std::vector<span> spans;
+
+    /** @brief First row with inside pixels. */
+    int row0 { 0 };
+
+    /** @brief One past the last row with inside pixels. */
+    int row1 { 0 };
+
+    /** @brief First word column with inside pixels. */
+    int word0 { 0 };
+
+    /** @brief One past the last word column with inside pixels. */
+    int word1 { 0 };
+
+    /** @brief Number of inside pixels. */
+    long long pixels { 0 };
+
+    /** @brief Mean inside pixel center. */
+    point center {};
+};
+
+/**
+ * @brief Regions (closed lines) of a @ref line_set at one resolution.
+ *
+ * Only closed lines with at least three points become regions; open lines
+ * are tripwires only.
+ *
+ * Thread-safety:
+ * - Immutable after construction; safe to query concurrently.
+ */
+class region_set {
+public:
+    /** @brief Empty set. */
+    region_set() = default;
+
+    /**
+     * @brief Rasterize the closed lines of @p lines.
+     *
+     * @param lines Compiled lines (kept alive by the set).
+     * @param width Mask width in pixels.
+     * @param height Mask height in pixels.
+     */
+    region_set(std::shared_ptr<const line_set> lines, int width, int height);
+
+    /**
+     * @brief Whether the set was built from @p lines at this size.
+     */
+    bool matches(
+        const std::shared_ptr<const line_set>& lines, int width, int height
+    ) const;
+
+    /** @brief Number of regions. */
+    std::size_t size() const { return masks.size(); }
+
+    /** @brief Whether there are no regions. */
+    bool empty() const { return masks.empty(); }
+
+    /** @brief Line of region @p i. */
+    const line& line_at(std::size_t i) const;
+
+    /** @brief Mask of region @p i. */
+    const region_mask& mask_at(std::size_t i) const { return masks[i]; }
+
+private:
+    /** @brief Source lines. */
+    std::shared_ptr<const line_set> source;
+
+    /** @brief Mask width. */
+    int w { 0 };
+
+    /** @brief Mask height. */
+    int h { 0 };
+
+    /** @brief Index of each region's line in @ref source. */
+    std::vector<std::size_t> line_index;
+
+    /** @brief One mask per region. */
+    std::vector<region_mask> masks;
+};
+
+/**
+ * @brief Thresholds of @ref region_occupancy.
+ *
+ * The share of region pixels with motion must reach @ref enter_ratio for
+ * @ref enter_frames analyzed frames in a row to enter, and stay below
+ * @ref exit_ratio for @ref exit_frames frames in a row to exit. Keeping
+ * @ref exit_ratio below @ref enter_ratio gives hysteresis, so a region does
+ * not flicker when motion hovers around a single threshold.
+ */
+struct occupancy_config {
+    /** @brief Share of region pixels that counts as activity. */
+    double enter_ratio { 0.02 };
+
+    /** @brief Share of region pixels below which the region is idle. */
+    double exit_ratio { 0.005 };
+
+    /** @brief Consecutive active frames needed to enter. */
+    int enter_frames { 2 };
+
+    /** @brief Consecutive idle frames needed to exit. */
+    int exit_frames { 5 };
+
+    /**
+     * @brief Interval of `occupied` reports while entered (0 disables).
+     */
+    std::chrono::milliseconds report_interval { 1000 };
+};
+
+/**
+ * @brief Enter/exit state machine of one region.
+ */
+class region_occupancy {
+public:
+    /**
+     * @brief State change reported by @ref update.
+     */
+    enum class change {
+        /** Nothing to report. */
+        none,
+        /** The region became occupied. */
+        enter,
+        /** The region became idle. */
+        exit,
+        /** The region is still occupied (periodic report). */
+        occupied
+    };
+
+    /**
+     * @brief Feed the motion share of one analyzed frame.
+     *
+     * @param ratio Region pixels with motion / region area.
+     * @param now Frame timestamp.
+     * @param cfg Thresholds.
+     * @return State change to report, if any.
+     */
+    change update(
+        double ratio, std::chrono::steady_clock::time_point now,
+        const occupancy_config& cfg
+    );
+
+    /** @brief Whether the region is currently occupied. */
+    bool occupied() const { return inside; }
+
+private:
+    /** @brief Current state. */
+    bool inside { false };
+
+    /** @brief Frames in a row that argue for leaving the current state. */
+    int streak { 0 };
+
+    /** @brief Time of the last enter / occupied report. */
+    std::chrono::steady_clock::time_point last_report {};
+};
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_REGION_MASK_HPP
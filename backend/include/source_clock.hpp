@@ -0,0 +1,68 @@
+#ifndef YODAU_BACKEND_SOURCE_CLOCK_HPP
+#define YODAU_BACKEND_SOURCE_CLOCK_HPP
+
+#include <chrono>
+
+namespace yodau::backend {
+
+/**
+ * @brief Maps source presentation timestamps onto the local steady clock.
+ *
+ * Network sources stamp frames with their own clock. Arrival time alone hides
+ * how long a frame sat in network, demuxer and decoder buffers, so frames are
+ * instead stamped with an estimate of when they left the source:
+ *
+ * @code
+ * ts = pts + min(arrival - pts)
+ * @endcode
+ *
+ * i.e. every frame is assumed to have been delayed at least as much as the
+ * fastest frame seen so far. Queueing delay on top of that baseline then shows
+ * up in measured latency instead of being absorbed into the timestamp.
+ *
+ * - Unknown (negative) timestamps map to the arrival time.
+ * - A backwards jump or a forward jump of more than @ref max_jump
+ *   (source restart, seek, wrap) re-anchors the mapping.
+ * - The baseline may drift forward by @ref max_drift of the elapsed source
+ *   time, so a source clock running slightly slow does not inflate latency
+ *   forever.
+ *
+ * The mapped time is never later than the arrival time.
+ */
+class source_clock {
+public:
+    /** @brief Local clock. */
+    using clock = std::chrono::steady_clock;
+
+    /** @brief Largest forward timestamp step kept on the same anchor. */
+    static constexpr std::chrono::milliseconds max_jump { 5000 };
+
+    /** @brief Tolerated source/local clock rate difference. */
+    static constexpr double max_drift { 0.001 };
+
+    /**
+     * @brief Map a frame's source timestamp.
+     *
+     * @param pts_ms Source presentation time in ms, negative if unknown.
+     * @param arrival Local time the frame became available.
+     * @return Estimated local capture time.
+     */
+    clock::time_point map(double pts_ms, clock::time_point arrival);
+
+    /** @brief Forget the mapping; the next frame re-anchors it. */
+    void reset();
+
+private:
+    /** @brief Local time corresponding to source time 0. */
+    clock::time_point base {};
+
+    /** @brief Source time of the previous mapped frame, ms. */
+    double last_pts_ms { -1.0 };
+
+    /** @brief Whether @ref base is set. */
+    bool started { false };
+};
+
+} // namespace yodau::backend
+
+#endif // YODAU_BACKEND_SOURCE_CLOCK_HPP
@@ -2,7 +2,11 @@
 #define YODAU_BACKEND_STREAM_HPP
 
 #include "geometry.hpp"
+#include "line_set.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <ostream>
 #include <string>
@@ -46,6 +50,65 @@ enum class stream_pipeline {
     none
 };
 
+/**
+ * @brief Capture format of a stream source.
+ *
+ * Used both for the format requested from the source and for the one the
+ * capture backend actually negotiated. Unset fields (0 / empty) mean "source
+ * default" in a request and "unknown" in a negotiated format.
+ */
+struct capture_format {
+    /** @brief Frame width in pixels. */
+    int width { 0 };
+
+    /** @brief Frame height in pixels. */
+    int height { 0 };
+
+    /** @brief Frame rate. */
+    double fps { 0.0 };
+
+    /** @brief Four-character pixel/codec code, e.g. "MJPG" or "YUYV". */
+    std::string fourcc;
+
+    /** @brief Whether no field is set. */
+    bool empty() const;
+
+    /** @brief Whether all fields are equal. */
+    bool operator==(const capture_format&) const = default;
+
+    /**
+     * @brief Pack @ref fourcc the way V4L2 and OpenCV do (first character in
+     * the lowest byte).
+     *
+     * @return Packed code, or 0 unless @ref fourcc has exactly 4 characters.
+     */
+    std::uint32_t fourcc_code() const;
+
+    /**
+     * @brief Unpack a fourcc code into its characters.
+     *
+     * @param code Packed code.
+     * @return Four characters, or an empty string for 0 or non-printable
+     * codes.
+     */
+    static std::string fourcc_name(std::uint32_t code);
+
+    /**
+     * @brief Parse a frame size written as "WIDTHxHEIGHT" (e.g. "640x480").
+     *
+     * @param text Size text.
+     * @param width Receives the width.
+     * @param height Receives the height.
+     * @return false if @p text is not two positive integers separated by 'x'.
+     */
+    static bool parse_size(const std::string& text, int& width, int& height);
+};
+
+/**
+ * @brief Print a format as "640x480@30fps MJPG", omitting unset fields.
+ */
+std::ostream& operator<<(std::ostream& out, const capture_format& fmt);
+
 /**
  * @brief Represents a single video stream and its analytic connections.
  *
@@ -57,9 +120,12 @@ enum class stream_pipeline {
  * (tripwires / ROIs), identified by their logical names.
  *
  * Thread-safety:
- * - All access to connected lines is synchronized via @ref lines_mtx.
- * - Non-line metadata (name/path/type/loop/active) is not internally
- * synchronized.
+ * - Changes to connected lines are serialized via @ref lines_mtx; each one
+ * publishes a new immutable @ref line_set that readers load without
+ * locking (see @ref compiled_lines).
+ * - The negotiated capture format is synchronized via @ref format_mtx.
+ * - Other metadata (name/path/type/loop/active/requested format) is not
+ * internally synchronized.
  */
 class stream {
 public:
@@ -78,10 +144,11 @@ public:
      * @param type_str Optional textual override ("local", "file", "rtsp",
      * "http").
      * @param loop Whether file-based streams should loop on end-of-file.
+     * @param format Requested capture format (default: source default).
      */
     stream(
         std::string path, std::string name, const std::string& type_str = {},
-        bool loop = true
+        bool loop = true, capture_format format = {}
     );
 
     /// Non-copyable (streams manage shared connections / mutex).
@@ -158,6 +225,30 @@ public:
      */
     bool is_looping() const;
 
+    /**
+     * @brief Capture format requested from the source.
+     *
+     * Capture backends apply the fields the source supports (resolution,
+     * frame rate and pixel format of local cameras) when opening it.
+     */
+    const capture_format& requested_format() const;
+
+    /**
+     * @brief Record the format the capture backend actually negotiated.
+     *
+     * Called by capture daemons, which only see the stream as const, once
+     * the source is open.
+     *
+     * @param format Negotiated format.
+     */
+    void report_negotiated_format(capture_format format) const;
+
+    /**
+     * @brief Format reported by the last capture daemon (empty before the
+     * stream was first opened).
+     */
+    capture_format negotiated_format() const;
+
     /**
      * @brief Dump stream metadata to an output stream.
      *
@@ -201,6 +292,19 @@ public:
      */
     void connect_line(line_ptr line);
 
+    /**
+     * @brief Replace a connected line with a new version of it.
+     *
+     * The connection with the same @ref line::name is updated and a new
+     * @ref line_set is published; analysis running on the previous set
+     * finishes with it. If @p line is null or not connected, the call is
+     * ignored.
+     *
+     * @param line New version of the line.
+     * @return true if the line was connected and has been replaced.
+     */
+    bool replace_line(line_ptr line);
+
     /**
      * @brief Get a list of names of all connected lines.
      *
@@ -217,6 +321,30 @@ public:
      */
     std::vector<line_ptr> lines_snapshot() const;
 
+    /**
+     * @brief Get the connected lines compiled for hit testing.
+     *
+     * The set is built once per change of the connections and published
+     * atomically (read-copy-update), so this is one constant-time atomic
+     * load that does not take @ref lines_mtx or allocate. It is not
+     * lock-free: libstdc++ guards an atomic shared_ptr with a spin bit held
+     * for the reference count update only, so readers never wait for a
+     * writer rebuilding the set. A caller keeps a consistent set for as
+     * long as it holds the pointer, even if the lines change meanwhile.
+     *
+     * @return Compiled lines (never null); its @ref line_set::version is
+     * the @ref lines_version it was published as.
+     */
+    std::shared_ptr<const line_set> compiled_lines() const;
+
+    /**
+     * @brief Version of the connected lines.
+     *
+     * Starts at 0 and grows with every change, so that consumers can detect
+     * changes and rebuild derived structures with one atomic read.
+     */
+    std::uint64_t lines_version() const;
+
 private:
     /** @brief Logical stream name. */
     std::string name;
@@ -233,6 +361,22 @@ private:
     /** @brief Currently active pipeline mode. */
     stream_pipeline active { stream_pipeline::none };
 
+    /** @brief Requested capture format. */
+    capture_format requested;
+
+    /**
+     * @brief Format negotiated by the capture backend.
+     *
+     * Protected by @ref format_mtx.
+     */
+    mutable capture_format negotiated;
+
+    /** @brief Mutex guarding @ref negotiated. */
+    mutable std::mutex format_mtx;
+
+    /** @brief Compile @ref lines and publish them; needs @ref lines_mtx. */
+    void publish_locked();
+
     /**
      * @brief Connected lines keyed by their logical names.
      *
@@ -240,7 +384,18 @@ private:
      */
     std::unordered_map<std::string, line_ptr> lines;
 
-    /** @brief Mutex guarding @ref lines. */
+    /**
+     * @brief Current compilation of @ref lines.
+     *
+     * Written under @ref lines_mtx, read without it (see
+     * @ref compiled_lines).
+     */
+    std::atomic<std::shared_ptr<const line_set>> published;
+
+    /** @brief Version of @ref published. */
+    std::atomic<std::uint64_t> version { 0 };
+
+    /** @brief Mutex serializing changes to @ref lines. */
     mutable std::mutex lines_mtx;
 };
 
@@ -1,16 +1,27 @@
 #ifndef YODAU_BACKEND_STREAM_MANAGER_HPP
 #define YODAU_BACKEND_STREAM_MANAGER_HPP
 
+#include "adaptive_sampler.hpp"
+#include "crossing_counter.hpp"
 #include "event.hpp"
+#include "event_batch.hpp"
 #include "frame.hpp"
+#include "motion_heatmap.hpp"
+#include "rate_limiter.hpp"
 #include "stream.hpp"
 
+#ifdef __linux__
+#include "capture_engine.hpp"
+#endif
+
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <ostream>
+#include <span>
 #include <stop_token>
 #include <string>
 #include <thread>
@@ -69,18 +80,33 @@ public:
      * @brief Hook used to start a background daemon that produces frames.
      *
      * The manager provides an on-frame callback that the daemon should call for
-     * each produced frame. The daemon must also respect @p st and exit promptly
+     * each produced frame, and a demand callback (see @ref wants_frame) the
+     * daemon may query before decoding a frame: frames that are not wanted
+     * would be dropped by the manager anyway, so the daemon can skip their
+     * decode/conversion. The daemon must also respect @p st and exit promptly
      * when stop is requested.
      *
      * @param s Stream to run.
      * @param on_frame Callback to deliver produced frames to the manager.
+     * @param wants_frame Returns whether the next frame would be consumed.
      * @param st Stop token to observe for cancellation.
      */
     using daemon_start_fn = std::function<void(
         const stream& s, std::function<void(frame&&)> on_frame,
-        std::stop_token st
+        std::function<bool()> wants_frame, std::stop_token st
     )>;
 
+#ifdef __linux__
+    /**
+     * @brief Factory of @ref capture_engine sources.
+     *
+     * @param s Stream to open.
+     * @return Opened source, or nullptr if the engine cannot serve @p s.
+     */
+    using capture_source_fn
+        = std::function<std::unique_ptr<capture_source>(const stream& s)>;
+#endif
+
     /**
      * @brief Frame analysis function.
      *
@@ -94,6 +120,19 @@ public:
     using frame_processor_fn
         = std::function<std::vector<event>(const stream& s, const frame& f)>;
 
+    /**
+     * @brief Frame analysis function producing compact events.
+     *
+     * Same role as @ref frame_processor_fn, but appends to a reused
+     * @ref event_batch instead of returning string-based events.
+     *
+     * @param s Stream metadata/context.
+     * @param f Frame to analyze (const reference).
+     * @param out Batch to append generated events to.
+     */
+    using batch_processor_fn = std::function<
+        void(const stream& s, const frame& f, event_batch& out)>;
+
     /**
      * @brief Sink for individual events.
      *
@@ -109,6 +148,36 @@ public:
     using event_batch_sink_fn
         = std::function<void(const std::vector<event>& events)>;
 
+    /**
+     * @brief Sink for compact event batches.
+     *
+     * If set, @ref push_frame delivers the @ref event_batch itself, without
+     * converting events to @ref event. The batch is only valid during the
+     * call.
+     */
+    using compact_sink_fn = std::function<void(const event_batch& events)>;
+
+    /**
+     * @brief Glass-to-event latency of a stream.
+     *
+     * Measured for every analyzed frame as the time between @ref frame::ts
+     * (capture time, source-timestamp based where available) and the moment
+     * the frame processor returned its events.
+     */
+    struct latency_stats {
+        /** @brief Latency of the most recently analyzed frame. */
+        std::chrono::microseconds last {};
+
+        /** @brief Exponential moving average (weight 1/16 per frame). */
+        std::chrono::microseconds average {};
+
+        /** @brief Largest latency seen. */
+        std::chrono::microseconds max {};
+
+        /** @brief Number of measured frames. */
+        std::uint64_t samples { 0 };
+    };
+
     /**
      * @brief Construct manager and attempt to discover local streams.
      *
@@ -118,6 +187,16 @@ public:
      */
     stream_manager();
 
+    /**
+     * @brief Stop streams served by a capture engine.
+     *
+     * Daemon threads are stopped and joined by their own destructors.
+     */
+    ~stream_manager();
+
+    stream_manager(const stream_manager&) = delete;
+    stream_manager& operator=(const stream_manager&) = delete;
+
     /**
      * @brief Dump all streams and lines to an output stream.
      *
@@ -177,11 +256,13 @@ public:
      * @param name Optional explicit stream name.
      * @param type Optional explicit type override passed to @ref stream ctor.
      * @param loop Whether file streams should loop on EOF.
+     * @param format Requested capture format (see @ref stream).
      * @return Reference to the stored stream.
      */
     stream& add_stream(
         const std::string& path, const std::string& name = {},
-        const std::string& type = {}, bool loop = true
+        const std::string& type = {}, bool loop = true,
+        const capture_format& format = {}
     );
 
     /**
@@ -257,13 +338,32 @@ public:
      */
     void set_daemon_start_hook(daemon_start_fn hook);
 
+#ifdef __linux__
+    /**
+     * @brief Serve streams from a shared multiplexed capture engine.
+     *
+     * Streams started afterwards are first offered to @p make_source; those
+     * it opens are read by @p engine, the others still get a daemon thread
+     * from the @ref daemon_start hook. Running streams keep their current
+     * capture until restarted.
+     *
+     * @param engine Engine to use; nullptr returns to daemons only.
+     * @param make_source Source factory (e.g. @ref v4l2_source::open).
+     */
+    void set_capture_engine(
+        std::shared_ptr<capture_engine> engine, capture_source_fn make_source
+    );
+#endif
+
     /**
      * @brief Push a frame into the manager for a specific stream.
      *
      * Workflow:
      * - If manual push hook is set, delegate to it.
-     * - Else analyze frame with @ref process_frame (throttled).
-     * - If batch sink is set, deliver whole batch.
+     * - Else analyze frame with @ref process_frame (throttled) into an
+     *   @ref event_batch reused by the calling thread.
+     * - If the compact sink is set, deliver the batch as is.
+     * - Else if batch sink is set, deliver whole batch as events.
      * - Else if single-event sink is set, deliver events one-by-one.
      *
      * @param stream_name Stream name.
@@ -283,15 +383,29 @@ public:
     /**
      * @brief Set the frame processor.
      *
+     * Returned events are converted to the compact form.
+     *
      * @param fn Analysis functor (may be empty to unset).
      */
     void set_frame_processor(frame_processor_fn fn);
 
+    /**
+     * @brief Set a frame processor producing compact events.
+     *
+     * Replaces any processor set by @ref set_frame_processor.
+     *
+     * @param fn Analysis functor (may be empty to unset).
+     */
+    void set_batch_processor(batch_processor_fn fn);
+
     /**
      * @brief Analyze a frame and return generated events.
      *
      * Analysis is throttled per stream by @ref analysis_interval_ms.
      * If the stream does not exist or processor is not set, returns empty list.
+     * Analyzed frames with a capture timestamp update @ref latency, and
+     * returned tripwire events are counted in @ref crossings and frame
+     * activity accumulated in @ref heatmap.
      *
      * @param stream_name Stream name.
      * @param f Frame to analyze (moved into function; read-only for processor).
@@ -299,6 +413,84 @@ public:
      */
     std::vector<event> process_frame(const std::string& stream_name, frame&& f);
 
+    /**
+     * @brief Analyze a frame, appending compact events to @p out.
+     *
+     * Same as the other overload, without converting events.
+     *
+     * @param stream_name Stream name.
+     * @param f Frame to analyze.
+     * @param out Batch to append produced events to.
+     */
+    void process_frame(
+        const std::string& stream_name, frame&& f, event_batch& out
+    );
+
+    /**
+     * @brief Check whether a frame pushed now would be consumed.
+     *
+     * A frame is wanted if a manual push hook is installed (it receives
+     * every frame), or if a frame processor is set and the per-stream
+     * analysis interval has elapsed. Unlike @ref process_frame this does not
+     * update the throttle state.
+     *
+     * @param stream_name Stream name.
+     * @return true if the next pushed frame would be processed.
+     */
+    bool wants_frame(const std::string& stream_name) const;
+
+    /**
+     * @brief Glass-to-event latency statistics of a stream.
+     *
+     * @param stream_name Stream name.
+     * @return Statistics; all zero if no frame was measured yet.
+     */
+    latency_stats latency(const std::string& stream_name) const;
+
+    /**
+     * @brief Tripwire crossing counts per line.
+     *
+     * Every tripwire event returned by the frame processor is counted in
+     * @ref process_frame; this only reads the counters.
+     *
+     * @param stream_name Only this stream; all streams if empty.
+     * @return One row per (stream, line) with at least one crossing.
+     */
+    std::vector<crossing_counters::row>
+    crossings(const std::string& stream_name = {}) const;
+
+    /**
+     * @brief Long-term motion heatmap of a stream.
+     *
+     * The activity of every frame the processor analyzed (see
+     * @ref event_batch::add_activity) is added to its stream's
+     * @ref motion_heatmap in @ref process_frame, regardless of the events
+     * produced. For processors that report no frame activity, their motion
+     * grid events are added instead.
+     *
+     * @param stream_name Stream name.
+     * @return Copy of the map; empty if the stream had no motion yet.
+     */
+    motion_heatmap heatmap(const std::string& stream_name) const;
+
+    /**
+     * @brief Set how fast heatmaps forget old motion (default: one hour
+     * half-life); applies to existing maps too.
+     *
+     * @param half_life Half-life; zero or negative disables decay.
+     */
+    void set_heatmap_half_life(std::chrono::steady_clock::duration half_life);
+
+    /** @brief Current heatmap half-life. */
+    std::chrono::steady_clock::duration get_heatmap_half_life() const;
+
+    /**
+     * @brief Forget the heatmap of a stream.
+     *
+     * @param stream_name Stream name.
+     */
+    void clear_heatmap(const std::string& stream_name);
+
     /**
      * @brief Set per-event sink.
      *
@@ -317,6 +509,33 @@ public:
      */
     void set_event_batch_sink(event_batch_sink_fn fn);
 
+    /**
+     * @brief Set compact batch sink.
+     *
+     * When set, overrides both other sinks.
+     *
+     * @param fn Sink functor (may be empty to unset).
+     */
+    void set_compact_sink(compact_sink_fn fn);
+
+    /**
+     * @brief Set the global budget of events delivered to the sinks.
+     *
+     * One token bucket shared by all streams caps the event volume under
+     * event storms (e.g. a lighting change triggering every line at once);
+     * events beyond it are dropped before delivery, in arrival order. Off
+     * by default.
+     *
+     * @param rule Token bucket; an unlimited rule disables the budget.
+     */
+    void set_event_budget(const rate_rule& rule);
+
+    /** @brief Current global event budget. */
+    rate_rule get_event_budget() const;
+
+    /** @brief Number of events dropped by the global budget. */
+    std::uint64_t dropped_events() const;
+
     /**
      * @brief Set minimum analysis interval per stream, in milliseconds.
      *
@@ -326,25 +545,67 @@ public:
      */
     void set_analysis_interval_ms(int ms);
 
+    /**
+     * @brief Configure content-driven analysis sampling.
+     *
+     * When enabled, the motion position of every analyzed frame (see
+     * @ref event_batch::set_activity_pos), independent of the motion rate
+     * limit, drives a per-stream @ref adaptive_sampler, and each stream
+     * is throttled by the interval it plans instead of the fixed
+     * @ref analysis_interval_ms: shorter while motion approaches one of
+     * its lines, longer while the scene is quiet. Off by default.
+     *
+     * @param cfg Sampling parameters.
+     */
+    void set_sampling(const sampling_config& cfg);
+
+    /** @brief Current sampling parameters. */
+    sampling_config get_sampling() const;
+
+    /**
+     * @brief Interval currently throttling analysis of a stream.
+     *
+     * @param stream_name Stream name.
+     * @return The planned interval with adaptive sampling, otherwise the
+     * fixed one.
+     */
+    std::chrono::milliseconds analysis_interval(const std::string& stream_name
+    ) const;
+
     /**
      * @brief Start a stream daemon by name.
      *
      * Requirements:
-     * - @ref daemon_start hook must be set,
+     * - @ref daemon_start hook or a capture engine must be set,
      * - stream must exist,
-     * - daemon for this stream must not already be running.
-     *
-     * On Linux, local capture devices may be validated again before starting.
+     * - the stream must not already be running.
+     *
+     * On Linux, local capture devices may be validated again before starting,
+     * and streams the capture engine can open are served by it instead of a
+     * daemon thread (see @ref set_capture_engine).
+     *
+     * Streams with the same @ref stream::get_path share one capture: if the
+     * source is already captured for another stream, this stream only
+     * subscribes to its frames. The capture keeps the settings of the stream
+     * that opened it, and its negotiated format is reported to every
+     * subscriber. A stream requesting a different capture format cannot
+     * subscribe (streams without a requested format take whatever the
+     * capture runs with). Each frame is decoded once and fanned out to every
+     * subscriber with its pixels in a shared buffer (see @ref frame::share);
+     * demand and analysis throttling stay per stream.
      *
      * @param name Stream name.
+     * @throws std::runtime_error if the stream's source is already captured
+     * with a different requested format.
      */
     void start_stream(const std::string& name);
 
     /**
      * @brief Stop a running stream daemon by name.
      *
-     * Requests stop on the associated @ref std::jthread and deactivates the
-     * stream (sets pipeline to @ref stream_pipeline::none).
+     * Unsubscribes the stream from its capture and deactivates it (sets
+     * pipeline to @ref stream_pipeline::none). The capture itself is stopped
+     * once no stream uses it anymore.
      *
      * @param name Stream name.
      */
@@ -380,7 +641,9 @@ public:
      *
      * Since lines are stored as immutable shared pointers, this method clones
      * the line, changes @ref line::dir, and replaces the pointer in the
-     * registry.
+     * registry and in every stream the line is connected to (see
+     * @ref stream::replace_line), so that running analysis picks up the
+     * change with its next frame.
      *
      * @param line_name Name of the line to reconfigure.
      * @param dir New direction constraint.
@@ -407,11 +670,54 @@ private:
      * @param fp Out: frame processor.
      * @param es Out: per-event sink.
      * @param bes Out: batch sink.
+     * @param cs Out: compact batch sink.
      */
     void snapshot_hooks(
-        frame_processor_fn& fp, event_sink_fn& es, event_batch_sink_fn& bes
+        batch_processor_fn& fp, event_sink_fn& es, event_batch_sink_fn& bes,
+        compact_sink_fn& cs
     ) const;
 
+    /**
+     * @brief Interval throttling analysis of @p stream_name; needs
+     * @ref mtx.
+     */
+    std::chrono::steady_clock::duration
+    interval_locked(const std::string& stream_name) const;
+
+    /**
+     * @brief Feed the motion of an analyzed frame to the stream's sampler
+     * and plan its next interval; needs @ref mtx.
+     *
+     * Motion positions come from @p activity; processors that report no
+     * frame activity are followed through their motion events instead.
+     *
+     * @param s Analyzed stream.
+     * @param events Events of the frame.
+     * @param first Index of the frame's first event in @p events.
+     * @param activity Activity records of the frame.
+     * @param now Analysis end time.
+     */
+    void update_sampler_locked(
+        const stream& s, const event_batch& events, std::size_t first,
+        std::span<const frame_activity> activity,
+        std::chrono::steady_clock::time_point now
+    );
+
+    /**
+     * @brief Remove the events exceeding the global event budget.
+     *
+     * @param events In/out: events about to be delivered.
+     */
+    void apply_event_budget(event_batch& events);
+
+    /**
+     * @brief Deliver @p events to the preferred installed sink.
+     */
+    static void deliver(
+        const event_batch& events, const event_sink_fn& es,
+        const event_batch_sink_fn& bes, const compact_sink_fn& cs
+    );
+
     /**
      * @brief Get current fake-event interval.
      *
@@ -442,6 +748,24 @@ private:
     static bool is_linux_capture_ok(const stream& s);
 #endif
 
+    struct shared_capture;
+
+    /**
+     * @brief Deliver a captured frame to every subscriber of @p c.
+     */
+    void fan_out(const shared_capture& c, frame&& f);
+
+    /**
+     * @brief Whether any subscriber of @p c wants the next frame.
+     */
+    bool any_wants_frame(const shared_capture& c) const;
+
+    /**
+     * @brief Unregister a capture that could not be started; its
+     * subscribers are deactivated. Requires @ref mtx held.
+     */
+    void drop_capture_locked(const std::shared_ptr<shared_capture>& c);
+
     /** @brief Registered streams keyed by name. */
     std::unordered_map<std::string, std::shared_ptr<stream>> streams;
 
@@ -464,7 +788,7 @@ private:
     daemon_start_fn daemon_start;
 
     /** @brief Optional frame analysis hook. */
-    frame_processor_fn frame_processor;
+    batch_processor_fn frame_processor;
 
     /** @brief Optional per-event sink. */
     event_sink_fn event_sink;
@@ -472,19 +796,64 @@ private:
     /** @brief Optional batch event sink. */
     event_batch_sink_fn event_batch_sink;
 
+    /** @brief Optional compact batch sink. */
+    compact_sink_fn compact_sink;
+
+    /** @brief Global budget of delivered events. */
+    rate_rule event_budget {};
+
+    /** @brief State of @ref event_budget. */
+    token_bucket event_budget_state;
+
+    /** @brief Events dropped by @ref event_budget. */
+    std::uint64_t budget_dropped { 0 };
+
     /** @brief Per-stream analysis throttle interval. */
     int analysis_interval_ms { 200 };
 
     /**
      * @brief Last analysis time per stream.
      *
-     * Used to enforce @ref analysis_interval_ms.
+     * Used to enforce @ref analysis_interval_ms (or the interval planned by
+     * @ref sampler_by_stream).
      */
     std::unordered_map<std::string, std::chrono::steady_clock::time_point>
         last_analysis_ts;
 
-    /** @brief Running daemon threads keyed by stream name. */
-    std::unordered_map<std::string, std::jthread> daemons;
+    /** @brief Content-driven sampling parameters. */
+    sampling_config sampling {};
+
+    /** @brief Motion tracker per stream, used when @ref sampling is on. */
+    std::unordered_map<std::string, adaptive_sampler> sampler_by_stream;
+
+    /** @brief Glass-to-event latency per stream. */
+    std::unordered_map<std::string, latency_stats> latency_by_stream;
+
+    /** @brief Tripwire crossing counters per stream and line. */
+    crossing_counters crossing_counts;
+
+    /** @brief Half-life of new and existing heatmaps. */
+    std::chrono::steady_clock::duration heatmap_half_life {
+        std::chrono::hours(1)
+    };
+
+    /** @brief Motion heatmap per stream. */
+    std::unordered_map<std::string, motion_heatmap> heatmap_by_stream;
+
+    /** @brief Running captures keyed by source path. */
+    std::unordered_map<std::string, std::shared_ptr<shared_capture>>
+        captures;
+
+    /** @brief Source path of each running stream. */
+    std::unordered_map<std::string, std::string> running;
+
+#ifdef __linux__
+    /** @brief Engine serving newly started streams, if any. */
+    std::shared_ptr<capture_engine> engine;
+
+    /** @brief Source factory of @ref engine. */
+    capture_source_fn engine_source;
+#endif
 
     /** @brief Fake-event generator thread. */
     std::jthread fake_thread;
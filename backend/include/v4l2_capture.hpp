@@ -0,0 +1,233 @@
+#ifndef YODAU_BACKEND_V4L2_CAPTURE_HPP
+#define YODAU_BACKEND_V4L2_CAPTURE_HPP
+
+#ifdef __linux__
+
+#include "frame.hpp"
+#include "stream.hpp"
+
+#include <poll.h>
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace yodau::backend {
+
+/**
+ * @brief System call layer used by @ref v4l2_capture.
+ *
+ * The default implementation (@ref system_v4l2_io) forwards to the libc
+ * functions of the same name. Tests substitute a fake device to exercise the
+ * capture state machine without a camera.
+ */
+class v4l2_io {
+public:
+    virtual ~v4l2_io() = default;
+
+    /** @brief See open(2). */
+    virtual int open(const char* path, int flags) = 0;
+
+    /** @brief See close(2). */
+    virtual int close(int fd) = 0;
+
+    /** @brief See ioctl(2); failures return -1 and set errno. */
+    virtual int ioctl(int fd, unsigned long request, void* arg) = 0;
+
+    /** @brief See mmap(2). */
+    virtual void*
+    mmap(void* addr, std::size_t len, int prot, int flags, int fd, off_t off)
+        = 0;
+
+    /** @brief See munmap(2). */
+    virtual int munmap(void* addr, std::size_t len) = 0;
+
+    /** @brief See poll(2). */
+    virtual int poll(pollfd* fds, nfds_t nfds, int timeout_ms) = 0;
+};
+
+/**
+ * @brief Process-wide libc-backed @ref v4l2_io.
+ */
+std::shared_ptr<v4l2_io> system_v4l2_io();
+
+/**
+ * @brief Zero-copy V4L2 streaming capture (memory-mapped buffers).
+ *
+ * Opening negotiates a pixel format, requests a ring of driver buffers
+ * (@c VIDIOC_REQBUFS), maps them and starts streaming. Each @ref read
+ * waits with poll(2), dequeues a filled buffer (@c VIDIOC_DQBUF) and
+ * returns it as a @ref frame whose @ref frame::external points straight into
+ * the mapping. When the last copy of that frame is destroyed the buffer is
+ * queued back to the driver (@c VIDIOC_QBUF).
+ *
+ * Only formats the analysis path understands without conversion are
+ * accepted: packed YUYV and 8-bit grey. Other formats make @ref open fail so
+ * that callers can fall back to a generic backend.
+ *
+ * Mappings stay valid until the last outstanding frame is released, even if
+ * the capture is closed or destroyed earlier.
+ */
+class v4l2_capture {
+public:
+    /**
+     * @brief Requested capture parameters.
+     */
+    struct config {
+        /** @brief Width in pixels; 0 keeps the device's current width. */
+        int width { 0 };
+
+        /** @brief Height in pixels; 0 keeps the device's current height. */
+        int height { 0 };
+
+        /** @brief Frame rate; 0 keeps the device's current rate. */
+        double fps { 0.0 };
+
+        /** @brief V4L2 fourcc; 0 selects YUYV. */
+        std::uint32_t fourcc { 0 };
+
+        /** @brief Number of driver buffers to request. */
+        unsigned buffers { 4 };
+
+        /**
+         * @brief Config requesting a stream's @ref capture_format.
+         *
+         * @param fmt Requested format; unset fields keep the defaults.
+         */
+        static config for_format(const capture_format& fmt);
+    };
+
+    /**
+     * @brief Outcome of @ref read / @ref drop.
+     */
+    enum class read_result {
+        /** A buffer was dequeued. */
+        ok,
+        /** No buffer became ready in time. */
+        timeout,
+        /** The device failed (e.g. it was unplugged); stop reading. */
+        error
+    };
+
+    /**
+     * @brief Construct an unopened capture.
+     *
+     * @param io System call layer (defaults to libc).
+     */
+    explicit v4l2_capture(std::shared_ptr<v4l2_io> io = system_v4l2_io());
+
+    /**
+     * @brief Stop streaming (see @ref close).
+     */
+    ~v4l2_capture();
+
+    v4l2_capture(const v4l2_capture&) = delete;
+    v4l2_capture& operator=(const v4l2_capture&) = delete;
+
+    /**
+     * @brief Open a device, negotiate the format and start streaming.
+     *
+     * @param path Device path, e.g. "/dev/video0".
+     * @param cfg Requested parameters.
+     * @return true on success; on failure the device is closed again.
+     */
+    bool open(const std::string& path, const config& cfg);
+
+    /**
+     * @brief Stop streaming and drop the device.
+     *
+     * Outstanding frames stay readable; their buffers are unmapped once they
+     * are released.
+     */
+    void close();
+
+    /** @brief Whether the capture is streaming. */
+    bool is_open() const;
+
+    /**
+     * @brief Wait for the next buffer and wrap it as a zero-copy frame.
+     *
+     * @param out Receives the frame on @ref read_result::ok.
+     * @param timeout_ms Poll timeout in milliseconds.
+     * @return Read outcome.
+     */
+    read_result read(frame& out, int timeout_ms);
+
+    /**
+     * @brief Wait for the next buffer and hand it straight back.
+     *
+     * Used for frames nobody will consume.
+     *
+     * @param timeout_ms Poll timeout in milliseconds.
+     * @return Read outcome.
+     */
+    read_result drop(int timeout_ms);
+
+    /** @brief Negotiated width in pixels. */
+    int width() const;
+
+    /** @brief Negotiated height in pixels. */
+    int height() const;
+
+    /** @brief Negotiated row stride in bytes. */
+    int stride() const;
+
+    /** @brief Negotiated V4L2 fourcc. */
+    std::uint32_t fourcc() const;
+
+    /** @brief Negotiated frame rate, 0 if the driver does not report it. */
+    double fps() const;
+
+    /** @brief Negotiated size, rate and fourcc as a @ref capture_format. */
+    capture_format negotiated() const;
+
+    /**
+     * @brief Device descriptor, -1 if closed.
+     *
+     * Readable when a filled buffer can be dequeued; lets callers wait on
+     * many devices at once and then @ref read with a zero timeout.
+     */
+    int fd() const;
+
+private:
+    struct device;
+
+    /**
+     * @brief Poll and dequeue one buffer.
+     *
+     * @param index Receives the buffer index.
+     * @param bytes Receives the number of used bytes.
+     */
+    read_result dequeue(int timeout_ms, unsigned& index, std::size_t& bytes);
+
+    /** @brief System call layer. */
+    std::shared_ptr<v4l2_io> io;
+
+    /** @brief Open device; shared with outstanding frames. */
+    std::shared_ptr<device> dev;
+
+    /** @brief Negotiated width. */
+    int w { 0 };
+
+    /** @brief Negotiated height. */
+    int h { 0 };
+
+    /** @brief Negotiated stride. */
+    int bpl { 0 };
+
+    /** @brief Negotiated fourcc. */
+    std::uint32_t pixfmt { 0 };
+
+    /** @brief Negotiated frame rate. */
+    double rate { 0.0 };
+
+    /** @brief Frame format matching @ref pixfmt. */
+    pixel_format format { pixel_format::yuyv422 };
+};
+
+} // namespace yodau::backend
+
+#endif // __linux__
+#endif // YODAU_BACKEND_V4L2_CAPTURE_HPP
@@ -0,0 +1,105 @@
+#include "activity_grid.hpp"
+
+namespace {
+std::uint32_t count_nonzero_span(const std::uint8_t* p, const int n) {
+    std::uint32_t count = 0;
+    for (int i = 0; i < n; ++i) {
+        count += p[i] != 0 ? 1u : 0u;
+    }
+    return count;
+}
+
+// shared cell walk; count_row(y, x0, x1) returns the number of changed
+// pixels of row y in [x0; x1)
+template <class CountRow>
+yodau::backend::activity_grid
+build_grid(const int width, const int height, CountRow&& count_row) {
+    yodau::backend::activity_grid out;
+
+    constexpr int cols = yodau::backend::activity_grid::cols;
+    constexpr int rows = yodau::backend::activity_grid::rows;
+
+    std::array<int, cols + 1> x_edges {};
+    for (int i = 0; i <= cols; ++i) {
+        x_edges[static_cast<size_t>(i)] = i * width / cols;
+    }
+
+    std::array<std::uint32_t, cols> counts {};
+
+    for (int cy = 0; cy < rows; ++cy) {
+        const int y0 = cy * height / rows;
+        const int y1 = (cy + 1) * height / rows;
+
+        counts.fill(0);
+        for (int y = y0; y < y1; ++y) {
+            for (size_t cx = 0; cx < cols; ++cx) {
+                counts[cx] += count_row(y, x_edges[cx], x_edges[cx + 1]);
+            }
+        }
+
+        for (size_t cx = 0; cx < cols; ++cx) {
+            const auto area = static_cast<std::uint32_t>(
+                (y1 - y0) * (x_edges[cx + 1] - x_edges[cx])
+            );
+            if (area == 0) {
+                continue;
+            }
+            const std::uint32_t level = (counts[cx] * 255u + area / 2) / area;
+            out.cells[static_cast<size_t>(cy * cols) + cx]
+                = static_cast<std::uint8_t>(level > 255u ? 255u : level);
+        }
+    }
+
+    return out;
+}
+}
+
+std::uint8_t
+yodau::backend::activity_grid::at(const int cx, const int cy) const {
+    if (cx < 0 || cx >= cols || cy < 0 || cy >= rows) {
+        return 0;
+    }
+    return cells[static_cast<size_t>(cy * cols + cx)];
+}
+
+int yodau::backend::activity_grid::active_cells(
+    const std::uint8_t min_level
+) const {
+    int n = 0;
+    for (const auto c : cells) {
+        if (c >= min_level) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+yodau::backend::activity_grid yodau::backend::compute_activity_grid(
+    const std::uint8_t* mask, const int width, const int height,
+    const std::size_t stride
+) {
+    if (!mask || width <= 0 || height <= 0) {
+        return {};
+    }
+
+    return build_grid(
+        width, height, [&](const int y, const int x0, const int x1) {
+            const std::uint8_t* row = mask + static_cast<size_t>(y) * stride;
+            return count_nonzero_span(row + x0, x1 - x0);
+        }
+    );
+}
+
+yodau::backend::activity_grid
+yodau::backend::compute_activity_grid(const bit_mask& mask) {
+    if (mask.empty()) {
+        return {};
+    }
+
+    return build_grid(
+        mask.width(), mask.height(),
+        [&](const int y, const int x0, const int x1) {
+            return static_cast<std::uint32_t>(mask.count_span(y, x0, x1));
+        }
+    );
+}
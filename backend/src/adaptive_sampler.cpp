@@ -0,0 +1,110 @@
+#include "adaptive_sampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+// seconds in a duration, as float
+float seconds(const std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<float>(d).count();
+}
+
+// point of segment a-b nearest to p
+yodau::backend::point nearest_on_segment(
+    const yodau::backend::point& p, const yodau::backend::point& a,
+    const yodau::backend::point& b
+) {
+    const float dx = b.x - a.x;
+    const float dy = b.y - a.y;
+    const float len2 = dx * dx + dy * dy;
+    if (len2 <= 0.0f) {
+        return a;
+    }
+    const float t = std::clamp(
+        ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2, 0.0f, 1.0f
+    );
+    return { a.x + t * dx, a.y + t * dy };
+}
+} // namespace
+
+void yodau::backend::adaptive_sampler::observe(
+    const point p, const clock::time_point ts, const sampling_config& cfg
+) {
+    if (seen && ts > last && ts - last <= cfg.quiet) {
+        const float dt = seconds(ts - last);
+        const point v { (p.x - pos.x) / dt, (p.y - pos.y) / dt };
+        vel = moving ? point { (vel.x + v.x) * 0.5f, (vel.y + v.y) * 0.5f }
+                     : v;
+        moving = true;
+    } else if (!seen || ts > last) {
+        // first sighting or after a quiet gap: the velocity is unknown
+        vel = {};
+        moving = false;
+    }
+    pos = p;
+    last = std::max(last, ts);
+    seen = true;
+}
+
+yodau::backend::adaptive_sampler::clock::duration
+yodau::backend::adaptive_sampler::plan(
+    const line_set& lines, const sampling_config& cfg,
+    const clock::duration base, const clock::time_point now
+) const {
+    if (!seen || now - last > cfg.quiet) {
+        return std::max<clock::duration>(base, cfg.idle_interval);
+    }
+    if (lines.empty()) {
+        return base;
+    }
+    if (!moving) {
+        // fresh motion: look again soon to measure its velocity
+        return std::min<clock::duration>(base, 2 * cfg.min_interval);
+    }
+
+    const float speed = std::sqrt(vel.x * vel.x + vel.y * vel.y);
+    const float horizon = seconds(cfg.lookahead);
+    const float reach = cfg.near_pct + speed * horizon;
+    const bbox area { pos.x - reach, pos.y - reach, pos.x + reach,
+                      pos.y + reach };
+
+    thread_local std::vector<std::uint32_t> near;
+    lines.query(area, near);
+
+    clock::duration best = base;
+    for (const auto s : near) {
+        const auto q = nearest_on_segment(
+            pos, lines.segment_a(s), lines.segment_b(s)
+        );
+        const float dist = pos.distance_to(q);
+        if (dist <= cfg.near_pct) {
+            return cfg.min_interval;
+        }
+        // speed towards the line; motion along or away from it is ignored
+        const float closing
+            = (vel.x * (q.x - pos.x) + vel.y * (q.y - pos.y)) / dist;
+        if (closing <= 0.0f) {
+            continue;
+        }
+        const float eta = (dist - cfg.near_pct) / closing;
+        if (eta > horizon) {
+            continue;
+        }
+        // about two analyses before the motion reaches the line
+        const auto half = std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<float>(eta * 0.5f)
+        );
+        best = std::min(
+            best, std::max<clock::duration>(half, cfg.min_interval)
+        );
+    }
+    return best;
+}
+
+void yodau::backend::adaptive_sampler::update(
+    const line_set& lines, const sampling_config& cfg,
+    const clock::duration base, const clock::time_point now
+) {
+    next = plan(lines, cfg, base, now);
+}
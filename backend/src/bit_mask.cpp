@@ -0,0 +1,356 @@
+#include "bit_mask.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+constexpr int word_bits = 64;
+
+// eight mask bytes to eight bits (byte i -> bit i) without branches: set
+// the high bit of every non-zero byte, then gather the high bits with a
+// multiply
+std::uint64_t pack_bytes(const std::uint8_t* p) {
+    if constexpr (std::endian::native == std::endian::little) {
+        constexpr std::uint64_t low7 = 0x7f7f7f7f7f7f7f7fULL;
+        constexpr std::uint64_t high = 0x8080808080808080ULL;
+        constexpr std::uint64_t gather = 0x0102040810204080ULL;
+
+        std::uint64_t x = 0;
+        std::memcpy(&x, p, sizeof(x));
+        const std::uint64_t t = (((x & low7) + low7) | x) & high;
+        return ((t >> 7) * gather) >> 56;
+    } else {
+        std::uint64_t v = 0;
+        for (int b = 0; b < 8; ++b) {
+            v |= static_cast<std::uint64_t>(p[b] != 0) << b;
+        }
+        return v;
+    }
+}
+
+int find_root(std::vector<int>& parent, int i) {
+    while (parent[static_cast<size_t>(i)] != i) {
+        auto& p = parent[static_cast<size_t>(i)];
+        p = parent[static_cast<size_t>(p)];
+        i = p;
+    }
+    return i;
+}
+
+void unite(std::vector<int>& parent, const int a, const int b) {
+    const int ra = find_root(parent, a);
+    const int rb = find_root(parent, b);
+    if (ra < rb) {
+        parent[static_cast<size_t>(rb)] = ra;
+    } else if (rb < ra) {
+        parent[static_cast<size_t>(ra)] = rb;
+    }
+}
+
+// one 3x3 pass: horizontal neighbours via word shifts with carries, then
+// vertical neighbours by combining three rows; pixels beyond the image count
+// as set for erosion and as unset for dilation
+yodau::backend::bit_mask
+morph_pass(const yodau::backend::bit_mask& src, const bool erode) {
+    const int w = src.width();
+    const int h = src.height();
+    const int n = src.words_per_row();
+    const std::uint64_t tail = src.tail_mask();
+    const std::uint64_t outside = erode ? ~std::uint64_t { 0 } : 0;
+
+    yodau::backend::bit_mask horiz(w, h);
+    for (int y = 0; y < h; ++y) {
+        const std::uint64_t* s = src.row(y);
+        std::uint64_t* d = horiz.row(y);
+        for (int i = 0; i < n; ++i) {
+            const bool last = i == n - 1;
+            const std::uint64_t pad = last ? (~tail & outside) : 0;
+            const std::uint64_t cur = s[i] | pad;
+            const std::uint64_t prev_hi
+                = i == 0 ? (outside & 1u) : s[i - 1] >> 63;
+            const std::uint64_t next_lo
+                = last ? (outside & 1u) : s[i + 1] & 1u;
+            const std::uint64_t left = (cur << 1) | prev_hi;
+            const std::uint64_t right = (cur >> 1) | (next_lo << 63);
+            const std::uint64_t v
+                = erode ? (cur & left & right) : (cur | left | right);
+            d[i] = last ? (v & tail) : v;
+        }
+    }
+
+    yodau::backend::bit_mask out(w, h);
+    for (int y = 0; y < h; ++y) {
+        const std::uint64_t* up = y > 0 ? horiz.row(y - 1) : nullptr;
+        const std::uint64_t* mid = horiz.row(y);
+        const std::uint64_t* down = y + 1 < h ? horiz.row(y + 1) : nullptr;
+        std::uint64_t* d = out.row(y);
+        for (int i = 0; i < n; ++i) {
+            const std::uint64_t a = up ? up[i] : outside;
+            const std::uint64_t c = down ? down[i] : outside;
+            d[i] = erode ? (a & mid[i] & c) : (a | mid[i] | c);
+        }
+        d[n - 1] &= tail;
+    }
+
+    return out;
+}
+
+yodau::backend::bit_mask morph(
+    const yodau::backend::bit_mask& src, const int iterations, const bool erode
+) {
+    if (src.empty() || iterations <= 0) {
+        return src;
+    }
+    auto out = morph_pass(src, erode);
+    for (int it = 1; it < iterations; ++it) {
+        out = morph_pass(out, erode);
+    }
+    return out;
+}
+}
+
+yodau::backend::bit_mask::bit_mask(const int width, const int height)
+    : w(std::max(width, 0))
+    , h(std::max(height, 0))
+    , wpr((w + word_bits - 1) / word_bits)
+    , words(static_cast<size_t>(wpr) * static_cast<size_t>(h), 0) {
+    if (w == 0 || h == 0) {
+        w = 0;
+        h = 0;
+        wpr = 0;
+        words.clear();
+    }
+}
+
+yodau::backend::bit_mask yodau::backend::bit_mask::from_bytes(
+    const std::uint8_t* data, const int width, const int height,
+    const std::size_t stride
+) {
+    bit_mask out(width, height);
+    if (!data || out.empty()) {
+        return out;
+    }
+
+    for (int y = 0; y < out.h; ++y) {
+        const std::uint8_t* src = data + static_cast<size_t>(y) * stride;
+        std::uint64_t* dst = out.row(y);
+        const int full = out.w / word_bits;
+        for (int i = 0; i < full; ++i) {
+            const std::uint8_t* p = src + i * word_bits;
+            std::uint64_t v = 0;
+            for (int b = 0; b < word_bits; b += 8) {
+                v |= pack_bytes(p + b) << b;
+            }
+            dst[i] = v;
+        }
+        if (full < out.wpr) {
+            const std::uint8_t* p = src + full * word_bits;
+            std::uint64_t v = 0;
+            for (int b = 0; b < out.w - full * word_bits; ++b) {
+                v |= static_cast<std::uint64_t>(p[b] != 0) << b;
+            }
+            dst[full] = v;
+        }
+    }
+
+    return out;
+}
+
+void yodau::backend::bit_mask::to_bytes(
+    std::uint8_t* dst, const std::size_t stride
+) const {
+    if (!dst) {
+        return;
+    }
+
+    for (int y = 0; y < h; ++y) {
+        const std::uint64_t* src = row(y);
+        std::uint8_t* d = dst + static_cast<size_t>(y) * stride;
+        for (int x = 0; x < w; ++x) {
+            const auto bit = (src[x / word_bits] >> (x % word_bits)) & 1u;
+            d[x] = bit ? 255 : 0;
+        }
+    }
+}
+
+int yodau::backend::bit_mask::width() const { return w; }
+
+int yodau::backend::bit_mask::height() const { return h; }
+
+int yodau::backend::bit_mask::words_per_row() const { return wpr; }
+
+bool yodau::backend::bit_mask::empty() const { return w == 0 || h == 0; }
+
+std::uint64_t* yodau::backend::bit_mask::row(const int y) {
+    return words.data() + static_cast<size_t>(y) * static_cast<size_t>(wpr);
+}
+
+const std::uint64_t* yodau::backend::bit_mask::row(const int y) const {
+    return words.data() + static_cast<size_t>(y) * static_cast<size_t>(wpr);
+}
+
+bool yodau::backend::bit_mask::test(const int x, const int y) const {
+    if (x < 0 || x >= w || y < 0 || y >= h) {
+        return false;
+    }
+    return ((row(y)[x / word_bits] >> (x % word_bits)) & 1u) != 0;
+}
+
+void yodau::backend::bit_mask::set(const int x, const int y, const bool value) {
+    if (x < 0 || x >= w || y < 0 || y >= h) {
+        return;
+    }
+    const std::uint64_t bit = std::uint64_t { 1 } << (x % word_bits);
+    auto& word = row(y)[x / word_bits];
+    word = value ? (word | bit) : (word & ~bit);
+}
+
+long long yodau::backend::bit_mask::count() const {
+    long long n = 0;
+    for (const auto v : words) {
+        n += std::popcount(v);
+    }
+    return n;
+}
+
+long long yodau::backend::bit_mask::count_span(
+    const int y, const int x0, const int x1
+) const {
+    const int a = std::max(x0, 0);
+    const int b = std::min(x1, w);
+    if (y < 0 || y >= h || a >= b) {
+        return 0;
+    }
+
+    const std::uint64_t* r = row(y);
+    const int first = a / word_bits;
+    const int last = (b - 1) / word_bits;
+    const std::uint64_t head = ~std::uint64_t { 0 } << (a % word_bits);
+    const int tail_bits = b - last * word_bits;
+    const std::uint64_t tail = tail_bits == word_bits
+        ? ~std::uint64_t { 0 }
+        : (std::uint64_t { 1 } << tail_bits) - 1;
+
+    if (first == last) {
+        return std::popcount(r[first] & head & tail);
+    }
+
+    long long n = std::popcount(r[first] & head);
+    for (int i = first + 1; i < last; ++i) {
+        n += std::popcount(r[i]);
+    }
+    n += std::popcount(r[last] & tail);
+    return n;
+}
+
+std::uint64_t yodau::backend::bit_mask::tail_mask() const {
+    const int bits = w % word_bits;
+    return bits == 0 ? ~std::uint64_t { 0 }
+                     : (std::uint64_t { 1 } << bits) - 1;
+}
+
+yodau::backend::bit_mask
+yodau::backend::erode(const bit_mask& src, const int iterations) {
+    return morph(src, iterations, true);
+}
+
+yodau::backend::bit_mask
+yodau::backend::dilate(const bit_mask& src, const int iterations) {
+    return morph(src, iterations, false);
+}
+
+int yodau::backend::bit_labels::largest() const {
+    int best = -1;
+    long long best_area = 0;
+    for (size_t i = 0; i < components.size(); ++i) {
+        if (components[i].area > best_area) {
+            best_area = components[i].area;
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
+
+yodau::backend::bit_labels
+yodau::backend::label_components(const bit_mask& mask) {
+    bit_labels out;
+    if (mask.empty()) {
+        return out;
+    }
+
+    auto& runs = out.runs;
+    std::vector<int> parent;
+
+    size_t prev_begin = 0;
+    size_t prev_end = 0;
+
+    for (int y = 0; y < mask.height(); ++y) {
+        const std::uint64_t* r = mask.row(y);
+        const size_t cur_begin = runs.size();
+
+        int run_start = -1;
+        for (int i = 0; i < mask.words_per_row(); ++i) {
+            const std::uint64_t v = r[i];
+            const int base = i * word_bits;
+            int pos = 0;
+            while (pos < word_bits) {
+                if (run_start < 0) {
+                    const std::uint64_t rest = v >> pos;
+                    if (rest == 0) {
+                        break;
+                    }
+                    pos += std::countr_zero(rest);
+                    run_start = base + pos;
+                }
+                const std::uint64_t rest = ~v >> pos;
+                if (rest == 0) {
+                    break;
+                }
+                pos += std::countr_zero(rest);
+                runs.push_back({ y, run_start, base + pos, 0 });
+                run_start = -1;
+            }
+        }
+        if (run_start >= 0) {
+            runs.push_back({ y, run_start, mask.width(), 0 });
+        }
+
+        size_t j = prev_begin;
+        for (size_t k = cur_begin; k < runs.size(); ++k) {
+            const int id = static_cast<int>(k);
+            parent.push_back(id);
+
+            const auto& cur = runs[k];
+            while (j < prev_end && runs[j].x1 < cur.x0) {
+                ++j;
+            }
+            for (size_t p = j; p < prev_end && runs[p].x0 <= cur.x1; ++p) {
+                unite(parent, id, static_cast<int>(p));
+            }
+        }
+
+        prev_begin = cur_begin;
+        prev_end = runs.size();
+    }
+
+    std::vector<int> component_of(runs.size(), -1);
+    for (size_t k = 0; k < runs.size(); ++k) {
+        auto& run = runs[k];
+        const auto root
+            = static_cast<size_t>(find_root(parent, static_cast<int>(k)));
+        if (component_of[root] < 0) {
+            component_of[root] = static_cast<int>(out.components.size());
+            out.components.push_back({ 0, run.x0, run.y, run.x1, run.y + 1 });
+        }
+        run.label = component_of[root];
+
+        auto& c = out.components[static_cast<size_t>(run.label)];
+        c.area += run.x1 - run.x0;
+        c.x0 = std::min(c.x0, run.x0);
+        c.x1 = std::max(c.x1, run.x1);
+        c.y1 = std::max(c.y1, run.y + 1);
+    }
+
+    return out;
+}
@@ -0,0 +1,842 @@
+#ifdef __linux__
+
+#include "capture_engine.hpp"
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <optional>
+#include <ranges>
+#include <string_view>
+#include <system_error>
+
+namespace {
+// epoll cookie of the wake-up eventfd; source ids start at 1
+constexpr std::uint64_t wake_id = 0;
+
+void wake(const int fd) {
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const auto n = ::write(fd, &one, sizeof(one));
+}
+
+// parts of an "http://[user:password@]host[:port][/target]" URL
+struct http_url {
+    std::string host;
+    std::string port { "80" };
+    std::string target { "/" };
+    std::string credentials;
+};
+
+bool parse_http_url(const std::string& url, http_url& out) {
+    constexpr std::string_view scheme = "http://";
+    if (!url.starts_with(scheme)) {
+        return false;
+    }
+    std::string_view rest(url);
+    rest.remove_prefix(scheme.size());
+
+    const auto slash = rest.find('/');
+    auto authority = rest.substr(0, slash);
+    if (slash != std::string_view::npos) {
+        out.target = std::string(rest.substr(slash));
+    }
+    if (const auto at = authority.rfind('@'); at != std::string_view::npos) {
+        out.credentials = std::string(authority.substr(0, at));
+        authority.remove_prefix(at + 1);
+    }
+
+    // "[v6 address]:port" or "host:port"
+    std::size_t colon = std::string_view::npos;
+    if (authority.starts_with('[')) {
+        const auto close = authority.find(']');
+        if (close == std::string_view::npos) {
+            return false;
+        }
+        out.host = std::string(authority.substr(1, close - 1));
+        if (close + 1 < authority.size()) {
+            if (authority[close + 1] != ':') {
+                return false;
+            }
+            colon = close + 1;
+        }
+    } else {
+        colon = authority.rfind(':');
+        out.host = std::string(authority.substr(0, colon));
+    }
+    if (colon != std::string_view::npos) {
+        out.port = std::string(authority.substr(colon + 1));
+    }
+    return !out.host.empty() && !out.port.empty();
+}
+
+std::string base64(const std::string_view in) {
+    constexpr std::string_view digits
+        = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const auto byte = [&](const std::size_t i) -> std::uint32_t {
+        return i < in.size() ? static_cast<unsigned char>(in[i]) : 0u;
+    };
+    std::string out;
+    for (std::size_t i = 0; i < in.size(); i += 3) {
+        const std::uint32_t v = byte(i) << 16 | byte(i + 1) << 8 | byte(i + 2);
+        out += digits[v >> 18 & 63];
+        out += digits[v >> 12 & 63];
+        out += i + 1 < in.size() ? digits[v >> 6 & 63] : '=';
+        out += i + 2 < in.size() ? digits[v & 63] : '=';
+    }
+    return out;
+}
+
+// non-blocking socket connected to host:port, or -1
+int connect_to(const http_url& url, const std::chrono::milliseconds timeout) {
+    addrinfo hints {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* list = nullptr;
+    if (::getaddrinfo(url.host.c_str(), url.port.c_str(), &hints, &list)
+        != 0) {
+        return -1;
+    }
+
+    int fd = -1;
+    for (const addrinfo* ai = list; ai; ai = ai->ai_next) {
+        fd = ::socket(
+            ai->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+            ai->ai_protocol
+        );
+        if (fd < 0) {
+            continue;
+        }
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            break;
+        }
+        if (errno == EINPROGRESS) {
+            pollfd p { fd, POLLOUT, 0 };
+            int err = 0;
+            socklen_t len = sizeof(err);
+            if (::poll(&p, 1, static_cast<int>(timeout.count())) == 1
+                && ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0
+                && err == 0) {
+                break;
+            }
+        }
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(list);
+    return fd;
+}
+
+// send all of @p data on a non-blocking socket
+bool send_all(
+    const int fd, std::string_view data, const std::chrono::milliseconds timeout
+) {
+    while (!data.empty()) {
+        const auto n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n > 0) {
+            data.remove_prefix(static_cast<std::size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EINTR) {
+            return false;
+        }
+        pollfd p { fd, POLLOUT, 0 };
+        if (::poll(&p, 1, static_cast<int>(timeout.count())) != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string lower(std::string_view text) {
+    std::string out(text);
+    std::ranges::transform(out, out.begin(), [](const unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return out;
+}
+
+// value of header @p name (lowercase) in a header block, or empty
+std::string_view
+header_value(const std::string_view block, const std::string_view name) {
+    std::size_t start = 0;
+    while (start < block.size()) {
+        auto end = block.find("\r\n", start);
+        if (end == std::string_view::npos) {
+            end = block.size();
+        }
+        const auto line = block.substr(start, end - start);
+        const auto colon = line.find(':');
+        if (colon != std::string_view::npos
+            && lower(line.substr(0, colon)) == name) {
+            auto value = line.substr(colon + 1);
+            while (!value.empty()
+                   && (value.front() == ' ' || value.front() == '\t')) {
+                value.remove_prefix(1);
+            }
+            return value;
+        }
+        start = end + 2;
+    }
+    return {};
+}
+
+std::size_t find(
+    const std::vector<std::uint8_t>& buf, const std::string_view what,
+    const std::size_t from
+) {
+    if (from >= buf.size()) {
+        return std::string_view::npos;
+    }
+    const auto it = std::search(
+        buf.begin() + static_cast<std::ptrdiff_t>(from), buf.end(),
+        what.begin(), what.end(),
+        [](const std::uint8_t a, const char b) {
+            return a == static_cast<std::uint8_t>(b);
+        }
+    );
+    return it == buf.end() ? std::string_view::npos
+                           : static_cast<std::size_t>(it - buf.begin());
+}
+
+std::string_view text_at(
+    const std::vector<std::uint8_t>& buf, const std::size_t begin,
+    const std::size_t end
+) {
+    return { reinterpret_cast<const char*>(buf.data()) + begin, end - begin };
+}
+}
+
+struct yodau::backend::capture_engine::entry {
+    /** @brief Epoll cookie. */
+    std::uint64_t id { 0 };
+
+    std::unique_ptr<capture_source> src;
+    std::function<void(frame&&)> on_frame;
+    std::function<bool()> wants_frame;
+
+    /** @brief I/O thread the source is registered with. */
+    io_thread* owner { nullptr };
+
+    /** @brief Set once removed; checked before every callback. */
+    std::atomic<bool> removed { false };
+
+    /** @brief Held while the I/O thread reads the source. */
+    std::mutex io_mtx;
+
+    /** @brief Held while a worker runs @ref on_frame. */
+    std::mutex work_mtx;
+
+    /** @brief Guards @ref pending and @ref queued. */
+    std::mutex slot_mtx;
+
+    /** @brief Newest frame not yet picked up by a worker. */
+    std::optional<frame> pending;
+
+    /** @brief Whether the entry is in the ready queue or being processed. */
+    bool queued { false };
+};
+
+struct yodau::backend::capture_engine::io_thread {
+    io_thread() = default;
+
+    ~io_thread() {
+        if (th.joinable()) {
+            th.request_stop();
+            wake(wake_fd);
+            th.join();
+        }
+        if (wake_fd >= 0) {
+            ::close(wake_fd);
+        }
+        if (epoll_fd >= 0) {
+            ::close(epoll_fd);
+        }
+    }
+
+    io_thread(const io_thread&) = delete;
+    io_thread& operator=(const io_thread&) = delete;
+
+    int epoll_fd { -1 };
+    int wake_fd { -1 };
+
+    /** @brief Registered sources by id; guarded by @ref mtx. */
+    std::unordered_map<std::uint64_t, std::shared_ptr<entry>> by_id;
+    std::mutex mtx;
+
+    std::jthread th;
+};
+
+std::unique_ptr<yodau::backend::capture_source>
+yodau::backend::v4l2_source::open(
+    const stream& s, std::shared_ptr<v4l2_io> io
+) {
+    if (s.get_type() != stream_type::local) {
+        return nullptr;
+    }
+    std::unique_ptr<v4l2_source> src(new v4l2_source(std::move(io)));
+    const auto cfg = v4l2_capture::config::for_format(s.requested_format());
+    if (!src->cap.open(s.get_path(), cfg)) {
+        return nullptr;
+    }
+    s.report_negotiated_format(src->cap.negotiated());
+    return src;
+}
+
+yodau::backend::v4l2_source::v4l2_source(std::shared_ptr<v4l2_io> io)
+    : cap(std::move(io)) { }
+
+int yodau::backend::v4l2_source::fd() const { return cap.fd(); }
+
+yodau::backend::capture_source::read_result
+yodau::backend::v4l2_source::read(frame& out, const bool wanted) {
+    const auto res = wanted ? cap.read(out, 0) : cap.drop(0);
+    if (res == v4l2_capture::read_result::error) {
+        return read_result::end;
+    }
+    if (res == v4l2_capture::read_result::timeout || !wanted) {
+        return read_result::none;
+    }
+    return read_result::frame;
+}
+
+std::unique_ptr<yodau::backend::capture_source>
+yodau::backend::http_mjpeg_source::open(
+    const stream& s, decoder_fn decode
+) {
+    http_url url;
+    if (!decode || !parse_http_url(s.get_path(), url)) {
+        return nullptr;
+    }
+    const int fd = connect_to(url, connect_timeout);
+    if (fd < 0) {
+        return nullptr;
+    }
+    // HTTP/1.0, so that the body is never chunked
+    std::string request = "GET " + url.target + " HTTP/1.0\r\nHost: "
+        + url.host + "\r\nUser-Agent: yodau\r\n";
+    if (!url.credentials.empty()) {
+        request += "Authorization: Basic " + base64(url.credentials) + "\r\n";
+    }
+    request += "\r\n";
+    if (!send_all(fd, request, connect_timeout)) {
+        ::close(fd);
+        return nullptr;
+    }
+    auto src = from_socket(fd, std::move(decode));
+    if (!src->await_response(connect_timeout)) {
+        return nullptr;
+    }
+    s.report_negotiated_format({ 0, 0, 0.0, "MJPG" });
+    return src;
+}
+
+std::unique_ptr<yodau::backend::http_mjpeg_source>
+yodau::backend::http_mjpeg_source::from_socket(
+    const int fd, decoder_fn decode
+) {
+    return std::unique_ptr<http_mjpeg_source>(
+        new http_mjpeg_source(fd, std::move(decode))
+    );
+}
+
+yodau::backend::http_mjpeg_source::http_mjpeg_source(
+    const int fd, decoder_fn decode
+)
+    : sock(fd)
+    , decode(std::move(decode)) { }
+
+yodau::backend::http_mjpeg_source::~http_mjpeg_source() {
+    if (sock >= 0) {
+        ::close(sock);
+    }
+}
+
+int yodau::backend::http_mjpeg_source::fd() const { return sock; }
+
+yodau::backend::capture_source::read_result
+yodau::backend::http_mjpeg_source::read(frame& out, const bool wanted) {
+    // drain what is there in a few large reads; a socket with more input
+    // stays readable and is served again after the other sources
+    constexpr std::size_t chunk = 64 * 1024;
+    constexpr int max_reads = 16;
+    bool ended = false;
+    for (int i = 0; i < max_reads; ++i) {
+        const auto old = buf.size();
+        buf.resize(old + chunk);
+        const auto n = ::recv(sock, buf.data() + old, chunk, 0);
+        buf.resize(old + static_cast<std::size_t>(std::max<ssize_t>(n, 0)));
+        if (n == 0) {
+            ended = true;
+            break;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return read_result::end;
+            }
+            break;
+        }
+        if (static_cast<std::size_t>(n) < chunk) {
+            break;
+        }
+    }
+
+    if (delimiter.empty()) {
+        const auto res = parse_response();
+        if (res == parse_result::bad) {
+            return read_result::end;
+        }
+        if (res == parse_result::more) {
+            return ended ? read_result::end : read_result::none;
+        }
+    }
+
+    // only the newest complete image is kept
+    bool found = false;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    while (true) {
+        std::size_t b = 0;
+        std::size_t e = 0;
+        const auto res = next_image(b, e);
+        if (res == parse_result::bad) {
+            return read_result::end;
+        }
+        if (res == parse_result::more) {
+            break;
+        }
+        found = true;
+        begin = b;
+        end = e;
+    }
+
+    const bool deliver = found && wanted;
+    if (deliver) {
+        out = frame {};
+        out.data.assign(
+            buf.begin() + static_cast<std::ptrdiff_t>(begin),
+            buf.begin() + static_cast<std::ptrdiff_t>(end)
+        );
+        out.ts = std::chrono::steady_clock::now();
+    }
+    buf.erase(buf.begin(), buf.begin() + static_cast<std::ptrdiff_t>(pos));
+    pos = 0;
+
+    if (deliver) {
+        return read_result::frame;
+    }
+    return ended ? read_result::end : read_result::none;
+}
+
+bool yodau::backend::http_mjpeg_source::finish(frame& f) {
+    frame decoded;
+    if (!decode(f.bytes(), f.size(), decoded)) {
+        return false;
+    }
+    decoded.ts = f.ts;
+    f = std::move(decoded);
+    return true;
+}
+
+bool yodau::backend::http_mjpeg_source::await_response(
+    const std::chrono::milliseconds timeout
+) {
+    std::array<std::uint8_t, 4096> chunk {};
+    while (true) {
+        pollfd p { sock, POLLIN, 0 };
+        if (::poll(&p, 1, static_cast<int>(timeout.count())) != 1) {
+            return false;
+        }
+        const auto n = ::recv(sock, chunk.data(), chunk.size(), 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+            return false;
+        }
+        if (n > 0) {
+            buf.insert(buf.end(), chunk.begin(), chunk.begin() + n);
+        }
+        const auto res = parse_response();
+        if (res != parse_result::more) {
+            return res == parse_result::done;
+        }
+    }
+}
+
+yodau::backend::http_mjpeg_source::parse_result
+yodau::backend::http_mjpeg_source::parse_response() {
+    const auto end = find(buf, "\r\n\r\n", 0);
+    if (end == std::string_view::npos) {
+        return buf.size() > max_part ? parse_result::bad : parse_result::more;
+    }
+    const auto head = text_at(buf, 0, end);
+
+    // "HTTP/1.x 200 ..."
+    const auto space = head.find(' ');
+    if (!head.starts_with("HTTP/") || space == std::string_view::npos
+        || head.substr(space + 1, 3) != "200") {
+        return parse_result::bad;
+    }
+
+    const auto type = header_value(head, "content-type");
+    const auto type_lower = lower(type);
+    const auto key = type_lower.find("boundary=");
+    if (!type_lower.starts_with("multipart/")
+        || key == std::string::npos) {
+        return parse_result::bad;
+    }
+    auto boundary = type.substr(key + 9);
+    boundary = boundary.substr(0, boundary.find(';'));
+    while (!boundary.empty() && boundary.back() == ' ') {
+        boundary.remove_suffix(1);
+    }
+    if (boundary.size() >= 2 && boundary.front() == '"'
+        && boundary.back() == '"') {
+        boundary = boundary.substr(1, boundary.size() - 2);
+    }
+    // some servers repeat the dashes of the delimiter in the boundary
+    if (boundary.starts_with("--")) {
+        boundary.remove_prefix(2);
+    }
+    if (boundary.empty()) {
+        return parse_result::bad;
+    }
+
+    delimiter = "--" + std::string(boundary);
+    pos = end + 4;
+    return parse_result::done;
+}
+
+yodau::backend::http_mjpeg_source::parse_result
+yodau::backend::http_mjpeg_source::next_image(
+    std::size_t& begin, std::size_t& end
+) {
+    const auto start = find(buf, delimiter, pos);
+    if (start == std::string_view::npos) {
+        // skip what cannot be the start of a delimiter
+        if (buf.size() >= delimiter.size()) {
+            pos = std::max(pos, buf.size() - delimiter.size() + 1);
+        }
+        return parse_result::more;
+    }
+
+    const auto head_begin = start + delimiter.size();
+    const auto head_end = find(buf, "\r\n\r\n", head_begin);
+    if (head_end == std::string_view::npos) {
+        return buf.size() - start > max_part ? parse_result::bad
+                                             : parse_result::more;
+    }
+    const auto body = head_end + 4;
+
+    std::size_t length = 0;
+    const auto value = header_value(
+        text_at(buf, head_begin, head_end + 2), "content-length"
+    );
+    const bool has_length = !value.empty()
+        && std::from_chars(value.data(), value.data() + value.size(), length)
+               .ec
+            == std::errc {};
+    if (has_length) {
+        if (length > max_part) {
+            return parse_result::bad;
+        }
+        if (buf.size() - body < length) {
+            return parse_result::more;
+        }
+        begin = body;
+        end = body + length;
+    } else {
+        const auto next = find(buf, "\r\n" + delimiter, body);
+        if (next == std::string_view::npos) {
+            return buf.size() - body > max_part ? parse_result::bad
+                                                : parse_result::more;
+        }
+        begin = body;
+        end = next;
+    }
+    pos = end;
+    return parse_result::done;
+}
+
+yodau::backend::capture_engine::capture_engine()
+    : capture_engine(config {}) { }
+
+yodau::backend::capture_engine::capture_engine(const config cfg) {
+    const int io_count = std::max(1, cfg.io_threads);
+    for (int i = 0; i < io_count; ++i) {
+        auto t = std::make_unique<io_thread>();
+        t->epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+        t->wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (t->epoll_fd < 0 || t->wake_fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "epoll");
+        }
+        epoll_event ev {};
+        ev.events = EPOLLIN;
+        ev.data.u64 = wake_id;
+        if (::epoll_ctl(t->epoll_fd, EPOLL_CTL_ADD, t->wake_fd, &ev) < 0) {
+            throw std::system_error(errno, std::generic_category(), "epoll");
+        }
+        auto* raw = t.get();
+        t->th = std::jthread([this, raw](const std::stop_token& st) {
+            run_io(*raw, st);
+        });
+        io.push_back(std::move(t));
+    }
+
+    int worker_count = cfg.workers;
+    if (worker_count <= 0) {
+        const auto cores = std::thread::hardware_concurrency();
+        worker_count = std::max(1, static_cast<int>(cores));
+    }
+    workers.reserve(static_cast<std::size_t>(worker_count));
+    for (int i = 0; i < worker_count; ++i) {
+        workers.emplace_back([this](const std::stop_token& st) {
+            run_worker(st);
+        });
+    }
+}
+
+yodau::backend::capture_engine::~capture_engine() {
+    {
+        std::scoped_lock lock(mtx);
+        for (const auto& e : entries | std::views::values) {
+            e->removed = true;
+        }
+    }
+    // I/O threads first, so that nothing is delivered to stopped workers
+    io.clear();
+    workers.clear();
+}
+
+bool yodau::backend::capture_engine::add(
+    const std::string& key, std::unique_ptr<capture_source> src,
+    std::function<void(frame&&)> on_frame, std::function<bool()> wants_frame
+) {
+    if (!src || src->fd() < 0 || !on_frame) {
+        return false;
+    }
+    const int fd = src->fd();
+
+    auto e = std::make_shared<entry>();
+    e->src = std::move(src);
+    e->on_frame = std::move(on_frame);
+    e->wants_frame = std::move(wants_frame);
+
+    {
+        std::scoped_lock lock(mtx);
+        if (entries.contains(key)) {
+            return false;
+        }
+        e->id = next_id++;
+        entries.emplace(key, e);
+    }
+
+    io_thread* target = nullptr;
+    std::size_t load = 0;
+    for (const auto& t : io) {
+        std::scoped_lock lock(t->mtx);
+        if (!target || t->by_id.size() < load) {
+            target = t.get();
+            load = t->by_id.size();
+        }
+    }
+    e->owner = target;
+
+    bool ok = false;
+    {
+        std::scoped_lock lock(target->mtx);
+        target->by_id.emplace(e->id, e);
+        epoll_event ev {};
+        ev.events = EPOLLIN;
+        ev.data.u64 = e->id;
+        ok = ::epoll_ctl(target->epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+        if (!ok) {
+            target->by_id.erase(e->id);
+        }
+    }
+    if (!ok) {
+        std::scoped_lock lock(mtx);
+        entries.erase(key);
+    }
+    return ok;
+}
+
+void yodau::backend::capture_engine::remove(const std::string& key) {
+    std::shared_ptr<entry> e;
+    {
+        std::scoped_lock lock(mtx);
+        const auto it = entries.find(key);
+        if (it == entries.end()) {
+            return;
+        }
+        e = std::move(it->second);
+        entries.erase(it);
+    }
+    e->removed = true;
+
+    {
+        auto& t = *e->owner;
+        std::scoped_lock lock(t.mtx);
+        if (t.by_id.erase(e->id) > 0) {
+            ::epoll_ctl(t.epoll_fd, EPOLL_CTL_DEL, e->src->fd(), nullptr);
+        }
+    }
+    // wait for a read or callback in flight; later ones see the flag (the
+    // source is also used by workers, see capture_source::finish)
+    {
+        std::scoped_lock lock(e->io_mtx, e->work_mtx);
+        e->src.reset();
+    }
+    std::scoped_lock lock(e->slot_mtx);
+    e->pending.reset();
+}
+
+bool yodau::backend::capture_engine::contains(const std::string& key) const {
+    std::scoped_lock lock(mtx);
+    return entries.contains(key);
+}
+
+std::size_t yodau::backend::capture_engine::size() const {
+    std::scoped_lock lock(mtx);
+    return entries.size();
+}
+
+std::uint64_t yodau::backend::capture_engine::dropped() const {
+    return drops.load();
+}
+
+void yodau::backend::capture_engine::deliver(
+    const std::shared_ptr<entry>& e, frame&& f
+) {
+    bool enqueue = false;
+    {
+        std::scoped_lock lock(e->slot_mtx);
+        if (e->pending) {
+            ++drops;
+        }
+        e->pending = std::move(f);
+        if (!e->queued) {
+            e->queued = true;
+            enqueue = true;
+        }
+    }
+    if (enqueue) {
+        {
+            std::scoped_lock lock(ready_mtx);
+            ready.push_back(e);
+        }
+        ready_cv.notify_one();
+    }
+}
+
+void yodau::backend::capture_engine::run_io(
+    io_thread& t, const std::stop_token& st
+) {
+    std::array<epoll_event, 64> events {};
+    while (!st.stop_requested()) {
+        const int n = ::epoll_wait(
+            t.epoll_fd, events.data(), static_cast<int>(events.size()), -1
+        );
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            const auto id = events[static_cast<std::size_t>(i)].data.u64;
+            if (id == wake_id) {
+                std::uint64_t count = 0;
+                [[maybe_unused]] const auto rd
+                    = ::read(t.wake_fd, &count, sizeof(count));
+                continue;
+            }
+
+            std::shared_ptr<entry> e;
+            {
+                std::scoped_lock lock(t.mtx);
+                const auto it = t.by_id.find(id);
+                if (it == t.by_id.end()) {
+                    continue;
+                }
+                e = it->second;
+            }
+
+            frame f;
+            auto res = capture_source::read_result::none;
+            int fd = -1;
+            {
+                std::scoped_lock lock(e->io_mtx);
+                if (e->removed || !e->src) {
+                    continue;
+                }
+                const bool wanted = !e->wants_frame || e->wants_frame();
+                res = e->src->read(f, wanted);
+                fd = e->src->fd();
+            }
+
+            if (res == capture_source::read_result::frame) {
+                deliver(e, std::move(f));
+            } else if (res == capture_source::read_result::end) {
+                std::scoped_lock lock(t.mtx);
+                if (t.by_id.erase(id) > 0) {
+                    ::epoll_ctl(t.epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+                }
+            }
+        }
+    }
+}
+
+void yodau::backend::capture_engine::run_worker(const std::stop_token& st) {
+    while (true) {
+        std::shared_ptr<entry> e;
+        {
+            std::unique_lock lock(ready_mtx);
+            if (!ready_cv.wait(lock, st, [this] { return !ready.empty(); })) {
+                return;
+            }
+            e = std::move(ready.front());
+            ready.pop_front();
+        }
+
+        std::optional<frame> f;
+        {
+            std::scoped_lock lock(e->slot_mtx);
+            f.swap(e->pending);
+        }
+        if (f) {
+            std::scoped_lock lock(e->work_mtx);
+            if (!e->removed && e->src->finish(*f)) {
+                e->on_frame(std::move(*f));
+            }
+        }
+
+        // requeue at the back if a newer frame arrived meanwhile, so busy
+        // sources take turns with the others
+        bool again = false;
+        {
+            std::scoped_lock lock(e->slot_mtx);
+            again = e->pending.has_value();
+            e->queued = again;
+        }
+        if (again) {
+            {
+                std::scoped_lock lock(ready_mtx);
+                ready.push_back(std::move(e));
+            }
+            ready_cv.notify_one();
+        }
+    }
+}
+
+#endif // __linux__
@@ -1,5 +1,8 @@
 #include "cli_client.hpp"
+#include "decode_budget.hpp"
+#include "ffmpeg_client.hpp"
 #include "opencv_client.hpp"
+#include <fstream>
 #include <iostream>
 
 yodau::backend::cli_client::cli_client(backend::stream_manager& mgr)
@@ -54,7 +57,23 @@ void yodau::backend::cli_client::dispatch_command(
                         { "stop-stream", &cli_client::cmd_stop_stream },
                         { "list-lines", &cli_client::cmd_list_lines },
                         { "add-line", &cli_client::cmd_add_line },
-                        { "set-line", &cli_client::cmd_set_line } };
+                        { "set-line", &cli_client::cmd_set_line },
+                        { "set-detection", &cli_client::cmd_set_detection },
+                        { "list-stats", &cli_client::cmd_list_stats },
+                        { "set-playback", &cli_client::cmd_set_playback },
+                        { "set-backend", &cli_client::cmd_set_backend },
+                        { "set-decoder", &cli_client::cmd_set_decoder },
+                        { "set-ingest", &cli_client::cmd_set_ingest },
+                        { "set-capture", &cli_client::cmd_set_capture },
+                        { "set-decode-budget",
+                          &cli_client::cmd_set_decode_budget },
+                        { "set-tripwire", &cli_client::cmd_set_tripwire },
+                        { "set-roi", &cli_client::cmd_set_roi },
+                        { "list-crossings",
+                          &cli_client::cmd_list_crossings },
+                        { "set-rate", &cli_client::cmd_set_rate },
+                        { "set-sampling", &cli_client::cmd_set_sampling },
+                        { "show-heatmap", &cli_client::cmd_show_heatmap } };
     const auto it = command_map.find(cmd);
     if (it == command_map.end()) {
         std::cerr << "unknown command: " << cmd << std::endl;
@@ -122,7 +141,10 @@ void yodau::backend::cli_client::cmd_add_stream(
         ("path", "Path to the device, media file or stream URL", cxxopts::value<std::string>())
         ("name", "Name of the stream", cxxopts::value<std::string>()->default_value(""))
         ("type", "Type of the stream (local/file/rtsp/http)", cxxopts::value<std::string>()->default_value(""))
-        ("loop", "Whether to loop the stream (true/false)", cxxopts::value<bool>()->default_value("true"));
+        ("loop", "Whether to loop the stream (true/false)", cxxopts::value<bool>()->default_value("true"))
+        ("size", "Requested capture size (WIDTHxHEIGHT)", cxxopts::value<std::string>())
+        ("fps", "Requested capture frame rate", cxxopts::value<double>())
+        ("fourcc", "Requested pixel format (e.g. MJPG, YUYV)", cxxopts::value<std::string>());
     options.parse_positional({ "path", "name", "type", "loop" });
     try {
         const auto result = parse_with_cxxopts(cmd, args, options);
@@ -138,7 +160,29 @@ void yodau::backend::cli_client::cmd_add_stream(
         const std::string name = result["name"].as<std::string>();
         const std::string type = result["type"].as<std::string>();
         const bool loop = result["loop"].as<bool>();
-        const auto& stream = stream_mgr.add_stream(path, name, type, loop);
+
+        capture_format format;
+        if (result.count("size")
+            && !capture_format::parse_size(
+                result["size"].as<std::string>(), format.width, format.height
+            )) {
+            std::cerr << "Error: invalid size, expected WIDTHxHEIGHT."
+                      << std::endl;
+            return;
+        }
+        if (result.count("fps")) {
+            format.fps = result["fps"].as<double>();
+        }
+        if (result.count("fourcc")) {
+            format.fourcc = result["fourcc"].as<std::string>();
+            if (format.fourcc.size() != 4) {
+                std::cerr << "Error: fourcc must be 4 characters." << std::endl;
+                return;
+            }
+        }
+
+        const auto& stream
+            = stream_mgr.add_stream(path, name, type, loop, format);
         stream.dump(std::cout, true);
         std::cout << std::endl;
     } catch (const cxxopts::exceptions::exception& e) {
@@ -323,3 +367,802 @@ void yodau::backend::cli_client::cmd_set_line(
         std::cout << options.help() << std::endl;
     }
 }
+
+void yodau::backend::cli_client::cmd_set_detection(
+    const std::vector<std::string>& args
+) const {
+    const std::string cmd = "set-detection";
+    cxxopts::Options options(cmd, "Configure motion detection");
+    options.allow_unrecognised_options();
+    options.add_options()
+    ("h,help", "Print help")
+    ("mode", "Detection mode (full/pyramid)", cxxopts::value<std::string>())
+    ("levels", "Pyramid levels for the coarse pass (1-5)", cxxopts::value<int>())
+    ("activation", "Share of changed coarse pixels activating a tile (0-1)",
+        cxxopts::value<double>())
+    ("parallel-min-pixels", "Frame size from which analysis runs in row bands (0 disables)",
+        cxxopts::value<long long>())
+    ("packed", "Post-process motion masks as packed bits (true/false)",
+        cxxopts::value<bool>())
+    ("static-tolerance", "Mean luma change below which frames are skipped (<0 disables)",
+        cxxopts::value<int>())
+    ("vector-area", "Moving share of decoder motion vectors below which frames are skipped (<0 disables)",
+        cxxopts::value<double>())
+    ("analysis-width", "Width Motion JPEG streams are decoded down to (0 = full size)",
+        cxxopts::value<int>());
+    options.parse_positional({ "mode" });
+    try {
+        const auto result = parse_with_cxxopts(cmd, args, options);
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return;
+        }
+#ifdef YODAU_OPENCV
+        auto& client = global_opencv_client();
+        if (result.count("mode")) {
+            const auto mode = result["mode"].as<std::string>();
+            if (mode == "full") {
+                client.set_detection_mode(opencv_client::detection_mode::full);
+            } else if (mode == "pyramid") {
+                client.set_detection_mode(
+                    opencv_client::detection_mode::pyramid
+                );
+            } else {
+                std::cerr << "Error: unknown mode: " << mode << std::endl;
+                return;
+            }
+        }
+        if (result.count("levels")) {
+            client.set_pyramid_levels(result["levels"].as<int>());
+        }
+        if (result.count("activation")) {
+            client.set_pyramid_activation(result["activation"].as<double>());
+        }
+        if (result.count("parallel-min-pixels")) {
+            client.set_parallel_min_pixels(
+                result["parallel-min-pixels"].as<long long>()
+            );
+        }
+        if (result.count("packed")) {
+            client.set_packed_masks(result["packed"].as<bool>());
+        }
+        if (result.count("static-tolerance")) {
+            client.set_static_tolerance(result["static-tolerance"].as<int>());
+        }
+        if (result.count("vector-area")) {
+            client.set_vector_prefilter(result["vector-area"].as<double>());
+        }
+        if (result.count("analysis-width")) {
+            const int width = result["analysis-width"].as<int>();
+            client.set_analysis_width(width);
+#ifdef YODAU_FFMPEG
+            global_ffmpeg_client().set_analysis_width(width);
+#endif
+        }
+        const bool pyramid = client.get_detection_mode()
+            == opencv_client::detection_mode::pyramid;
+        std::cout << "detection mode: " << (pyramid ? "pyramid" : "full")
+                  << std::endl;
+#else
+        std::cerr << "Error: built without OpenCV support." << std::endl;
+#endif
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Error parsing command '" << cmd << "': " << e.what()
+                  << std::endl;
+        std::cout << options.help() << std::endl;
+    }
+}
+
+void yodau::backend::cli_client::cmd_list_stats(
+    const std::vector<std::string>& args
+) const {
+    const std::string cmd = "list-stats";
+    cxxopts::Options options(cmd, "Show per-stream analysis statistics");
+    options.allow_unrecognised_options();
+    options.add_options()("h,help", "Print help");
+    try {
+        const auto result = parse_with_cxxopts(cmd, args, options);
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return;
+        }
+        const auto to_ms = [](const std::chrono::microseconds us) {
+            return static_cast<double>(us.count()) / 1000.0;
+        };
+        for (const auto& name : stream_mgr.stream_names()) {
+            std::cout << name << ":";
+#ifdef YODAU_OPENCV
+            std::cout << " skipped="
+                      << global_opencv_client().skipped_frames(name);
+#endif
+            const auto lat = stream_mgr.latency(name);
+            std::cout << " latency_ms(last/avg/max)=" << to_ms(lat.last) << "/"
+                      << to_ms(lat.average) << "/" << to_ms(lat.max)
+                      << " samples=" << lat.samples << " interval_ms="
+                      << stream_mgr.analysis_interval(name).count()
+                      << std::endl;
+        }
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Error parsing command '" << cmd << "': " << e.what()
+                  << std::endl;
+        std::cout << options.help() << std::endl;
+    }
+}
+
+void yodau::backend::cli_client::cmd_set_playback(
+    const std::vector<std::string>& args
+) const {
+    const std::string cmd = "set-playback";
+    cxxopts::Options options(cmd, "Configure file stream playback speed");
+    options.allow_unrecognised_options();
+    options.add_options()
+    ("h,help", "Print help")
+    ("mode", "Playback mode (realtime/max)", cxxopts::value<std::string>());
+    options.parse_positional({ "mode" });
+    try {
+        const auto result = parse_with_cxxopts(cmd, args, options);
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return;
+        }
+#ifdef YODAU_OPENCV
+        auto& client = global_opencv_client();
+        if (result.count("mode")) {
+            const auto mode = result["mode"].as<std::string>();
+            if (mode == "realtime") {
+                client.set_playback_mode(
+                    opencv_client::playback_mode::realtime
+                );
+            } else if (mode == "max") {
+                client.set_playback_mode(
+                    opencv_client::playback_mode::max_speed
+                );
+            } else {
+                std::cerr << "Error: unknown mode: " << mode << std::endl;
+                return;
+            }
+#ifdef YODAU_FFMPEG
+            global_ffmpeg_client().set_realtime_files(mode == "realtime");
+#endif
+        }
+        const bool realtime = client.get_playback_mode()
+            == opencv_client::playback_mode::realtime;
+        std::cout << "playback mode: " << (realtime ? "realtime" : "max")
+                  << std::endl;
+#else
+        std::cerr << "Error: built without OpenCV support." << std::endl;
+#endif
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Error parsing command '" << cmd << "': " << e.what()
+                  << std::endl;
+        std::cout << options.help() << std::endl;
+    }
+}
+
+void yodau::backend::cli_client::cmd_set_backend(
+    const std::vector<std::string>& args
+) const {
+    const std::string cmd = "set-backend";
+    cxxopts::Options options(cmd, "Select the capture backend");
+    options.allow_unrecognised_options();
+    options.add_options()
+    ("h,help", "Print help")
+    ("backend", "Capture backend (opencv/ffmpeg)", cxxopts::value<std::string>());
+    options.parse_positional({ "backend" });
+    try {
+        const auto result = parse_with_cxxopts(cmd, args, options);
+        if (result.count("help") || !result.count("backend")) {
+            std::cout << options.help() << std::endl;
+            return;
+        }
+        const auto backend = result["backend"].as<std::string>();
+        if (backend == "opencv") {
+#ifdef YODAU_OPENCV
+            stream_mgr.set_daemon_start_hook(opencv_daemon_start);
+#else
+            std::cerr << "Error: built without OpenCV support." << std::endl;
+            return;
+#endif
+        } else if (backend == "ffmpeg") {
+#ifdef YODAU_FFMPEG
+            stream_mgr.set_daemon_start_hook(ffmpeg_daemon_start);
+#else
+            std::cerr << "Error: built without FFmpeg support." << std::endl;
+            return;
+#endif
+        } else {
+            std::cerr << "Error: unknown backend: " << backend << std::endl;
+            return;
+        }
+        std::cout << "capture backend: " << backend << std::endl;
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Error parsing command '" << cmd << "': " << e.what()
+                  << std::endl;
+        std::cout << options.help() << std::endl;
+    }
+}
+
+void yodau::backend::cli_client::cmd_set_decoder(
+    const std::vector<std::string>& args
+) const {
+    const std::string cmd = "set-decoder";
+    cxxopts::Options options(cmd, "Configure the FFmpeg decoder of a stream");
+    options.allow_unrecognised_options();
+    options.add_options()
+    ("h,help", "Print help")
+    ("name", "Stream name", cxxopts::value<std::string>())
+    ("threads", "Decoder threads (0 = automatic)", cxxopts::value<int>())
+    ("motion-vectors", "Export codec motion vectors (true/false)",
+        cxxopts::value<bool>());
+    options.parse_positional({ "name" });
+    try {
+        const auto result = parse_with_cxxopts(cmd, args, options);
+        if (result.count("help") || !result.count("name")) {
+            std::cout << options.help() << std::endl;
+            return;
+        }
+#ifdef YODAU_FFMPEG
+        auto& client = global_ffmpeg_client();
+        const auto name = result["name"].as<std::string>();
+        auto cfg = client.decoder_config(name);
+        if (result.count("threads")) {
+            cfg.threads = result["threads"].as<int>();
+        }
+        if (result.count("motion-vectors")) {
+            cfg.motion_vectors = result["motion-vectors"].as<bool>();
+        }
+        client.set_decoder_config(name, cfg);
+        std::cout << name << ": threads=" << cfg.threads
+                  << " motion-vectors=" << (cfg.motion_vectors ? "on" : "off")
+                  << std::endl;
+#else
+        std::cerr << "Error: built without FFmpeg support." << std::endl;
+#endif
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Error parsing command '" << cmd << "': " << e.what()
+                  << std::endl;
+        std::cout << options.help() << std::endl;
+    }
+}
+
+void yodau::backend::cli_client::cmd_set_ingest(
+    const std::vector<std::string>& args
+) const {
+    const std::string cmd = "set-ingest";
+    cxxopts::Options options(cmd, "Configure network stream ingest");
+    options.allow_unrecognised_options();
+    options.add_options()
+    ("h,help", "Print help")
+    ("mode", "Ingest mode (buffered/low-latency)", cxxopts::value<std::string>());
+    options.parse_positional({ "mode" });
+    try {
+        const auto result = parse_with_cxxopts(cmd, args, options);
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return;
+        }
+#ifdef YODAU_OPENCV
+        auto& client = global_opencv_client();
+        if (result.count("mode")) {
+            const auto mode = result["mode"].as<std::string>();
+            if (mode != "buffered" && mode != "low-latency") {
+                std::cerr << "Error: unknown mode: " << mode << std::endl;
+                return;
+            }
+            client.set_low_latency(mode == "low-latency");
+#ifdef YODAU_FFMPEG
+            global_ffmpeg_client().set_low_latency(mode == "low-latency");
+#endif
+        }
+        std::cout << "ingest mode: "
+                  << (client.get_low_latency() ? "low-latency" : "buffered")
+                  << std::endl;
+#else
+        std::cerr << "Error: built without OpenCV support." << std::endl;
+#endif
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Error parsing command '" << cmd << "': " << e.what()
+                  << std::endl;
+        std::cout << options.help() << std::endl;
+    }
+}
+
+void yodau::backend::cli_client::cmd_set_capture(
+    const std::vector<std::string>& args
+) const {
+    const std::string cmd = "set-capture";
+    cxxopts::Options options(cmd, "Configure how streams are captured");
+    options.allow_unrecognised_options();
+    options.add_options()
+    ("h,help", "Print help")
+    ("mode", "Capture mode (threads/engine)", cxxopts::value<std::string>())
+    ("io-threads", "Engine I/O threads", cxxopts::value<int>()->default_value("2"))
+    ("workers", "Engine worker threads (0 = one per core)", cxxopts::value<int>()->default_value("0"));
+    options.parse_positional({ "mode" });
+    try {
+        const auto result = parse_with_cxxopts(cmd, args, options);
+        if (result.count("help") || !result.count("mode")) {
+            std::cout << options.help() << std::endl;
+            return;
+        }
+#ifdef __linux__
+        const auto mode = result["mode"].as<std::string>();
+        if (mode == "threads") {
+            stream_mgr.set_capture_engine(nullptr, {});
+            std::cout << "capture mode: threads" << std::endl;
+            return;
+        }
+        if (mode != "engine") {
+            std::cerr << "Error: unknown mode: " << mode << std::endl;
+            return;
+        }
+        const auto io_threads = result["io-threads"].as<int>();
+        const auto workers = result["workers"].as<int>();
+        if (io_threads < 1 || workers < 0) {
+            std::cerr << "Error: invalid thread count." << std::endl;
+            return;
+        }
+        stream_mgr.set_capture_engine(
+            std::make_shared<capture_engine>(
+                capture_engine::config { io_threads, workers }
+            ),
+            [](const stream& s) -> std::unique_ptr<capture_source> {
+                if (auto src = v4l2_source::open(s)) {
+                    return src;
+                }
+#ifdef YODAU_OPENCV
+                // network cameras serving MJPEG over HTTP
+                return http_mjpeg_source::open(
+                    s,
+                    [](const std::uint8_t* data, const std::size_t size,
+                       frame& out) {
+                        return global_opencv_client().decode_jpeg(
+                            data, size, out
+                        );
+                    }
+                );
+#else
+                return nullptr;
+#endif
+            }
+        );
+        std::cout << "capture mode: engine (" << io_threads << " I/O threads, "
+                  << workers << " workers)" << std::endl;
+#else
+        std::cerr << "Error: capture engine is only available on Linux."
+                  << std::endl;
+#endif
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Error parsing command '" << cmd << "': " << e.what()
+                  << std::endl;
+        std::cout << options.help() << std::endl;
+    }
+}
+
+void yodau::backend::cli_client::cmd_set_decode_budget(
+    const std::vector<std::string>& args
+) const {
+    const std::string cmd = "set-decode-budget";
+    cxxopts::Options options(cmd, "Configure the shared decoder thread budget");
+    options.allow_unrecognised_options();
+    options.add_options()
+    ("h,help", "Print help")
+    ("threads", "Decoder threads for all streams (0 = one per core)", cxxopts::value<int>());
+    options.parse_positional({ "threads" });
+    try {
+        const auto result = parse_with_cxxopts(cmd, args, options);
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return;
+        }
+        auto& budget = global_decode_budget();
+        if (result.count("threads")) {
+            const auto threads = result["threads"].as<int>();
+            if (threads < 0) {
+                std::cerr << "Error: invalid thread count." << std::endl;
+                return;
+            }
+            budget.set_total(threads);
+        }
+        std::cout << "decode budget: " << budget.total() << " threads, "
+                  << budget.leased() << " leased" << std::endl;
+        for (const auto& a : budget.allocations()) {
+            std::cout << "  " << a.name << ": " << a.width << "x" << a.height
+                      << " threads=" << a.threads << std::endl;
+        }
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Error parsing command '" << cmd << "': " << e.what()
+                  << std::endl;
+        std::cout << options.help() << std::endl;
+    }
+}
+
+void yodau::backend::cli_client::cmd_set_tripwire(
+    const std::vector<std::string>& args
+) const {
+    const std::string cmd = "set-tripwire";
+    cxxopts::Options options(cmd, "Configure tripwire hit testing of a stream");
+    options.allow_unrecognised_options();
+    options.add_options()
+    ("h,help", "Print help")
+    ("name", "Stream name", cxxopts::value<std::string>())
+    ("mode", "Hit testing mode (vector/raster)", cxxopts::value<std::string>());
+    options.parse_positional({ "name" });
+    try {
+        const auto result = parse_with_cxxopts(cmd, args, options);
+        if (result.count("help") || !result.count("name")) {
+            std::cout << options.help() << std::endl;
+            return;
+        }
+#ifdef YODAU_OPENCV
+        auto& client = global_opencv_client();
+        const auto name = result["name"].as<std::string>();
+        if (result.count("mode")) {
+            const auto mode = result["mode"].as<std::string>();
+            if (mode == "vector") {
+                client.set_tripwire_mode(
+                    name, opencv_client::tripwire_mode::vector
+                );
+            } else if (mode == "raster") {
+                client.set_tripwire_mode(
+                    name, opencv_client::tripwire_mode::raster
+                );
+            } else {
+                std::cerr << "Error: unknown mode: " << mode << std::endl;
+                return;
+            }
+        }
+        const auto mode = client.get_tripwire_mode(name);
+        std::cout << name << ": tripwire="
+                  << (mode == opencv_client::tripwire_mode::raster ? "raster"
+                                                                   : "vector")
+                  << std::endl;
+#else
+        std::cerr << "Error: built without OpenCV support." << std::endl;
+#endif
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Error parsing command '" << cmd << "': " << e.what()
+                  << std::endl;
+        std::cout << options.help() << std::endl;
+    }
+}
+
+void yodau::backend::cli_client::cmd_set_roi(
+    const std::vector<std::string>& args
+) const {
+    const std::string cmd = "set-roi";
+    cxxopts::Options options(cmd, "Configure region (closed line) events");
+    options.allow_unrecognised_options();
+    options.add_options()
+    ("h,help", "Print help")
+    ("enter", "Share of region pixels with motion to enter (0.0-1.0)", cxxopts::value<double>())
+    ("exit", "Share of region pixels with motion below which to exit (0.0-1.0)", cxxopts::value<double>())
+    ("enter-frames", "Consecutive active frames to enter", cxxopts::value<int>())
+    ("exit-frames", "Consecutive idle frames to exit", cxxopts::value<int>())
+    ("interval-ms", "Interval of occupied reports (0 = off)", cxxopts::value<int>());
+    try {
+        const auto result = parse_with_cxxopts(cmd, args, options);
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return;
+        }
+#ifdef YODAU_OPENCV
+        auto& client = global_opencv_client();
+        auto cfg = client.get_roi_config();
+        if (result.count("enter")) {
+            cfg.enter_ratio = result["enter"].as<double>();
+        }
+        if (result.count("exit")) {
+            cfg.exit_ratio = result["exit"].as<double>();
+        }
+        if (result.count("enter-frames")) {
+            cfg.enter_frames = result["enter-frames"].as<int>();
+        }
+        if (result.count("exit-frames")) {
+            cfg.exit_frames = result["exit-frames"].as<int>();
+        }
+        if (result.count("interval-ms")) {
+            cfg.report_interval
+                = std::chrono::milliseconds(result["interval-ms"].as<int>());
+        }
+        if (cfg.enter_ratio < 0.0 || cfg.enter_ratio > 1.0
+            || cfg.exit_ratio < 0.0 || cfg.exit_ratio > cfg.enter_ratio
+            || cfg.enter_frames < 1 || cfg.exit_frames < 1
+            || cfg.report_interval.count() < 0) {
+            std::cerr << "Error: invalid thresholds (exit must not exceed "
+                         "enter)."
+                      << std::endl;
+            return;
+        }
+        client.set_roi_config(cfg);
+        std::cout << "roi: enter=" << cfg.enter_ratio << " (x"
+                  << cfg.enter_frames << ") exit=" << cfg.exit_ratio << " (x"
+                  << cfg.exit_frames
+                  << ") interval=" << cfg.report_interval.count() << "ms"
+                  << std::endl;
+#else
+        std::cerr << "Error: built without OpenCV support." << std::endl;
+#endif
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Error parsing command '" << cmd << "': " << e.what()
+                  << std::endl;
+        std::cout << options.help() << std::endl;
+    }
+}
+
+void yodau::backend::cli_client::cmd_list_crossings(
+    const std::vector<std::string>& args
+) const {
+    const std::string cmd = "list-crossings";
+    cxxopts::Options options(cmd, "Show tripwire crossing counts per line");
+    options.allow_unrecognised_options();
+    options.add_options()
+    ("h,help", "Print help")
+    ("name", "Stream name (all streams if omitted)", cxxopts::value<std::string>());
+    options.parse_positional({ "name" });
+    try {
+        const auto result = parse_with_cxxopts(cmd, args, options);
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return;
+        }
+        const auto name
+            = result.count("name") ? result["name"].as<std::string>() : "";
+        const auto print = [](const crossing_count& c) {
+            std::cout << c.neg_to_pos << "/" << c.pos_to_neg << "/" << c.flat;
+        };
+        for (const auto& row : stream_mgr.crossings(name)) {
+            std::cout << row.stream_name << " " << row.line_name << ":";
+            for (std::size_t i = 0; i < crossing_window_count; ++i) {
+                std::cout << " "
+                          << crossing_window_name(
+                                 static_cast<crossing_window>(i)
+                             )
+                          << "=";
+                print(row.windows[i]);
+            }
+            std::cout << " total=";
+            print(row.total);
+            std::cout << std::endl;
+        }
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Error parsing command '" << cmd << "': " << e.what()
+                  << std::endl;
+        std::cout << options.help() << std::endl;
+    }
+}
+
+void yodau::backend::cli_client::cmd_set_rate(
+    const std::vector<std::string>& args
+) const {
+    const std::string cmd = "set-rate";
+    cxxopts::Options options(cmd, "Configure event rate limits");
+    options.allow_unrecognised_options();
+    options.add_options()
+    ("h,help", "Print help")
+    ("target", "Limited events (motion/tripwire/budget)", cxxopts::value<std::string>())
+    ("s,stream", "Stream name (default of all streams if omitted)", cxxopts::value<std::string>()->default_value(""))
+    ("l,line", "Line name (tripwire only)", cxxopts::value<std::string>()->default_value(""))
+    ("interval-ms", "Time to regain one event (0 = unlimited)", cxxopts::value<double>())
+    ("burst", "Events allowed at once", cxxopts::value<int>());
+    options.parse_positional({ "target" });
+    try {
+        const auto result = parse_with_cxxopts(cmd, args, options);
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return;
+        }
+        if (!result.count("target")) {
+            std::cerr << "Error: 'target' argument is required." << std::endl;
+            return;
+        }
+        const auto target = result["target"].as<std::string>();
+
+        const auto update = [&](rate_rule& rule) {
+            if (result.count("interval-ms")) {
+                const std::chrono::duration<double, std::milli> ms(
+                    result["interval-ms"].as<double>()
+                );
+                rule.interval = std::chrono::duration_cast<
+                    std::chrono::steady_clock::duration>(ms);
+            }
+            if (result.count("burst")) {
+                rule.burst = result["burst"].as<int>();
+            }
+            if (rule.burst < 1) {
+                std::cerr << "Error: burst must be at least 1." << std::endl;
+                return false;
+            }
+            return true;
+        };
+        const auto print = [](const std::string& what, const rate_rule& rule) {
+            std::cout << what << ": ";
+            if (rule.unlimited()) {
+                std::cout << "unlimited";
+            } else {
+                const std::chrono::duration<double, std::milli> ms(
+                    rule.interval
+                );
+                std::cout << "interval=" << ms.count()
+                          << "ms burst=" << rule.burst;
+            }
+        };
+
+        if (target == "budget") {
+            auto rule = stream_mgr.get_event_budget();
+            if (!update(rule)) {
+                return;
+            }
+            stream_mgr.set_event_budget(rule);
+            print(target, rule);
+            std::cout << " dropped=" << stream_mgr.dropped_events()
+                      << std::endl;
+            return;
+        }
+#ifdef YODAU_OPENCV
+        opencv_client::rate_target t {};
+        if (target == "motion") {
+            t = opencv_client::rate_target::motion;
+        } else if (target == "tripwire") {
+            t = opencv_client::rate_target::tripwire;
+        } else {
+            std::cerr << "Error: unknown target: " << target << std::endl;
+            return;
+        }
+        const auto stream_name = result["stream"].as<std::string>();
+        const auto line_name = t == opencv_client::rate_target::tripwire
+            ? result["line"].as<std::string>()
+            : std::string {};
+        auto& client = global_opencv_client();
+        auto rule = client.get_rate_rule(t, stream_name, line_name);
+        if (!update(rule)) {
+            return;
+        }
+        client.set_rate_rule(t, stream_name, line_name, rule);
+        print(target, rule);
+        std::cout << std::endl;
+#else
+        std::cerr << "Error: built without OpenCV support." << std::endl;
+#endif
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Error parsing command '" << cmd << "': " << e.what()
+                  << std::endl;
+        std::cout << options.help() << std::endl;
+    }
+}
+
+void yodau::backend::cli_client::cmd_set_sampling(
+    const std::vector<std::string>& args
+) const {
+    const std::string cmd = "set-sampling";
+    cxxopts::Options options(cmd, "Configure content-driven analysis sampling");
+    options.allow_unrecognised_options();
+    options.add_options()
+    ("h,help", "Print help")
+    ("mode", "Sampling mode (adaptive/fixed)", cxxopts::value<std::string>())
+    ("min-ms", "Interval while motion is at or approaching a line", cxxopts::value<int>())
+    ("idle-ms", "Interval of quiet scenes", cxxopts::value<int>())
+    ("lookahead-ms", "How far ahead approaching motion is anticipated", cxxopts::value<int>())
+    ("quiet-ms", "Time without motion after which a scene is quiet", cxxopts::value<int>())
+    ("near-pct", "Distance to a line (percent) that counts as at the line", cxxopts::value<float>());
+    options.parse_positional({ "mode" });
+    try {
+        const auto result = parse_with_cxxopts(cmd, args, options);
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return;
+        }
+        auto cfg = stream_mgr.get_sampling();
+        if (result.count("mode")) {
+            const auto mode = result["mode"].as<std::string>();
+            if (mode != "adaptive" && mode != "fixed") {
+                std::cerr << "Error: unknown mode: " << mode << std::endl;
+                return;
+            }
+            cfg.enabled = mode == "adaptive";
+        }
+        const auto set_ms = [&](const char* key, std::chrono::milliseconds& v) {
+            if (result.count(key)) {
+                v = std::chrono::milliseconds(result[key].as<int>());
+            }
+        };
+        set_ms("min-ms", cfg.min_interval);
+        set_ms("idle-ms", cfg.idle_interval);
+        set_ms("lookahead-ms", cfg.lookahead);
+        set_ms("quiet-ms", cfg.quiet);
+        if (result.count("near-pct")) {
+            cfg.near_pct = result["near-pct"].as<float>();
+        }
+        if (cfg.min_interval.count() <= 0 || cfg.near_pct < 0.0f) {
+            std::cerr << "Error: min-ms must be positive and near-pct "
+                         "non-negative."
+                      << std::endl;
+            return;
+        }
+        stream_mgr.set_sampling(cfg);
+        std::cout << "sampling: " << (cfg.enabled ? "adaptive" : "fixed")
+                  << " min=" << cfg.min_interval.count()
+                  << "ms idle=" << cfg.idle_interval.count()
+                  << "ms lookahead=" << cfg.lookahead.count()
+                  << "ms quiet=" << cfg.quiet.count()
+                  << "ms near=" << cfg.near_pct << "%" << std::endl;
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Error parsing command '" << cmd << "': " << e.what()
+                  << std::endl;
+        std::cout << options.help() << std::endl;
+    }
+}
+
+void yodau::backend::cli_client::cmd_show_heatmap(
+    const std::vector<std::string>& args
+) const {
+    const std::string cmd = "show-heatmap";
+    cxxopts::Options options(cmd, "Show the motion heatmap of a stream");
+    options.allow_unrecognised_options();
+    options.add_options()
+    ("h,help", "Print help")
+    ("name", "Stream name", cxxopts::value<std::string>())
+    ("o,output", "Write the map as a PGM image to this file", cxxopts::value<std::string>())
+    ("half-life-min", "Minutes for old motion to lose half its weight, all streams (0 = never)", cxxopts::value<double>())
+    ("clear", "Forget the stream's map", cxxopts::value<bool>()->default_value("false"));
+    options.parse_positional({ "name" });
+    try {
+        const auto result = parse_with_cxxopts(cmd, args, options);
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return;
+        }
+        if (result.count("half-life-min")) {
+            const std::chrono::duration<double, std::ratio<60>> minutes(
+                result["half-life-min"].as<double>()
+            );
+            stream_mgr.set_heatmap_half_life(
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    minutes
+                )
+            );
+        }
+        if (!result.count("name")) {
+            if (!result.count("half-life-min")) {
+                std::cerr << "Error: 'name' argument is required." << std::endl;
+            }
+            return;
+        }
+        const auto name = result["name"].as<std::string>();
+        if (result["clear"].as<bool>()) {
+            stream_mgr.clear_heatmap(name);
+            return;
+        }
+
+        const auto map = stream_mgr.heatmap(name);
+        if (result.count("output")) {
+            const auto path = result["output"].as<std::string>();
+            std::ofstream out(path, std::ios::binary);
+            map.write_pgm(out);
+            if (!out) {
+                std::cerr << "Error: cannot write " << path << std::endl;
+                return;
+            }
+            std::cout << "Wrote " << path << " (" << map.samples()
+                      << " samples)" << std::endl;
+            return;
+        }
+
+        // one character per cell, from no motion to the hottest cell
+        static constexpr std::string_view ramp = " .:-=+*#%@";
+        const auto grid = map.normalized();
+        std::cout << name << ": " << map.samples() << " samples" << std::endl;
+        for (int y = 0; y < motion_heatmap::rows; ++y) {
+            std::string row;
+            for (int x = 0; x < motion_heatmap::cols; ++x) {
+                const auto level = static_cast<std::size_t>(grid.at(x, y));
+                row.push_back(ramp[level * (ramp.size() - 1) / 255]);
+            }
+            std::cout << "|" << row << "|" << std::endl;
+        }
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Error parsing command '" << cmd << "': " << e.what()
+                  << std::endl;
+        std::cout << options.help() << std::endl;
+    }
+}
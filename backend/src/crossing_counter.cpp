@@ -0,0 +1,187 @@
+#include "crossing_counter.hpp"
+
+#include <algorithm>
+#include <utility>
+
+void yodau::backend::crossing_count::add(const crossing_dir dir) {
+    switch (dir) {
+    case crossing_dir::neg_to_pos:
+        ++neg_to_pos;
+        break;
+    case crossing_dir::pos_to_neg:
+        ++pos_to_neg;
+        break;
+    case crossing_dir::flat:
+        ++flat;
+        break;
+    }
+}
+
+yodau::backend::crossing_count&
+yodau::backend::crossing_count::operator+=(const crossing_count& o) {
+    neg_to_pos += o.neg_to_pos;
+    pos_to_neg += o.pos_to_neg;
+    flat += o.flat;
+    return *this;
+}
+
+yodau::backend::crossing_count&
+yodau::backend::crossing_count::operator-=(const crossing_count& o) {
+    neg_to_pos -= o.neg_to_pos;
+    pos_to_neg -= o.pos_to_neg;
+    flat -= o.flat;
+    return *this;
+}
+
+std::chrono::seconds
+yodau::backend::crossing_window_span(const crossing_window w) {
+    using namespace std::chrono_literals;
+    switch (w) {
+    case crossing_window::minute:
+        return 60s;
+    case crossing_window::quarter_hour:
+        return 15min;
+    case crossing_window::hour:
+        return 1h;
+    case crossing_window::day:
+        return 24h;
+    }
+    return 0s;
+}
+
+std::string_view
+yodau::backend::crossing_window_name(const crossing_window w) {
+    switch (w) {
+    case crossing_window::minute:
+        return "1m";
+    case crossing_window::quarter_hour:
+        return "15m";
+    case crossing_window::hour:
+        return "1h";
+    case crossing_window::day:
+        return "24h";
+    }
+    return "";
+}
+
+yodau::backend::sliding_counter::sliding_counter(
+    const clock::duration span, const std::size_t buckets
+)
+    : width(std::max<clock::duration>(
+          span / static_cast<clock::rep>(std::max<std::size_t>(buckets, 1)),
+          clock::duration { 1 }
+      ))
+    , ring(std::max<std::size_t>(buckets, 1)) { }
+
+long long
+yodau::backend::sliding_counter::bucket_of(const clock::time_point t) const {
+    return static_cast<long long>(t.time_since_epoch() / width);
+}
+
+std::size_t yodau::backend::sliding_counter::slot_of(const long long b) const {
+    const auto n = static_cast<long long>(ring.size());
+    return static_cast<std::size_t>((b % n + n) % n);
+}
+
+void yodau::backend::sliding_counter::add(
+    const crossing_count& delta, const clock::time_point ts
+) {
+    if (ring.empty()) {
+        return;
+    }
+    const long long b = bucket_of(ts);
+    const auto n = static_cast<long long>(ring.size());
+
+    if (b > head) {
+        // clear the buckets that slid out of the window
+        if (b - head >= n) {
+            std::ranges::fill(ring, crossing_count {});
+            sum = {};
+        } else {
+            for (long long k = head + 1; k <= b; ++k) {
+                auto& c = ring[slot_of(k)];
+                sum -= c;
+                c = {};
+            }
+        }
+        head = b;
+    } else if (head - b >= n) {
+        return;
+    }
+
+    ring[slot_of(b)] += delta;
+    sum += delta;
+}
+
+yodau::backend::crossing_count
+yodau::backend::sliding_counter::total(const clock::time_point now) const {
+    if (ring.empty()) {
+        return {};
+    }
+    const long long b = bucket_of(now);
+    const auto n = static_cast<long long>(ring.size());
+    if (b <= head) {
+        return sum;
+    }
+    if (b - head >= n) {
+        return {};
+    }
+
+    // buckets that would be cleared by advancing to now
+    auto out = sum;
+    for (long long k = head + 1; k <= b; ++k) {
+        out -= ring[slot_of(k)];
+    }
+    return out;
+}
+
+yodau::backend::crossing_counters::line_counters::line_counters() {
+    for (std::size_t i = 0; i < crossing_window_count; ++i) {
+        windows[i] = sliding_counter(
+            crossing_window_span(static_cast<crossing_window>(i)),
+            buckets_per_window
+        );
+    }
+}
+
+void yodau::backend::crossing_counters::add(
+    const std::string& stream_name, const std::string& line_name,
+    const crossing_dir dir, const clock::time_point ts
+) {
+    crossing_count delta;
+    delta.add(dir);
+
+    auto& c = streams[stream_name][line_name];
+    for (auto& w : c.windows) {
+        w.add(delta, ts);
+    }
+    c.total += delta;
+}
+
+std::vector<yodau::backend::crossing_counters::row>
+yodau::backend::crossing_counters::snapshot(
+    const std::string& stream_name, const clock::time_point now
+) const {
+    std::vector<row> out;
+    for (const auto& [sname, lines] : streams) {
+        if (!stream_name.empty() && sname != stream_name) {
+            continue;
+        }
+        for (const auto& [lname, c] : lines) {
+            row r;
+            r.stream_name = sname;
+            r.line_name = lname;
+            for (std::size_t i = 0; i < crossing_window_count; ++i) {
+                r.windows[i] = c.windows[i].total(now);
+            }
+            r.total = c.total;
+            out.push_back(std::move(r));
+        }
+    }
+
+    std::ranges::sort(out, [](const row& a, const row& b) {
+        return a.stream_name != b.stream_name ? a.stream_name < b.stream_name
+                                              : a.line_name < b.line_name;
+    });
+    return out;
+}
@@ -0,0 +1,146 @@
+#include "decode_budget.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace {
+int resolve_total(const int total) {
+    if (total > 0) {
+        return total;
+    }
+    const auto cores = static_cast<int>(std::thread::hardware_concurrency());
+    return std::max(1, cores);
+}
+
+std::int64_t pixels_of(const int width, const int height) {
+    return static_cast<std::int64_t>(width) * height;
+}
+}
+
+yodau::backend::decode_budget::lease::lease(
+    decode_budget* from, const std::uint64_t lease_id, const int threads
+)
+    : owner(from)
+    , id(lease_id)
+    , count(threads) { }
+
+yodau::backend::decode_budget::lease::~lease() { release(); }
+
+yodau::backend::decode_budget::lease::lease(lease&& other) noexcept
+    : owner(std::exchange(other.owner, nullptr))
+    , id(other.id)
+    , count(std::exchange(other.count, 0)) { }
+
+yodau::backend::decode_budget::lease&
+yodau::backend::decode_budget::lease::operator=(lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        owner = std::exchange(other.owner, nullptr);
+        id = other.id;
+        count = std::exchange(other.count, 0);
+    }
+    return *this;
+}
+
+int yodau::backend::decode_budget::lease::threads() const { return count; }
+
+void yodau::backend::decode_budget::lease::release() {
+    if (owner) {
+        owner->release(id);
+        owner = nullptr;
+    }
+    count = 0;
+}
+
+yodau::backend::decode_budget::decode_budget(const int total)
+    : budget(resolve_total(total)) { }
+
+void yodau::backend::decode_budget::set_total(const int total) {
+    std::scoped_lock lock(mtx);
+    budget = resolve_total(total);
+}
+
+int yodau::backend::decode_budget::total() const {
+    std::scoped_lock lock(mtx);
+    return budget;
+}
+
+yodau::backend::decode_budget::lease yodau::backend::decode_budget::acquire(
+    const std::string& name, int width, int height, const int fixed
+) {
+    if (width <= 0 || height <= 0) {
+        width = default_width;
+        height = default_height;
+    }
+    const auto pixels = pixels_of(width, height);
+
+    std::scoped_lock lock(mtx);
+    int threads = fixed;
+    if (threads <= 0) {
+        std::int64_t active = 0;
+        int taken = 0;
+        for (const auto& r : records) {
+            active += pixels_of(r.alloc.width, r.alloc.height);
+            taken += r.alloc.threads;
+        }
+
+        const auto wanted
+            = (pixels + pixels_per_thread - 1) / pixels_per_thread;
+        const auto share = budget * pixels / (pixels + active);
+        const auto left = static_cast<std::int64_t>(budget - taken);
+        const auto capped = std::min({ wanted, max_per_stream, share, left });
+        threads = static_cast<int>(std::max<std::int64_t>(1, capped));
+    }
+
+    const auto id = next_id++;
+    records.push_back({ id, { name, width, height, threads } });
+    return lease(this, id, threads);
+}
+
+yodau::backend::decode_budget::lease
+yodau::backend::decode_budget::acquire(const stream& s, const int fixed) {
+    auto fmt = s.requested_format();
+    if (fmt.width <= 0 || fmt.height <= 0) {
+        fmt = s.negotiated_format();
+    }
+    return acquire(s.get_name(), fmt.width, fmt.height, fixed);
+}
+
+void yodau::backend::decode_budget::reacquire(
+    lease& held, const std::string& name, const int width, const int height,
+    const int fixed
+) {
+    held = lease {};
+    held = acquire(name, width, height, fixed);
+}
+
+int yodau::backend::decode_budget::leased() const {
+    std::scoped_lock lock(mtx);
+    int sum = 0;
+    for (const auto& r : records) {
+        sum += r.alloc.threads;
+    }
+    return sum;
+}
+
+std::vector<yodau::backend::decode_budget::allocation>
+yodau::backend::decode_budget::allocations() const {
+    std::scoped_lock lock(mtx);
+    std::vector<allocation> out;
+    out.reserve(records.size());
+    for (const auto& r : records) {
+        out.push_back(r.alloc);
+    }
+    return out;
+}
+
+void yodau::backend::decode_budget::release(const std::uint64_t id) {
+    std::scoped_lock lock(mtx);
+    std::erase_if(records, [id](const record& r) { return r.id == id; });
+}
+
+yodau::backend::decode_budget& yodau::backend::global_decode_budget() {
+    static decode_budget instance;
+    return instance;
+}
@@ -0,0 +1,213 @@
+#include "event_batch.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+yodau::backend::name_table::name_table() {
+    names.emplace_back();
+    ids.emplace(std::string_view { names.front() }, empty_id);
+}
+
+std::uint32_t yodau::backend::name_table::intern(const std::string_view s) {
+    {
+        std::shared_lock lock(mtx);
+        const auto it = ids.find(s);
+        if (it != ids.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock lock(mtx);
+    const auto it = ids.find(s);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    const auto id = static_cast<std::uint32_t>(names.size());
+    names.emplace_back(s);
+    ids.emplace(std::string_view { names.back() }, id);
+    return id;
+}
+
+const std::string&
+yodau::backend::name_table::name(const std::uint32_t id) const {
+    std::shared_lock lock(mtx);
+    return id < names.size() ? names[id] : names.front();
+}
+
+std::size_t yodau::backend::name_table::size() const {
+    std::shared_lock lock(mtx);
+    return names.size();
+}
+
+yodau::backend::name_table& yodau::backend::global_names() {
+    static name_table instance;
+    return instance;
+}
+
+std::string_view yodau::backend::crossing_dir_name(const crossing_dir d) {
+    switch (d) {
+    case crossing_dir::neg_to_pos:
+        return "neg_to_pos";
+    case crossing_dir::pos_to_neg:
+        return "pos_to_neg";
+    case crossing_dir::flat:
+        break;
+    }
+    return "flat";
+}
+
+yodau::backend::crossing_dir
+yodau::backend::parse_crossing_dir(const std::string_view s) {
+    if (s == "neg_to_pos") {
+        return crossing_dir::neg_to_pos;
+    }
+    if (s == "pos_to_neg") {
+        return crossing_dir::pos_to_neg;
+    }
+    return crossing_dir::flat;
+}
+
+void yodau::backend::event_batch::clear() {
+    kind.clear();
+    dir.clear();
+    stream_id.clear();
+    line_id.clear();
+    message_id.clear();
+    grid_id.clear();
+    ts.clear();
+    x.clear();
+    y.clear();
+    grids.clear();
+    frames.clear();
+}
+
+void yodau::backend::event_batch::truncate(const std::size_t n) {
+    if (n >= size()) {
+        return;
+    }
+    kind.resize(n);
+    dir.resize(n);
+    stream_id.resize(n);
+    line_id.resize(n);
+    message_id.resize(n);
+    grid_id.resize(n);
+    ts.resize(n);
+    x.resize(n);
+    y.resize(n);
+
+    // grids are added in event order, so the kept ones form a prefix
+    std::size_t used = 0;
+    for (const auto g : grid_id) {
+        if (g != compact_event::no_grid) {
+            used = std::max<std::size_t>(used, g + std::size_t { 1 });
+        }
+    }
+    grids.resize(used);
+}
+
+void yodau::backend::event_batch::push_back(const compact_event& e) {
+    kind.push_back(e.kind);
+    dir.push_back(e.dir);
+    stream_id.push_back(e.stream);
+    line_id.push_back(e.line);
+    message_id.push_back(e.message);
+    grid_id.push_back(e.grid);
+    ts.push_back(e.ts);
+    x.push_back(e.x);
+    y.push_back(e.y);
+}
+
+void yodau::backend::event_batch::push_back(
+    const event& e, name_table& names
+) {
+    compact_event c;
+    c.kind = e.kind;
+    c.ts = e.ts;
+    c.stream = names.intern(e.stream_name);
+    c.line = names.intern(e.line_name);
+    if (e.kind == event_kind::tripwire) {
+        c.dir = parse_crossing_dir(e.message);
+    }
+    // a tripwire message that names its direction is carried by dir alone
+    const bool implied = e.kind == event_kind::tripwire
+        && e.message == crossing_dir_name(c.dir);
+    if (!implied) {
+        c.message = names.intern(e.message);
+    }
+    if (e.pos_pct) {
+        c.x = e.pos_pct->x;
+        c.y = e.pos_pct->y;
+    }
+    if (e.grid) {
+        c.grid = add_grid(*e.grid);
+    }
+    push_back(c);
+}
+
+std::uint32_t
+yodau::backend::event_batch::add_grid(const activity_grid& g) {
+    grids.push_back(g);
+    return static_cast<std::uint32_t>(grids.size() - 1);
+}
+
+void yodau::backend::event_batch::add_activity(
+    const activity_grid& g, const std::chrono::steady_clock::time_point ts
+) {
+    frames.push_back({ g, ts });
+}
+
+void yodau::backend::event_batch::set_activity_pos(
+    const float px, const float py
+) {
+    if (!frames.empty()) {
+        frames.back().x = px;
+        frames.back().y = py;
+    }
+}
+
+yodau::backend::compact_event
+yodau::backend::event_batch::at(const std::size_t i) const {
+    compact_event c;
+    c.kind = kind[i];
+    c.dir = dir[i];
+    c.stream = stream_id[i];
+    c.line = line_id[i];
+    c.message = message_id[i];
+    c.grid = grid_id[i];
+    c.ts = ts[i];
+    c.x = x[i];
+    c.y = y[i];
+    return c;
+}
+
+yodau::backend::event yodau::backend::event_batch::to_event(
+    const std::size_t i, const name_table& names
+) const {
+    event e;
+    e.kind = kind[i];
+    e.stream_name = names.name(stream_id[i]);
+    e.line_name = names.name(line_id[i]);
+    if (message_id[i] != name_table::empty_id) {
+        e.message = names.name(message_id[i]);
+    } else if (kind[i] == event_kind::tripwire) {
+        e.message = crossing_dir_name(dir[i]);
+    }
+    e.ts = ts[i];
+    if (!std::isnan(x[i])) {
+        e.pos_pct = point { x[i], y[i] };
+    }
+    if (grid_id[i] != compact_event::no_grid) {
+        e.grid = grids[grid_id[i]];
+    }
+    return e;
+}
+
+std::vector<yodau::backend::event>
+yodau::backend::event_batch::to_events(const name_table& names) const {
+    std::vector<event> out;
+    out.reserve(size());
+    for (std::size_t i = 0; i < size(); ++i) {
+        out.push_back(to_event(i, names));
+    }
+    return out;
+}
@@ -0,0 +1,557 @@
+#ifdef YODAU_FFMPEG
+
+#include "ffmpeg_client.hpp"
+#include "decode_budget.hpp"
+#include "jpeg_scale.hpp"
+#include "latest_frame.hpp"
+#include "playback_clock.hpp"
+#include "source_clock.hpp"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/motion_vector.h>
+#include <libswscale/swscale.h>
+}
+
+#include <algorithm>
+#include <string>
+
+namespace {
+// decoder output whose first plane is 8-bit luma
+bool has_luma_plane(const int format) {
+    switch (format) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+    case AV_PIX_FMT_YUV422P:
+    case AV_PIX_FMT_YUVJ422P:
+    case AV_PIX_FMT_YUV444P:
+    case AV_PIX_FMT_YUVJ444P:
+    case AV_PIX_FMT_YUV440P:
+    case AV_PIX_FMT_YUVJ440P:
+    case AV_PIX_FMT_YUV411P:
+    case AV_PIX_FMT_YUV410P:
+    case AV_PIX_FMT_NV12:
+    case AV_PIX_FMT_NV21:
+    case AV_PIX_FMT_NV16:
+    case AV_PIX_FMT_GRAY8:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// device demuxers name input formats after codecs / pixel formats
+std::string input_format_name(const std::string& fourcc) {
+    if (fourcc == "MJPG") {
+        return "mjpeg";
+    }
+    if (fourcc == "YUYV") {
+        return "yuyv422";
+    }
+    if (fourcc == "GREY") {
+        return "gray";
+    }
+    if (fourcc == "H264") {
+        return "h264";
+    }
+    return fourcc;
+}
+
+double to_ms(const std::int64_t ts, const AVRational tb) {
+    if (ts == AV_NOPTS_VALUE) {
+        return -1.0;
+    }
+    return static_cast<double>(ts) * av_q2d(tb) * 1000.0;
+}
+}
+
+struct yodau::backend::ffmpeg_capture::state {
+    state() = default;
+
+    ~state() {
+        sws_freeContext(sws);
+        av_frame_free(&pic);
+        av_packet_free(&pkt);
+        avcodec_free_context(&dec);
+        avformat_close_input(&fmt);
+    }
+
+    state(const state&) = delete;
+    state& operator=(const state&) = delete;
+
+    AVFormatContext* fmt { nullptr };
+    AVCodecContext* dec { nullptr };
+    AVPacket* pkt { nullptr };
+    AVFrame* pic { nullptr };
+    SwsContext* sws { nullptr };
+    int video { -1 };
+    AVRational time_base { 0, 1 };
+    double rate { 0.0 };
+    double last_packet_ms { -1.0 };
+    bool export_mvs { false };
+    bool draining { false };
+};
+
+yodau::backend::ffmpeg_capture::ffmpeg_capture() = default;
+
+yodau::backend::ffmpeg_capture::~ffmpeg_capture() = default;
+
+bool yodau::backend::ffmpeg_capture::open(
+    const std::string& url, const config& cfg
+) {
+    close();
+
+    auto s = std::make_unique<state>();
+    AVDictionary* input_opts = nullptr;
+    if (cfg.low_delay) {
+        av_dict_set(&input_opts, "fflags", "nobuffer", 0);
+        av_dict_set(&input_opts, "max_delay", "0", 0);
+    }
+    const auto& want = cfg.format;
+    if (want.width > 0 && want.height > 0) {
+        const auto size
+            = std::to_string(want.width) + "x" + std::to_string(want.height);
+        av_dict_set(&input_opts, "video_size", size.c_str(), 0);
+    }
+    if (want.fps > 0.0) {
+        av_dict_set(
+            &input_opts, "framerate", std::to_string(want.fps).c_str(), 0
+        );
+    }
+    if (!want.fourcc.empty()) {
+        const auto name = input_format_name(want.fourcc);
+        av_dict_set(&input_opts, "input_format", name.c_str(), 0);
+    }
+    const int opened
+        = avformat_open_input(&s->fmt, url.c_str(), nullptr, &input_opts);
+    av_dict_free(&input_opts);
+    if (opened < 0) {
+        return false;
+    }
+    if (avformat_find_stream_info(s->fmt, nullptr) < 0) {
+        return false;
+    }
+
+    const AVCodec* codec = nullptr;
+    s->video
+        = av_find_best_stream(s->fmt, AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
+    if (s->video < 0 || !codec) {
+        return false;
+    }
+    const AVStream* vs = s->fmt->streams[s->video];
+
+    s->dec = avcodec_alloc_context3(codec);
+    if (!s->dec || avcodec_parameters_to_context(s->dec, vs->codecpar) < 0) {
+        return false;
+    }
+    const int threads = cfg.size_threads
+        ? cfg.size_threads(vs->codecpar->width, vs->codecpar->height)
+        : cfg.threads;
+    s->dec->thread_count = std::max(0, threads);
+    s->dec->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    if (cfg.low_delay) {
+        s->dec->flags |= AV_CODEC_FLAG_LOW_DELAY;
+        s->dec->thread_type = FF_THREAD_SLICE;
+    }
+    if (cfg.analysis_width > 0 && codec->max_lowres > 0) {
+        int reduction = jpeg_reduction(vs->codecpar->width, cfg.analysis_width);
+        int lowres = 0;
+        while (reduction > 1 && lowres < codec->max_lowres) {
+            reduction /= 2;
+            ++lowres;
+        }
+        s->dec->lowres = lowres;
+    }
+
+    AVDictionary* opts = nullptr;
+    if (cfg.motion_vectors) {
+        av_dict_set(&opts, "flags2", "+export_mvs", 0);
+    }
+    const int rc = avcodec_open2(s->dec, codec, &opts);
+    av_dict_free(&opts);
+    if (rc < 0) {
+        return false;
+    }
+
+    s->pkt = av_packet_alloc();
+    s->pic = av_frame_alloc();
+    if (!s->pkt || !s->pic) {
+        return false;
+    }
+
+    s->time_base = vs->time_base;
+    const AVRational fr
+        = vs->avg_frame_rate.num > 0 ? vs->avg_frame_rate : vs->r_frame_rate;
+    s->rate = fr.num > 0 && fr.den > 0 ? av_q2d(fr) : 0.0;
+    s->export_mvs = cfg.motion_vectors;
+
+    impl = std::move(s);
+    return true;
+}
+
+void yodau::backend::ffmpeg_capture::close() { impl.reset(); }
+
+bool yodau::backend::ffmpeg_capture::is_open() const {
+    return impl != nullptr;
+}
+
+yodau::backend::ffmpeg_capture::read_result
+yodau::backend::ffmpeg_capture::feed() {
+    if (impl->draining) {
+        return read_result::end;
+    }
+
+    while (true) {
+        const int rc = av_read_frame(impl->fmt, impl->pkt);
+        if (rc == AVERROR_EOF) {
+            impl->draining = true;
+            return avcodec_send_packet(impl->dec, nullptr) < 0
+                ? read_result::error
+                : read_result::ok;
+        }
+        if (rc < 0) {
+            return read_result::error;
+        }
+        if (impl->pkt->stream_index != impl->video) {
+            av_packet_unref(impl->pkt);
+            continue;
+        }
+
+        const auto ts = impl->pkt->dts != AV_NOPTS_VALUE ? impl->pkt->dts
+                                                         : impl->pkt->pts;
+        impl->last_packet_ms = to_ms(ts, impl->time_base);
+
+        const int sent = avcodec_send_packet(impl->dec, impl->pkt);
+        av_packet_unref(impl->pkt);
+        // a single damaged packet is not fatal for the stream
+        if (sent < 0 && sent != AVERROR_INVALIDDATA) {
+            return read_result::error;
+        }
+        return read_result::ok;
+    }
+}
+
+bool yodau::backend::ffmpeg_capture::to_frame(frame& out) {
+    AVFrame* pic = impl->pic;
+
+    out = frame {};
+    out.width = pic->width;
+    out.height = pic->height;
+    out.format = pixel_format::gray8;
+    out.ts = std::chrono::steady_clock::now();
+    out.pts_ms = to_ms(pic->best_effort_timestamp, impl->time_base);
+
+    if (has_luma_plane(pic->format) && pic->linesize[0] > 0) {
+        // keep a reference to the decoded picture instead of copying luma
+        AVFrame* ref = av_frame_clone(pic);
+        if (!ref) {
+            return false;
+        }
+        out.stride = ref->linesize[0];
+        out.external_size = static_cast<std::size_t>(ref->linesize[0])
+            * static_cast<std::size_t>(ref->height);
+        out.external = std::shared_ptr<const std::uint8_t>(
+            ref->data[0],
+            [ref](const std::uint8_t*) mutable { av_frame_free(&ref); }
+        );
+    } else {
+        impl->sws = sws_getCachedContext(
+            impl->sws, pic->width, pic->height,
+            static_cast<AVPixelFormat>(pic->format), pic->width, pic->height,
+            AV_PIX_FMT_GRAY8, SWS_POINT, nullptr, nullptr, nullptr
+        );
+        if (!impl->sws) {
+            return false;
+        }
+        out.stride = pic->width;
+        out.data.resize(
+            static_cast<std::size_t>(pic->width)
+            * static_cast<std::size_t>(pic->height)
+        );
+        std::uint8_t* dst[1] = { out.data.data() };
+        const int dst_stride[1] = { out.stride };
+        sws_scale(
+            impl->sws, pic->data, pic->linesize, 0, pic->height, dst,
+            dst_stride
+        );
+    }
+
+    if (!impl->export_mvs || pic->pict_type == AV_PICTURE_TYPE_I) {
+        return true;
+    }
+    const AVFrameSideData* sd
+        = av_frame_get_side_data(pic, AV_FRAME_DATA_MOTION_VECTORS);
+    if (!sd) {
+        return true;
+    }
+
+    const auto* mvs = reinterpret_cast<const AVMotionVector*>(sd->data);
+    const auto n = static_cast<std::size_t>(sd->size) / sizeof(AVMotionVector);
+    out.motion_vectors.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto& v = mvs[i];
+        const float scale
+            = v.motion_scale ? static_cast<float>(v.motion_scale) : 1.0f;
+        motion_vector mv;
+        mv.x = v.dst_x;
+        mv.y = v.dst_y;
+        mv.dx = static_cast<float>(v.motion_x) / scale;
+        mv.dy = static_cast<float>(v.motion_y) / scale;
+        mv.w = v.w;
+        mv.h = v.h;
+        out.motion_vectors.push_back(mv);
+    }
+    out.has_motion_vectors = true;
+    return true;
+}
+
+yodau::backend::ffmpeg_capture::read_result
+yodau::backend::ffmpeg_capture::read(frame& out) {
+    if (!impl) {
+        return read_result::error;
+    }
+
+    while (true) {
+        const int rc = avcodec_receive_frame(impl->dec, impl->pic);
+        if (rc == 0) {
+            const bool converted = to_frame(out);
+            av_frame_unref(impl->pic);
+            return converted ? read_result::ok : read_result::error;
+        }
+        if (rc == AVERROR_EOF) {
+            return read_result::end;
+        }
+        if (rc != AVERROR(EAGAIN)) {
+            return read_result::error;
+        }
+
+        const auto fed = feed();
+        if (fed != read_result::ok) {
+            return fed;
+        }
+    }
+}
+
+yodau::backend::ffmpeg_capture::read_result
+yodau::backend::ffmpeg_capture::skip() {
+    if (!impl) {
+        return read_result::error;
+    }
+
+    impl->dec->skip_frame = AVDISCARD_NONREF;
+    const auto fed = feed();
+    impl->dec->skip_frame = AVDISCARD_DEFAULT;
+    if (fed == read_result::error) {
+        return fed;
+    }
+
+    // drop whatever the decoder has ready
+    int rc = 0;
+    while ((rc = avcodec_receive_frame(impl->dec, impl->pic)) == 0) {
+        av_frame_unref(impl->pic);
+    }
+    if (rc == AVERROR_EOF) {
+        return read_result::end;
+    }
+    return rc == AVERROR(EAGAIN) ? read_result::ok : read_result::error;
+}
+
+bool yodau::backend::ffmpeg_capture::rewind() {
+    if (!impl) {
+        return false;
+    }
+
+    const AVStream* vs = impl->fmt->streams[impl->video];
+    const auto start = vs->start_time != AV_NOPTS_VALUE ? vs->start_time : 0;
+    if (av_seek_frame(impl->fmt, impl->video, start, AVSEEK_FLAG_BACKWARD)
+        < 0) {
+        return false;
+    }
+    avcodec_flush_buffers(impl->dec);
+    impl->draining = false;
+    impl->last_packet_ms = -1.0;
+    return true;
+}
+
+double yodau::backend::ffmpeg_capture::fps() const {
+    return impl ? impl->rate : 0.0;
+}
+
+yodau::backend::capture_format
+yodau::backend::ffmpeg_capture::format() const {
+    capture_format out;
+    if (!impl) {
+        return out;
+    }
+    const AVCodecParameters* par = impl->fmt->streams[impl->video]->codecpar;
+    out.width = par->width;
+    out.height = par->height;
+    out.fps = impl->rate;
+    out.fourcc = capture_format::fourcc_name(par->codec_tag);
+    return out;
+}
+
+double yodau::backend::ffmpeg_capture::packet_ms() const {
+    return impl ? impl->last_packet_ms : -1.0;
+}
+
+void yodau::backend::ffmpeg_client::set_decoder_config(
+    const std::string& stream_name, const ffmpeg_capture::config& cfg
+) {
+    std::scoped_lock lock(mtx);
+    config_by_stream[stream_name] = cfg;
+}
+
+yodau::backend::ffmpeg_capture::config
+yodau::backend::ffmpeg_client::decoder_config(const std::string& stream_name
+) const {
+    std::scoped_lock lock(mtx);
+    const auto it = config_by_stream.find(stream_name);
+    return it == config_by_stream.end() ? ffmpeg_capture::config {}
+                                        : it->second;
+}
+
+void yodau::backend::ffmpeg_client::set_realtime_files(const bool enabled) {
+    std::scoped_lock lock(mtx);
+    realtime = enabled;
+}
+
+bool yodau::backend::ffmpeg_client::realtime_files() const {
+    std::scoped_lock lock(mtx);
+    return realtime;
+}
+
+void yodau::backend::ffmpeg_client::set_low_latency(const bool enabled) {
+    std::scoped_lock lock(mtx);
+    low_latency_ingest = enabled;
+}
+
+bool yodau::backend::ffmpeg_client::low_latency() const {
+    std::scoped_lock lock(mtx);
+    return low_latency_ingest;
+}
+
+void yodau::backend::ffmpeg_client::set_analysis_width(const int px) {
+    std::scoped_lock lock(mtx);
+    target_width = std::max(0, px);
+}
+
+int yodau::backend::ffmpeg_client::analysis_width() const {
+    std::scoped_lock lock(mtx);
+    return target_width;
+}
+
+void yodau::backend::ffmpeg_client::daemon_start(
+    const stream& s, const std::function<void(frame&&)>& on_frame,
+    const std::function<bool()>& wants_frame, const std::stop_token& st
+) {
+    const auto path = s.get_path();
+    auto cfg = decoder_config(s.get_name());
+
+    const auto type = s.get_type();
+    const bool is_network
+        = type == stream_type::rtsp || type == stream_type::http;
+    const bool live = is_network && low_latency();
+    cfg.low_delay = cfg.low_delay || live;
+    cfg.analysis_width = analysis_width();
+    cfg.format = s.requested_format();
+
+    // threads the user did not pin come from the shared budget, sized by
+    // the resolution found when the source is probed (on every reopen)
+    decode_budget::lease decode_threads;
+    const int fixed = cfg.threads;
+    cfg.size_threads = [&](const int width, const int height) {
+        global_decode_budget().reacquire(
+            decode_threads, s.get_name(), width, height, fixed
+        );
+        return decode_threads.threads();
+    };
+
+    ffmpeg_capture cap;
+    if (!cap.open(path, cfg)) {
+        return;
+    }
+    s.report_negotiated_format(cap.format());
+
+    if (live) {
+        source_clock clock;
+        deliver_latest(
+            [&](std::optional<frame>& out) {
+                if (wants_frame && !wants_frame()) {
+                    return cap.skip() == ffmpeg_capture::read_result::ok;
+                }
+                frame f;
+                if (cap.read(f) != ffmpeg_capture::read_result::ok) {
+                    return false;
+                }
+                f.ts = clock.map(f.pts_ms, f.ts);
+                out = std::move(f);
+                return true;
+            },
+            on_frame, st
+        );
+        return;
+    }
+
+    const bool is_file = s.get_type() == stream_type::file;
+    playback_clock pacing(cap.fps());
+    bool got_frame = false;
+
+    while (!st.stop_requested()) {
+        frame f;
+        const bool wanted = !wants_frame || wants_frame();
+        const auto res = wanted ? cap.read(f) : cap.skip();
+        if (res == ffmpeg_capture::read_result::error) {
+            break;
+        }
+        if (res == ffmpeg_capture::read_result::end) {
+            // a loop pass without a single frame means the file is unusable
+            if (!is_file || !s.is_looping() || !got_frame) {
+                break;
+            }
+            got_frame = false;
+            pacing.restart();
+            if (!cap.rewind() && !cap.open(path, cfg)) {
+                break;
+            }
+            continue;
+        }
+        got_frame = true;
+
+        if (is_file && realtime_files()) {
+            const auto due = pacing.due(
+                cap.packet_ms(), std::chrono::steady_clock::now()
+            );
+            if (!playback_clock::sleep_until(due, st)) {
+                break;
+            }
+        }
+
+        if (wanted) {
+            on_frame(std::move(f));
+        }
+    }
+}
+
+yodau::backend::stream_manager::daemon_start_fn
+yodau::backend::ffmpeg_client::daemon_start_fn() {
+    return [this](
+               const stream& s, std::function<void(frame&&)> on_frame,
+               std::function<bool()> wants_frame, std::stop_token st
+           ) { daemon_start(s, on_frame, wants_frame, st); };
+}
+
+yodau::backend::ffmpeg_client& yodau::backend::global_ffmpeg_client() {
+    static ffmpeg_client inst;
+    return inst;
+}
+
+void yodau::backend::ffmpeg_daemon_start(
+    const stream& s, const std::function<void(frame&&)>& on_frame,
+    const std::function<bool()>& wants_frame, const std::stop_token& st
+) {
+    global_ffmpeg_client().daemon_start(s, on_frame, wants_frame, st);
+}
+
+#endif // YODAU_FFMPEG
@@ -0,0 +1,68 @@
+#include "frame_signature.hpp"
+
+#include <cstdlib>
+
+yodau::backend::frame_signature yodau::backend::compute_frame_signature(
+    const std::uint8_t* data, const int width, const int height,
+    const std::size_t stride, const int channels
+) {
+    frame_signature out;
+    if (!data || width <= 0 || height <= 0
+        || channels < 1 || channels > 4) {
+        return out;
+    }
+
+    out.width = width;
+    out.height = height;
+
+    constexpr int cols = frame_signature::cols;
+    constexpr int rows = frame_signature::rows;
+
+    std::array<size_t, cols> x_offsets {};
+    for (int cx = 0; cx < cols; ++cx) {
+        const int x = (2 * cx + 1) * width / (2 * cols);
+        x_offsets[static_cast<size_t>(cx)] = static_cast<size_t>(x * channels);
+    }
+
+    auto* dst = out.samples.data();
+    for (int cy = 0; cy < rows; ++cy) {
+        const int y = (2 * cy + 1) * height / (2 * rows);
+        const std::uint8_t* row = data + static_cast<size_t>(y) * stride;
+        if (channels <= 2) {
+            // gray, or the Y byte of packed YUYV
+            for (const auto off : x_offsets) {
+                *dst++ = row[off];
+            }
+        } else {
+            for (const auto off : x_offsets) {
+                const std::uint8_t* p = row + off;
+                *dst++ = static_cast<std::uint8_t>(
+                    (p[0] + 2 * p[1] + p[2] + 2) >> 2
+                );
+            }
+        }
+    }
+
+    return out;
+}
+
+bool yodau::backend::same_scene(
+    const frame_signature& a, const frame_signature& b,
+    const int mean_tolerance, const int max_tolerance
+) {
+    if (a.width <= 0 || a.width != b.width || a.height != b.height) {
+        return false;
+    }
+
+    int sum = 0;
+    for (size_t i = 0; i < a.samples.size(); ++i) {
+        const int d = std::abs(int { a.samples[i] } - int { b.samples[i] });
+        if (d > max_tolerance) {
+            return false;
+        }
+        sum += d;
+    }
+
+    const auto n = static_cast<int>(a.samples.size());
+    return sum <= mean_tolerance * n;
+}
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <charconv>
 #include <cmath>
+#include <limits>
 
 float yodau::backend::point::distance_to(const point& other) const {
     const float dx = x - other.x;
@@ -14,6 +15,245 @@ bool yodau::backend::point::compare(const point& other) const {
     return std::fabs(x - other.x) < epsilon && std::fabs(y - other.y) < epsilon;
 }
 
+namespace {
+// c in [min(a, b); max(a, b)], with tolerance
+bool between(const float a, const float b, const float c) {
+    constexpr float eps = yodau::backend::point::epsilon;
+    return (a <= c + eps && c <= b + eps) || (b <= c + eps && c <= a + eps);
+}
+
+bool on_segment(
+    const yodau::backend::point& a, const yodau::backend::point& b,
+    const yodau::backend::point& c
+) {
+    return yodau::backend::orient(a, b, c) == 0 && between(a.x, b.x, c.x)
+        && between(a.y, b.y, c.y);
+}
+}
+
+float yodau::backend::cross_z(const point& a, const point& b, const point& c) {
+    const float abx = b.x - a.x;
+    const float aby = b.y - a.y;
+    const float acx = c.x - a.x;
+    const float acy = c.y - a.y;
+    return abx * acy - aby * acx;
+}
+
+int yodau::backend::orient(const point& a, const point& b, const point& c) {
+    const float v = cross_z(a, b, c);
+    if (v > point::epsilon) {
+        return 1;
+    }
+    if (v < -point::epsilon) {
+        return -1;
+    }
+    return 0;
+}
+
+bool yodau::backend::segments_intersect(
+    const point& p1, const point& p2, const point& q1, const point& q2
+) {
+    const int o1 = orient(p1, p2, q1);
+    const int o2 = orient(p1, p2, q2);
+    const int o3 = orient(q1, q2, p1);
+    const int o4 = orient(q1, q2, p2);
+
+    if (o1 != o2 && o3 != o4) {
+        return true;
+    }
+
+    if (o1 == 0 && on_segment(p1, p2, q1)) {
+        return true;
+    }
+    if (o2 == 0 && on_segment(p1, p2, q2)) {
+        return true;
+    }
+    if (o3 == 0 && on_segment(q1, q2, p1)) {
+        return true;
+    }
+    if (o4 == 0 && on_segment(q1, q2, p2)) {
+        return true;
+    }
+
+    return false;
+}
+
+std::optional<yodau::backend::point> yodau::backend::segment_intersection(
+    const point& p1, const point& p2, const point& q1, const point& q2
+) {
+    const float rpx = p2.x - p1.x;
+    const float rpy = p2.y - p1.y;
+    const float spx = q2.x - q1.x;
+    const float spy = q2.y - q1.y;
+
+    const float den = rpx * spy - rpy * spx;
+    if (std::abs(den) <= point::epsilon) {
+        return {};
+    }
+
+    const float qpx = q1.x - p1.x;
+    const float qpy = q1.y - p1.y;
+
+    const float t = (qpx * spy - qpy * spx) / den;
+    const float u = (qpx * rpy - qpy * rpx) / den;
+
+    if (t < -point::epsilon || t > 1.0f + point::epsilon) {
+        return {};
+    }
+    if (u < -point::epsilon || u > 1.0f + point::epsilon) {
+        return {};
+    }
+
+    point out;
+    out.x = p1.x + t * rpx;
+    out.y = p1.y + t * rpy;
+    return out;
+}
+
+void yodau::backend::segment_batch::clear() {
+    sx.clear();
+    sy.clear();
+    ex.clear();
+    ey.clear();
+    count = 0;
+}
+
+void yodau::backend::segment_batch::push_back(const point& a, const point& b) {
+    if (count == sx.size()) {
+        const auto nan = std::numeric_limits<float>::quiet_NaN();
+        const auto padded = sx.size() + block;
+        sx.resize(padded, nan);
+        sy.resize(padded, nan);
+        ex.resize(padded, nan);
+        ey.resize(padded, nan);
+    }
+    sx[count] = a.x;
+    sy[count] = a.y;
+    ex[count] = b.x;
+    ey[count] = b.y;
+    ++count;
+}
+
+void yodau::backend::segment_batch::assign_chain(
+    const std::vector<point>& pts, const bool closed
+) {
+    clear();
+    for (size_t i = 1; i < pts.size(); ++i) {
+        push_back(pts[i - 1], pts[i]);
+    }
+    if (closed && pts.size() > 1) {
+        push_back(pts.back(), pts.front());
+    }
+}
+
+namespace {
+// mirrors segments_intersect / segment_intersection term by term (same
+// operands, same order) so that the results match exactly; every branch
+// is replaced by a mask so that the loop vectorizes
+std::uint32_t intersect_kernel(
+    const yodau::backend::point& a, const yodau::backend::point& b,
+    const yodau::backend::segment_batch& batch,
+    yodau::backend::segment_hits& out
+) {
+    // a and b are copied out: they could alias the output otherwise
+    constexpr float eps = yodau::backend::point::epsilon;
+    const float ax = a.x;
+    const float ay = a.y;
+    const float bx = b.x;
+    const float by = b.y;
+    const float rpx = bx - ax;
+    const float rpy = by - ay;
+    const float min_ax = std::min(ax, bx);
+    const float max_ax = std::max(ax, bx);
+    const float min_ay = std::min(ay, by);
+    const float max_ay = std::max(ay, by);
+
+    const std::size_t n = batch.x0().size();
+    const float* x0 = batch.x0().data();
+    const float* y0 = batch.y0().data();
+    const float* x1 = batch.x1().data();
+    const float* y1 = batch.y1().data();
+    std::uint32_t* hit = out.hit.data();
+    std::uint32_t* has_t = out.has_t.data();
+    float* t_out = out.t.data();
+
+    // masks are 32-bit integers so that they share the vector width of the
+    // float lanes
+    std::uint32_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const float spx = x1[i] - x0[i];
+        const float spy = y1[i] - y0[i];
+
+        // orient(a, b, q1), orient(a, b, q2), orient(q1, q2, a),
+        // orient(q1, q2, b)
+        const float c1 = rpx * (y0[i] - ay) - rpy * (x0[i] - ax);
+        const float c2 = rpx * (y1[i] - ay) - rpy * (x1[i] - ax);
+        const float c3 = spx * (ay - y0[i]) - spy * (ax - x0[i]);
+        const float c4 = spx * (by - y0[i]) - spy * (bx - x0[i]);
+        const int o1 = (c1 > eps) - (c1 < -eps);
+        const int o2 = (c2 > eps) - (c2 < -eps);
+        const int o3 = (c3 > eps) - (c3 < -eps);
+        const int o4 = (c4 > eps) - (c4 < -eps);
+        const std::uint32_t proper = (o1 != o2) & (o3 != o4);
+
+        // collinear endpoints lying on the other segment
+        const float min_qx = std::min(x0[i], x1[i]);
+        const float max_qx = std::max(x0[i], x1[i]);
+        const float min_qy = std::min(y0[i], y1[i]);
+        const float max_qy = std::max(y0[i], y1[i]);
+        const std::uint32_t q1_on = (o1 == 0) & (min_ax <= x0[i] + eps)
+            & (x0[i] <= max_ax + eps) & (min_ay <= y0[i] + eps)
+            & (y0[i] <= max_ay + eps);
+        const std::uint32_t q2_on = (o2 == 0) & (min_ax <= x1[i] + eps)
+            & (x1[i] <= max_ax + eps) & (min_ay <= y1[i] + eps)
+            & (y1[i] <= max_ay + eps);
+        const std::uint32_t a_on = (o3 == 0) & (min_qx <= ax + eps)
+            & (ax <= max_qx + eps) & (min_qy <= ay + eps)
+            & (ay <= max_qy + eps);
+        const std::uint32_t b_on = (o4 == 0) & (min_qx <= bx + eps)
+            & (bx <= max_qx + eps) & (min_qy <= by + eps)
+            & (by <= max_qy + eps);
+        const std::uint32_t h = proper | q1_on | q2_on | a_on | b_on;
+
+        // parametric intersection; a degenerate denominator is replaced
+        // by one and masked out
+        const float den = rpx * spy - rpy * spx;
+        const std::uint32_t den_ok = std::abs(den) > eps;
+        const float safe_den = den_ok ? den : 1.0f;
+        const float qpx = x0[i] - ax;
+        const float qpy = y0[i] - ay;
+        const float t = (qpx * spy - qpy * spx) / safe_den;
+        const float u = (qpx * rpy - qpy * rpx) / safe_den;
+        const std::uint32_t in_range = (t >= -eps) & (t <= 1.0f + eps)
+            & (u >= -eps) & (u <= 1.0f + eps);
+
+        hit[i] = h;
+        has_t[i] = den_ok & in_range;
+        t_out[i] = t;
+        count += h;
+    }
+    return count;
+}
+}
+
+std::size_t yodau::backend::intersect_segments(
+    const point& a, const point& b, const segment_batch& batch,
+    segment_hits& out
+) {
+    // the kernel runs over the padding too; padding never hits
+    const size_t padded = batch.x0().size();
+    out.hit.resize(padded);
+    out.has_t.resize(padded);
+    out.t.resize(padded);
+    const auto count = intersect_kernel(a, b, batch, out);
+
+    const size_t n = batch.size();
+    out.hit.resize(n);
+    out.has_t.resize(n);
+    out.t.resize(n);
+    return count;
+}
+
 void yodau::backend::line::dump(std::ostream& out) const {
     out << "Line(name=" << name << ", closed=" << (closed ? "true" : "false")
         << ", points=[";
@@ -0,0 +1,74 @@
+#include "jpeg_scale.hpp"
+
+namespace {
+int read_u16(const std::uint8_t* p) { return (p[0] << 8) | p[1]; }
+
+// SOF0..SOF15 except DHT (C4), JPG (C8) and DAC (CC)
+bool is_start_of_frame(const std::uint8_t marker) {
+    return marker >= 0xC0 && marker <= 0xCF && marker != 0xC4
+        && marker != 0xC8 && marker != 0xCC;
+}
+
+// markers that carry no length field
+bool is_standalone(const std::uint8_t marker) {
+    return marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7);
+}
+}
+
+bool yodau::backend::jpeg_dimensions(
+    const std::uint8_t* data, const std::size_t size, int& width, int& height
+) {
+    if (!data || size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        return false;
+    }
+
+    std::size_t pos = 2;
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xFF) {
+            return false;
+        }
+        const std::uint8_t marker = data[pos + 1];
+        if (marker == 0xFF) {
+            // fill byte
+            ++pos;
+            continue;
+        }
+        if (is_standalone(marker)) {
+            pos += 2;
+            continue;
+        }
+        if (marker == 0xD9 || marker == 0xDA) {
+            // end of image or scan data before any frame header
+            return false;
+        }
+
+        const auto len = static_cast<std::size_t>(read_u16(data + pos + 2));
+        if (len < 2) {
+            return false;
+        }
+        if (is_start_of_frame(marker)) {
+            // length, precision, height, width
+            if (len < 7 || pos + 9 > size) {
+                return false;
+            }
+            height = read_u16(data + pos + 5);
+            width = read_u16(data + pos + 7);
+            return width > 0 && height > 0;
+        }
+        pos += 2 + len;
+    }
+    return false;
+}
+
+int yodau::backend::jpeg_reduction(const int width, const int target_width) {
+    if (width <= 0 || target_width <= 0) {
+        return 1;
+    }
+    for (int d = 8; d > 1; d /= 2) {
+        // decoders round the scaled size up
+        if ((width + d - 1) / d >= target_width) {
+            return d;
+        }
+    }
+    return 1;
+}
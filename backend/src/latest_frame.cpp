@@ -0,0 +1,70 @@
+#include "latest_frame.hpp"
+
+#include <thread>
+
+void yodau::backend::latest_frame::put(frame&& f) {
+    {
+        std::scoped_lock lock(mtx);
+        if (slot) {
+            ++drops;
+        }
+        slot = std::move(f);
+    }
+    cv.notify_one();
+}
+
+bool yodau::backend::latest_frame::take(
+    frame& out, const std::stop_token& st
+) {
+    std::unique_lock lock(mtx);
+    cv.wait(lock, st, [this] { return slot.has_value() || closed; });
+    if (st.stop_requested() || !slot) {
+        return false;
+    }
+    out = std::move(*slot);
+    slot.reset();
+    return true;
+}
+
+void yodau::backend::latest_frame::close() {
+    {
+        std::scoped_lock lock(mtx);
+        closed = true;
+    }
+    cv.notify_one();
+}
+
+std::uint64_t yodau::backend::latest_frame::dropped() const {
+    std::scoped_lock lock(mtx);
+    return drops;
+}
+
+std::uint64_t yodau::backend::deliver_latest(
+    const std::function<bool(std::optional<frame>&)>& produce,
+    const std::function<void(frame&&)>& on_frame, const std::stop_token& st
+) {
+    latest_frame box;
+
+    std::jthread reader([&](const std::stop_token& rst) {
+        std::optional<frame> f;
+        while (!rst.stop_requested() && !st.stop_requested()) {
+            f.reset();
+            if (!produce(f)) {
+                break;
+            }
+            if (f) {
+                box.put(std::move(*f));
+            }
+        }
+        box.close();
+    });
+
+    frame f;
+    while (box.take(f, st)) {
+        on_frame(std::move(f));
+    }
+
+    reader.request_stop();
+    reader.join();
+    return box.dropped();
+}
@@ -0,0 +1,182 @@
+#include "line_raster.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <tuple>
+#include <utility>
+
+namespace {
+// Liang-Barsky clip of a segment to [0; 100] x [0; 100]
+bool clip_to_frame(yodau::backend::point& a, yodau::backend::point& b) {
+    const float dx = b.x - a.x;
+    const float dy = b.y - a.y;
+    float t0 = 0.0f;
+    float t1 = 1.0f;
+
+    const auto edge = [&](const float p, const float q) {
+        if (std::fpclassify(p) == FP_ZERO) {
+            return q >= 0.0f;
+        }
+        const float r = q / p;
+        if (p < 0.0f) {
+            if (r > t1) {
+                return false;
+            }
+            t0 = std::max(t0, r);
+        } else {
+            if (r < t0) {
+                return false;
+            }
+            t1 = std::min(t1, r);
+        }
+        return true;
+    };
+
+    if (!edge(-dx, a.x) || !edge(dx, 100.0f - a.x) || !edge(-dy, a.y)
+        || !edge(dy, 100.0f - a.y)) {
+        return false;
+    }
+
+    const yodau::backend::point start = a;
+    a = { start.x + t0 * dx, start.y + t0 * dy };
+    b = { start.x + t1 * dx, start.y + t1 * dy };
+    return true;
+}
+
+int to_pixel(const float pct, const int size) {
+    const auto px = static_cast<int>(
+        std::floor(pct * static_cast<float>(size) / 100.0f)
+    );
+    return std::clamp(px, 0, size - 1);
+}
+}
+
+yodau::backend::line_raster::line_raster(
+    std::shared_ptr<const line_set> lines, const int width, const int height
+)
+    : source(std::move(lines))
+    , w(std::max(0, width))
+    , h(std::max(0, height)) {
+    if (!source || w == 0 || h == 0) {
+        row_start.assign(static_cast<std::size_t>(h) + 1, 0);
+        return;
+    }
+
+    struct pixel {
+        int y;
+        int x;
+        std::uint32_t segment;
+    };
+    std::vector<pixel> pixels;
+
+    for (std::size_t s = 0; s < source->segment_count(); ++s) {
+        auto a = source->segment_a(s);
+        auto b = source->segment_b(s);
+        if (!clip_to_frame(a, b)) {
+            continue;
+        }
+
+        // Bresenham, all octants
+        int x = to_pixel(a.x, w);
+        int y = to_pixel(a.y, h);
+        const int xe = to_pixel(b.x, w);
+        const int ye = to_pixel(b.y, h);
+        const int dx = std::abs(xe - x);
+        const int dy = -std::abs(ye - y);
+        const int sx = x < xe ? 1 : -1;
+        const int sy = y < ye ? 1 : -1;
+        int err = dx + dy;
+        while (true) {
+            pixels.push_back({ y, x, static_cast<std::uint32_t>(s) });
+            if (x == xe && y == ye) {
+                break;
+            }
+            const int e2 = 2 * err;
+            if (e2 >= dy) {
+                err += dy;
+                x += sx;
+            }
+            if (e2 <= dx) {
+                err += dx;
+                y += sy;
+            }
+        }
+    }
+
+    std::ranges::sort(pixels, [](const pixel& l, const pixel& r) {
+        return std::tie(l.y, l.x, l.segment) < std::tie(r.y, r.x, r.segment);
+    });
+
+    row_start.assign(static_cast<std::size_t>(h) + 1, 0);
+    pix_x.reserve(pixels.size());
+    pix_segment.reserve(pixels.size());
+    for (const auto& p : pixels) {
+        ++row_start[static_cast<std::size_t>(p.y) + 1];
+        pix_x.push_back(p.x);
+        pix_segment.push_back(p.segment);
+    }
+    for (std::size_t y = 0; y < static_cast<std::size_t>(h); ++y) {
+        row_start[y + 1] += row_start[y];
+    }
+}
+
+bool yodau::backend::line_raster::matches(
+    const std::shared_ptr<const line_set>& lines, const int width,
+    const int height
+) const {
+    return source == lines && w == width && h == height;
+}
+
+template <typename Fn>
+void yodau::backend::line_raster::for_pixels(
+    int x0, int y0, int x1, int y1, Fn&& fn
+) const {
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, w);
+    y1 = std::min(y1, h);
+
+    for (int y = y0; y < y1; ++y) {
+        const auto begin = pix_x.begin() + row_start[static_cast<size_t>(y)];
+        const auto end = pix_x.begin() + row_start[static_cast<size_t>(y) + 1];
+        for (auto it = std::lower_bound(begin, end, x0); it != end && *it < x1;
+             ++it) {
+            const auto i = static_cast<std::size_t>(it - pix_x.begin());
+            fn(pix_segment[i], *it, y);
+        }
+    }
+}
+
+void yodau::backend::line_raster::hits(
+    const std::uint8_t* mask, const std::size_t stride, const int x0,
+    const int y0, const int x1, const int y1, std::vector<hit>& out
+) const {
+    out.clear();
+    if (!mask) {
+        return;
+    }
+    const auto visit = [&](const std::uint32_t s, const int x, const int y) {
+        const auto row = static_cast<std::size_t>(y) * stride;
+        if (mask[row + static_cast<std::size_t>(x)] != 0) {
+            out.push_back({ s, x, y });
+        }
+    };
+    for_pixels(x0, y0, x1, y1, visit);
+}
+
+void yodau::backend::line_raster::hits(
+    const bit_mask& mask, const int x0, const int y0, const int x1,
+    const int y1, std::vector<hit>& out
+) const {
+    out.clear();
+    if (mask.width() != w || mask.height() != h) {
+        return;
+    }
+    const auto visit = [&](const std::uint32_t s, const int x, const int y) {
+        if (mask.test(x, y)) {
+            out.push_back({ s, x, y });
+        }
+    };
+    for_pixels(x0, y0, x1, y1, visit);
+}
@@ -0,0 +1,127 @@
+#include "line_set.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+yodau::backend::bbox yodau::backend::bbox::of(const std::vector<point>& pts) {
+    if (pts.empty()) {
+        return {};
+    }
+    bbox out { pts.front().x, pts.front().y, pts.front().x, pts.front().y };
+    for (const auto& p : pts) {
+        out.min_x = std::min(out.min_x, p.x);
+        out.min_y = std::min(out.min_y, p.y);
+        out.max_x = std::max(out.max_x, p.x);
+        out.max_y = std::max(out.max_y, p.y);
+    }
+    return out;
+}
+
+yodau::backend::line_set::line_set(
+    const std::vector<line_ptr>& src, const std::uint64_t version
+)
+    : ver(version) {
+    for (const auto& lp : src) {
+        if (!lp || lp->points.size() < 2) {
+            continue;
+        }
+        const auto idx = static_cast<std::uint32_t>(lines.size());
+        lines.push_back(lp);
+        boxes.push_back(bbox::of(lp->points));
+
+        const auto& pts = lp->points;
+        const auto add = [&](const point& a, const point& b) {
+            ax.push_back(a.x);
+            ay.push_back(a.y);
+            bx.push_back(b.x);
+            by.push_back(b.y);
+            owner.push_back(idx);
+        };
+        for (std::size_t i = 1; i < pts.size(); ++i) {
+            add(pts[i - 1], pts[i]);
+        }
+        if (lp->closed && pts.size() > 2) {
+            add(pts.back(), pts.front());
+        }
+    }
+
+    // counting sort of segments into the cells their bounding box covers;
+    // filling in segment order keeps every cell list ascending
+    constexpr auto cells = static_cast<std::size_t>(grid_size * grid_size);
+    cell_start.assign(cells + 1, 0);
+    const auto for_cells = [this](const std::size_t s, const auto& fn) {
+        int x0 = 0;
+        int x1 = 0;
+        int y0 = 0;
+        int y1 = 0;
+        cell_range(std::min(ax[s], bx[s]), std::max(ax[s], bx[s]), x0, x1);
+        cell_range(std::min(ay[s], by[s]), std::max(ay[s], by[s]), y0, y1);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                fn(static_cast<std::size_t>(y * grid_size + x));
+            }
+        }
+    };
+
+    for (std::size_t s = 0; s < ax.size(); ++s) {
+        for_cells(s, [this](const std::size_t c) { ++cell_start[c + 1]; });
+    }
+    for (std::size_t c = 0; c < cells; ++c) {
+        cell_start[c + 1] += cell_start[c];
+    }
+    cell_segments.resize(cell_start[cells]);
+    std::vector<std::uint32_t> fill(cell_start.begin(), cell_start.end() - 1);
+    for (std::size_t s = 0; s < ax.size(); ++s) {
+        for_cells(s, [&](const std::size_t c) {
+            cell_segments[fill[c]++] = static_cast<std::uint32_t>(s);
+        });
+    }
+}
+
+void yodau::backend::line_set::query(
+    const bbox& area, std::vector<std::uint32_t>& out
+) const {
+    out.clear();
+    if (empty()) {
+        return;
+    }
+
+    int x0 = 0;
+    int x1 = 0;
+    int y0 = 0;
+    int y1 = 0;
+    cell_range(area.min_x, area.max_x, x0, x1);
+    cell_range(area.min_y, area.max_y, y0, y1);
+
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            const auto c = static_cast<std::size_t>(y * grid_size + x);
+            for (auto i = cell_start[c]; i < cell_start[c + 1]; ++i) {
+                const auto s = cell_segments[i];
+                const bbox seg { std::min(ax[s], bx[s]), std::min(ay[s], by[s]),
+                                 std::max(ax[s], bx[s]),
+                                 std::max(ay[s], by[s]) };
+                if (seg.overlaps(area)) {
+                    out.push_back(s);
+                }
+            }
+        }
+    }
+
+    // a segment spanning several queried cells is listed once per cell
+    std::ranges::sort(out);
+    const auto dup = std::ranges::unique(out);
+    out.erase(dup.begin(), dup.end());
+}
+
+void yodau::backend::line_set::cell_range(
+    const float lo, const float hi, int& first, int& last
+) {
+    constexpr float cell = 100.0f / static_cast<float>(grid_size);
+    const auto to_cell = [](const float v) {
+        const auto c = static_cast<int>(std::floor(v / cell));
+        return std::clamp(c, 0, grid_size - 1);
+    };
+    first = to_cell(lo);
+    last = to_cell(hi);
+}
@@ -0,0 +1,100 @@
+#include "motion_heatmap.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// weight growth after which the cells are rescaled, well within float
+// precision of the accumulated sums
+constexpr float max_weight { 65536.0f };
+} // namespace
+
+yodau::backend::motion_heatmap::motion_heatmap(
+    const clock::duration half_life
+)
+    : half_life(half_life) { }
+
+void yodau::backend::motion_heatmap::set_half_life(
+    const clock::duration hl
+) {
+    if (count > 0) {
+        // values at the last sample stay the same
+        rebase(last);
+    }
+    half_life = hl;
+}
+
+float yodau::backend::motion_heatmap::weight_at(
+    const clock::time_point ts
+) const {
+    if (half_life.count() <= 0) {
+        return 1.0f;
+    }
+    const auto lives = std::chrono::duration<double>(ts - origin)
+        / std::chrono::duration<double>(half_life);
+    return static_cast<float>(std::exp2(lives));
+}
+
+void yodau::backend::motion_heatmap::rebase(const clock::time_point ts) {
+    const float scale = 1.0f / weight_at(ts);
+    for (auto& v : acc) {
+        v *= scale;
+    }
+    origin = ts;
+}
+
+void yodau::backend::motion_heatmap::add(
+    const activity_grid& grid, const clock::time_point ts
+) {
+    if (count == 0) {
+        origin = ts;
+    }
+    float w = weight_at(ts);
+    if (w > max_weight) {
+        rebase(ts);
+        w = 1.0f;
+    }
+    for (std::size_t i = 0; i < acc.size(); ++i) {
+        acc[i] += w * static_cast<float>(grid.cells[i]);
+    }
+    last = ts;
+    ++count;
+}
+
+yodau::backend::motion_heatmap::cells_type
+yodau::backend::motion_heatmap::values(const clock::time_point now) const {
+    cells_type out {};
+    if (count == 0) {
+        return out;
+    }
+    const float scale = 1.0f / weight_at(now);
+    for (std::size_t i = 0; i < acc.size(); ++i) {
+        out[i] = acc[i] * scale;
+    }
+    return out;
+}
+
+yodau::backend::activity_grid
+yodau::backend::motion_heatmap::normalized() const {
+    activity_grid out;
+    const float hottest = *std::ranges::max_element(acc);
+    if (hottest <= 0.0f) {
+        return out;
+    }
+    const float scale = 255.0f / hottest;
+    for (std::size_t i = 0; i < acc.size(); ++i) {
+        out.cells[i] = static_cast<std::uint8_t>(
+            std::lround(std::min(255.0f, acc[i] * scale))
+        );
+    }
+    return out;
+}
+
+void yodau::backend::motion_heatmap::write_pgm(std::ostream& out) const {
+    const auto grid = normalized();
+    out << "P5\n" << cols << ' ' << rows << "\n255\n";
+    out.write(
+        reinterpret_cast<const char*>(grid.cells.data()),
+        static_cast<std::streamsize>(grid.cells.size())
+    );
+}
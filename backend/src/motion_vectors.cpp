@@ -0,0 +1,29 @@
+#include "motion_vectors.hpp"
+
+#include <algorithm>
+
+double yodau::backend::moving_area(
+    const std::vector<motion_vector>& mvs, const int width, const int height,
+    const float min_magnitude
+) {
+    if (width <= 0 || height <= 0) {
+        return 0.0;
+    }
+
+    const float min_sq = min_magnitude * min_magnitude;
+    long long covered = 0;
+    long long moving = 0;
+    for (const auto& mv : mvs) {
+        const long long area = static_cast<long long>(mv.w) * mv.h;
+        covered += area;
+        if (mv.dx * mv.dx + mv.dy * mv.dy >= min_sq) {
+            moving += area;
+        }
+    }
+
+    const long long total = static_cast<long long>(width) * height;
+    moving += std::max(0LL, total - covered);
+    return std::min(
+        1.0, static_cast<double>(moving) / static_cast<double>(total)
+    );
+}
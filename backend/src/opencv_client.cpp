@@ -2,10 +2,14 @@
 
 #include "opencv_client.hpp"
 
+#include <algorithm>
 #include <charconv>
 #include <filesystem>
+#include <utility>
 
 #ifdef __linux__
+#include "v4l2_capture.hpp"
+
 #include <fcntl.h>
 #include <linux/videodev2.h>
 #include <sys/ioctl.h>
@@ -45,6 +49,99 @@ namespace {
 }
 #endif
 
+namespace {
+    // wrap frame pixels without copying; code is the cvtColor code to gray,
+    // or -1 if the frame already is gray
+    cv::Mat frame_mat(const frame& f, int& code) {
+        int type = CV_8UC3;
+        switch (f.format) {
+        case pixel_format::gray8:
+            type = CV_8UC1;
+            code = -1;
+            break;
+        case pixel_format::yuyv422:
+            type = CV_8UC2;
+            code = cv::COLOR_YUV2GRAY_YUYV;
+            break;
+        case pixel_format::rgb24:
+            code = cv::COLOR_RGB2GRAY;
+            break;
+        case pixel_format::rgba32:
+            type = CV_8UC4;
+            code = cv::COLOR_RGBA2GRAY;
+            break;
+        case pixel_format::bgra32:
+            type = CV_8UC4;
+            code = cv::COLOR_BGRA2GRAY;
+            break;
+        default:
+            code = cv::COLOR_BGR2GRAY;
+            break;
+        }
+        return { f.height, f.width, type,
+                 const_cast<std::uint8_t*>(f.bytes()),
+                 static_cast<size_t>(f.stride) };
+    }
+
+    // gray input is copied as well: references are kept across frames and
+    // must not point into capture buffers
+    void to_gray(const cv::Mat& src, cv::Mat& dst, const int code) {
+        if (code < 0) {
+            src.copyTo(dst);
+        } else {
+            cv::cvtColor(src, dst, code);
+        }
+    }
+
+    // the FFmpeg backend reports the container tag ("MJPG" in AVI/MOV) or,
+    // without one (HTTP multipart, raw .mjpeg), the codec name ("mjpeg")
+    bool is_mjpeg_fourcc(const int fourcc) {
+        return fourcc == cv::VideoWriter::fourcc('M', 'J', 'P', 'G')
+            || fourcc == cv::VideoWriter::fourcc('m', 'j', 'p', 'g')
+            || fourcc == cv::VideoWriter::fourcc('m', 'j', 'p', 'e');
+    }
+
+    // FOURCC first: many drivers only offer larger sizes or higher rates
+    // in compressed formats
+    void apply_format(cv::VideoCapture& cap, const capture_format& want) {
+        if (const auto code = want.fourcc_code(); code != 0) {
+            cap.set(cv::CAP_PROP_FOURCC, static_cast<double>(code));
+        }
+        if (want.width > 0 && want.height > 0) {
+            cap.set(cv::CAP_PROP_FRAME_WIDTH, want.width);
+            cap.set(cv::CAP_PROP_FRAME_HEIGHT, want.height);
+        }
+        if (want.fps > 0.0) {
+            cap.set(cv::CAP_PROP_FPS, want.fps);
+        }
+    }
+
+    capture_format read_format(const cv::VideoCapture& cap) {
+        capture_format out;
+        out.width = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH));
+        out.height = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_HEIGHT));
+        out.fps = cap.get(cv::CAP_PROP_FPS);
+        const auto code
+            = static_cast<std::int64_t>(cap.get(cv::CAP_PROP_FOURCC));
+        out.fourcc
+            = capture_format::fourcc_name(static_cast<std::uint32_t>(code));
+        return out;
+    }
+
+    int reduced_gray_flag(const int reduction) {
+        switch (reduction) {
+        case 2:
+            return cv::IMREAD_REDUCED_GRAYSCALE_2;
+        case 4:
+            return cv::IMREAD_REDUCED_GRAYSCALE_4;
+        case 8:
+            return cv::IMREAD_REDUCED_GRAYSCALE_8;
+        default:
+            return cv::IMREAD_GRAYSCALE;
+        }
+    }
+}
+
 int opencv_client::local_index_from_path(const std::string& path) const {
     const std::string pref = "/dev/video";
     if (path.rfind(pref, 0) != 0) {
@@ -91,144 +188,242 @@ frame opencv_client::mat_to_frame(const cv::Mat& m) const {
     return f;
 }
 
+bool opencv_client::use_reduced_jpeg(cv::VideoCapture& cap) const {
+    if (get_analysis_width() <= 0) {
+        return false;
+    }
+    if (!is_mjpeg_fourcc(static_cast<int>(cap.get(cv::CAP_PROP_FOURCC)))) {
+        return false;
+    }
+    // -1 makes the FFmpeg backend hand out demuxed packets undecoded
+    return cap.set(cv::CAP_PROP_FORMAT, -1);
+}
+
+bool opencv_client::retrieve_frame(
+    cv::VideoCapture& cap, const bool reduced_jpeg, cv::Mat& m, frame& out
+) const {
+    if (!cap.retrieve(m) || m.empty()) {
+        return false;
+    }
+    if (!reduced_jpeg) {
+        out = mat_to_frame(m);
+        return true;
+    }
+
+    // one encoded image as a row of bytes
+    return m.isContinuous()
+        && decode_jpeg(m.data, m.total() * m.elemSize(), out);
+}
+
+bool opencv_client::decode_jpeg(
+    const std::uint8_t* data, const std::size_t size, frame& out
+) const {
+    int width = 0;
+    int height = 0;
+    if (!jpeg_dimensions(data, size, width, height)) {
+        return false;
+    }
+    const int reduction = jpeg_reduction(width, get_analysis_width());
+    const cv::Mat encoded(
+        1, static_cast<int>(size), CV_8UC1, const_cast<std::uint8_t*>(data)
+    );
+    const cv::Mat gray = cv::imdecode(encoded, reduced_gray_flag(reduction));
+    if (gray.empty()) {
+        return false;
+    }
+
+    out = frame {};
+    out.width = gray.cols;
+    out.height = gray.rows;
+    out.stride = static_cast<int>(gray.step);
+    out.format = pixel_format::gray8;
+    out.ts = std::chrono::steady_clock::now();
+    out.data.assign(gray.data, gray.data + gray.total() * gray.elemSize());
+    return true;
+}
+
 void opencv_client::daemon_start(
     const stream& s, const std::function<void(frame&&)>& on_frame,
-    const std::stop_token& st
+    const std::function<bool()>& wants_frame, const std::stop_token& st
 ) {
     const auto path = s.get_path();
     cv::VideoCapture cap;
 
     const auto idx = local_index_from_path(path);
+#ifdef __linux__
+    if (idx >= 0 && run_v4l2(s, on_frame, wants_frame, st)) {
+        return;
+    }
+#endif
+    // decoding runs inside the backend; size its threads from the budget
+    decode_budget::lease decode_threads;
+    std::vector<int> open_params;
     if (idx >= 0) {
         cap.open(idx);
     } else {
-        cap.open(path);
+        // the size is only known once the source is open: start from the
+        // stream's format and reopen if the probed size changes the lease
+        decode_threads = global_decode_budget().acquire(s);
+        const int guess = decode_threads.threads();
+        open_params = { cv::CAP_PROP_N_THREADS, guess };
+        if (cap.open(path, cv::CAP_ANY, open_params)) {
+            global_decode_budget().reacquire(
+                decode_threads, s.get_name(),
+                static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH)),
+                static_cast<int>(cap.get(cv::CAP_PROP_FRAME_HEIGHT))
+            );
+            if (decode_threads.threads() != guess) {
+                open_params[1] = decode_threads.threads();
+                cap.release();
+                cap.open(path, cv::CAP_ANY, open_params);
+            }
+        }
     }
 
     if (!cap.isOpened()) {
         return;
     }
+    if (idx >= 0) {
+        apply_format(cap, s.requested_format());
+    }
+    s.report_negotiated_format(read_format(cap));
+    bool reduced_jpeg = idx < 0 && use_reduced_jpeg(cap);
+
+    const bool is_network = s.get_type() == stream_type::rtsp
+        || s.get_type() == stream_type::http;
+    if (is_network && get_low_latency()) {
+        // keep as little as possible queued inside the backend
+        cap.set(cv::CAP_PROP_BUFFERSIZE, 1);
+        source_clock clock;
+        cv::Mat m;
+        deliver_latest(
+            [&](std::optional<frame>& out) {
+                if (!cap.grab()) {
+                    return false;
+                }
+                if (wants_frame && !wants_frame()) {
+                    return true;
+                }
+                frame f;
+                if (!retrieve_frame(cap, reduced_jpeg, m, f)) {
+                    return true;
+                }
+                out = std::move(f);
+                out->pts_ms = cap.get(cv::CAP_PROP_POS_MSEC);
+                out->ts = clock.map(out->pts_ms, out->ts);
+                return true;
+            },
+            on_frame, st
+        );
+        return;
+    }
+
+    const bool is_file = s.get_type() == stream_type::file;
+    playback_clock pacing(cap.get(cv::CAP_PROP_FPS));
+    bool got_frame = false;
 
     cv::Mat m;
     while (!st.stop_requested()) {
-        if (!cap.read(m) || m.empty()) {
-            if (s.is_looping() && s.get_type() == stream_type::file) {
-                cap.set(cv::CAP_PROP_POS_FRAMES, 0);
-                continue;
+        if (!cap.grab()) {
+            // a loop pass without a single frame means the file is unusable
+            if (!is_file || !s.is_looping() || !got_frame) {
+                break;
             }
-            break;
+            got_frame = false;
+            pacing.restart();
+            // seeking keeps the demuxer and decoder; reopen only as fallback
+            if (!cap.set(cv::CAP_PROP_POS_FRAMES, 0)) {
+                cap.release();
+                if (!cap.open(path, cv::CAP_ANY, open_params)) {
+                    break;
+                }
+                reduced_jpeg = use_reduced_jpeg(cap);
+            }
+            continue;
         }
+        got_frame = true;
 
-        auto f = mat_to_frame(m);
-        on_frame(std::move(f));
-    }
-}
-
-float opencv_client::cross_z(
-    const point& a, const point& b, const point& c
-) const {
-    const float abx = b.x - a.x;
-    const float aby = b.y - a.y;
-    const float acx = c.x - a.x;
-    const float acy = c.y - a.y;
-    return abx * acy - aby * acx;
-}
-
-int opencv_client::orient(
-    const point& a, const point& b, const point& c
-) const {
-    const float v = cross_z(a, b, c);
-    if (v > point::epsilon) {
-        return 1;
-    }
-    if (v < -point::epsilon) {
-        return -1;
-    }
-    return 0;
-}
-
-bool opencv_client::between(float a, float b, float c) const {
-    return (a <= c + point::epsilon && c <= b + point::epsilon)
-        || (b <= c + point::epsilon && c <= a + point::epsilon);
-}
-
-bool opencv_client::on_segment(
-    const point& a, const point& b, const point& c
-) const {
-    return orient(a, b, c) == 0 && between(a.x, b.x, c.x)
-        && between(a.y, b.y, c.y);
-}
-
-bool opencv_client::segments_intersect(
-    const point& p1, const point& p2, const point& q1, const point& q2
-) const {
-    const int o1 = orient(p1, p2, q1);
-    const int o2 = orient(p1, p2, q2);
-    const int o3 = orient(q1, q2, p1);
-    const int o4 = orient(q1, q2, p2);
-
-    if (o1 != o2 && o3 != o4) {
-        return true;
-    }
+        if (is_file && get_playback_mode() == playback_mode::realtime) {
+            const auto due = pacing.due(
+                cap.get(cv::CAP_PROP_POS_MSEC), std::chrono::steady_clock::now()
+            );
+            if (!playback_clock::sleep_until(due, st)) {
+                break;
+            }
+        }
 
-    if (o1 == 0 && on_segment(p1, p2, q1)) {
-        return true;
-    }
-    if (o2 == 0 && on_segment(p1, p2, q2)) {
-        return true;
-    }
-    if (o3 == 0 && on_segment(q1, q2, p1)) {
-        return true;
-    }
-    if (o4 == 0 && on_segment(q1, q2, p2)) {
-        return true;
+        // grab() only advances the source; retrieve() (color conversion and
+        // copy out of the backend) is paid for frames that will be used
+        if (wants_frame && !wants_frame()) {
+            continue;
+        }
+        frame f;
+        if (!retrieve_frame(cap, reduced_jpeg, m, f)) {
+            continue;
+        }
+        f.pts_ms = cap.get(cv::CAP_PROP_POS_MSEC);
+        on_frame(std::move(f));
     }
-
-    return false;
 }
 
-std::optional<point> opencv_client::segment_intersection(
-    const point& p1, const point& p2, const point& q1, const point& q2
-) const {
-    const float rpx = p2.x - p1.x;
-    const float rpy = p2.y - p1.y;
-    const float spx = q2.x - q1.x;
-    const float spy = q2.y - q1.y;
-
-    const float den = rpx * spy - rpy * spx;
-    if (std::abs(den) <= point::epsilon) {
-        return {};
+#ifdef __linux__
+bool opencv_client::run_v4l2(
+    const stream& s, const std::function<void(frame&&)>& on_frame,
+    const std::function<bool()>& wants_frame, const std::stop_token& st
+) {
+    v4l2_capture cap;
+    const auto cfg = v4l2_capture::config::for_format(s.requested_format());
+    if (!cap.open(s.get_path(), cfg)) {
+        return false;
     }
+    s.report_negotiated_format(cap.negotiated());
 
-    const float qpx = q1.x - p1.x;
-    const float qpy = q1.y - p1.y;
-
-    const float t = (qpx * spy - qpy * spx) / den;
-    const float u = (qpx * rpy - qpy * rpx) / den;
+    // short poll timeout so that stop requests are noticed promptly
+    constexpr int poll_ms = 100;
+    while (!st.stop_requested()) {
+        if (wants_frame && !wants_frame()) {
+            if (cap.drop(poll_ms) == v4l2_capture::read_result::error) {
+                break;
+            }
+            continue;
+        }
 
-    if (t < -point::epsilon || t > 1.0f + point::epsilon) {
-        return {};
-    }
-    if (u < -point::epsilon || u > 1.0f + point::epsilon) {
-        return {};
+        frame f;
+        const auto res = cap.read(f, poll_ms);
+        if (res == v4l2_capture::read_result::error) {
+            break;
+        }
+        if (res == v4l2_capture::read_result::ok) {
+            on_frame(std::move(f));
+        }
     }
-
-    point out;
-    out.x = p1.x + t * rpx;
-    out.y = p1.y + t * rpy;
-    return out;
+    return true;
 }
+#endif
 
 void opencv_client::add_motion_event(
-    std::vector<event>& out, const std::string& stream_name,
+    event_batch& out, const std::uint32_t stream_id,
     const std::chrono::steady_clock::time_point ts, const point& pos_pct
 ) const {
-    event e;
+    compact_event e;
     e.kind = event_kind::motion;
-    e.stream_name = stream_name;
+    e.stream = stream_id;
+    e.ts = ts;
+    e.x = pos_pct.x;
+    e.y = pos_pct.y;
+    out.push_back(e);
+}
+
+void opencv_client::add_motion_grid_event(
+    event_batch& out, const std::uint32_t stream_id,
+    const std::chrono::steady_clock::time_point ts, const activity_grid& grid
+) const {
+    compact_event e;
+    e.kind = event_kind::motion_grid;
+    e.stream = stream_id;
     e.ts = ts;
-    e.pos_pct = pos_pct;
-    out.push_back(std::move(e));
+    e.grid = out.add_grid(grid);
+    out.push_back(e);
 }
 
 void opencv_client::consider_hit(
@@ -250,37 +445,21 @@ void opencv_client::consider_hit(
 
 void opencv_client::test_line_segment_against_contour(
     bool& hit, float& best_dist2, point& best_a, point& best_b, point& best_pos,
-    const point& cur_pos_pct, const std::vector<point>& contour_pct,
-    const point& a, const point& b
+    const point& cur_pos_pct, const segment_batch& contour_edges,
+    segment_hits& scratch, const point& a, const point& b
 ) const {
-    if (contour_pct.size() < 2) {
+    if (intersect_segments(a, b, contour_edges, scratch) == 0) {
         return;
     }
 
-    for (size_t j = 1; j < contour_pct.size(); ++j) {
-        const auto& c1 = contour_pct[j - 1];
-        const auto& c2 = contour_pct[j];
-
-        if (segments_intersect(a, b, c1, c2)) {
-            point ip = cur_pos_pct;
-            const auto inter = segment_intersection(a, b, c1, c2);
-            if (inter.has_value()) {
-                ip = *inter;
-            }
-
-            consider_hit(
-                hit, best_dist2, best_a, best_b, best_pos, cur_pos_pct, a, b, ip
-            );
+    for (size_t j = 0; j < contour_edges.size(); ++j) {
+        if (!scratch.hit[j]) {
+            continue;
         }
-    }
-
-    const auto& c_last = contour_pct.back();
-    const auto& c_first = contour_pct.front();
-    if (segments_intersect(a, b, c_last, c_first)) {
         point ip = cur_pos_pct;
-        const auto inter = segment_intersection(a, b, c_last, c_first);
-        if (inter.has_value()) {
-            ip = *inter;
+        if (scratch.has_t[j]) {
+            const float t = scratch.t[j];
+            ip = { a.x + t * (b.x - a.x), a.y + t * (b.y - a.y) };
         }
 
         consider_hit(
@@ -290,15 +469,15 @@ void opencv_client::test_line_segment_against_contour(
 }
 
 void opencv_client::process_tripwire_for_line(
-    std::vector<event>& out, const stream& s, const line& l,
-    const point& prev_pos, const point& cur_pos_pct,
-    const std::vector<point>& contour_pct,
-    const std::chrono::steady_clock::time_point now
+    event_batch& out, const stream& s, const line_set& lines,
+    const std::span<const std::uint32_t> segments, const point& prev_pos,
+    const point& cur_pos_pct, const segment_batch& contour_edges,
+    segment_hits& scratch, const std::chrono::steady_clock::time_point now
 ) {
-    const auto& pts = l.points;
-    if (pts.size() < 2) {
+    if (segments.empty()) {
         return;
     }
+    const auto& l = lines.line_at(lines.segment_line(segments.front()));
 
     bool hit = false;
     point best_a {};
@@ -306,83 +485,112 @@ void opencv_client::process_tripwire_for_line(
     point best_pos = cur_pos_pct;
     float best_dist2 = std::numeric_limits<float>::max();
 
-    for (size_t i = 1; i < pts.size(); ++i) {
+    for (const auto seg : segments) {
         test_line_segment_against_contour(
-            hit, best_dist2, best_a, best_b, best_pos, cur_pos_pct, contour_pct,
-            pts[i - 1], pts[i]
+            hit, best_dist2, best_a, best_b, best_pos, cur_pos_pct,
+            contour_edges, scratch, lines.segment_a(seg), lines.segment_b(seg)
         );
     }
 
-    if (l.closed && pts.size() > 2) {
-        test_line_segment_against_contour(
-            hit, best_dist2, best_a, best_b, best_pos, cur_pos_pct, contour_pct,
-            pts.back(), pts.front()
+    if (hit) {
+        emit_tripwire(
+            out, s, l, best_a, best_b, best_pos, prev_pos, cur_pos_pct, now
         );
     }
+}
 
-    if (!hit) {
-        return;
+void opencv_client::process_raster_tripwires(
+    event_batch& out, const stream& s, const line_raster& raster,
+    const std::vector<line_raster::hit>& hits, const point& prev_pos,
+    const point& cur_pos_pct, const std::chrono::steady_clock::time_point now
+) {
+    const auto& lines = raster.lines();
+    struct best_hit {
+        bool found { false };
+        float dist2 { 0.0f };
+        std::uint32_t segment { 0 };
+        point pos {};
+    };
+    std::vector<best_hit> best(lines.line_count());
+
+    const float sx = 100.0f / static_cast<float>(raster.width());
+    const float sy = 100.0f / static_cast<float>(raster.height());
+    for (const auto& h : hits) {
+        // pixel center in percentage coordinates
+        const point pos { (static_cast<float>(h.x) + 0.5f) * sx,
+                          (static_cast<float>(h.y) + 0.5f) * sy };
+        const float dx = pos.x - cur_pos_pct.x;
+        const float dy = pos.y - cur_pos_pct.y;
+        const float d2 = dx * dx + dy * dy;
+        auto& b = best[lines.segment_line(h.segment)];
+        if (!b.found || d2 < b.dist2) {
+            b = { true, d2, h.segment, pos };
+        }
+    }
+
+    for (size_t i = 0; i < best.size(); ++i) {
+        const auto& b = best[i];
+        if (!b.found) {
+            continue;
+        }
+        emit_tripwire(
+            out, s, lines.line_at(i), lines.segment_a(b.segment),
+            lines.segment_b(b.segment), b.pos, prev_pos, cur_pos_pct, now
+        );
     }
+}
 
-    const float prev_side = cross_z(best_a, best_b, prev_pos);
-    const float cur_side = cross_z(best_a, best_b, cur_pos_pct);
+void opencv_client::emit_tripwire(
+    event_batch& out, const stream& s, const line& l, const point& a,
+    const point& b, const point& pos, const point& prev_pos,
+    const point& cur_pos_pct, const std::chrono::steady_clock::time_point now
+) {
+    const float prev_side = cross_z(a, b, prev_pos);
+    const float cur_side = cross_z(a, b, cur_pos_pct);
 
-    std::string dir = "flat";
+    crossing_dir dir = crossing_dir::flat;
     if (prev_side <= 0.0f && cur_side > 0.0f) {
-        dir = "neg_to_pos";
+        dir = crossing_dir::neg_to_pos;
     } else if (prev_side >= 0.0f && cur_side < 0.0f) {
-        dir = "pos_to_neg";
+        dir = crossing_dir::pos_to_neg;
     }
 
     if (l.dir == tripwire_dir::neg_to_pos) {
-        if (dir != "neg_to_pos") {
+        if (dir != crossing_dir::neg_to_pos) {
             return;
         }
     } else if (l.dir == tripwire_dir::pos_to_neg) {
-        if (dir != "pos_to_neg") {
+        if (dir != crossing_dir::pos_to_neg) {
             return;
         }
     }
 
-    const int tripwire_cooldown_ms = 1200;
-    const std::string key = s.get_name() + "|" + l.name + "|" + dir;
-
-    bool allow_tripwire = true;
+    // one bucket per direction, so a crossing back is not swallowed
+    const auto channel = static_cast<std::uint32_t>(rate_target::tripwire) * 4
+        + static_cast<std::uint32_t>(dir);
     {
         std::scoped_lock lock(mtx);
-        auto it = last_tripwire_by_key.find(key);
-        if (it != last_tripwire_by_key.end()) {
-            const auto dt
-                = std::chrono::duration_cast<std::chrono::milliseconds>(
-                      now - it->second
-                )
-                      .count();
-            if (dt < tripwire_cooldown_ms) {
-                allow_tripwire = false;
-            }
-        }
-
-        if (allow_tripwire) {
-            last_tripwire_by_key[key] = now;
+        const auto rule
+            = rate_rule_locked(rate_target::tripwire, s.get_name(), l.name);
+        const auto key = rate_key(s.get_name(), l.name, channel);
+        if (!limiter.allow(key, rule, now)) {
+            return;
         }
     }
 
-    if (!allow_tripwire) {
-        return;
-    }
-
-    event t;
+    compact_event t;
     t.kind = event_kind::tripwire;
-    t.stream_name = s.get_name();
-    t.line_name = l.name;
+    t.stream = global_names().intern(s.get_name());
+    t.line = global_names().intern(l.name);
     t.ts = now;
-    t.pos_pct = best_pos;
-    t.message = dir;
+    t.x = pos.x;
+    t.y = pos.y;
+    t.dir = dir;
 
-    std::cerr << "tripwire stream=" << t.stream_name << " line=" << t.line_name
-              << " dir=" << dir << std::endl;
+    std::cerr << "tripwire stream=" << s.get_name() << " line=" << l.name
+              << " dir=" << crossing_dir_name(dir) << std::endl;
 
-    out.push_back(std::move(t));
+    out.push_back(t);
 }
 
 std::optional<size_t> opencv_client::find_largest_contour_index(
@@ -406,263 +614,1038 @@ std::optional<size_t> opencv_client::find_largest_contour_index(
     return max_i;
 }
 
-std::vector<event>
-opencv_client::motion_processor(const stream& s, const frame& f) {
-    std::vector<event> out;
-
-    if (f.data.empty() || f.width <= 0 || f.height <= 0) {
-        return out;
+void opencv_client::set_detection_mode(const detection_mode m) {
+    std::scoped_lock lock(mtx);
+    if (mode == m) {
+        return;
     }
+    mode = m;
+    prev_gray_by_stream.clear();
+    prev_coarse_by_stream.clear();
+    signature_by_stream.clear();
+}
 
-    cv::Mat bgr(
-        f.height, f.width, CV_8UC3, const_cast<std::uint8_t*>(f.data.data()),
-        static_cast<size_t>(f.stride)
-    );
+opencv_client::detection_mode opencv_client::get_detection_mode() const {
+    std::scoped_lock lock(mtx);
+    return mode;
+}
 
-    cv::Mat gray;
-    cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
-    cv::GaussianBlur(gray, gray, cv::Size(5, 5), 0.0);
+void opencv_client::set_tripwire_mode(
+    const std::string& stream_name, const tripwire_mode m
+) {
+    std::scoped_lock lock(mtx);
+    tripwire_mode_by_stream[stream_name] = m;
+    if (m != tripwire_mode::raster) {
+        raster_by_stream.erase(stream_name);
+    }
+}
 
-    cv::Mat prev_gray;
+opencv_client::tripwire_mode
+opencv_client::get_tripwire_mode(const std::string& stream_name) const {
+    std::scoped_lock lock(mtx);
+    const auto it = tripwire_mode_by_stream.find(stream_name);
+    return it == tripwire_mode_by_stream.end() ? tripwire_mode::vector
+                                               : it->second;
+}
+
+std::shared_ptr<const line_raster> opencv_client::tripwire_raster(
+    const std::string& stream_name,
+    const std::shared_ptr<const line_set>& lines, const int width,
+    const int height
+) {
     {
         std::scoped_lock lock(mtx);
-        auto it = prev_gray_by_stream.find(s.get_name());
-        if (it == prev_gray_by_stream.end()) {
-            prev_gray_by_stream.emplace(s.get_name(), gray.clone());
-            return out;
+        const auto it = raster_by_stream.find(stream_name);
+        if (it != raster_by_stream.end()
+            && it->second->matches(lines, width, height)) {
+            return it->second;
         }
-        prev_gray = it->second;
-        it->second = gray.clone();
     }
 
-    cv::Mat diff;
-    cv::absdiff(prev_gray, gray, diff);
-    cv::threshold(diff, diff, 25, 255, cv::THRESH_BINARY);
-
-    cv::erode(diff, diff, cv::Mat(), cv::Point(-1, -1), 1);
-    cv::dilate(diff, diff, cv::Mat(), cv::Point(-1, -1), 2);
+    // built outside the lock; connections and resolution rarely change
+    auto raster = std::make_shared<const line_raster>(lines, width, height);
+    std::scoped_lock lock(mtx);
+    raster_by_stream[stream_name] = raster;
+    return raster;
+}
 
-    std::vector<std::vector<cv::Point>> contours;
-    cv::findContours(
-        diff, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE
-    );
+void opencv_client::set_roi_config(const occupancy_config& cfg) {
+    std::scoped_lock lock(mtx);
+    roi_cfg = cfg;
+}
 
-    if (contours.empty()) {
-        return out;
-    }
+occupancy_config opencv_client::get_roi_config() const {
+    std::scoped_lock lock(mtx);
+    return roi_cfg;
+}
 
-    const auto max_i_opt = find_largest_contour_index(contours);
-    if (!max_i_opt.has_value()) {
-        return out;
+void opencv_client::set_rate_rule(
+    const rate_target t, const std::string& stream_name,
+    const std::string& line_name, const rate_rule& rule
+) {
+    std::scoped_lock lock(mtx);
+    if (stream_name.empty()) {
+        (t == rate_target::motion ? motion_rate : tripwire_rate) = rule;
+        return;
     }
+    rate_overrides[rate_key(
+        stream_name, line_name, static_cast<std::uint32_t>(t)
+    )] = rule;
+}
 
-    const size_t max_i = *max_i_opt;
-    const double max_area = cv::contourArea(contours[max_i]);
+rate_rule opencv_client::get_rate_rule(
+    const rate_target t, const std::string& stream_name,
+    const std::string& line_name
+) const {
+    std::scoped_lock lock(mtx);
+    return rate_rule_locked(t, stream_name, line_name);
+}
 
-    const double min_area = 0.001 * static_cast<double>(diff.rows * diff.cols);
-    if (max_area < min_area) {
-        return out;
+rate_rule opencv_client::rate_rule_locked(
+    const rate_target t, const std::string_view stream_name,
+    const std::string_view line_name
+) const {
+    const auto channel = static_cast<std::uint32_t>(t);
+    if (!rate_overrides.empty()) {
+        if (!line_name.empty()) {
+            const auto it = rate_overrides.find(
+                rate_key(stream_name, line_name, channel)
+            );
+            if (it != rate_overrides.end()) {
+                return it->second;
+            }
+        }
+        const auto it = rate_overrides.find(rate_key(stream_name, {}, channel));
+        if (it != rate_overrides.end()) {
+            return it->second;
+        }
     }
+    return t == rate_target::motion ? motion_rate : tripwire_rate;
+}
 
-    std::vector<cv::Point> approx;
+std::shared_ptr<const region_set> opencv_client::stream_regions(
+    const std::string& stream_name,
+    const std::shared_ptr<const line_set>& lines, const int width,
+    const int height
+) {
     {
-        const double eps = 3.0;
-        cv::approxPolyDP(contours[max_i], approx, eps, true);
-    }
-
-    std::vector<point> contour_pct;
-    contour_pct.reserve(approx.size());
-
-    for (const auto& pt : approx) {
-        point p;
-        p.x = static_cast<float>(pt.x) * 100.0f / static_cast<float>(f.width);
-        p.y = static_cast<float>(pt.y) * 100.0f / static_cast<float>(f.height);
-        contour_pct.push_back(p);
+        std::scoped_lock lock(mtx);
+        const auto it = rois_by_stream.find(stream_name);
+        if (it != rois_by_stream.end()
+            && it->second.regions->matches(lines, width, height)) {
+            return it->second.regions;
+        }
     }
 
-    struct bbox2f {
-        float min_x;
-        float min_y;
-        float max_x;
-        float max_y;
-    };
-
-    bbox2f motion_box {};
-    bool motion_box_ok = false;
-
-    if (!contour_pct.empty()) {
-        motion_box.min_x = 100.0f;
-        motion_box.min_y = 100.0f;
-        motion_box.max_x = 0.0f;
-        motion_box.max_y = 0.0f;
-
-        for (const auto& p : contour_pct) {
-            if (p.x < motion_box.min_x) {
-                motion_box.min_x = p.x;
-            }
-            if (p.y < motion_box.min_y) {
-                motion_box.min_y = p.y;
-            }
-            if (p.x > motion_box.max_x) {
-                motion_box.max_x = p.x;
-            }
-            if (p.y > motion_box.max_y) {
-                motion_box.max_y = p.y;
+    auto regions = std::make_shared<const region_set>(lines, width, height);
+    std::scoped_lock lock(mtx);
+    auto& rois = rois_by_stream[stream_name];
+
+    // a region keeps its state across rebuilds (another line published, a
+    // new analysis size), so an entered region can still exit
+    std::vector<region_occupancy> occupancy(regions->size());
+    if (rois.regions) {
+        for (size_t i = 0; i < regions->size(); ++i) {
+            const auto& name = regions->line_at(i).name;
+            for (size_t j = 0; j < rois.regions->size(); ++j) {
+                if (rois.regions->line_at(j).name == name) {
+                    occupancy[i] = rois.occupancy[j];
+                    break;
+                }
             }
         }
-
-        motion_box_ok = true;
     }
+    rois.regions = regions;
+    rois.occupancy = std::move(occupancy);
+    return regions;
+}
 
-    const int nz = cv::countNonZero(diff);
-    const int total = diff.rows * diff.cols;
-    const double ratio = total > 0 ? static_cast<double>(nz) / total : 0.0;
-
-    if (ratio < 0.01) {
-        return out;
+void opencv_client::process_regions(
+    event_batch& out, const stream& s, const region_set& regions,
+    const bit_mask* packed, const cv::Mat& mask,
+    const std::chrono::steady_clock::time_point now
+) {
+    std::vector<double> ratios(regions.size(), 0.0);
+    for (size_t i = 0; i < regions.size(); ++i) {
+        const auto& m = regions.mask_at(i);
+        if (m.area() == 0) {
+            continue;
+        }
+        const long long n = packed
+            ? m.count_in(*packed)
+            : m.count_in(mask.ptr<std::uint8_t>(0), mask.step);
+        ratios[i] = static_cast<double>(n) / static_cast<double>(m.area());
     }
+    update_regions(out, s, regions, ratios, now);
+}
 
-    const double min_ratio = 0.02;
-    const int cooldown_ms = 150;
-
-    if (ratio < min_ratio) {
-        return out;
+void opencv_client::process_regions(
+    event_batch& out, const stream& s,
+    const std::chrono::steady_clock::time_point now
+) {
+    std::shared_ptr<const region_set> regions;
+    {
+        std::scoped_lock lock(mtx);
+        const auto it = rois_by_stream.find(s.get_name());
+        if (it == rois_by_stream.end() || it->second.regions->empty()) {
+            return;
+        }
+        regions = it->second.regions;
     }
+    const std::vector<double> idle(regions->size(), 0.0);
+    update_regions(out, s, *regions, idle, now);
+}
 
-    const auto now = std::chrono::steady_clock::now();
+void opencv_client::update_regions(
+    event_batch& out, const stream& s, const region_set& regions,
+    const std::span<const double> ratios,
+    const std::chrono::steady_clock::time_point now
+) {
+    std::vector<std::pair<size_t, region_occupancy::change>> changes;
     {
         std::scoped_lock lock(mtx);
-        auto it = last_emit_by_stream.find(s.get_name());
-        if (it != last_emit_by_stream.end()) {
-            const auto dt
-                = std::chrono::duration_cast<std::chrono::milliseconds>(
-                      now - it->second
-                )
-                      .count();
-            if (dt < cooldown_ms) {
-                return out;
+        const auto it = rois_by_stream.find(s.get_name());
+        if (it == rois_by_stream.end()
+            || it->second.regions.get() != &regions) {
+            // rebuilt meanwhile; the new regions start from scratch
+            return;
+        }
+        auto& occupancy = it->second.occupancy;
+        for (size_t i = 0; i < regions.size(); ++i) {
+            const auto c = occupancy[i].update(ratios[i], now, roi_cfg);
+            if (c != region_occupancy::change::none) {
+                changes.emplace_back(i, c);
             }
         }
-        last_emit_by_stream[s.get_name()] = now;
     }
 
-    cv::Moments mm = cv::moments(contours[max_i]);
-    double cx = 0.0;
-    double cy = 0.0;
-    if (mm.m00 > 0.0) {
-        cx = mm.m10 / mm.m00;
-        cy = mm.m01 / mm.m00;
-    } else {
-        cx = static_cast<double>(f.width) * 0.5;
-        cy = static_cast<double>(f.height) * 0.5;
+    auto& names = global_names();
+    for (const auto& [i, c] : changes) {
+        std::string_view message = "occupied";
+        if (c == region_occupancy::change::enter) {
+            message = "enter";
+        } else if (c == region_occupancy::change::exit) {
+            message = "exit";
+        }
+
+        const auto& l = regions.line_at(i);
+        const auto center = regions.mask_at(i).centroid();
+        compact_event e;
+        e.kind = event_kind::roi;
+        e.stream = names.intern(s.get_name());
+        e.line = names.intern(l.name);
+        e.message = names.intern(message);
+        e.ts = now;
+        e.x = center.x;
+        e.y = center.y;
+        out.push_back(e);
     }
+}
 
-    const point cur_pos_pct { static_cast<float>(cx * 100.0 / f.width),
-                              static_cast<float>(cy * 100.0 / f.height) };
+void opencv_client::set_pyramid_levels(const int levels) {
+    if (levels < 1 || levels > 5) {
+        return;
+    }
+    std::scoped_lock lock(mtx);
+    if (pyramid_levels == levels) {
+        return;
+    }
+    pyramid_levels = levels;
+    prev_coarse_by_stream.clear();
+}
 
-    point prev_pos {};
-    bool has_prev = false;
+void opencv_client::set_pyramid_activation(const double ratio) {
+    if (ratio < 0.0 || ratio > 1.0) {
+        return;
+    }
+    std::scoped_lock lock(mtx);
+    pyramid_activation = ratio;
+}
+
+bool opencv_client::full_motion_mask(
+    const std::string& stream_name, const cv::Mat& gray, cv::Mat& mask
+) {
+    cv::Mat blurred;
+    cv::GaussianBlur(gray, blurred, cv::Size(5, 5), 0.0);
+
+    cv::Mat prev_gray;
     {
         std::scoped_lock lock(mtx);
-        auto it = last_pos_by_stream.find(s.get_name());
-        if (it != last_pos_by_stream.end()) {
-            prev_pos = it->second;
-            has_prev = true;
+        auto it = prev_gray_by_stream.find(stream_name);
+        if (it == prev_gray_by_stream.end()
+            || it->second.size() != blurred.size()) {
+            prev_gray_by_stream[stream_name] = blurred;
+            return false;
         }
-        last_pos_by_stream[s.get_name()] = cur_pos_pct;
+        prev_gray = it->second;
+        it->second = blurred;
+    }
+
+    cv::absdiff(prev_gray, blurred, mask);
+    cv::threshold(mask, mask, diff_threshold, 255, cv::THRESH_BINARY);
+    return true;
+}
+
+bool opencv_client::pyramid_motion_mask(
+    const std::string& stream_name, const cv::Mat& gray, cv::Mat& mask
+) {
+    int levels = 0;
+    double activation = 0.0;
+    {
+        std::scoped_lock lock(mtx);
+        levels = pyramid_levels;
+        activation = pyramid_activation;
     }
 
-    if (has_prev) {
-        const auto lines = s.lines_snapshot();
-        for (const auto& lp : lines) {
-            if (!lp) {
+    cv::Mat coarse = gray;
+    for (int i = 0; i < levels; ++i) {
+        cv::Mat next;
+        cv::pyrDown(coarse, next);
+        coarse = next;
+    }
+
+    // the references are swapped for copies owned by the map, so no matrix
+    // is shared between frames or written outside the lock
+    cv::Mat full = gray.clone();
+    cv::Mat prev_coarse;
+    cv::Mat prev_full;
+    {
+        std::scoped_lock lock(mtx);
+        auto& coarse_ref = prev_coarse_by_stream[stream_name];
+        auto& full_ref = prev_gray_by_stream[stream_name];
+        prev_coarse = std::exchange(coarse_ref, coarse);
+        prev_full = std::exchange(full_ref, std::move(full));
+    }
+    if (prev_coarse.size() != coarse.size()
+        || prev_full.size() != gray.size()) {
+        return false;
+    }
+
+    cv::Mat coarse_diff;
+    cv::absdiff(prev_coarse, coarse, coarse_diff);
+    cv::threshold(
+        coarse_diff, coarse_diff, diff_threshold, 255, cv::THRESH_BINARY
+    );
+
+    const int tile = pyramid_tile_px;
+    const int tiles_x = (coarse.cols + tile - 1) / tile;
+    const int tiles_y = (coarse.rows + tile - 1) / tile;
+
+    cv::Mat active = cv::Mat::zeros(tiles_y, tiles_x, CV_8UC1);
+    bool any_active = false;
+    for (int ty = 0; ty < tiles_y; ++ty) {
+        for (int tx = 0; tx < tiles_x; ++tx) {
+            const cv::Rect ct(
+                tx * tile, ty * tile, std::min(tile, coarse.cols - tx * tile),
+                std::min(tile, coarse.rows - ty * tile)
+            );
+            const int nz = cv::countNonZero(coarse_diff(ct));
+            if (nz == 0
+                || static_cast<double>(nz) < activation * ct.area()) {
+                continue;
+            }
+            active.at<std::uint8_t>(ty, tx) = 255;
+            any_active = true;
+        }
+    }
+
+    mask = cv::Mat::zeros(gray.size(), CV_8UC1);
+    if (!any_active) {
+        return true;
+    }
+
+    // neighbours of active tiles are refined too, so motion crossing a tile
+    // border keeps full-resolution geometry on both sides
+    cv::dilate(active, active, cv::Mat());
+
+    const int full_tile = tile << levels;
+    const cv::Rect full_rect(0, 0, gray.cols, gray.rows);
+
+    for (int ty = 0; ty < tiles_y; ++ty) {
+        const std::uint8_t* row = active.ptr<std::uint8_t>(ty);
+        for (int tx = 0; tx < tiles_x; ++tx) {
+            if (row[tx] == 0) {
                 continue;
             }
 
-            const auto& pts = lp->points;
-            if (pts.empty()) {
+            const cv::Rect ft
+                = cv::Rect(tx * full_tile, ty * full_tile, full_tile, full_tile)
+                & full_rect;
+            if (ft.empty()) {
                 continue;
             }
 
-            if (motion_box_ok) {
-                bbox2f line_box {};
-                line_box.min_x = 100.0f;
-                line_box.min_y = 100.0f;
-                line_box.max_x = 0.0f;
-                line_box.max_y = 0.0f;
-
-                for (const auto& p : pts) {
-                    if (p.x < line_box.min_x) {
-                        line_box.min_x = p.x;
-                    }
-                    if (p.y < line_box.min_y) {
-                        line_box.min_y = p.y;
-                    }
-                    if (p.x > line_box.max_x) {
-                        line_box.max_x = p.x;
-                    }
-                    if (p.y > line_box.max_y) {
-                        line_box.max_y = p.y;
-                    }
-                }
+            // both frames are blurred only where they are compared;
+            // blurring an ROI reads the surrounding pixels of the parent
+            // matrix, so tile borders match a full-frame blur
+            cv::Mat blurred;
+            cv::Mat prev_blurred;
+            cv::GaussianBlur(gray(ft), blurred, cv::Size(5, 5), 0.0);
+            cv::GaussianBlur(prev_full(ft), prev_blurred, cv::Size(5, 5), 0.0);
+
+            cv::Mat mask_tile = mask(ft);
+            cv::absdiff(prev_blurred, blurred, mask_tile);
+            cv::threshold(
+                mask_tile, mask_tile, diff_threshold, 255, cv::THRESH_BINARY
+            );
+        }
+    }
+
+    return true;
+}
+
+void opencv_client::set_parallel_min_pixels(const long long px) {
+    std::scoped_lock lock(mtx);
+    parallel_min_px = px;
+}
+
+int opencv_client::analysis_bands(const int width, const int height) const {
+    long long min_px = 0;
+    {
+        std::scoped_lock lock(mtx);
+        min_px = parallel_min_px;
+    }
+
+    const long long px = static_cast<long long>(width) * height;
+    if (min_px <= 0 || px < min_px) {
+        return 1;
+    }
+
+    const int threads = std::max(1, cv::getNumThreads());
+    return std::clamp(height / min_band_rows, 1, threads);
+}
+
+void opencv_client::set_packed_masks(const bool enabled) {
+    std::scoped_lock lock(mtx);
+    packed_masks = enabled;
+}
+
+void opencv_client::set_playback_mode(const playback_mode m) {
+    std::scoped_lock lock(mtx);
+    file_playback = m;
+}
 
-                const bool x_overlap
-                    = !(line_box.max_x < motion_box.min_x
-                        || line_box.min_x > motion_box.max_x);
+opencv_client::playback_mode opencv_client::get_playback_mode() const {
+    std::scoped_lock lock(mtx);
+    return file_playback;
+}
+
+void opencv_client::set_low_latency(const bool enabled) {
+    std::scoped_lock lock(mtx);
+    low_latency = enabled;
+}
 
-                const bool y_overlap
-                    = !(line_box.max_y < motion_box.min_y
-                        || line_box.min_y > motion_box.max_y);
+bool opencv_client::get_low_latency() const {
+    std::scoped_lock lock(mtx);
+    return low_latency;
+}
+
+void opencv_client::set_analysis_width(const int px) {
+    std::scoped_lock lock(mtx);
+    analysis_width = std::max(0, px);
+}
+
+int opencv_client::get_analysis_width() const {
+    std::scoped_lock lock(mtx);
+    return analysis_width;
+}
+
+void opencv_client::set_static_tolerance(const int mean_tolerance) {
+    std::scoped_lock lock(mtx);
+    static_tolerance = mean_tolerance;
+    if (static_tolerance < 0) {
+        signature_by_stream.clear();
+    }
+}
 
-                if (!(x_overlap && y_overlap)) {
+void opencv_client::set_vector_prefilter(const double min_area) {
+    std::scoped_lock lock(mtx);
+    vector_min_area = min_area;
+}
+
+std::uint64_t
+opencv_client::skipped_frames(const std::string& stream_name) const {
+    std::scoped_lock lock(mtx);
+    const auto it = skipped_by_stream.find(stream_name);
+    return it == skipped_by_stream.end() ? 0 : it->second;
+}
+
+bool opencv_client::vectors_show_no_motion(
+    const std::string& stream_name, const frame& f
+) {
+    if (!f.has_motion_vectors) {
+        return false;
+    }
+
+    double min_area = 0.0;
+    {
+        std::scoped_lock lock(mtx);
+        min_area = vector_min_area;
+    }
+    if (min_area < 0.0) {
+        return false;
+    }
+
+    const double area = moving_area(
+        f.motion_vectors, f.width, f.height, vector_min_magnitude
+    );
+    if (area >= min_area) {
+        return false;
+    }
+
+    std::scoped_lock lock(mtx);
+    ++skipped_by_stream[stream_name];
+    return true;
+}
+
+bool opencv_client::is_static_frame(
+    const std::string& stream_name, const frame& f
+) {
+    int tolerance = 0;
+    {
+        std::scoped_lock lock(mtx);
+        tolerance = static_tolerance;
+    }
+    if (tolerance < 0) {
+        return false;
+    }
+
+    int channels = 3;
+    switch (f.format) {
+    case pixel_format::gray8:
+        channels = 1;
+        break;
+    case pixel_format::yuyv422:
+        channels = 2;
+        break;
+    case pixel_format::rgba32:
+    case pixel_format::bgra32:
+        channels = 4;
+        break;
+    default:
+        break;
+    }
+
+    const auto sig = compute_frame_signature(
+        f.bytes(), f.width, f.height, static_cast<size_t>(f.stride),
+        channels
+    );
+
+    std::scoped_lock lock(mtx);
+    auto& prev = signature_by_stream[stream_name];
+    if (same_scene(prev, sig, tolerance, diff_threshold)) {
+        ++skipped_by_stream[stream_name];
+        return true;
+    }
+    prev = sig;
+    return false;
+}
+
+cv::Range
+opencv_client::band_rows(const int rows, const int bands, const int b) {
+    return { b * rows / bands, (b + 1) * rows / bands };
+}
+
+bool opencv_client::parallel_motion_mask(
+    const std::string& stream_name, const cv::Mat& gray, cv::Mat& mask,
+    const int bands
+) {
+    cv::Mat blurred(gray.rows, gray.cols, CV_8UC1);
+    cv::Mat prev_gray;
+    {
+        std::scoped_lock lock(mtx);
+        auto it = prev_gray_by_stream.find(stream_name);
+        if (it != prev_gray_by_stream.end()
+            && it->second.size() == gray.size()) {
+            prev_gray = it->second;
+        }
+    }
+
+    mask.create(gray.rows, gray.cols, CV_8UC1);
+
+    // filtering a row band reads the neighbouring rows of the parent matrix
+    // as halo, so every band produces exactly the rows of a full-frame blur
+    cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& r) {
+        for (int b = r.start; b < r.end; ++b) {
+            const auto rows = band_rows(gray.rows, bands, b);
+            cv::Mat dst = blurred.rowRange(rows.start, rows.end);
+            cv::GaussianBlur(
+                gray.rowRange(rows.start, rows.end), dst, cv::Size(5, 5), 0.0
+            );
+            if (prev_gray.empty()) {
+                continue;
+            }
+            cv::Mat m = mask.rowRange(rows.start, rows.end);
+            cv::absdiff(prev_gray.rowRange(rows.start, rows.end), dst, m);
+            cv::threshold(m, m, diff_threshold, 255, cv::THRESH_BINARY);
+        }
+    });
+
+    {
+        std::scoped_lock lock(mtx);
+        prev_gray_by_stream[stream_name] = blurred;
+    }
+
+    return !prev_gray.empty();
+}
+
+void opencv_client::parallel_morphology(cv::Mat& mask, const int bands) {
+    // erosion and dilation read up to two rows of halo from the parent, so
+    // each pass writes into a separate matrix and passes run one after the
+    // other
+    cv::Mat eroded(mask.rows, mask.cols, CV_8UC1);
+    cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& r) {
+        for (int b = r.start; b < r.end; ++b) {
+            const auto rows = band_rows(mask.rows, bands, b);
+            cv::Mat dst = eroded.rowRange(rows.start, rows.end);
+            cv::erode(
+                mask.rowRange(rows.start, rows.end), dst, cv::Mat(),
+                cv::Point(-1, -1), 1
+            );
+        }
+    });
+
+    cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& r) {
+        for (int b = r.start; b < r.end; ++b) {
+            const auto rows = band_rows(mask.rows, bands, b);
+            cv::Mat dst = mask.rowRange(rows.start, rows.end);
+            cv::dilate(
+                eroded.rowRange(rows.start, rows.end), dst, cv::Mat(),
+                cv::Point(-1, -1), 2
+            );
+        }
+    });
+}
+
+int opencv_client::parallel_largest_component(
+    const cv::Mat& mask, const int bands,
+    std::vector<std::vector<cv::Point>>& contours
+) const {
+    struct band_labels {
+        cv::Range rows;
+        cv::Mat labels;
+        cv::Mat stats;
+        int count { 0 };
+    };
+
+    std::vector<band_labels> parts(static_cast<size_t>(bands));
+    cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& r) {
+        for (int b = r.start; b < r.end; ++b) {
+            auto& part = parts[static_cast<size_t>(b)];
+            part.rows = band_rows(mask.rows, bands, b);
+            cv::Mat centroids;
+            part.count = cv::connectedComponentsWithStats(
+                mask.rowRange(part.rows.start, part.rows.end), part.labels,
+                part.stats, centroids, 8, CV_32S
+            );
+        }
+    });
+
+    std::vector<int> offsets(parts.size(), 0);
+    int total_labels = 0;
+    for (size_t b = 0; b < parts.size(); ++b) {
+        offsets[b] = total_labels;
+        total_labels += parts[b].count;
+    }
+
+    std::vector<int> parent(static_cast<size_t>(total_labels));
+    for (int i = 0; i < total_labels; ++i) {
+        parent[static_cast<size_t>(i)] = i;
+    }
+
+    const auto find = [&parent](int i) {
+        while (parent[static_cast<size_t>(i)] != i) {
+            auto& p = parent[static_cast<size_t>(i)];
+            p = parent[static_cast<size_t>(p)];
+            i = p;
+        }
+        return i;
+    };
+
+    // components touching a band border continue in the next band; merge
+    // labels of 8-connected pixels across each border row pair
+    for (size_t b = 0; b + 1 < parts.size(); ++b) {
+        const auto& up = parts[b];
+        const auto& down = parts[b + 1];
+        if (up.labels.rows == 0 || down.labels.rows == 0) {
+            continue;
+        }
+
+        const int* last = up.labels.ptr<int>(up.labels.rows - 1);
+        const int* first = down.labels.ptr<int>(0);
+        for (int x = 0; x < mask.cols; ++x) {
+            if (last[x] == 0) {
+                continue;
+            }
+            for (int dx = -1; dx <= 1; ++dx) {
+                const int xx = x + dx;
+                if (xx < 0 || xx >= mask.cols || first[xx] == 0) {
                     continue;
                 }
+                const int ra = find(offsets[b] + last[x]);
+                const int rb = find(offsets[b + 1] + first[xx]);
+                if (ra != rb) {
+                    parent[static_cast<size_t>(rb)] = ra;
+                }
             }
+        }
+    }
 
-            process_tripwire_for_line(
-                out, s, *lp, prev_pos, cur_pos_pct, contour_pct, now
+    std::vector<int> area(static_cast<size_t>(total_labels), 0);
+    std::vector<cv::Rect> box(static_cast<size_t>(total_labels));
+    int nz = 0;
+
+    for (size_t b = 0; b < parts.size(); ++b) {
+        const auto& part = parts[b];
+        for (int l = 1; l < part.count; ++l) {
+            const int* st = part.stats.ptr<int>(l);
+            const cv::Rect rb(
+                st[cv::CC_STAT_LEFT], st[cv::CC_STAT_TOP] + part.rows.start,
+                st[cv::CC_STAT_WIDTH], st[cv::CC_STAT_HEIGHT]
             );
+            const auto root = static_cast<size_t>(find(offsets[b] + l));
+            box[root] = area[root] == 0 ? rb : (box[root] | rb);
+            area[root] += st[cv::CC_STAT_AREA];
+            nz += st[cv::CC_STAT_AREA];
         }
     }
 
-    add_motion_event(out, s.get_name(), now, cur_pos_pct);
+    const auto best_it = std::ranges::max_element(area);
+    if (best_it == area.end() || *best_it == 0) {
+        return nz;
+    }
 
-    const int grid_step = 24;
-    const int max_bubbles = 80;
+    const auto best = static_cast<int>(std::distance(area.begin(), best_it));
+    const cv::Rect bb = box[static_cast<size_t>(best)];
+
+    // one pixel of zero padding keeps border pixels off the image edge for
+    // contour tracing
+    cv::Mat comp = cv::Mat::zeros(bb.height + 2, bb.width + 2, CV_8UC1);
+    for (size_t b = 0; b < parts.size(); ++b) {
+        const auto& part = parts[b];
+        const int y0 = std::max(bb.y, part.rows.start);
+        const int y1 = std::min(bb.y + bb.height, part.rows.end);
+        for (int y = y0; y < y1; ++y) {
+            const int* lrow = part.labels.ptr<int>(y - part.rows.start);
+            std::uint8_t* dst = comp.ptr<std::uint8_t>(y - bb.y + 1);
+            for (int x = bb.x; x < bb.x + bb.width; ++x) {
+                const int l = lrow[x];
+                if (l != 0 && find(offsets[b] + l) == best) {
+                    dst[x - bb.x + 1] = 255;
+                }
+            }
+        }
+    }
+
+    cv::findContours(
+        comp, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE,
+        cv::Point(bb.x - 1, bb.y - 1)
+    );
 
-    int bubbled = 0;
-    for (int y = 0; y < diff.rows; y += grid_step) {
-        const std::uint8_t* row = diff.ptr<std::uint8_t>(y);
-        for (int x = 0; x < diff.cols; x += grid_step) {
-            if (row[x] == 0) {
+    return nz;
+}
+
+int opencv_client::packed_largest_component(
+    const cv::Mat& mask, bit_mask& packed,
+    std::vector<std::vector<cv::Point>>& contours
+) {
+    packed = bit_mask::from_bytes(
+        mask.ptr<std::uint8_t>(0), mask.cols, mask.rows, mask.step
+    );
+    packed = erode(packed, 1);
+    packed = dilate(packed, 2);
+
+    const auto labels = label_components(packed);
+    const int best = labels.largest();
+    if (best >= 0) {
+        const auto& c = labels.components[static_cast<size_t>(best)];
+
+        // one pixel of zero padding keeps border pixels off the image edge
+        // for contour tracing
+        cv::Mat comp = cv::Mat::zeros(
+            c.y1 - c.y0 + 2, c.x1 - c.x0 + 2, CV_8UC1
+        );
+        for (const auto& run : labels.runs) {
+            if (run.label != best) {
                 continue;
             }
+            std::uint8_t* dst = comp.ptr<std::uint8_t>(run.y - c.y0 + 1);
+            std::fill(
+                dst + (run.x0 - c.x0 + 1), dst + (run.x1 - c.x0 + 1),
+                std::uint8_t { 255 }
+            );
+        }
 
-            point p;
-            p.x = static_cast<float>(x) * 100.0f / static_cast<float>(f.width);
-            p.y = static_cast<float>(y) * 100.0f / static_cast<float>(f.height);
+        cv::findContours(
+            comp, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE,
+            cv::Point(c.x0 - 1, c.y0 - 1)
+        );
+    }
 
-            add_motion_event(out, s.get_name(), now, p);
-            bubbled++;
+    return static_cast<int>(packed.count());
+}
 
-            if (bubbled >= max_bubbles) {
-                break;
+std::vector<event>
+opencv_client::motion_processor(const stream& s, const frame& f) {
+    event_batch out;
+    motion_processor(s, f, out);
+    return out.to_events();
+}
+
+void opencv_client::motion_processor(
+    const stream& s, const frame& f, event_batch& out
+) {
+    if (f.empty() || f.width <= 0 || f.height <= 0) {
+        return;
+    }
+
+    if (vectors_show_no_motion(s.get_name(), f)
+        || is_static_frame(s.get_name(), f)) {
+        process_regions(out, s, std::chrono::steady_clock::now());
+        return;
+    }
+
+    int gray_code = cv::COLOR_BGR2GRAY;
+    const cv::Mat src = frame_mat(f, gray_code);
+
+    detection_mode cur_mode = detection_mode::full;
+    bool use_packed = false;
+    {
+        std::scoped_lock lock(mtx);
+        cur_mode = mode;
+        use_packed = packed_masks;
+    }
+
+    const int bands = analysis_bands(f.width, f.height);
+
+    cv::Mat gray;
+    if (bands > 1) {
+        gray.create(src.rows, src.cols, CV_8UC1);
+        cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& r) {
+            for (int b = r.start; b < r.end; ++b) {
+                const auto rows = band_rows(src.rows, bands, b);
+                cv::Mat dst = gray.rowRange(rows.start, rows.end);
+                to_gray(src.rowRange(rows.start, rows.end), dst, gray_code);
             }
+        });
+    } else {
+        to_gray(src, gray, gray_code);
+    }
+
+    cv::Mat diff;
+    bool has_mask = false;
+    if (cur_mode == detection_mode::pyramid) {
+        has_mask = pyramid_motion_mask(s.get_name(), gray, diff);
+    } else if (bands > 1) {
+        has_mask = parallel_motion_mask(s.get_name(), gray, diff, bands);
+    } else {
+        has_mask = full_motion_mask(s.get_name(), gray, diff);
+    }
+    if (!has_mask) {
+        process_regions(out, s, std::chrono::steady_clock::now());
+        return;
+    }
+
+    std::vector<std::vector<cv::Point>> contours;
+    int nz = 0;
+    bit_mask packed;
+    use_packed = use_packed && bands == 1;
+
+    if (bands > 1) {
+        parallel_morphology(diff, bands);
+        nz = parallel_largest_component(diff, bands, contours);
+    } else if (use_packed) {
+        nz = packed_largest_component(diff, packed, contours);
+    } else {
+        cv::erode(diff, diff, cv::Mat(), cv::Point(-1, -1), 1);
+        cv::dilate(diff, diff, cv::Mat(), cv::Point(-1, -1), 2);
+
+        cv::findContours(
+            diff, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE
+        );
+        nz = -1;
+    }
+
+    // one published line set serves the whole frame, even if the lines
+    // change meanwhile
+    const auto lines = s.compiled_lines();
+
+    // the heatmap sees every analyzed mask, also those below the event
+    // cutoffs and rate limit further down
+    const auto now = std::chrono::steady_clock::now();
+    const auto activity = use_packed ? compute_activity_grid(packed)
+                                     : compute_activity_grid(
+                                           diff.ptr<std::uint8_t>(0),
+                                           diff.cols, diff.rows, diff.step
+                                       );
+    out.add_activity(activity, now);
+
+    // regions see every frame, with or without a motion event, so that
+    // they can also exit (frames without a mask are handled above)
+    const auto regions
+        = stream_regions(s.get_name(), lines, diff.cols, diff.rows);
+    if (!regions->empty()) {
+        process_regions(
+            out, s, *regions, use_packed ? &packed : nullptr, diff, now
+        );
+    }
+
+    if (contours.empty()) {
+        return;
+    }
+
+    const auto max_i_opt = find_largest_contour_index(contours);
+    if (!max_i_opt.has_value()) {
+        return;
+    }
+
+    const size_t max_i = *max_i_opt;
+    const double max_area = cv::contourArea(contours[max_i]);
+
+    const double min_area = 0.001 * static_cast<double>(diff.rows * diff.cols);
+    if (max_area < min_area) {
+        return;
+    }
+
+    std::vector<cv::Point> approx;
+    {
+        const double eps = 3.0;
+        cv::approxPolyDP(contours[max_i], approx, eps, true);
+    }
+
+    std::vector<point> contour_pct;
+    contour_pct.reserve(approx.size());
+
+    for (const auto& pt : approx) {
+        point p;
+        p.x = static_cast<float>(pt.x) * 100.0f / static_cast<float>(f.width);
+        p.y = static_cast<float>(pt.y) * 100.0f / static_cast<float>(f.height);
+        contour_pct.push_back(p);
+    }
+
+    // grown by the intersection tolerance so that no touching segment is
+    // filtered out
+    bbox motion_box = bbox::of(contour_pct);
+    motion_box.min_x -= point::epsilon;
+    motion_box.min_y -= point::epsilon;
+    motion_box.max_x += point::epsilon;
+    motion_box.max_y += point::epsilon;
+
+    if (nz < 0) {
+        nz = cv::countNonZero(diff);
+    }
+    const int total = diff.rows * diff.cols;
+    const double ratio = total > 0 ? static_cast<double>(nz) / total : 0.0;
+
+    if (ratio < 0.01) {
+        return;
+    }
+
+    const double min_ratio = 0.02;
+
+    if (ratio < min_ratio) {
+        return;
+    }
+
+    cv::Moments mm = cv::moments(contours[max_i]);
+    double cx = 0.0;
+    double cy = 0.0;
+    if (mm.m00 > 0.0) {
+        cx = mm.m10 / mm.m00;
+        cy = mm.m01 / mm.m00;
+    } else {
+        cx = static_cast<double>(f.width) * 0.5;
+        cy = static_cast<double>(f.height) * 0.5;
+    }
+
+    const point cur_pos_pct { static_cast<float>(cx * 100.0 / f.width),
+                              static_cast<float>(cy * 100.0 / f.height) };
+    // the sampler follows the motion before the rate limits below
+    out.set_activity_pos(cur_pos_pct.x, cur_pos_pct.y);
+
+    point prev_pos {};
+    bool has_prev = false;
+    {
+        std::scoped_lock lock(mtx);
+        auto it = last_pos_by_stream.find(s.get_name());
+        if (it != last_pos_by_stream.end()) {
+            prev_pos = it->second;
+            has_prev = true;
         }
+        last_pos_by_stream[s.get_name()] = cur_pos_pct;
+    }
 
-        if (bubbled >= max_bubbles) {
-            break;
+    if (has_prev
+        && get_tripwire_mode(s.get_name()) == tripwire_mode::raster) {
+        const auto raster
+            = tripwire_raster(s.get_name(), lines, diff.cols, diff.rows);
+        const cv::Rect area = cv::boundingRect(contours[max_i]);
+        const int x1 = area.x + area.width;
+        const int y1 = area.y + area.height;
+        std::vector<line_raster::hit> hits;
+        if (use_packed) {
+            raster->hits(packed, area.x, area.y, x1, y1, hits);
+        } else {
+            raster->hits(
+                diff.ptr<std::uint8_t>(0), diff.step, area.x, area.y, x1, y1,
+                hits
+            );
+        }
+        process_raster_tripwires(
+            out, s, *raster, hits, prev_pos, cur_pos_pct, now
+        );
+    } else if (has_prev) {
+        // only segments near the motion are tested; the query result is
+        // grouped by line
+        std::vector<std::uint32_t> near;
+        lines->query(motion_box, near);
+
+        segment_batch contour_edges;
+        if (contour_pct.size() >= 2) {
+            contour_edges.assign_chain(contour_pct, true);
+        }
+        segment_hits scratch;
+
+        const std::span<const std::uint32_t> all(near);
+        size_t first = 0;
+        while (first < all.size()) {
+            const auto owner = lines->segment_line(all[first]);
+            size_t last = first + 1;
+            while (last < all.size()
+                   && lines->segment_line(all[last]) == owner) {
+                ++last;
+            }
+            process_tripwire_for_line(
+                out, s, *lines, all.subspan(first, last - first), prev_pos,
+                cur_pos_pct, contour_edges, scratch, now
+            );
+            first = last;
+        }
+    }
+
+    // the motion rule limits motion events only: tripwires and the last
+    // position follow every analyzed frame, however often it is sampled
+    {
+        std::scoped_lock lock(mtx);
+        const auto rule
+            = rate_rule_locked(rate_target::motion, s.get_name(), {});
+        const auto channel = static_cast<std::uint32_t>(rate_target::motion);
+        const auto key = rate_key(s.get_name(), {}, channel * 4);
+        if (!limiter.allow(key, rule, now)) {
+            return;
         }
     }
 
-    return out;
+    const auto stream_id = global_names().intern(s.get_name());
+    add_motion_event(out, stream_id, now, cur_pos_pct);
+    add_motion_grid_event(out, stream_id, now, activity);
 }
 
 stream_manager::daemon_start_fn opencv_client::daemon_start_fn() {
     return [this](
                const stream& s, std::function<void(frame&&)> on_frame,
-               std::stop_token st
-           ) { daemon_start(s, on_frame, st); };
+               std::function<bool()> wants_frame, std::stop_token st
+           ) { daemon_start(s, on_frame, wants_frame, st); };
 }
 
 stream_manager::frame_processor_fn opencv_client::frame_processor_fn() {
@@ -671,24 +1654,34 @@ stream_manager::frame_processor_fn opencv_client::frame_processor_fn() {
     };
 }
 
-namespace {
-    opencv_client& global_opencv_client() {
-        static opencv_client inst;
-        return inst;
-    }
+stream_manager::batch_processor_fn opencv_client::batch_processor_fn() {
+    return [this](const stream& s, const frame& f, event_batch& out) {
+        motion_processor(s, f, out);
+    };
+}
+
+opencv_client& global_opencv_client() {
+    static opencv_client inst;
+    return inst;
 }
 
 void opencv_daemon_start(
     const stream& s, const std::function<void(frame&&)>& on_frame,
-    const std::stop_token& st
+    const std::function<bool()>& wants_frame, const std::stop_token& st
 ) {
-    global_opencv_client().daemon_start(s, on_frame, st);
+    global_opencv_client().daemon_start(s, on_frame, wants_frame, st);
 }
 
 std::vector<event> opencv_motion_processor(const stream& s, const frame& f) {
     return global_opencv_client().motion_processor(s, f);
 }
 
+void opencv_batch_processor(
+    const stream& s, const frame& f, event_batch& out
+) {
+    global_opencv_client().motion_processor(s, f, out);
+}
+
 }
 
 #endif
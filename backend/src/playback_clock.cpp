@@ -0,0 +1,71 @@
+#include "playback_clock.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
+namespace {
+yodau::backend::playback_clock::clock::duration from_ms(const double ms) {
+    return std::chrono::duration_cast<
+        yodau::backend::playback_clock::clock::duration>(
+        std::chrono::duration<double, std::milli>(ms)
+    );
+}
+}
+
+yodau::backend::playback_clock::playback_clock(const double fps)
+    : period(from_ms(fps > 0.0 && fps <= 1000.0 ? 1000.0 / fps : 1000.0 / 30.0)
+      ) { }
+
+void yodau::backend::playback_clock::restart() {
+    started = false;
+    last_pts_ms = -1.0;
+    last_offset = {};
+}
+
+yodau::backend::playback_clock::clock::time_point
+yodau::backend::playback_clock::due(
+    const double pts_ms, const clock::time_point now
+) {
+    if (!started) {
+        started = true;
+        origin = now;
+        first_pts_ms = pts_ms >= 0.0 ? pts_ms : 0.0;
+        last_pts_ms = pts_ms;
+        last_offset = {};
+        return now;
+    }
+
+    clock::duration offset {};
+    if (pts_ms >= 0.0 && pts_ms > last_pts_ms) {
+        // never earlier than a frame scheduled from the fallback before
+        offset = std::max(from_ms(pts_ms - first_pts_ms), last_offset);
+        last_pts_ms = pts_ms;
+    } else {
+        // a rejected timestamp is not a reference for the next frame
+        offset = last_offset + period;
+    }
+    last_offset = offset;
+
+    auto target = origin + offset;
+    if (now - target > max_lag) {
+        origin = now - offset;
+        target = now;
+    }
+    return target;
+}
+
+yodau::backend::playback_clock::clock::duration
+yodau::backend::playback_clock::frame_period() const {
+    return period;
+}
+
+bool yodau::backend::playback_clock::sleep_until(
+    const clock::time_point tp, const std::stop_token& st
+) {
+    std::mutex m;
+    std::condition_variable_any cv;
+    std::unique_lock lock(m);
+    cv.wait_until(lock, st, tp, [] { return false; });
+    return !st.stop_requested();
+}
@@ -0,0 +1,105 @@
+#include "rate_limiter.hpp"
+
+#include <algorithm>
+#include <functional>
+
+bool yodau::backend::token_bucket::take(
+    const rate_rule& rule, const clock::time_point now
+) {
+    if (rule.unlimited()) {
+        return true;
+    }
+    // admitted while the backlog is shorter than burst - 1 intervals
+    const auto slack = rule.interval * (std::max(rule.burst, 1) - 1);
+    const auto start = std::max(tat, now);
+    if (start - now > slack) {
+        return false;
+    }
+    tat = start + rule.interval;
+    return true;
+}
+
+std::uint64_t yodau::backend::rate_key(
+    const std::string_view stream_name, const std::string_view line_name,
+    const std::uint32_t channel
+) {
+    const std::hash<std::string_view> h;
+    std::uint64_t k = h(stream_name);
+    k = (k ^ (k >> 31)) * 0x9e3779b97f4a7c15ull;
+    k ^= h(line_name);
+    k = (k ^ (k >> 29)) * 0xbf58476d1ce4e5b9ull;
+    return k ^ channel;
+}
+
+yodau::backend::rate_limiter::rate_limiter(
+    const clock::duration tick, const std::size_t slots
+)
+    : tick(std::max(tick, clock::duration { 1 }))
+    , wheel(std::max<std::size_t>(slots, 1)) { }
+
+long long
+yodau::backend::rate_limiter::tick_of(const clock::time_point t) const {
+    return static_cast<long long>(t.time_since_epoch() / tick);
+}
+
+void yodau::backend::rate_limiter::schedule(
+    const std::uint64_t key, const long long t
+) {
+    const auto n = static_cast<long long>(wheel.size());
+    wheel[static_cast<std::size_t>((t % n + n) % n)].push_back(key);
+}
+
+bool yodau::backend::rate_limiter::allow(
+    const std::uint64_t key, const rate_rule& rule, const clock::time_point now
+) {
+    expire(now);
+    if (rule.unlimited()) {
+        return true;
+    }
+
+    const auto [it, fresh] = buckets.try_emplace(key);
+    if (!it->second.take(rule, now)) {
+        return false;
+    }
+    // a tracked bucket is rescheduled lazily when its slot comes up
+    if (fresh) {
+        schedule(key, tick_of(it->second.full_at()));
+    }
+    return true;
+}
+
+void yodau::backend::rate_limiter::expire(const clock::time_point now) {
+    const long long last = tick_of(now) - 1;
+    if (!started) {
+        done = last;
+        started = true;
+        return;
+    }
+    if (last <= done) {
+        return;
+    }
+
+    // one revolution visits every slot
+    const auto n = static_cast<long long>(wheel.size());
+    const long long from = std::max(done + 1, last - n + 1);
+    for (long long t = from; t <= last; ++t) {
+        auto& slot = wheel[static_cast<std::size_t>((t % n + n) % n)];
+        if (slot.empty()) {
+            continue;
+        }
+        firing.swap(slot);
+        for (const auto key : firing) {
+            const auto it = buckets.find(key);
+            if (it == buckets.end()) {
+                continue;
+            }
+            if (it->second.full_at() <= now) {
+                buckets.erase(it);
+            } else {
+                schedule(key, tick_of(it->second.full_at()));
+            }
+        }
+        firing.clear();
+    }
+    done = last;
+}
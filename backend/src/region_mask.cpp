@@ -0,0 +1,178 @@
+#include "region_mask.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <utility>
+
+namespace {
+// first of w pixels whose center lies at or right of pct
+int first_pixel_from(const float pct, const float px_per_pct, const int w) {
+    const float x = std::ceil(pct * px_per_pct - 0.5f);
+    return static_cast<int>(std::clamp(x, 0.0f, static_cast<float>(w)));
+}
+}
+
+yodau::backend::region_mask::region_mask(
+    const std::vector<point>& polygon, const int width, const int height
+)
+    : inside(width, height) {
+    const int w = inside.width();
+    const int h = inside.height();
+    if (polygon.size() < 3 || w == 0 || h == 0) {
+        return;
+    }
+
+    const float px_per_pct_x = static_cast<float>(w) / 100.0f;
+    const float pct_per_px_y = 100.0f / static_cast<float>(h);
+    const std::size_t n = polygon.size();
+
+    std::vector<float> xs;
+    double sum_x = 0.0;
+    double sum_y = 0.0;
+    int min_x = w;
+    int max_x = 0;
+    row0 = h;
+    row1 = 0;
+
+    // scanline fill at pixel centers, even-odd rule; the half-open test
+    // counts a vertex on the scanline once
+    for (int y = 0; y < h; ++y) {
+        const float yc = (static_cast<float>(y) + 0.5f) * pct_per_px_y;
+        xs.clear();
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto& a = polygon[i];
+            const auto& b = polygon[(i + 1) % n];
+            if ((a.y <= yc) != (b.y <= yc)) {
+                xs.push_back(a.x + (yc - a.y) * (b.x - a.x) / (b.y - a.y));
+            }
+        }
+        std::ranges::sort(xs);
+
+        for (std::size_t k = 0; k + 1 < xs.size(); k += 2) {
+            const int x0 = first_pixel_from(xs[k], px_per_pct_x, w);
+            const int x1 = first_pixel_from(xs[k + 1], px_per_pct_x, w);
+            if (x0 >= x1) {
+                continue;
+            }
+            spans.push_back({ y, x0, x1 });
+            for (int x = x0; x < x1; ++x) {
+                inside.set(x, y);
+            }
+
+            const int len = x1 - x0;
+            pixels += len;
+            sum_x += static_cast<double>(len) * (x0 + x1) * 0.5;
+            sum_y += static_cast<double>(len) * (y + 0.5);
+            min_x = std::min(min_x, x0);
+            max_x = std::max(max_x, x1);
+            row0 = std::min(row0, y);
+            row1 = y + 1;
+        }
+    }
+
+    if (pixels == 0) {
+        row0 = 0;
+        return;
+    }
+    word0 = min_x / 64;
+    word1 = (max_x - 1) / 64 + 1;
+    const auto count = static_cast<double>(pixels);
+    center = { static_cast<float>(sum_x / count * 100.0 / w),
+               static_cast<float>(sum_y / count * 100.0 / h) };
+}
+
+long long yodau::backend::region_mask::count_in(const bit_mask& motion) const {
+    if (motion.width() != inside.width()
+        || motion.height() != inside.height()) {
+        return 0;
+    }
+
+    long long n = 0;
+    for (int y = row0; y < row1; ++y) {
+        const std::uint64_t* m = motion.row(y);
+        const std::uint64_t* r = inside.row(y);
+        for (int k = word0; k < word1; ++k) {
+            n += std::popcount(m[k] & r[k]);
+        }
+    }
+    return n;
+}
+
+long long yodau::backend::region_mask::count_in(
+    const std::uint8_t* motion, const std::size_t stride
+) const {
+    if (!motion) {
+        return 0;
+    }
+
+    long long n = 0;
+    for (const auto& s : spans) {
+        const auto* row = motion + static_cast<std::size_t>(s.y) * stride;
+        for (int x = s.x0; x < s.x1; ++x) {
+            n += row[x] != 0 ? 1 : 0;
+        }
+    }
+    return n;
+}
+
+yodau::backend::region_set::region_set(
+    std::shared_ptr<const line_set> lines, const int width, const int height
+)
+    : source(std::move(lines))
+    , w(std::max(0, width))
+    , h(std::max(0, height)) {
+    if (!source) {
+        return;
+    }
+    for (std::size_t i = 0; i < source->line_count(); ++i) {
+        const auto& l = source->line_at(i);
+        if (!l.closed || l.points.size() < 3) {
+            continue;
+        }
+        line_index.push_back(i);
+        masks.emplace_back(l.points, w, h);
+    }
+}
+
+bool yodau::backend::region_set::matches(
+    const std::shared_ptr<const line_set>& lines, const int width,
+    const int height
+) const {
+    return source == lines && w == width && h == height;
+}
+
+const yodau::backend::line&
+yodau::backend::region_set::line_at(const std::size_t i) const {
+    return source->line_at(line_index[i]);
+}
+
+yodau::backend::region_occupancy::change
+yodau::backend::region_occupancy::update(
+    const double ratio, const std::chrono::steady_clock::time_point now,
+    const occupancy_config& cfg
+) {
+    if (!inside) {
+        streak = ratio >= cfg.enter_ratio ? streak + 1 : 0;
+        if (streak < std::max(1, cfg.enter_frames)) {
+            return change::none;
+        }
+        inside = true;
+        streak = 0;
+        last_report = now;
+        return change::enter;
+    }
+
+    streak = ratio < cfg.exit_ratio ? streak + 1 : 0;
+    if (streak >= std::max(1, cfg.exit_frames)) {
+        inside = false;
+        streak = 0;
+        return change::exit;
+    }
+    if (cfg.report_interval.count() > 0
+        && now - last_report >= cfg.report_interval) {
+        last_report = now;
+        return change::occupied;
+    }
+    return change::none;
+}
@@ -0,0 +1,43 @@
+#include "source_clock.hpp"
+
+namespace {
+yodau::backend::source_clock::clock::duration from_ms(const double ms) {
+    return std::chrono::duration_cast<
+        yodau::backend::source_clock::clock::duration>(
+        std::chrono::duration<double, std::milli>(ms)
+    );
+}
+}
+
+yodau::backend::source_clock::clock::time_point
+yodau::backend::source_clock::map(
+    const double pts_ms, const clock::time_point arrival
+) {
+    if (pts_ms < 0.0) {
+        return arrival;
+    }
+
+    const auto candidate = arrival - from_ms(pts_ms);
+    const double step = pts_ms - last_pts_ms;
+    const bool jumped = step < 0.0
+        || step > static_cast<double>(max_jump.count());
+
+    if (!started || jumped) {
+        started = true;
+        base = candidate;
+    } else {
+        base += from_ms(step * max_drift);
+        if (candidate < base) {
+            base = candidate;
+        }
+    }
+    last_pts_ms = pts_ms;
+
+    return base + from_ms(pts_ms);
+}
+
+void yodau::backend::source_clock::reset() {
+    started = false;
+    last_pts_ms = -1.0;
+    base = {};
+}
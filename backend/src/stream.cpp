@@ -1,15 +1,86 @@
 #include "stream.hpp"
 
+#include <cctype>
+#include <charconv>
 #include <ranges>
 
+bool yodau::backend::capture_format::empty() const {
+    return width <= 0 && height <= 0 && fps <= 0.0 && fourcc.empty();
+}
+
+std::uint32_t yodau::backend::capture_format::fourcc_code() const {
+    if (fourcc.size() != 4) {
+        return 0;
+    }
+    std::uint32_t code = 0;
+    for (int i = 3; i >= 0; --i) {
+        code = (code << 8)
+            | static_cast<std::uint8_t>(fourcc[static_cast<size_t>(i)]);
+    }
+    return code;
+}
+
+std::string yodau::backend::capture_format::fourcc_name(std::uint32_t code) {
+    std::string out;
+    for (int i = 0; i < 4; ++i) {
+        const auto c = static_cast<unsigned char>(code & 0xFF);
+        if (!std::isprint(c)) {
+            return {};
+        }
+        out.push_back(static_cast<char>(c));
+        code >>= 8;
+    }
+    return out;
+}
+
+bool yodau::backend::capture_format::parse_size(
+    const std::string& text, int& width, int& height
+) {
+    const auto sep = text.find('x');
+    if (sep == std::string::npos) {
+        return false;
+    }
+    const char* begin = text.data();
+    const char* end = text.data() + text.size();
+
+    int w = 0;
+    int h = 0;
+    const auto rw = std::from_chars(begin, begin + sep, w);
+    const auto rh = std::from_chars(begin + sep + 1, end, h);
+    if (rw.ec != std::errc() || rw.ptr != begin + sep || rh.ec != std::errc()
+        || rh.ptr != end || w <= 0 || h <= 0) {
+        return false;
+    }
+    width = w;
+    height = h;
+    return true;
+}
+
+std::ostream&
+yodau::backend::operator<<(std::ostream& out, const capture_format& fmt) {
+    const bool sized = fmt.width > 0 && fmt.height > 0;
+    if (sized) {
+        out << fmt.width << 'x' << fmt.height;
+    }
+    if (fmt.fps > 0.0) {
+        out << '@' << fmt.fps << "fps";
+    }
+    if (!fmt.fourcc.empty()) {
+        out << (sized || fmt.fps > 0.0 ? " " : "") << fmt.fourcc;
+    }
+    return out;
+}
+
 yodau::backend::stream::stream(
     std::string path, std::string name, const std::string& type_str,
-    const bool loop
+    const bool loop, capture_format format
 )
     : name(std::move(name))
     , path(std::move(path))
     , loop(loop)
-    , active(stream_pipeline::none) {
+    , active(stream_pipeline::none)
+    , requested(std::move(format))
+    , published(std::make_shared<const line_set>()) {
     const auto detected = identify(this->path);
 
     if (type_str.empty() || type_str == type_name(detected)) {
@@ -32,10 +103,14 @@ yodau::backend::stream::stream(stream&& other) noexcept
     , path(std::move(other.path))
     , type(other.type)
     , loop(other.loop)
-    , active(other.active) {
+    , active(other.active)
+    , requested(std::move(other.requested)) {
 
-    std::scoped_lock lock(other.lines_mtx);
+    std::scoped_lock lock(other.lines_mtx, other.format_mtx);
     lines = std::move(other.lines);
+    published.store(other.published.load());
+    version.store(other.version.load());
+    negotiated = std::move(other.negotiated);
 }
 
 yodau::backend::stream&
@@ -44,14 +119,20 @@ yodau::backend::stream::operator=(stream&& other) noexcept {
         return *this;
     }
 
-    std::scoped_lock lock(lines_mtx, other.lines_mtx);
+    std::scoped_lock lock(
+        lines_mtx, other.lines_mtx, format_mtx, other.format_mtx
+    );
 
     name = std::move(other.name);
     path = std::move(other.path);
     type = other.type;
     loop = other.loop;
     active = other.active;
+    requested = std::move(other.requested);
     lines = std::move(other.lines);
+    published.store(other.published.load());
+    version.store(other.version.load());
+    negotiated = std::move(other.negotiated);
 
     return *this;
 }
@@ -103,13 +184,39 @@ yodau::backend::stream_type yodau::backend::stream::get_type() const {
 
 bool yodau::backend::stream::is_looping() const { return loop; }
 
+const yodau::backend::capture_format&
+yodau::backend::stream::requested_format() const {
+    return requested;
+}
+
+void yodau::backend::stream::report_negotiated_format(
+    capture_format format
+) const {
+    std::scoped_lock lock(format_mtx);
+    negotiated = std::move(format);
+}
+
+yodau::backend::capture_format
+yodau::backend::stream::negotiated_format() const {
+    std::scoped_lock lock(format_mtx);
+    return negotiated;
+}
+
 void yodau::backend::stream::dump(
     std::ostream& out, const bool connections
 ) const {
     out << "Stream(name=" << name << ", path=" << path
         << ", type=" << type_name(type)
         << ", loop=" << (loop ? "true" : "false")
-        << ", active_pipeline=" << pipeline_name(active) << ")";
+        << ", active_pipeline=" << pipeline_name(active);
+    if (!requested.empty()) {
+        out << ", format=" << requested;
+    }
+    const auto actual = negotiated_format();
+    if (!actual.empty()) {
+        out << ", negotiated=" << actual;
+    }
+    out << ")";
 
     if (!connections) {
         return;
@@ -141,7 +248,23 @@ void yodau::backend::stream::connect_line(line_ptr line) {
         return;
     }
     std::scoped_lock lock(lines_mtx);
-    lines.emplace(line->name, line);
+    if (lines.emplace(line->name, line).second) {
+        publish_locked();
+    }
+}
+
+bool yodau::backend::stream::replace_line(line_ptr line) {
+    if (!line) {
+        return false;
+    }
+    std::scoped_lock lock(lines_mtx);
+    const auto it = lines.find(line->name);
+    if (it == lines.end()) {
+        return false;
+    }
+    it->second = std::move(line);
+    publish_locked();
+    return true;
 }
 
 std::vector<std::string> yodau::backend::stream::line_names() const {
@@ -160,3 +283,25 @@ yodau::backend::stream::lines_snapshot() const {
     }
     return out;
 }
+
+std::shared_ptr<const yodau::backend::line_set>
+yodau::backend::stream::compiled_lines() const {
+    return published.load(std::memory_order_acquire);
+}
+
+std::uint64_t yodau::backend::stream::lines_version() const {
+    return version.load(std::memory_order_acquire);
+}
+
+void yodau::backend::stream::publish_locked() {
+    std::vector<line_ptr> src;
+    src.reserve(lines.size());
+    for (const auto& lp : lines | std::views::values) {
+        src.push_back(lp);
+    }
+    const auto next = version.load(std::memory_order_relaxed) + 1;
+    published.store(
+        std::make_shared<const line_set>(src, next), std::memory_order_release
+    );
+    version.store(next, std::memory_order_release);
+}
@@ -1,8 +1,12 @@
 #include "stream_manager.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <filesystem>
 #include <ranges>
+#include <sstream>
+#include <stdexcept>
 #include <thread>
 
 #ifdef __linux__
@@ -41,8 +45,61 @@ bool is_capture_device(const std::string& path) {
 }
 #endif
 
+namespace {
+std::string format_text(const yodau::backend::capture_format& fmt) {
+    if (fmt.empty()) {
+        return "the source default";
+    }
+    std::ostringstream out;
+    out << fmt;
+    return out.str();
+}
+}
+
+// one capture of a source path, shared by all streams using it
+struct yodau::backend::stream_manager::shared_capture {
+    std::string path;
+
+    // stream the capture was opened for: its settings (requested format,
+    // looping) apply and its daemon reports the negotiated format
+    std::shared_ptr<const stream> source;
+
+    // set once the negotiated format of source was copied to the
+    // subscribers; later subscribers copy it when they join
+    mutable std::atomic<bool> format_shared { false };
+
+    // streams receiving the frames; guarded by mtx and replaced rather than
+    // modified, so fan-out can use a snapshot without holding the lock
+    std::shared_ptr<const std::vector<std::string>> subscribers;
+
+#ifdef __linux__
+    // engine reading the source, if it is not read by a daemon thread
+    std::shared_ptr<capture_engine> engine;
+#endif
+
+    // declared last so that it is joined before the rest goes away
+    std::jthread thread;
+};
+
 yodau::backend::stream_manager::stream_manager() { refresh_local_streams(); }
 
+yodau::backend::stream_manager::~stream_manager() {
+    std::unordered_map<std::string, std::shared_ptr<shared_capture>> left;
+    {
+        std::scoped_lock lock(mtx);
+        left.swap(captures);
+    }
+    // capture callbacks point back here: stop them before members go away
+    for (auto& [path, cap] : left) {
+#ifdef __linux__
+        if (cap->engine) {
+            cap->engine->remove(path);
+        }
+#endif
+        cap.reset();
+    }
+}
+
 void yodau::backend::stream_manager::dump(std::ostream& out) const {
     std::scoped_lock lock(mtx);
     dump_stream(out);
@@ -127,14 +184,15 @@ void yodau::backend::stream_manager::refresh_local_streams() {
 
 yodau::backend::stream& yodau::backend::stream_manager::add_stream(
     const std::string& path, const std::string& name, const std::string& type,
-    bool loop
+    bool loop, const capture_format& format
 ) {
     std::scoped_lock lock(mtx);
     std::string stream_name = name;
     while (stream_name.empty() || streams.contains(stream_name)) {
         stream_name = "stream_" + std::to_string(stream_idx++);
     }
-    auto new_stream = std::make_shared<stream>(path, stream_name, type, loop);
+    auto new_stream
+        = std::make_shared<stream>(path, stream_name, type, loop, format);
     auto& ref = *new_stream;
     streams.emplace(stream_name, std::move(new_stream));
     return ref;
@@ -215,18 +273,30 @@ void yodau::backend::stream_manager::set_daemon_start_hook(
     daemon_start = std::move(hook);
 }
 
+#ifdef __linux__
+void yodau::backend::stream_manager::set_capture_engine(
+    std::shared_ptr<capture_engine> eng, capture_source_fn make_source
+) {
+    std::scoped_lock lock(mtx);
+    engine = std::move(eng);
+    engine_source = std::move(make_source);
+}
+#endif
+
 void yodau::backend::stream_manager::push_frame(
     const std::string& stream_name, frame&& f
 ) {
     manual_push_fn mp;
     event_sink_fn es;
     event_batch_sink_fn bes;
+    compact_sink_fn cs;
 
     {
         std::scoped_lock lock(mtx);
         mp = manual_push;
         es = event_sink;
         bes = event_batch_sink;
+        cs = compact_sink;
     }
 
     if (mp) {
@@ -234,10 +304,30 @@ void yodau::backend::stream_manager::push_frame(
         return;
     }
 
-    auto events = process_frame(stream_name, std::move(f));
+    // the batch keeps its capacity between frames of a capture thread; it
+    // is taken out while in use, so a re-entrant call starts a new one
+    thread_local event_batch reused;
+    auto events = std::move(reused);
+    events.clear();
+
+    process_frame(stream_name, std::move(f), events);
+    apply_event_budget(events);
+    deliver(events, es, bes, cs);
+
+    reused = std::move(events);
+}
+
+void yodau::backend::stream_manager::deliver(
+    const event_batch& events, const event_sink_fn& es,
+    const event_batch_sink_fn& bes, const compact_sink_fn& cs
+) {
+    if (cs) {
+        cs(events);
+        return;
+    }
 
     if (bes) {
-        bes(events);
+        bes(events.to_events());
         return;
     }
 
@@ -245,8 +335,8 @@ void yodau::backend::stream_manager::push_frame(
         return;
     }
 
-    for (const auto& e : events) {
-        es(e);
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        es(events.to_event(i));
     }
 }
 
@@ -258,6 +348,23 @@ void yodau::backend::stream_manager::start_daemon(
 
 void yodau::backend::stream_manager::set_frame_processor(
     frame_processor_fn fn
+) {
+    batch_processor_fn wrapped;
+    if (fn) {
+        wrapped = [fn = std::move(fn)](
+                      const stream& s, const frame& f, event_batch& out
+                  ) {
+            for (const auto& e : fn(s, f)) {
+                out.push_back(e);
+            }
+        };
+    }
+    std::scoped_lock lock(mtx);
+    frame_processor = std::move(wrapped);
+}
+
+void yodau::backend::stream_manager::set_batch_processor(
+    batch_processor_fn fn
 ) {
     std::scoped_lock lock(mtx);
     frame_processor = std::move(fn);
@@ -266,9 +373,17 @@ void yodau::backend::stream_manager::set_frame_processor(
 std::vector<yodau::backend::event>
 yodau::backend::stream_manager::process_frame(
     const std::string& stream_name, frame&& f
+) {
+    event_batch out;
+    process_frame(stream_name, std::move(f), out);
+    return out.to_events();
+}
+
+void yodau::backend::stream_manager::process_frame(
+    const std::string& stream_name, frame&& f, event_batch& out
 ) {
     std::shared_ptr<stream> sp;
-    frame_processor_fn fp;
+    batch_processor_fn fp;
     const auto now = std::chrono::steady_clock::now();
     bool allow = false;
 
@@ -276,7 +391,7 @@ yodau::backend::stream_manager::process_frame(
         std::scoped_lock lock(mtx);
         auto it = streams.find(stream_name);
         if (it == streams.end() || !frame_processor) {
-            return {};
+            return;
         }
 
         fp = frame_processor;
@@ -287,12 +402,7 @@ yodau::backend::stream_manager::process_frame(
             last_analysis_ts[stream_name] = now;
             allow = true;
         } else {
-            const auto dt
-                = std::chrono::duration_cast<std::chrono::milliseconds>(
-                      now - last_it->second
-                )
-                      .count();
-            if (dt >= analysis_interval_ms) {
+            if (now - last_it->second >= interval_locked(stream_name)) {
                 last_analysis_ts[stream_name] = now;
                 allow = true;
             }
@@ -300,10 +410,129 @@ yodau::backend::stream_manager::process_frame(
     }
 
     if (!allow || !sp || !fp) {
-        return {};
+        return;
+    }
+
+    const std::size_t first = out.size();
+    const std::size_t first_activity = out.activity().size();
+    fp(*sp, f, out);
+    const auto done = std::chrono::steady_clock::now();
+
+    std::scoped_lock lock(mtx);
+    if (f.ts != std::chrono::steady_clock::time_point {}) {
+        const auto lat = std::chrono::duration_cast<std::chrono::microseconds>(
+            done - f.ts
+        );
+        auto& stats = latency_by_stream[stream_name];
+        stats.last = lat;
+        stats.average = stats.samples == 0
+            ? lat
+            : stats.average + (lat - stats.average) / 16;
+        stats.max = std::max(stats.max, lat);
+        ++stats.samples;
+    }
+    // the heatmap follows every analyzed frame when the processor reports
+    // frame activity, and the motion grid events otherwise
+    const auto activity = out.activity().subspan(first_activity);
+    const auto heat = [&](
+                          const activity_grid& g,
+                          const std::chrono::steady_clock::time_point ts
+                      ) {
+        const bool has_ts = ts != std::chrono::steady_clock::time_point {};
+        heatmap_by_stream.try_emplace(stream_name, heatmap_half_life)
+            .first->second.add(g, has_ts ? ts : done);
+    };
+    for (const auto& a : activity) {
+        heat(a.grid, a.ts);
     }
 
-    return fp(*sp, f);
+    const auto kinds = out.kinds();
+    for (std::size_t i = first; i < out.size(); ++i) {
+        const auto ts = out.times()[i];
+        const bool has_ts = ts != std::chrono::steady_clock::time_point {};
+        if (kinds[i] == event_kind::tripwire) {
+            crossing_counts.add(
+                stream_name, global_names().name(out.lines()[i]),
+                out.dirs()[i], has_ts ? ts : done
+            );
+        } else if (kinds[i] == event_kind::motion_grid && activity.empty()) {
+            const auto grid = out.at(i).grid;
+            if (grid != compact_event::no_grid) {
+                heat(out.grid_at(grid), ts);
+            }
+        }
+    }
+    if (sampling.enabled) {
+        update_sampler_locked(*sp, out, first, activity, done);
+    }
+}
+
+bool yodau::backend::stream_manager::wants_frame(
+    const std::string& stream_name
+) const {
+    std::scoped_lock lock(mtx);
+    if (manual_push) {
+        return true;
+    }
+    if (!frame_processor || !streams.contains(stream_name)) {
+        return false;
+    }
+
+    const auto last_it = last_analysis_ts.find(stream_name);
+    if (last_it == last_analysis_ts.end()) {
+        return true;
+    }
+
+    return std::chrono::steady_clock::now() - last_it->second
+        >= interval_locked(stream_name);
+}
+
+yodau::backend::stream_manager::latency_stats
+yodau::backend::stream_manager::latency(const std::string& stream_name
+) const {
+    std::scoped_lock lock(mtx);
+    const auto it = latency_by_stream.find(stream_name);
+    return it == latency_by_stream.end() ? latency_stats {} : it->second;
+}
+
+yodau::backend::motion_heatmap
+yodau::backend::stream_manager::heatmap(const std::string& stream_name) const {
+    std::scoped_lock lock(mtx);
+    const auto it = heatmap_by_stream.find(stream_name);
+    return it == heatmap_by_stream.end() ? motion_heatmap(heatmap_half_life)
+                                         : it->second;
+}
+
+void yodau::backend::stream_manager::set_heatmap_half_life(
+    const std::chrono::steady_clock::duration half_life
+) {
+    std::scoped_lock lock(mtx);
+    heatmap_half_life = half_life;
+    for (auto& map : heatmap_by_stream | std::views::values) {
+        map.set_half_life(half_life);
+    }
+}
+
+std::chrono::steady_clock::duration
+yodau::backend::stream_manager::get_heatmap_half_life() const {
+    std::scoped_lock lock(mtx);
+    return heatmap_half_life;
+}
+
+void yodau::backend::stream_manager::clear_heatmap(
+    const std::string& stream_name
+) {
+    std::scoped_lock lock(mtx);
+    heatmap_by_stream.erase(stream_name);
+}
+
+std::vector<yodau::backend::crossing_counters::row>
+yodau::backend::stream_manager::crossings(const std::string& stream_name
+) const {
+    std::scoped_lock lock(mtx);
+    return crossing_counts.snapshot(
+        stream_name, std::chrono::steady_clock::now()
+    );
 }
 
 void yodau::backend::stream_manager::set_event_sink(event_sink_fn fn) {
@@ -318,6 +547,47 @@ void yodau::backend::stream_manager::set_event_batch_sink(
     event_batch_sink = std::move(fn);
 }
 
+void yodau::backend::stream_manager::set_compact_sink(compact_sink_fn fn) {
+    std::scoped_lock lock(mtx);
+    compact_sink = std::move(fn);
+}
+
+void yodau::backend::stream_manager::set_event_budget(const rate_rule& rule) {
+    std::scoped_lock lock(mtx);
+    event_budget = rule;
+}
+
+yodau::backend::rate_rule
+yodau::backend::stream_manager::get_event_budget() const {
+    std::scoped_lock lock(mtx);
+    return event_budget;
+}
+
+std::uint64_t yodau::backend::stream_manager::dropped_events() const {
+    std::scoped_lock lock(mtx);
+    return budget_dropped;
+}
+
+void yodau::backend::stream_manager::apply_event_budget(event_batch& events) {
+    if (events.empty()) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    std::scoped_lock lock(mtx);
+    if (event_budget.unlimited()) {
+        return;
+    }
+    // the bucket does not refill within one batch, so the admitted events
+    // are a prefix
+    std::size_t kept = 0;
+    while (kept < events.size()
+           && event_budget_state.take(event_budget, now)) {
+        ++kept;
+    }
+    budget_dropped += events.size() - kept;
+    events.truncate(kept);
+}
+
 void yodau::backend::stream_manager::set_analysis_interval_ms(int ms) {
     if (ms <= 0) {
         return;
@@ -326,13 +596,93 @@ void yodau::backend::stream_manager::set_analysis_interval_ms(int ms) {
     analysis_interval_ms = ms;
 }
 
+void yodau::backend::stream_manager::set_sampling(const sampling_config& cfg) {
+    std::scoped_lock lock(mtx);
+    sampling = cfg;
+    if (!sampling.enabled) {
+        sampler_by_stream.clear();
+    }
+}
+
+yodau::backend::sampling_config
+yodau::backend::stream_manager::get_sampling() const {
+    std::scoped_lock lock(mtx);
+    return sampling;
+}
+
+std::chrono::milliseconds yodau::backend::stream_manager::analysis_interval(
+    const std::string& stream_name
+) const {
+    std::scoped_lock lock(mtx);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        interval_locked(stream_name)
+    );
+}
+
+std::chrono::steady_clock::duration
+yodau::backend::stream_manager::interval_locked(const std::string& stream_name
+) const {
+    const std::chrono::milliseconds base { analysis_interval_ms };
+    if (!sampling.enabled) {
+        return base;
+    }
+    const auto it = sampler_by_stream.find(stream_name);
+    // streams are analyzed at the regular rate until their first plan
+    if (it == sampler_by_stream.end()
+        || it->second.interval() == std::chrono::steady_clock::duration {}) {
+        return base;
+    }
+    return it->second.interval();
+}
+
+void yodau::backend::stream_manager::update_sampler_locked(
+    const stream& s, const event_batch& events, const std::size_t first,
+    const std::span<const frame_activity> activity,
+    const std::chrono::steady_clock::time_point now
+) {
+    auto& sampler = sampler_by_stream[s.get_name()];
+    const auto observe = [&](
+                             const float x, const float y,
+                             const std::chrono::steady_clock::time_point ts
+                         ) {
+        const bool has_ts = ts != std::chrono::steady_clock::time_point {};
+        sampler.observe({ x, y }, has_ts ? ts : now, sampling);
+    };
+    // frame activity carries the motion of every analyzed frame; motion
+    // events may be thinned out by the motion rate limit
+    if (!activity.empty()) {
+        for (const auto& a : activity) {
+            if (a.has_pos()) {
+                observe(a.x, a.y, a.ts);
+            }
+        }
+    } else {
+        const auto kinds = events.kinds();
+        for (std::size_t i = first; i < events.size(); ++i) {
+            const auto e = events.at(i);
+            if (kinds[i] == event_kind::motion && e.has_pos()) {
+                observe(e.x, e.y, e.ts);
+            }
+        }
+    }
+    sampler.update(
+        *s.compiled_lines(), sampling,
+        std::chrono::milliseconds(analysis_interval_ms), now
+    );
+}
+
 void yodau::backend::stream_manager::start_stream(const std::string& name) {
     std::shared_ptr<stream> sp;
+    std::shared_ptr<shared_capture> cap;
     daemon_start_fn ds;
+#ifdef __linux__
+    std::shared_ptr<capture_engine> eng;
+    capture_source_fn make_source;
+#endif
 
     {
         std::scoped_lock lock(mtx);
-        if (!daemon_start || daemons.contains(name)) {
+        if (running.contains(name)) {
             return;
         }
 
@@ -342,42 +692,135 @@ void yodau::backend::stream_manager::start_stream(const std::string& name) {
         }
 
         sp = it->second;
+        const auto path = sp->get_path();
+
+        if (const auto cit = captures.find(path); cit != captures.end()) {
+            const auto& source = *cit->second->source;
+            const auto& want = sp->requested_format();
+            if (!want.empty() && want != source.requested_format()) {
+                throw std::runtime_error(
+                    "stream '" + name + "' requests " + format_text(want)
+                    + ", but " + path + " is already captured with "
+                    + format_text(source.requested_format())
+                );
+            }
+            sp->report_negotiated_format(source.negotiated_format());
+            auto subs = std::make_shared<std::vector<std::string>>(
+                *cit->second->subscribers
+            );
+            subs->push_back(name);
+            cit->second->subscribers = std::move(subs);
+            running.emplace(name, path);
+            sp->activate(stream_pipeline::automatic);
+            return;
+        }
+
         ds = daemon_start;
 
 #ifdef __linux__
         if (!is_linux_capture_ok(*sp)) {
             return;
         }
+        if (engine && engine_source) {
+            eng = engine;
+            make_source = engine_source;
+        }
+        if (!ds && !eng) {
+            return;
+        }
+#else
+        if (!ds) {
+            return;
+        }
 #endif
 
+        // registered before it runs, so that concurrent starts of the same
+        // source subscribe instead of opening it again
+        cap = std::make_shared<shared_capture>();
+        cap->path = path;
+        cap->source = sp;
+        cap->subscribers
+            = std::make_shared<const std::vector<std::string>>(1, name);
+        captures.emplace(path, cap);
+        running.emplace(name, path);
         sp->activate(stream_pipeline::automatic);
     }
 
-    std::jthread th([this, name, sp, ds](std::stop_token st) mutable {
+    const shared_capture* c = cap.get();
+    const auto registered = [this, &cap] {
+        const auto it = captures.find(cap->path);
+        return it != captures.end() && it->second == cap;
+    };
+
+#ifdef __linux__
+    if (eng) {
+        auto src = make_source(*sp);
+        if (src
+            && eng->add(
+                cap->path, std::move(src),
+                [this, c](frame&& f) { fan_out(*c, std::move(f)); },
+                [this, c] { return any_wants_frame(*c); }
+            )) {
+            bool orphaned = false;
+            {
+                std::scoped_lock lock(mtx);
+                cap->engine = eng;
+                orphaned = !registered();
+            }
+            if (orphaned) {
+                eng->remove(cap->path);
+            }
+            return;
+        }
+    }
+#endif
+
+    if (!ds) {
+        std::scoped_lock lock(mtx);
+        if (registered()) {
+            drop_capture_locked(cap);
+        }
+        return;
+    }
+
+    std::jthread th([this, c, sp, ds](std::stop_token st) mutable {
         ds(
-            *sp, [this, name](frame&& f) { push_frame(name, std::move(f)); }, st
+            *sp, [this, c](frame&& f) { fan_out(*c, std::move(f)); },
+            [this, c] { return any_wants_frame(*c); }, st
         );
     });
 
-    {
-        std::scoped_lock lock(mtx);
-        daemons.emplace(name, std::move(th));
+    // a capture stopped meanwhile leaves th to be joined here
+    std::scoped_lock lock(mtx);
+    if (registered()) {
+        cap->thread = std::move(th);
     }
 }
 
 void yodau::backend::stream_manager::stop_stream(const std::string& name) {
-    std::jthread th;
+    std::shared_ptr<shared_capture> cap;
     std::shared_ptr<stream> sp;
 
     {
         std::scoped_lock lock(mtx);
-        const auto it = daemons.find(name);
-        if (it == daemons.end()) {
+        const auto it = running.find(name);
+        if (it == running.end()) {
             return;
         }
 
-        th = std::move(it->second);
-        daemons.erase(it);
+        const auto cit = captures.find(it->second);
+        running.erase(it);
+        if (cit != captures.end()) {
+            auto subs = std::make_shared<std::vector<std::string>>(
+                *cit->second->subscribers
+            );
+            std::erase(*subs, name);
+            cit->second->subscribers = subs;
+            if (subs->empty()) {
+                cap = std::move(cit->second);
+                captures.erase(cit);
+            }
+        }
 
         const auto sit = streams.find(name);
         if (sit != streams.end()) {
@@ -385,7 +828,16 @@ void yodau::backend::stream_manager::stop_stream(const std::string& name) {
         }
     }
 
-    th.request_stop();
+    // the last subscriber stops the capture; joined outside the lock since
+    // its callbacks take it
+    if (cap) {
+#ifdef __linux__
+        if (cap->engine) {
+            cap->engine->remove(cap->path);
+        }
+#endif
+        cap.reset();
+    }
 
     if (sp) {
         std::scoped_lock lock(mtx);
@@ -397,7 +849,68 @@ bool yodau::backend::stream_manager::is_stream_running(
     const std::string& name
 ) const {
     std::scoped_lock lock(mtx);
-    return daemons.contains(name);
+    return running.contains(name);
+}
+
+void yodau::backend::stream_manager::fan_out(
+    const shared_capture& c, frame&& f
+) {
+    std::shared_ptr<const std::vector<std::string>> subs;
+    {
+        std::scoped_lock lock(mtx);
+        subs = c.subscribers;
+    }
+    if (!subs || subs->empty()) {
+        return;
+    }
+
+    // the format is negotiated before the first frame; subscribers joining
+    // after this copy it themselves (see start_stream)
+    if (!c.format_shared.exchange(true)) {
+        const auto fmt = c.source->negotiated_format();
+        for (const auto& name : *subs) {
+            if (const auto sp = find_stream(name)) {
+                sp->report_negotiated_format(fmt);
+            }
+        }
+    }
+
+    if (subs->size() > 1) {
+        f.share();
+        for (size_t i = 0; i + 1 < subs->size(); ++i) {
+            push_frame((*subs)[i], frame(f));
+        }
+    }
+    push_frame(subs->back(), std::move(f));
+}
+
+bool yodau::backend::stream_manager::any_wants_frame(
+    const shared_capture& c
+) const {
+    std::shared_ptr<const std::vector<std::string>> subs;
+    {
+        std::scoped_lock lock(mtx);
+        subs = c.subscribers;
+    }
+    if (!subs) {
+        return false;
+    }
+    return std::ranges::any_of(*subs, [this](const std::string& name) {
+        return wants_frame(name);
+    });
+}
+
+void yodau::backend::stream_manager::drop_capture_locked(
+    const std::shared_ptr<shared_capture>& c
+) {
+    for (const auto& name : *c->subscribers) {
+        running.erase(name);
+        if (const auto it = streams.find(name);
+            it != streams.end() && it->second) {
+            it->second->deactivate();
+        }
+    }
+    captures.erase(c->path);
 }
 
 void yodau::backend::stream_manager::enable_fake_events(const int interval_ms) {
@@ -462,6 +975,11 @@ void yodau::backend::stream_manager::set_line_dir(
     new_ptr->dir = dir;
 
     it->second = new_ptr;
+    for (const auto& sp : streams | std::views::values) {
+        if (sp) {
+            sp->replace_line(new_ptr);
+        }
+    }
 }
 
 std::vector<std::shared_ptr<yodau::backend::stream>>
@@ -480,12 +998,14 @@ yodau::backend::stream_manager::snapshot_streams() const {
 }
 
 void yodau::backend::stream_manager::snapshot_hooks(
-    frame_processor_fn& fp, event_sink_fn& es, event_batch_sink_fn& bes
+    batch_processor_fn& fp, event_sink_fn& es, event_batch_sink_fn& bes,
+    compact_sink_fn& cs
 ) const {
     std::scoped_lock lock(mtx);
     fp = frame_processor;
     es = event_sink;
     bes = event_batch_sink;
+    cs = compact_sink;
 }
 
 int yodau::backend::stream_manager::current_fake_interval_ms() const {
@@ -495,27 +1015,25 @@ int yodau::backend::stream_manager::current_fake_interval_ms() const {
 
 void yodau::backend::stream_manager::run_fake_events(std::stop_token st) {
     frame dummy;
+    event_batch evs;
 
     while (!st.stop_requested()) {
         auto snap = snapshot_streams();
 
-        frame_processor_fn fp;
+        batch_processor_fn fp;
         event_sink_fn es;
         event_batch_sink_fn bes;
-        snapshot_hooks(fp, es, bes);
+        compact_sink_fn cs;
+        snapshot_hooks(fp, es, bes, cs);
 
         if (fp) {
             for (const auto& sp : snap) {
-                auto evs = fp(*sp, dummy);
-
-                if (bes) {
-                    if (!evs.empty()) {
-                        bes(evs);
-                    }
-                } else if (es) {
-                    for (const auto& e : evs) {
-                        es(e);
-                    }
+                evs.clear();
+                fp(*sp, dummy, evs);
+                apply_event_budget(evs);
+
+                if (!evs.empty()) {
+                    deliver(evs, es, bes, cs);
                 }
             }
         }
@@ -0,0 +1,353 @@
+#ifdef __linux__
+
+#include "v4l2_capture.hpp"
+
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <mutex>
+#include <vector>
+
+namespace {
+class system_io final : public yodau::backend::v4l2_io {
+public:
+    int open(const char* path, const int flags) override {
+        return ::open(path, flags);
+    }
+
+    int close(const int fd) override { return ::close(fd); }
+
+    int ioctl(const int fd, const unsigned long request, void* arg) override {
+        int rc = 0;
+        do {
+            rc = ::ioctl(fd, request, arg);
+        } while (rc < 0 && errno == EINTR);
+        return rc;
+    }
+
+    void* mmap(
+        void* addr, const std::size_t len, const int prot, const int flags,
+        const int fd, const off_t off
+    ) override {
+        return ::mmap(addr, len, prot, flags, fd, off);
+    }
+
+    int munmap(void* addr, const std::size_t len) override {
+        return ::munmap(addr, len);
+    }
+
+    int poll(pollfd* fds, const nfds_t nfds, const int timeout_ms) override {
+        return ::poll(fds, nfds, timeout_ms);
+    }
+};
+}
+
+// open device state shared between the capture and the frames it handed
+// out; the last owner unmaps the buffers and closes the descriptor
+struct yodau::backend::v4l2_capture::device {
+    struct mapping {
+        void* ptr { nullptr };
+        std::size_t len { 0 };
+    };
+
+    device(std::shared_ptr<v4l2_io> io_, const int fd_)
+        : io(std::move(io_))
+        , fd(fd_) { }
+
+    ~device() {
+        for (const auto& m : mappings) {
+            io->munmap(m.ptr, m.len);
+        }
+        io->close(fd);
+    }
+
+    device(const device&) = delete;
+    device& operator=(const device&) = delete;
+
+    bool queue(const unsigned index) {
+        v4l2_buffer buf {};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = index;
+        return io->ioctl(fd, VIDIOC_QBUF, &buf) == 0;
+    }
+
+    // hand a released frame's buffer back to the driver
+    void requeue(const unsigned index) {
+        std::scoped_lock lock(mtx);
+        if (streaming) {
+            queue(index);
+        }
+    }
+
+    void stop() {
+        std::scoped_lock lock(mtx);
+        if (!streaming) {
+            return;
+        }
+        streaming = false;
+        int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        io->ioctl(fd, VIDIOC_STREAMOFF, &type);
+    }
+
+    std::shared_ptr<v4l2_io> io;
+    int fd { -1 };
+    std::vector<mapping> mappings;
+    std::mutex mtx;
+    bool streaming { false };
+};
+
+std::shared_ptr<yodau::backend::v4l2_io> yodau::backend::system_v4l2_io() {
+    static const auto io = std::make_shared<system_io>();
+    return io;
+}
+
+yodau::backend::v4l2_capture::v4l2_capture(std::shared_ptr<v4l2_io> io_)
+    : io(std::move(io_)) { }
+
+yodau::backend::v4l2_capture::~v4l2_capture() { close(); }
+
+bool yodau::backend::v4l2_capture::open(
+    const std::string& path, const config& cfg
+) {
+    close();
+    if (!io) {
+        return false;
+    }
+
+    const int fd = io->open(path.c_str(), O_RDWR | O_NONBLOCK);
+    if (fd < 0) {
+        return false;
+    }
+    auto d = std::make_shared<device>(io, fd);
+
+    v4l2_capability cap {};
+    if (io->ioctl(fd, VIDIOC_QUERYCAP, &cap) < 0) {
+        return false;
+    }
+    std::uint32_t caps = cap.capabilities;
+    if (caps & V4L2_CAP_DEVICE_CAPS) {
+        caps = cap.device_caps;
+    }
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps & V4L2_CAP_STREAMING)) {
+        return false;
+    }
+
+    v4l2_format fmt {};
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (io->ioctl(fd, VIDIOC_G_FMT, &fmt) < 0) {
+        return false;
+    }
+    if (cfg.width > 0 && cfg.height > 0) {
+        fmt.fmt.pix.width = static_cast<std::uint32_t>(cfg.width);
+        fmt.fmt.pix.height = static_cast<std::uint32_t>(cfg.height);
+    }
+    fmt.fmt.pix.pixelformat = cfg.fourcc ? cfg.fourcc : V4L2_PIX_FMT_YUYV;
+    fmt.fmt.pix.field = V4L2_FIELD_ANY;
+    if (io->ioctl(fd, VIDIOC_S_FMT, &fmt) < 0) {
+        return false;
+    }
+
+    // the driver may substitute another format; only keep what the
+    // analysis path reads directly
+    int bytes_per_px = 0;
+    if (fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_YUYV) {
+        format = pixel_format::yuyv422;
+        bytes_per_px = 2;
+    } else if (fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_GREY) {
+        format = pixel_format::gray8;
+        bytes_per_px = 1;
+    } else {
+        return false;
+    }
+
+    w = static_cast<int>(fmt.fmt.pix.width);
+    h = static_cast<int>(fmt.fmt.pix.height);
+    bpl = static_cast<int>(fmt.fmt.pix.bytesperline);
+    if (bpl < w * bytes_per_px) {
+        bpl = w * bytes_per_px;
+    }
+    pixfmt = fmt.fmt.pix.pixelformat;
+
+    v4l2_streamparm parm {};
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (cfg.fps > 0.0) {
+        parm.parm.capture.timeperframe.numerator = 1000;
+        parm.parm.capture.timeperframe.denominator
+            = static_cast<std::uint32_t>(cfg.fps * 1000.0);
+        io->ioctl(fd, VIDIOC_S_PARM, &parm);
+    } else {
+        io->ioctl(fd, VIDIOC_G_PARM, &parm);
+    }
+    const auto& tpf = parm.parm.capture.timeperframe;
+    rate = 0.0;
+    if (tpf.numerator > 0) {
+        rate = static_cast<double>(tpf.denominator) / tpf.numerator;
+    }
+
+    v4l2_requestbuffers req {};
+    req.count = cfg.buffers < 2 ? 2 : cfg.buffers;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (io->ioctl(fd, VIDIOC_REQBUFS, &req) < 0 || req.count < 2) {
+        return false;
+    }
+
+    for (unsigned i = 0; i < req.count; ++i) {
+        v4l2_buffer buf {};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (io->ioctl(fd, VIDIOC_QUERYBUF, &buf) < 0) {
+            return false;
+        }
+
+        void* ptr = io->mmap(
+            nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+            static_cast<off_t>(buf.m.offset)
+        );
+        if (ptr == MAP_FAILED) {
+            return false;
+        }
+        d->mappings.push_back({ ptr, buf.length });
+    }
+
+    for (unsigned i = 0; i < req.count; ++i) {
+        if (!d->queue(i)) {
+            return false;
+        }
+    }
+
+    int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (io->ioctl(fd, VIDIOC_STREAMON, &type) < 0) {
+        return false;
+    }
+    d->streaming = true;
+
+    dev = std::move(d);
+    return true;
+}
+
+void yodau::backend::v4l2_capture::close() {
+    if (!dev) {
+        return;
+    }
+    dev->stop();
+    dev.reset();
+}
+
+bool yodau::backend::v4l2_capture::is_open() const { return dev != nullptr; }
+
+yodau::backend::v4l2_capture::read_result
+yodau::backend::v4l2_capture::dequeue(
+    const int timeout_ms, unsigned& index, std::size_t& bytes
+) {
+    if (!dev) {
+        return read_result::error;
+    }
+
+    pollfd pfd {};
+    pfd.fd = dev->fd;
+    pfd.events = POLLIN;
+    const int rc = io->poll(&pfd, 1, timeout_ms);
+    if (rc == 0 || (rc < 0 && errno == EINTR)) {
+        return read_result::timeout;
+    }
+    if (rc < 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+        return read_result::error;
+    }
+
+    v4l2_buffer buf {};
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if (io->ioctl(dev->fd, VIDIOC_DQBUF, &buf) < 0) {
+        return errno == EAGAIN ? read_result::timeout : read_result::error;
+    }
+    if (buf.index >= dev->mappings.size()) {
+        return read_result::error;
+    }
+
+    index = buf.index;
+    bytes = buf.bytesused;
+    return read_result::ok;
+}
+
+yodau::backend::v4l2_capture::read_result
+yodau::backend::v4l2_capture::read(frame& out, const int timeout_ms) {
+    unsigned index = 0;
+    std::size_t bytes = 0;
+    const auto res = dequeue(timeout_ms, index, bytes);
+    if (res != read_result::ok) {
+        return res;
+    }
+
+    const auto& m = dev->mappings[index];
+    const auto needed = static_cast<std::size_t>(bpl) * static_cast<size_t>(h);
+    if (bytes < needed || m.len < needed) {
+        // short/corrupted buffer: skip it
+        dev->requeue(index);
+        return read_result::timeout;
+    }
+
+    out = frame {};
+    out.width = w;
+    out.height = h;
+    out.stride = bpl;
+    out.format = format;
+    out.ts = std::chrono::steady_clock::now();
+    out.external_size = bytes;
+    out.external = std::shared_ptr<const std::uint8_t>(
+        static_cast<const std::uint8_t*>(m.ptr),
+        [d = dev, index](const std::uint8_t*) { d->requeue(index); }
+    );
+    return read_result::ok;
+}
+
+yodau::backend::v4l2_capture::read_result
+yodau::backend::v4l2_capture::drop(const int timeout_ms) {
+    unsigned index = 0;
+    std::size_t bytes = 0;
+    const auto res = dequeue(timeout_ms, index, bytes);
+    if (res == read_result::ok) {
+        dev->requeue(index);
+    }
+    return res;
+}
+
+int yodau::backend::v4l2_capture::width() const { return w; }
+
+int yodau::backend::v4l2_capture::height() const { return h; }
+
+int yodau::backend::v4l2_capture::stride() const { return bpl; }
+
+std::uint32_t yodau::backend::v4l2_capture::fourcc() const { return pixfmt; }
+
+double yodau::backend::v4l2_capture::fps() const { return rate; }
+
+yodau::backend::capture_format
+yodau::backend::v4l2_capture::negotiated() const {
+    capture_format out;
+    out.width = w;
+    out.height = h;
+    out.fps = rate;
+    out.fourcc = capture_format::fourcc_name(pixfmt);
+    return out;
+}
+
+int yodau::backend::v4l2_capture::fd() const { return dev ? dev->fd : -1; }
+
+yodau::backend::v4l2_capture::config
+yodau::backend::v4l2_capture::config::for_format(const capture_format& fmt) {
+    config cfg;
+    cfg.width = fmt.width;
+    cfg.height = fmt.height;
+    cfg.fps = fmt.fps;
+    cfg.fourcc = fmt.fourcc_code();
+    return cfg;
+}
+
+#endif // __linux__
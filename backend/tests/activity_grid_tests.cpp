@@ -0,0 +1,43 @@
+#include "activity_grid.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using yodau::backend::activity_grid;
+using yodau::backend::compute_activity_grid;
+
+TEST(ActivityGrid, EmptyMaskIsAllZero) {
+    const std::vector<std::uint8_t> mask(640 * 360, 0);
+    const auto g = compute_activity_grid(mask.data(), 640, 360, 640);
+    EXPECT_EQ(g.active_cells(), 0);
+}
+
+TEST(ActivityGrid, FullMaskSaturatesEveryCell) {
+    const std::vector<std::uint8_t> mask(641 * 361, 255);
+    const auto g = compute_activity_grid(mask.data(), 641, 361, 641);
+    EXPECT_EQ(g.active_cells(255), activity_grid::cols * activity_grid::rows);
+}
+
+TEST(ActivityGrid, SingleCellAndStride) {
+    const int w = 320;
+    const int h = 180;
+    const int stride = 352;
+    std::vector<std::uint8_t> mask(static_cast<size_t>(stride * h), 0);
+
+    for (int y = 10; y < 20; ++y) {
+        for (int x = 30; x < 40; ++x) {
+            mask[static_cast<size_t>(y * stride + x)] = 255;
+        }
+    }
+    for (int y = 0; y < h; ++y) {
+        for (int x = w; x < stride; ++x) {
+            mask[static_cast<size_t>(y * stride + x)] = 255;
+        }
+    }
+
+    const auto g = compute_activity_grid(mask.data(), w, h, stride);
+    EXPECT_EQ(g.active_cells(), 1);
+    EXPECT_EQ(g.at(3, 1), 255);
+    EXPECT_EQ(g.at(-1, 0), 0);
+}
@@ -0,0 +1,143 @@
+#include "adaptive_sampler.hpp"
+#include "stream_manager.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using yodau::backend::adaptive_sampler;
+using yodau::backend::compact_event;
+using yodau::backend::event_batch;
+using yodau::backend::event_kind;
+using yodau::backend::frame;
+using yodau::backend::line_set;
+using yodau::backend::make_line;
+using yodau::backend::sampling_config;
+using yodau::backend::stream;
+using yodau::backend::stream_manager;
+
+namespace {
+// vertical tripwire through the middle of the frame
+line_set middle_line() {
+    return line_set({ make_line({ { 50, 0 }, { 50, 100 } }, "door") });
+}
+} // namespace
+
+TEST(AdaptiveSampler, QuietAndFarMotionKeepSlowRates) {
+    using namespace std::chrono_literals;
+    const auto lines = middle_line();
+    const sampling_config cfg;
+    const auto t0 = adaptive_sampler::clock::time_point {} + 1h;
+
+    adaptive_sampler s;
+    EXPECT_EQ(s.plan(lines, cfg, 200ms, t0), cfg.idle_interval);
+
+    // slow motion far from the line, and motion moving away from it
+    s.observe({ 10, 50 }, t0, cfg);
+    s.observe({ 11, 50 }, t0 + 100ms, cfg);
+    EXPECT_EQ(s.plan(lines, cfg, 200ms, t0 + 100ms), 200ms);
+    s.observe({ 70, 50 }, t0 + 200ms, cfg);
+    s.observe({ 80, 50 }, t0 + 300ms, cfg);
+    EXPECT_EQ(s.plan(lines, cfg, 200ms, t0 + 300ms), 200ms);
+
+    // and idle again once the scene is quiet
+    EXPECT_EQ(
+        s.plan(lines, cfg, 200ms, t0 + 300ms + cfg.quiet + 1ms),
+        cfg.idle_interval
+    );
+    EXPECT_EQ(s.plan(line_set {}, cfg, 200ms, t0 + 300ms), 200ms);
+}
+
+TEST(AdaptiveSampler, SpeedsUpAsMotionApproachesLine) {
+    using namespace std::chrono_literals;
+    const auto lines = middle_line();
+    const sampling_config cfg;
+    const auto t0 = adaptive_sampler::clock::time_point {} + 1h;
+
+    adaptive_sampler s;
+    s.observe({ 10, 50 }, t0, cfg);
+    s.observe({ 30, 50 }, t0 + 200ms, cfg);
+    EXPECT_FLOAT_EQ(s.velocity().x, 100.0f);
+
+    // 15% from the near band at 100%/s: two analyses in 150 ms
+    const auto approaching = s.plan(lines, cfg, 200ms, t0 + 200ms);
+    EXPECT_GT(approaching, cfg.min_interval);
+    EXPECT_LT(approaching, 80ms);
+
+    s.observe({ 47, 50 }, t0 + 300ms, cfg);
+    s.update(lines, cfg, 200ms, t0 + 300ms);
+    EXPECT_EQ(s.interval(), cfg.min_interval);
+}
+
+TEST(AdaptiveSampler, StreamManagerFollowsMotion) {
+    using namespace std::chrono_literals;
+    stream_manager mgr;
+    mgr.add_stream("a.mp4", "a", "file");
+    mgr.add_stream("b.mp4", "b", "file");
+    mgr.add_line("50,0;50,100", false, "door");
+    mgr.set_line("a", "door");
+    mgr.set_line("b", "door");
+    mgr.set_analysis_interval_ms(200);
+
+    // stream "a" sees fast motion heading for the line, "b" sees nothing
+    mgr.set_batch_processor(
+        [](const stream& s, const frame&, event_batch& out) {
+            if (s.get_name() != "a") {
+                return;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            compact_event e;
+            e.kind = event_kind::motion;
+            e.ts = now - 100ms;
+            e.x = 10.0f;
+            e.y = 50.0f;
+            out.push_back(e);
+            e.ts = now;
+            e.x = 25.0f;
+            out.push_back(e);
+        }
+    );
+
+    sampling_config cfg;
+    cfg.enabled = true;
+    mgr.set_sampling(cfg);
+    EXPECT_TRUE(mgr.get_sampling().enabled);
+
+    EXPECT_EQ(mgr.analysis_interval("a"), 200ms);
+    mgr.process_frame("a", frame {});
+    mgr.process_frame("b", frame {});
+    EXPECT_GE(mgr.analysis_interval("a"), cfg.min_interval);
+    EXPECT_LT(mgr.analysis_interval("a"), 200ms);
+    EXPECT_EQ(mgr.analysis_interval("b"), cfg.idle_interval);
+
+    cfg.enabled = false;
+    mgr.set_sampling(cfg);
+    EXPECT_EQ(mgr.analysis_interval("a"), 200ms);
+}
+
+TEST(AdaptiveSampler, FollowsFrameActivityWithoutMotionEvents) {
+    using namespace std::chrono_literals;
+    stream_manager mgr;
+    mgr.add_stream("a.mp4", "a", "file");
+    mgr.add_line("50,0;50,100", false, "door");
+    mgr.set_line("a", "door");
+    mgr.set_analysis_interval_ms(200);
+
+    // motion heading for the line, with its events dropped by a rate limit
+    mgr.set_batch_processor(
+        [](const stream&, const frame&, event_batch& out) {
+            const auto now = std::chrono::steady_clock::now();
+            out.add_activity({}, now - 100ms);
+            out.set_activity_pos(10.0f, 50.0f);
+            out.add_activity({}, now);
+            out.set_activity_pos(25.0f, 50.0f);
+        }
+    );
+
+    sampling_config cfg;
+    cfg.enabled = true;
+    mgr.set_sampling(cfg);
+    mgr.process_frame("a", frame {});
+    EXPECT_GE(mgr.analysis_interval("a"), cfg.min_interval);
+    EXPECT_LT(mgr.analysis_interval("a"), 200ms);
+}
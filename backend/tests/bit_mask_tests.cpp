@@ -0,0 +1,183 @@
+#include "activity_grid.hpp"
+#include "bit_mask.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+using yodau::backend::bit_mask;
+
+namespace {
+std::vector<std::uint8_t>
+random_bytes(const int w, const int h, const double p, const unsigned seed) {
+    std::mt19937 rng(seed);
+    std::bernoulli_distribution on(p);
+    std::vector<std::uint8_t> out(static_cast<size_t>(w * h), 0);
+    for (auto& v : out) {
+        v = on(rng) ? 255 : 0;
+    }
+    return out;
+}
+
+// byte reference of a 3x3 erode/dilate with OpenCV default borders
+std::vector<std::uint8_t> reference_morph(
+    const std::vector<std::uint8_t>& src, const int w, const int h,
+    const bool erode
+) {
+    std::vector<std::uint8_t> out(src.size(), 0);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            bool acc = erode;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const int xx = x + dx;
+                    const int yy = y + dy;
+                    if (xx < 0 || xx >= w || yy < 0 || yy >= h) {
+                        continue;
+                    }
+                    const bool v = src[static_cast<size_t>(yy * w + xx)] != 0;
+                    acc = erode ? (acc && v) : (acc || v);
+                }
+            }
+            out[static_cast<size_t>(y * w + x)] = acc ? 255 : 0;
+        }
+    }
+    return out;
+}
+
+int reference_components(std::vector<std::uint8_t> src, const int w, int h) {
+    int n = 0;
+    std::vector<int> stack;
+    for (int i = 0; i < w * h; ++i) {
+        if (src[static_cast<size_t>(i)] == 0) {
+            continue;
+        }
+        ++n;
+        stack.push_back(i);
+        src[static_cast<size_t>(i)] = 0;
+        while (!stack.empty()) {
+            const int p = stack.back();
+            stack.pop_back();
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const int xx = p % w + dx;
+                    const int yy = p / w + dy;
+                    if (xx < 0 || xx >= w || yy < 0 || yy >= h) {
+                        continue;
+                    }
+                    const int q = yy * w + xx;
+                    if (src[static_cast<size_t>(q)] != 0) {
+                        src[static_cast<size_t>(q)] = 0;
+                        stack.push_back(q);
+                    }
+                }
+            }
+        }
+    }
+    return n;
+}
+
+std::vector<std::uint8_t> unpack(const bit_mask& m) {
+    std::vector<std::uint8_t> out(
+        static_cast<size_t>(m.width() * m.height()), 0
+    );
+    m.to_bytes(out.data(), static_cast<size_t>(m.width()));
+    return out;
+}
+}
+
+TEST(BitMask, PackRoundTripAndCount) {
+    const int w = 130;
+    const int h = 7;
+    const auto bytes = random_bytes(w, h, 0.3, 1);
+    const auto m
+        = bit_mask::from_bytes(bytes.data(), w, h, static_cast<size_t>(w));
+
+    EXPECT_EQ(m.words_per_row(), 3);
+    EXPECT_EQ(unpack(m), bytes);
+
+    long long expected = 0;
+    for (const auto v : bytes) {
+        expected += v != 0 ? 1 : 0;
+    }
+    EXPECT_EQ(m.count(), expected);
+
+    long long span = 0;
+    for (int x = 60; x < 70; ++x) {
+        span += m.test(x, 3) ? 1 : 0;
+    }
+    EXPECT_EQ(m.count_span(3, 60, 70), span);
+}
+
+TEST(BitMask, MorphologyMatchesReference) {
+    for (const int w : { 1, 63, 64, 65, 200 }) {
+        const int h = 23;
+        const auto bytes = random_bytes(w, h, 0.6, static_cast<unsigned>(w));
+        const auto m
+            = bit_mask::from_bytes(bytes.data(), w, h, static_cast<size_t>(w));
+
+        EXPECT_EQ(unpack(erode(m)), reference_morph(bytes, w, h, true))
+            << "width " << w;
+        EXPECT_EQ(unpack(dilate(m)), reference_morph(bytes, w, h, false))
+            << "width " << w;
+
+        const auto twice = reference_morph(
+            reference_morph(bytes, w, h, false), w, h, false
+        );
+        EXPECT_EQ(unpack(dilate(m, 2)), twice) << "width " << w;
+    }
+}
+
+TEST(BitMask, ComponentsMatchFloodFill) {
+    const int w = 150;
+    const int h = 40;
+    const auto bytes = random_bytes(w, h, 0.35, 7);
+    const auto m
+        = bit_mask::from_bytes(bytes.data(), w, h, static_cast<size_t>(w));
+
+    const auto labels = label_components(m);
+    EXPECT_EQ(
+        static_cast<int>(labels.components.size()),
+        reference_components(bytes, w, h)
+    );
+
+    long long area = 0;
+    for (const auto& c : labels.components) {
+        area += c.area;
+    }
+    EXPECT_EQ(area, m.count());
+}
+
+TEST(BitMask, LargestComponentAcrossWords) {
+    bit_mask m(200, 10);
+    for (int x = 50; x < 150; ++x) {
+        m.set(x, 4);
+    }
+    m.set(150, 5);
+    m.set(10, 0);
+
+    const auto labels = label_components(m);
+    ASSERT_EQ(labels.components.size(), 2u);
+
+    const auto& c = labels.components[static_cast<size_t>(labels.largest())];
+    EXPECT_EQ(c.area, 101);
+    EXPECT_EQ(c.x0, 50);
+    EXPECT_EQ(c.x1, 151);
+    EXPECT_EQ(c.y0, 4);
+    EXPECT_EQ(c.y1, 6);
+}
+
+TEST(BitMask, ActivityGridMatchesByteMask) {
+    const int w = 333;
+    const int h = 181;
+    const auto bytes = random_bytes(w, h, 0.2, 3);
+    const auto m
+        = bit_mask::from_bytes(bytes.data(), w, h, static_cast<size_t>(w));
+
+    const auto a = yodau::backend::compute_activity_grid(
+        bytes.data(), w, h, static_cast<size_t>(w)
+    );
+    const auto b = yodau::backend::compute_activity_grid(m);
+    EXPECT_EQ(a.cells, b.cells);
+}
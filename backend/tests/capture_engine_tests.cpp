@@ -0,0 +1,404 @@
+#ifdef __linux__
+
+#include "capture_engine.hpp"
+#include "stream_manager.hpp"
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using yodau::backend::capture_engine;
+using yodau::backend::capture_source;
+using yodau::backend::frame;
+using yodau::backend::http_mjpeg_source;
+using yodau::backend::stream;
+using yodau::backend::stream_manager;
+
+namespace {
+// every byte written to the socket is one frame, its value stored as width
+class byte_source final : public capture_source {
+public:
+    explicit byte_source(const int read_fd, std::atomic<int>* reads = nullptr)
+        : rd(read_fd)
+        , reads(reads) { }
+
+    ~byte_source() override { ::close(rd); }
+
+    byte_source(const byte_source&) = delete;
+    byte_source& operator=(const byte_source&) = delete;
+
+    int fd() const override { return rd; }
+
+    read_result read(frame& out, const bool wanted) override {
+        unsigned char value = 0;
+        const auto n = ::read(rd, &value, 1);
+        if (n == 0) {
+            return read_result::end;
+        }
+        if (n < 0) {
+            return errno == EAGAIN ? read_result::none : read_result::end;
+        }
+        if (reads) {
+            ++*reads;
+        }
+        if (!wanted) {
+            return read_result::none;
+        }
+        out = frame {};
+        out.width = value;
+        return read_result::frame;
+    }
+
+private:
+    int rd;
+    std::atomic<int>* reads;
+};
+
+// a socket pair rather than a pipe: writing after the source closed its end
+// must not raise SIGPIPE
+struct socket_pair {
+    socket_pair() {
+        int fds[2] = { -1, -1 };
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0) {
+            rd = fds[0];
+            wr = fds[1];
+        }
+    }
+
+    ~socket_pair() { close_writer(); }
+
+    socket_pair(const socket_pair&) = delete;
+    socket_pair& operator=(const socket_pair&) = delete;
+
+    void write(const unsigned char value) const {
+        [[maybe_unused]] const auto n = ::send(wr, &value, 1, MSG_NOSIGNAL);
+    }
+
+    void close_writer() {
+        if (wr >= 0) {
+            ::close(wr);
+            wr = -1;
+        }
+    }
+
+    int rd { -1 };
+    int wr { -1 };
+};
+
+void send_text(const int fd, const std::string& text) {
+    [[maybe_unused]] const auto n
+        = ::send(fd, text.data(), text.size(), MSG_NOSIGNAL);
+}
+
+// stands in for a JPEG decoder: the image size becomes the frame width
+bool fake_decode(const std::uint8_t* data, const std::size_t size, frame& out) {
+    if (size < 2 || data[0] != 0xFF || data[1] != 0xD8) {
+        return false;
+    }
+    out = frame {};
+    out.width = static_cast<int>(size);
+    out.height = 1;
+    return true;
+}
+
+std::string bytes_of(const frame& f) {
+    return { reinterpret_cast<const char*>(f.bytes()), f.size() };
+}
+
+const std::string mjpeg_response = "HTTP/1.0 200 OK\r\n"
+                                   "Content-Type: multipart/x-mixed-replace;"
+                                   " boundary=\"frame\"\r\n\r\n";
+
+template <typename Pred> bool wait_for(Pred pred) {
+    const auto deadline
+        = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+}
+
+TEST(CaptureEngine, ServesManySourcesOnFewThreads) {
+    capture_engine engine({ 2, 2 });
+    constexpr int sources = 64;
+
+    std::vector<std::unique_ptr<socket_pair>> sockets;
+    std::vector<std::atomic<int>> got(sources);
+    for (int i = 0; i < sources; ++i) {
+        auto p = std::make_unique<socket_pair>();
+        ASSERT_GE(p->rd, 0);
+        ASSERT_TRUE(engine.add(
+            "s" + std::to_string(i), std::make_unique<byte_source>(p->rd),
+            [&got, i](frame&& f) {
+                got[static_cast<size_t>(i)] = f.width;
+            }
+        ));
+        sockets.push_back(std::move(p));
+    }
+    EXPECT_EQ(engine.size(), static_cast<size_t>(sources));
+    EXPECT_FALSE(engine.add(
+        "s0", std::make_unique<byte_source>(::dup(sockets[0]->rd)),
+        [](frame&&) { }
+    ));
+
+    for (int i = 0; i < sources; ++i) {
+        sockets[static_cast<size_t>(i)]->write(
+            static_cast<unsigned char>(i + 1)
+        );
+    }
+    EXPECT_TRUE(wait_for([&] {
+        for (int i = 0; i < sources; ++i) {
+            if (got[static_cast<size_t>(i)] != i + 1) {
+                return false;
+            }
+        }
+        return true;
+    }));
+}
+
+TEST(CaptureEngine, SlowConsumerGetsNewestFramesInOrder) {
+    capture_engine engine({ 1, 4 });
+    socket_pair p;
+    ASSERT_GE(p.rd, 0);
+
+    std::mutex seen_mtx;
+    std::vector<int> seen;
+    std::atomic<int> inside { 0 };
+    std::atomic<bool> overlap { false };
+    ASSERT_TRUE(engine.add(
+        "slow", std::make_unique<byte_source>(p.rd), [&](frame&& f) {
+            if (inside.fetch_add(1) != 0) {
+                overlap = true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            {
+                std::scoped_lock lock(seen_mtx);
+                seen.push_back(f.width);
+            }
+            inside.fetch_sub(1);
+        }
+    ));
+
+    constexpr int frames = 40;
+    for (int i = 1; i <= frames; ++i) {
+        p.write(static_cast<unsigned char>(i));
+    }
+    ASSERT_TRUE(wait_for([&] {
+        std::scoped_lock lock(seen_mtx);
+        return !seen.empty() && seen.back() == frames;
+    }));
+
+    std::scoped_lock lock(seen_mtx);
+    EXPECT_FALSE(overlap);
+    for (size_t i = 1; i < seen.size(); ++i) {
+        EXPECT_LT(seen[i - 1], seen[i]);
+    }
+    EXPECT_EQ(seen.size() + engine.dropped(), static_cast<size_t>(frames));
+}
+
+TEST(CaptureEngine, UnwantedFramesAreNotDelivered) {
+    capture_engine engine({ 1, 1 });
+    socket_pair p;
+    ASSERT_GE(p.rd, 0);
+
+    std::atomic<int> reads { 0 };
+    std::atomic<int> delivered { 0 };
+    ASSERT_TRUE(engine.add(
+        "idle", std::make_unique<byte_source>(p.rd, &reads),
+        [&](frame&&) { ++delivered; }, [] { return false; }
+    ));
+
+    for (int i = 0; i < 3; ++i) {
+        p.write(1);
+    }
+    EXPECT_TRUE(wait_for([&] { return reads == 3; }));
+    EXPECT_EQ(delivered, 0);
+}
+
+TEST(CaptureEngine, RemovedAndEndedSources) {
+    capture_engine engine({ 1, 1 });
+    socket_pair p;
+    ASSERT_GE(p.rd, 0);
+
+    std::atomic<int> delivered { 0 };
+    ASSERT_TRUE(engine.add(
+        "cam", std::make_unique<byte_source>(p.rd),
+        [&](frame&&) { ++delivered; }
+    ));
+    p.write(1);
+    ASSERT_TRUE(wait_for([&] { return delivered == 1; }));
+
+    engine.remove("cam");
+    EXPECT_FALSE(engine.contains("cam"));
+    p.write(2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(delivered, 1);
+
+    // an ended source stays registered until removed
+    socket_pair q;
+    ASSERT_GE(q.rd, 0);
+    ASSERT_TRUE(engine.add(
+        "cam", std::make_unique<byte_source>(q.rd),
+        [&](frame&&) { ++delivered; }
+    ));
+    q.write(3);
+    q.close_writer();
+    ASSERT_TRUE(wait_for([&] { return delivered == 2; }));
+    EXPECT_TRUE(engine.contains("cam"));
+    engine.remove("cam");
+    EXPECT_EQ(engine.size(), 0u);
+}
+
+TEST(CaptureEngine, StreamManagerStartsEngineStreams) {
+    stream_manager mgr;
+    mgr.add_stream("clip.mp4", "clip", "file");
+
+    socket_pair p;
+    ASSERT_GE(p.rd, 0);
+    std::atomic<int> pushed { 0 };
+    mgr.set_manual_push_hook([&](const std::string&, frame&&) { ++pushed; });
+    mgr.set_capture_engine(
+        std::make_shared<capture_engine>(capture_engine::config { 1, 1 }),
+        [&p](const stream&) {
+            return std::make_unique<byte_source>(::dup(p.rd));
+        }
+    );
+
+    mgr.start_stream("clip");
+    EXPECT_TRUE(mgr.is_stream_running("clip"));
+    p.write(1);
+    EXPECT_TRUE(wait_for([&] { return pushed == 1; }));
+
+    mgr.stop_stream("clip");
+    EXPECT_FALSE(mgr.is_stream_running("clip"));
+    p.write(2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(pushed, 1);
+}
+
+TEST(CaptureEngine, HttpMjpegSourceSplitsParts) {
+    socket_pair p;
+    ASSERT_GE(p.rd, 0);
+    auto src = http_mjpeg_source::from_socket(p.rd, fake_decode);
+
+    // one part with a length, one delimited by the next boundary, and the
+    // start of a third one
+    send_text(
+        p.wr,
+        mjpeg_response
+            + "--frame\r\nContent-Type: image/jpeg\r\n"
+              "Content-Length: 4\r\n\r\n\xFF\xD8"
+              "AB\r\n"
+              "--frame\r\nContent-Type: image/jpeg\r\n\r\n\xFF\xD8"
+              "CDE\r\n"
+              "--frame\r\n\r\n\xFF\xD8"
+    );
+
+    // only the newest complete image is returned, still encoded
+    frame f;
+    ASSERT_EQ(src->read(f, true), capture_source::read_result::frame);
+    EXPECT_EQ(bytes_of(f), "\xFF\xD8"
+                           "CDE");
+    ASSERT_TRUE(src->finish(f));
+    EXPECT_EQ(f.width, 5);
+
+    send_text(p.wr, "XYZ\r\n--frame\r\n");
+    ASSERT_EQ(src->read(f, true), capture_source::read_result::frame);
+    EXPECT_EQ(bytes_of(f), "\xFF\xD8"
+                           "XYZ");
+    EXPECT_EQ(src->read(f, true), capture_source::read_result::none);
+
+    p.close_writer();
+    EXPECT_EQ(src->read(f, true), capture_source::read_result::end);
+}
+
+TEST(CaptureEngine, HttpMjpegSourceRejectsOtherResponses) {
+    for (const std::string response :
+         { "HTTP/1.0 404 Not Found\r\n\r\n",
+           "HTTP/1.0 200 OK\r\nContent-Type: text/html\r\n\r\n" }) {
+        socket_pair p;
+        ASSERT_GE(p.rd, 0);
+        auto src = http_mjpeg_source::from_socket(p.rd, fake_decode);
+        send_text(p.wr, response);
+        frame f;
+        EXPECT_EQ(src->read(f, true), capture_source::read_result::end)
+            << response;
+    }
+}
+
+TEST(CaptureEngine, HttpMjpegSourceServesNetworkCamera) {
+    // a camera on the loopback interface
+    const int server = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(server, 0);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    ASSERT_EQ(::bind(server, reinterpret_cast<sockaddr*>(&addr), len), 0);
+    ASSERT_EQ(::listen(server, 1), 0);
+    ASSERT_EQ(
+        ::getsockname(server, reinterpret_cast<sockaddr*>(&addr), &len), 0
+    );
+
+    std::string request;
+    int client = -1;
+    std::jthread camera([&] {
+        client = ::accept(server, nullptr, nullptr);
+        char c = 0;
+        while (!request.ends_with("\r\n\r\n")
+               && ::recv(client, &c, 1, 0) == 1) {
+            request += c;
+        }
+        send_text(client, mjpeg_response);
+    });
+
+    const stream s(
+        "http://user:pw@127.0.0.1:" + std::to_string(ntohs(addr.sin_port))
+            + "/video",
+        "cam", "url"
+    );
+    auto src = http_mjpeg_source::open(s, fake_decode);
+    camera.join();
+    ASSERT_TRUE(src);
+    EXPECT_TRUE(request.starts_with("GET /video HTTP/1.0\r\n"));
+    EXPECT_NE(
+        request.find("Authorization: Basic dXNlcjpwdw==\r\n"),
+        std::string::npos
+    );
+    EXPECT_EQ(s.negotiated_format().fourcc, "MJPG");
+
+    // images are decoded on the workers
+    capture_engine engine({ 1, 1 });
+    std::atomic<int> width { 0 };
+    ASSERT_TRUE(engine.add("cam", std::move(src), [&](frame&& f) {
+        width = f.width;
+    }));
+    send_text(
+        client,
+        "--frame\r\nContent-Length: 6\r\n\r\n\xFF\xD8"
+        "1234\r\n"
+    );
+    EXPECT_TRUE(wait_for([&] { return width == 6; }));
+    engine.remove("cam");
+    ::close(client);
+    ::close(server);
+
+    const stream file("clip.mp4", "clip", "file");
+    EXPECT_FALSE(http_mjpeg_source::open(file, fake_decode));
+}
+
+#endif // __linux__
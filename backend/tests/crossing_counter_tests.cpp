@@ -0,0 +1,129 @@
+#include "crossing_counter.hpp"
+#include "stream_manager.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using yodau::backend::crossing_count;
+using yodau::backend::crossing_dir;
+using yodau::backend::crossing_counters;
+using yodau::backend::crossing_window;
+using yodau::backend::event;
+using yodau::backend::event_kind;
+using yodau::backend::frame;
+using yodau::backend::sliding_counter;
+using yodau::backend::stream;
+using yodau::backend::stream_manager;
+
+namespace {
+crossing_count one(const crossing_dir dir) {
+    crossing_count c;
+    c.add(dir);
+    return c;
+}
+}
+
+TEST(CrossingCounter, SlidingWindowExpiresBuckets) {
+    using namespace std::chrono_literals;
+    // 10 buckets of 1 s
+    sliding_counter win(10s, 10);
+    const auto t0 = sliding_counter::clock::time_point {} + 1h;
+
+    win.add(one(crossing_dir::neg_to_pos), t0);
+    win.add(one(crossing_dir::neg_to_pos), t0 + 500ms);
+    win.add(one(crossing_dir::pos_to_neg), t0 + 3s);
+    win.add(one(crossing_dir::flat), t0 + 9s);
+
+    auto c = win.total(t0 + 9s);
+    EXPECT_EQ(c.neg_to_pos, 2u);
+    EXPECT_EQ(c.pos_to_neg, 1u);
+    EXPECT_EQ(c.flat, 1u);
+    EXPECT_EQ(c.total(), 4u);
+
+    // the first bucket leaves the window one bucket later
+    EXPECT_EQ(win.total(t0 + 10s).neg_to_pos, 0u);
+    EXPECT_EQ(win.total(t0 + 10s).total(), 2u);
+    EXPECT_EQ(win.total(t0 + 13s).total(), 1u);
+    EXPECT_EQ(win.total(t0 + 1h).total(), 0u);
+
+    // late timestamps still inside the window are kept, older are dropped
+    win.add(one(crossing_dir::pos_to_neg), t0 + 12s);
+    win.add(one(crossing_dir::pos_to_neg), t0 + 5s);
+    win.add(one(crossing_dir::pos_to_neg), t0 + 1s);
+    EXPECT_EQ(win.total(t0 + 12s).pos_to_neg, 3u);
+    EXPECT_EQ(win.total(t0 + 12s).total(), 4u);
+
+    // a long gap clears every bucket at once
+    win.add(one(crossing_dir::flat), t0 + 2h);
+    EXPECT_EQ(win.total(t0 + 2h).total(), 1u);
+    EXPECT_EQ(win.bucket_count(), 10u);
+}
+
+TEST(CrossingCounter, CountsEveryWindowPerLine) {
+    using namespace std::chrono_literals;
+    crossing_counters counters;
+    const auto t0 = crossing_counters::clock::time_point {} + 48h;
+
+    // one crossing per second for two hours stays within fixed buckets
+    for (int s = 0; s < 7200; ++s) {
+        counters.add(
+            "cam", "door",
+            s % 2 == 0 ? crossing_dir::neg_to_pos : crossing_dir::pos_to_neg,
+            t0 + std::chrono::seconds(s)
+        );
+    }
+    counters.add("cam", "gate", crossing_dir::flat, t0);
+    counters.add("other", "door", crossing_dir::neg_to_pos, t0);
+
+    const auto now = t0 + 7199s;
+    const auto rows = counters.snapshot("cam", now);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[0].line_name, "door");
+    EXPECT_EQ(rows[1].line_name, "gate");
+
+    const auto& door = rows[0];
+    const auto window = [&](const crossing_window w) {
+        return door.windows[static_cast<std::size_t>(w)];
+    };
+    EXPECT_EQ(window(crossing_window::minute).total(), 60u);
+    EXPECT_EQ(window(crossing_window::minute).neg_to_pos, 30u);
+    EXPECT_EQ(window(crossing_window::quarter_hour).total(), 900u);
+    EXPECT_EQ(window(crossing_window::hour).total(), 3600u);
+    EXPECT_EQ(window(crossing_window::day).total(), 7200u);
+    EXPECT_EQ(door.total.total(), 7200u);
+
+    // the gate crossing is older than an hour but within a day
+    const auto& gate = rows[1];
+    EXPECT_EQ(gate.windows[2].total(), 0u);
+    EXPECT_EQ(gate.windows[3].flat, 1u);
+    EXPECT_EQ(gate.total.flat, 1u);
+
+    EXPECT_EQ(counters.snapshot({}, now).size(), 3u);
+    EXPECT_TRUE(counters.snapshot("missing", now).empty());
+}
+
+TEST(CrossingCounter, StreamManagerCountsTripwireEvents) {
+    stream_manager mgr;
+    mgr.add_stream("clip.mp4", "clip", "file");
+    mgr.set_frame_processor([](const stream& s, const frame&) {
+        std::vector<event> out(3);
+        for (auto& e : out) {
+            e.kind = event_kind::tripwire;
+            e.stream_name = s.get_name();
+            e.line_name = "door";
+            e.message = "neg_to_pos";
+        }
+        out[2].kind = event_kind::motion;
+        return out;
+    });
+
+    EXPECT_TRUE(mgr.crossings().empty());
+    mgr.process_frame("clip", frame {});
+
+    const auto rows = mgr.crossings("clip");
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0].line_name, "door");
+    EXPECT_EQ(rows[0].windows[0].neg_to_pos, 2u);
+    EXPECT_EQ(rows[0].total.total(), 2u);
+}
@@ -0,0 +1,106 @@
+#include "decode_budget.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using yodau::backend::decode_budget;
+using yodau::backend::stream;
+
+TEST(DecodeBudget, SizesLeasesByResolution) {
+    decode_budget budget(16);
+
+    const auto sd = budget.acquire("sd", 640, 480);
+    EXPECT_EQ(sd.threads(), 1);
+
+    const auto hd = budget.acquire("hd", 1280, 720);
+    EXPECT_EQ(hd.threads(), 2);
+
+    const auto full = budget.acquire("full", 1920, 1080);
+    EXPECT_EQ(full.threads(), 4);
+
+    // unknown resolution counts as 1080p
+    const auto unknown = budget.acquire("unknown", 0, 0);
+    EXPECT_EQ(unknown.threads(), 4);
+
+    EXPECT_EQ(budget.leased(), 11);
+    const auto allocs = budget.allocations();
+    ASSERT_EQ(allocs.size(), 4u);
+    EXPECT_EQ(allocs[1].name, "hd");
+    EXPECT_EQ(allocs[1].width, 1280);
+    EXPECT_EQ(allocs[1].threads, 2);
+    EXPECT_EQ(allocs[3].width, decode_budget::default_width);
+}
+
+TEST(DecodeBudget, StaysWithinBudgetAsStreamsAreAdded) {
+    decode_budget budget(16);
+
+    std::vector<decode_budget::lease> leases;
+    leases.push_back(budget.acquire("uhd", 3840, 2160));
+    EXPECT_EQ(leases.back().threads(), decode_budget::max_per_stream);
+    for (int i = 0; i < 8; ++i) {
+        leases.push_back(budget.acquire("cam", 1280, 720));
+        EXPECT_LE(budget.leased(), budget.total());
+    }
+    EXPECT_EQ(budget.leased(), 16);
+
+    // past the budget every stream still gets one thread
+    for (int i = 0; i < 3; ++i) {
+        leases.push_back(budget.acquire("extra", 3840, 2160));
+        EXPECT_EQ(leases.back().threads(), 1);
+    }
+    EXPECT_EQ(budget.leased(), 19);
+}
+
+TEST(DecodeBudget, ReleasesAndFixedLeases) {
+    decode_budget budget(8);
+    {
+        const auto a = budget.acquire("a", 1920, 1080);
+        auto b = budget.acquire("b", 1920, 1080);
+        EXPECT_EQ(a.threads(), 4);
+        EXPECT_EQ(b.threads(), 4);
+
+        auto moved = std::move(b);
+        EXPECT_EQ(b.threads(), 0);
+        EXPECT_EQ(budget.leased(), 8);
+    }
+    EXPECT_EQ(budget.leased(), 0);
+    EXPECT_TRUE(budget.allocations().empty());
+
+    // a user-chosen count is recorded as is and limits later leases
+    const auto fixed = budget.acquire("fixed", 640, 480, 6);
+    EXPECT_EQ(fixed.threads(), 6);
+    const auto next = budget.acquire("next", 1920, 1080);
+    EXPECT_EQ(next.threads(), 2);
+
+    budget.set_total(32);
+    EXPECT_EQ(budget.total(), 32);
+    EXPECT_EQ(next.threads(), 2);
+}
+
+TEST(DecodeBudget, ReacquiresOnceSizeIsProbed) {
+    decode_budget budget(8);
+
+    // sizes of files are unknown before they are opened
+    const stream clip("clip.mp4", "clip", "file");
+    auto lease = budget.acquire(clip);
+    EXPECT_EQ(lease.threads(), 4);
+
+    budget.reacquire(lease, clip.get_name(), 640, 480);
+    EXPECT_EQ(lease.threads(), 1);
+    EXPECT_EQ(budget.leased(), 1);
+    const auto allocs = budget.allocations();
+    ASSERT_EQ(allocs.size(), 1u);
+    EXPECT_EQ(allocs[0].width, 640);
+    EXPECT_EQ(allocs[0].height, 480);
+
+    // the guess no longer holds back other streams
+    const auto next = budget.acquire("next", 3840, 2160);
+    EXPECT_EQ(next.threads(), 7);
+
+    // an empty lease is simply acquired (past the budget: one thread)
+    decode_budget::lease late;
+    budget.reacquire(late, "late", 1280, 720);
+    EXPECT_EQ(late.threads(), 1);
+    EXPECT_EQ(budget.allocations().size(), 3u);
+}
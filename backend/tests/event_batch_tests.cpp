@@ -0,0 +1,110 @@
+#include "event_batch.hpp"
+#include "stream_manager.hpp"
+
+#include <gtest/gtest.h>
+
+#include <type_traits>
+#include <vector>
+
+using yodau::backend::activity_grid;
+using yodau::backend::compact_event;
+using yodau::backend::crossing_dir;
+using yodau::backend::event;
+using yodau::backend::event_batch;
+using yodau::backend::event_kind;
+using yodau::backend::frame;
+using yodau::backend::name_table;
+using yodau::backend::point;
+using yodau::backend::stream;
+using yodau::backend::stream_manager;
+
+static_assert(std::is_trivially_copyable_v<compact_event>);
+
+TEST(EventBatch, InternsNames) {
+    name_table names;
+    EXPECT_EQ(names.intern(""), name_table::empty_id);
+    const auto cam = names.intern("cam");
+    const auto door = names.intern("door");
+    EXPECT_NE(cam, door);
+    EXPECT_EQ(names.intern(std::string("cam")), cam);
+    EXPECT_EQ(names.name(door), "door");
+    EXPECT_EQ(names.name(12345), "");
+    EXPECT_EQ(names.size(), 3u);
+}
+
+TEST(EventBatch, RoundTripsEvents) {
+    name_table names;
+    std::vector<event> in(4);
+    in[0].kind = event_kind::tripwire;
+    in[0].stream_name = "cam";
+    in[0].line_name = "door";
+    in[0].message = "pos_to_neg";
+    in[0].pos_pct = point { 10.0f, 20.0f };
+    in[1].kind = event_kind::motion_grid;
+    in[1].stream_name = "cam";
+    in[1].grid = activity_grid {};
+    in[1].grid->cells[5] = 200;
+    in[2].kind = event_kind::roi;
+    in[2].stream_name = "cam";
+    in[2].line_name = "zone";
+    in[2].message = "enter";
+    in[3].message = "hello";
+
+    event_batch batch;
+    for (const auto& e : in) {
+        batch.push_back(e, names);
+    }
+    ASSERT_EQ(batch.size(), 4u);
+    EXPECT_EQ(batch.dirs()[0], crossing_dir::pos_to_neg);
+    EXPECT_EQ(batch.at(0).message, name_table::empty_id);
+    EXPECT_EQ(batch.streams()[0], batch.streams()[2]);
+    EXPECT_FALSE(batch.at(1).has_pos());
+
+    const auto out = batch.to_events(names);
+    ASSERT_EQ(out.size(), in.size());
+    for (std::size_t i = 0; i < in.size(); ++i) {
+        EXPECT_EQ(out[i].kind, in[i].kind);
+        EXPECT_EQ(out[i].stream_name, in[i].stream_name);
+        EXPECT_EQ(out[i].line_name, in[i].line_name);
+        EXPECT_EQ(out[i].message, in[i].message);
+        EXPECT_EQ(out[i].pos_pct.has_value(), in[i].pos_pct.has_value());
+        EXPECT_EQ(out[i].grid.has_value(), in[i].grid.has_value());
+    }
+    EXPECT_FLOAT_EQ(out[0].pos_pct->y, 20.0f);
+    EXPECT_EQ(out[1].grid->cells[5], 200);
+
+    batch.truncate(1);
+    EXPECT_EQ(batch.size(), 1u);
+    batch.clear();
+    EXPECT_TRUE(batch.empty());
+}
+
+TEST(EventBatch, StreamManagerDeliversCompactBatches) {
+    stream_manager mgr;
+    mgr.add_stream("clip.mp4", "clip", "file");
+    mgr.set_batch_processor([](const stream&, const frame&, event_batch& out) {
+        auto& names = yodau::backend::global_names();
+        compact_event e;
+        e.kind = event_kind::tripwire;
+        e.stream = names.intern("clip");
+        e.line = names.intern("door");
+        e.dir = crossing_dir::neg_to_pos;
+        e.grid = out.add_grid(activity_grid {});
+        out.push_back(e);
+        out.push_back(e);
+    });
+
+    std::size_t delivered = 0;
+    mgr.set_compact_sink([&](const event_batch& evs) {
+        delivered += evs.size();
+    });
+    mgr.set_event_budget({ std::chrono::hours(1), 1 });
+    mgr.push_frame("clip", frame {});
+    EXPECT_EQ(delivered, 1u);
+    EXPECT_EQ(mgr.dropped_events(), 1u);
+
+    // both crossings are counted, the budget only limits delivery
+    const auto rows = mgr.crossings("clip");
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0].total.neg_to_pos, 2u);
+}
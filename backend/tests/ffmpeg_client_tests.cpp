@@ -0,0 +1,270 @@
+#ifdef YODAU_FFMPEG
+
+#include "decode_budget.hpp"
+#include "ffmpeg_client.hpp"
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+using yodau::backend::decode_budget;
+using yodau::backend::ffmpeg_capture;
+using yodau::backend::frame;
+using yodau::backend::moving_area;
+using yodau::backend::pixel_format;
+
+namespace {
+constexpr int clip_w = 160;
+constexpr int clip_h = 96;
+
+// encode a raw MPEG-4 part 2 (or Motion JPEG) clip: flat background and, if
+// moving, a bright square travelling right by 4 px per frame
+bool write_clip(
+    const std::filesystem::path& path, const int frames, const bool moving,
+    const AVCodecID id = AV_CODEC_ID_MPEG4
+) {
+    const AVCodec* codec = avcodec_find_encoder(id);
+    if (!codec) {
+        return false;
+    }
+    AVCodecContext* enc = avcodec_alloc_context3(codec);
+    AVFrame* pic = av_frame_alloc();
+    AVPacket* pkt = av_packet_alloc();
+
+    enc->width = clip_w;
+    enc->height = clip_h;
+    enc->pix_fmt = id == AV_CODEC_ID_MJPEG ? AV_PIX_FMT_YUVJ420P
+                                           : AV_PIX_FMT_YUV420P;
+    enc->time_base = { 1, 25 };
+    enc->framerate = { 25, 1 };
+    enc->gop_size = 100;
+    enc->max_b_frames = 0;
+    enc->bit_rate = 400'000;
+
+    pic->format = enc->pix_fmt;
+    pic->width = clip_w;
+    pic->height = clip_h;
+
+    std::ofstream out(path, std::ios::binary);
+    bool ok = avcodec_open2(enc, codec, nullptr) >= 0
+        && av_frame_get_buffer(pic, 0) >= 0 && out.good();
+
+    const auto drain = [&] {
+        while (avcodec_receive_packet(enc, pkt) == 0) {
+            out.write(
+                reinterpret_cast<const char*>(pkt->data),
+                static_cast<std::streamsize>(pkt->size)
+            );
+            av_packet_unref(pkt);
+        }
+    };
+
+    for (int i = 0; ok && i < frames; ++i) {
+        ok = av_frame_make_writable(pic) >= 0;
+        for (int y = 0; ok && y < clip_h; ++y) {
+            auto* row = pic->data[0] + y * pic->linesize[0];
+            for (int x = 0; x < clip_w; ++x) {
+                const bool square = moving && y >= 40 && y < 56
+                    && x >= 8 + 4 * i && x < 24 + 4 * i;
+                row[x] = square ? 220 : 64;
+            }
+        }
+        for (int p = 1; ok && p < 3; ++p) {
+            for (int y = 0; y < clip_h / 2; ++y) {
+                auto* row = pic->data[p] + y * pic->linesize[p];
+                std::fill_n(row, clip_w / 2, 128);
+            }
+        }
+        pic->pts = i;
+        ok = ok && avcodec_send_frame(enc, pic) >= 0;
+        drain();
+    }
+    avcodec_send_frame(enc, nullptr);
+    drain();
+
+    av_packet_free(&pkt);
+    av_frame_free(&pic);
+    avcodec_free_context(&enc);
+    return ok && out.good();
+}
+
+class FfmpegCapture : public testing::Test {
+protected:
+    void SetUp() override {
+        dir = std::filesystem::temp_directory_path() / "yodau_ffmpeg_tests";
+        std::filesystem::create_directories(dir);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(dir); }
+
+    std::filesystem::path clip(
+        const std::string& name, const bool moving,
+        const AVCodecID id = AV_CODEC_ID_MPEG4
+    ) {
+        const auto ext = id == AV_CODEC_ID_MJPEG ? ".mjpeg" : ".m4v";
+        const auto path = dir / (name + ext);
+        if (!write_clip(path, frames, moving, id)) {
+            return {};
+        }
+        return path;
+    }
+
+    static constexpr int frames { 20 };
+    std::filesystem::path dir;
+};
+}
+
+TEST_F(FfmpegCapture, DecodesLumaWithMotionVectors) {
+    const auto path = clip("moving", true);
+    if (path.empty()) {
+        GTEST_SKIP() << "MPEG-4 encoder not available";
+    }
+
+    ffmpeg_capture::config cfg;
+    cfg.threads = 1;
+    ffmpeg_capture cap;
+    ASSERT_TRUE(cap.open(path.string(), cfg));
+
+    int count = 0;
+    int with_vectors = 0;
+    int moving = 0;
+    frame f;
+    while (cap.read(f) == ffmpeg_capture::read_result::ok) {
+        ++count;
+        EXPECT_EQ(f.format, pixel_format::gray8);
+        EXPECT_EQ(f.width, clip_w);
+        EXPECT_EQ(f.height, clip_h);
+        // luma is referenced, not copied
+        EXPECT_TRUE(f.data.empty());
+        ASSERT_GE(f.size(), static_cast<size_t>(f.stride * clip_h));
+        EXPECT_NEAR(f.bytes()[0], 64, 4);
+
+        if (f.has_motion_vectors) {
+            ++with_vectors;
+            if (moving_area(f.motion_vectors, f.width, f.height, 0.5f) > 0.0) {
+                ++moving;
+            }
+        }
+    }
+    EXPECT_EQ(count, frames);
+    EXPECT_GT(with_vectors, 0);
+    EXPECT_GT(moving, 0);
+
+    ASSERT_TRUE(cap.rewind());
+    EXPECT_EQ(cap.read(f), ffmpeg_capture::read_result::ok);
+}
+
+TEST_F(FfmpegCapture, StaticClipHasNoMovingBlocks) {
+    const auto path = clip("static", false);
+    if (path.empty()) {
+        GTEST_SKIP() << "MPEG-4 encoder not available";
+    }
+
+    ffmpeg_capture::config cfg;
+    cfg.threads = 1;
+    ffmpeg_capture cap;
+    ASSERT_TRUE(cap.open(path.string(), cfg));
+
+    frame f;
+    while (cap.read(f) == ffmpeg_capture::read_result::ok) {
+        if (f.has_motion_vectors) {
+            EXPECT_LT(
+                moving_area(f.motion_vectors, f.width, f.height, 0.5f), 0.001
+            );
+        }
+    }
+}
+
+TEST_F(FfmpegCapture, SkipConsumesPacketsAndDisabledVectors) {
+    const auto path = clip("skip", true);
+    if (path.empty()) {
+        GTEST_SKIP() << "MPEG-4 encoder not available";
+    }
+
+    ffmpeg_capture::config cfg;
+    cfg.threads = 1;
+    cfg.motion_vectors = false;
+    ffmpeg_capture cap;
+    ASSERT_TRUE(cap.open(path.string(), cfg));
+
+    int count = 0;
+    frame f;
+    while (true) {
+        const auto res = count % 2 ? cap.skip() : cap.read(f);
+        if (res != ffmpeg_capture::read_result::ok) {
+            EXPECT_EQ(res, ffmpeg_capture::read_result::end);
+            break;
+        }
+        EXPECT_FALSE(f.has_motion_vectors);
+        ++count;
+    }
+    EXPECT_EQ(count, frames);
+
+    EXPECT_FALSE(cap.open((dir / "missing.m4v").string(), cfg));
+    EXPECT_FALSE(cap.is_open());
+}
+
+TEST_F(FfmpegCapture, DecodesMotionJpegAtReducedScale) {
+    const auto path = clip("mjpeg", true, AV_CODEC_ID_MJPEG);
+    if (path.empty()) {
+        GTEST_SKIP() << "Motion JPEG encoder not available";
+    }
+
+    ffmpeg_capture::config cfg;
+    cfg.threads = 1;
+    cfg.analysis_width = clip_w / 4;
+    ffmpeg_capture cap;
+    ASSERT_TRUE(cap.open(path.string(), cfg));
+
+    int count = 0;
+    frame f;
+    while (cap.read(f) == ffmpeg_capture::read_result::ok) {
+        ++count;
+        EXPECT_EQ(f.format, pixel_format::gray8);
+        EXPECT_EQ(f.width, clip_w / 4);
+        EXPECT_EQ(f.height, clip_h / 4);
+        EXPECT_NEAR(f.bytes()[0], 64, 4);
+    }
+    EXPECT_EQ(count, frames);
+}
+
+TEST_F(FfmpegCapture, LeasesThreadsForProbedSize) {
+    const auto path = clip("sized", false);
+    if (path.empty()) {
+        GTEST_SKIP() << "MPEG-4 encoder not available";
+    }
+
+    // the clip's size is only known once it is opened
+    decode_budget budget(8);
+    decode_budget::lease lease;
+    ffmpeg_capture::config cfg;
+    cfg.size_threads = [&](const int width, const int height) {
+        budget.reacquire(lease, "sized", width, height);
+        return lease.threads();
+    };
+    ffmpeg_capture cap;
+    ASSERT_TRUE(cap.open(path.string(), cfg));
+
+    auto allocs = budget.allocations();
+    ASSERT_EQ(allocs.size(), 1u);
+    EXPECT_EQ(allocs[0].width, clip_w);
+    EXPECT_EQ(allocs[0].height, clip_h);
+    EXPECT_EQ(lease.threads(), 1);
+
+    // reopening replaces the lease instead of adding one
+    ASSERT_TRUE(cap.open(path.string(), cfg));
+    allocs = budget.allocations();
+    ASSERT_EQ(allocs.size(), 1u);
+    EXPECT_EQ(budget.leased(), 1);
+
+    frame f;
+    EXPECT_EQ(cap.read(f), ffmpeg_capture::read_result::ok);
+}
+
+#endif // YODAU_FFMPEG
@@ -0,0 +1,82 @@
+#include "frame_signature.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using yodau::backend::compute_frame_signature;
+using yodau::backend::same_scene;
+
+namespace {
+std::vector<std::uint8_t> gradient_bgr(const int w, const int h) {
+    std::vector<std::uint8_t> out(static_cast<size_t>(w * h * 3));
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            auto* p = out.data() + static_cast<size_t>((y * w + x) * 3);
+            p[0] = static_cast<std::uint8_t>(x % 256);
+            p[1] = static_cast<std::uint8_t>(y % 256);
+            p[2] = static_cast<std::uint8_t>((x + y) % 256);
+        }
+    }
+    return out;
+}
+}
+
+TEST(FrameSignature, IdenticalFramesMatch) {
+    const int w = 320;
+    const int h = 180;
+    const auto img = gradient_bgr(w, h);
+    const auto a = compute_frame_signature(
+        img.data(), w, h, static_cast<size_t>(w * 3), 3
+    );
+    const auto b = compute_frame_signature(
+        img.data(), w, h, static_cast<size_t>(w * 3), 3
+    );
+    EXPECT_TRUE(same_scene(a, b, 0, 0));
+}
+
+TEST(FrameSignature, NoiseWithinToleranceMatches) {
+    const int w = 320;
+    const int h = 180;
+    auto img = gradient_bgr(w, h);
+    const auto a = compute_frame_signature(
+        img.data(), w, h, static_cast<size_t>(w * 3), 3
+    );
+    for (size_t i = 0; i < img.size(); i += 7) {
+        img[i] = static_cast<std::uint8_t>(img[i] < 255 ? img[i] + 1 : 254);
+    }
+    const auto b = compute_frame_signature(
+        img.data(), w, h, static_cast<size_t>(w * 3), 3
+    );
+    EXPECT_TRUE(same_scene(a, b, 1, 4));
+}
+
+TEST(FrameSignature, BlobBreaksMatch) {
+    const int w = 1920;
+    const int h = 1080;
+    auto img = gradient_bgr(w, h);
+    const auto stride = static_cast<size_t>(w * 3);
+    const auto a = compute_frame_signature(img.data(), w, h, stride, 3);
+
+    // roughly the minimal motion area (0.1% of the frame)
+    for (int y = 500; y < 546; ++y) {
+        for (int x = 900; x < 946; ++x) {
+            auto* p = img.data() + static_cast<size_t>(y) * stride
+                + static_cast<size_t>(x * 3);
+            p[0] = 255;
+            p[1] = 255;
+            p[2] = 255;
+        }
+    }
+    const auto b = compute_frame_signature(img.data(), w, h, stride, 3);
+    EXPECT_FALSE(same_scene(a, b, 2, 25));
+}
+
+TEST(FrameSignature, SizeMismatchNeverMatches) {
+    const auto img = gradient_bgr(64, 64);
+    const auto a = compute_frame_signature(img.data(), 64, 64, 64 * 3, 3);
+    const auto b = compute_frame_signature(img.data(), 64, 32, 64 * 3, 3);
+    const auto invalid = compute_frame_signature(nullptr, 64, 64, 64 * 3, 3);
+    EXPECT_FALSE(same_scene(a, b, 255, 255));
+    EXPECT_FALSE(same_scene(invalid, invalid, 255, 255));
+}
@@ -0,0 +1,89 @@
+#include "geometry.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+using yodau::backend::intersect_segments;
+using yodau::backend::point;
+using yodau::backend::segment_batch;
+using yodau::backend::segment_hits;
+using yodau::backend::segment_intersection;
+using yodau::backend::segments_intersect;
+
+namespace {
+// compares the batch against the scalar functions for every segment
+void expect_matches_scalar(
+    const point& a, const point& b, const segment_batch& batch
+) {
+    segment_hits out;
+    const auto count = intersect_segments(a, b, batch, out);
+    ASSERT_EQ(out.hit.size(), batch.size());
+
+    std::size_t want_count = 0;
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        const point q1 { batch.x0()[i], batch.y0()[i] };
+        const point q2 { batch.x1()[i], batch.y1()[i] };
+        const bool want = segments_intersect(a, b, q1, q2);
+        want_count += want ? 1 : 0;
+        EXPECT_EQ(out.hit[i] != 0, want) << "segment " << i;
+
+        const auto ip = segment_intersection(a, b, q1, q2);
+        ASSERT_EQ(out.has_t[i] != 0, ip.has_value()) << "segment " << i;
+        if (ip) {
+            const float t = out.t[i];
+            EXPECT_NEAR(a.x + t * (b.x - a.x), ip->x, 1e-4f);
+            EXPECT_NEAR(a.y + t * (b.y - a.y), ip->y, 1e-4f);
+        }
+    }
+    EXPECT_EQ(count, want_count);
+}
+}
+
+TEST(Geometry, SegmentIntersectionCases) {
+    EXPECT_TRUE(segments_intersect({ 0, 0 }, { 10, 10 }, { 0, 10 }, { 10, 0 }));
+    EXPECT_FALSE(segments_intersect({ 0, 0 }, { 1, 1 }, { 2, 2 }, { 3, 0 }));
+    // collinear overlap: intersecting, but without a single point
+    EXPECT_TRUE(segments_intersect({ 0, 0 }, { 10, 0 }, { 5, 0 }, { 15, 0 }));
+    EXPECT_FALSE(segment_intersection({ 0, 0 }, { 10, 0 }, { 5, 0 }, { 15, 0 })
+                     .has_value());
+    // touching at an endpoint
+    const auto ip
+        = segment_intersection({ 0, 0 }, { 10, 0 }, { 5, 0 }, { 5, 5 });
+    ASSERT_TRUE(ip.has_value());
+    EXPECT_FLOAT_EQ(ip->x, 5.0f);
+
+    segment_batch batch;
+    batch.assign_chain({ { 0, 0 }, { 10, 0 }, { 10, 10 } }, true);
+    ASSERT_EQ(batch.size(), 3u);
+    EXPECT_FLOAT_EQ(batch.x0()[2], 10.0f);
+    EXPECT_FLOAT_EQ(batch.y1()[2], 0.0f);
+    expect_matches_scalar({ 5, -5 }, { 5, 5 }, batch);
+    expect_matches_scalar({ 0, 0 }, { 10, 0 }, batch);
+}
+
+TEST(Geometry, BatchMatchesScalarOnRandomSegments) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> coord(-5.0f, 105.0f);
+    // a coarse grid produces many collinear, touching and parallel cases
+    std::uniform_int_distribution<int> grid(0, 4);
+
+    for (int round = 0; round < 200; ++round) {
+        const bool coarse = round % 2 == 0;
+        const auto next = [&] {
+            if (coarse) {
+                return point { static_cast<float>(grid(rng) * 25),
+                               static_cast<float>(grid(rng) * 25) };
+            }
+            return point { coord(rng), coord(rng) };
+        };
+
+        segment_batch batch;
+        // odd sizes also exercise a vectorized loop's remainder
+        const int n = 1 + round % 37;
+        for (int i = 0; i < n; ++i) {
+            batch.push_back(next(), next());
+        }
+        expect_matches_scalar(next(), next(), batch);
+    }
+}
@@ -0,0 +1,56 @@
+#include "jpeg_scale.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using yodau::backend::jpeg_dimensions;
+using yodau::backend::jpeg_reduction;
+
+namespace {
+// SOI, an APP0 segment, a padded SOF0 header and EOI; no entropy data is
+// needed to read the size
+std::vector<std::uint8_t> jpeg_header(const int w, const int h) {
+    const auto hh = static_cast<std::uint8_t>(h >> 8);
+    const auto hl = static_cast<std::uint8_t>(h & 0xFF);
+    const auto wh = static_cast<std::uint8_t>(w >> 8);
+    const auto wl = static_cast<std::uint8_t>(w & 0xFF);
+    return { 0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x06, 'J',  'F',  'I',
+             'F',  0xFF, 0xFF, 0xC0, 0x00, 0x0B, 0x08, hh,   hl,
+             wh,   wl,   0x01, 0x01, 0x11, 0x00, 0xFF, 0xD9 };
+}
+}
+
+TEST(JpegScale, ReadsFrameHeader) {
+    const auto img = jpeg_header(1920, 1080);
+    int w = 0;
+    int h = 0;
+    ASSERT_TRUE(jpeg_dimensions(img.data(), img.size(), w, h));
+    EXPECT_EQ(w, 1920);
+    EXPECT_EQ(h, 1080);
+}
+
+TEST(JpegScale, RejectsOtherAndTruncatedData) {
+    const auto img = jpeg_header(640, 480);
+    int w = 0;
+    int h = 0;
+    EXPECT_FALSE(jpeg_dimensions(img.data(), 16, w, h));
+
+    const std::vector<std::uint8_t> png { 0x89, 'P', 'N', 'G', 0x0D, 0x0A };
+    EXPECT_FALSE(jpeg_dimensions(png.data(), png.size(), w, h));
+
+    const std::vector<std::uint8_t> no_frame { 0xFF, 0xD8, 0xFF, 0xD9 };
+    EXPECT_FALSE(jpeg_dimensions(no_frame.data(), no_frame.size(), w, h));
+}
+
+TEST(JpegScale, PicksLargestReductionAboveTarget) {
+    EXPECT_EQ(jpeg_reduction(1920, 0), 1);
+    EXPECT_EQ(jpeg_reduction(1920, 1920), 1);
+    EXPECT_EQ(jpeg_reduction(1920, 960), 2);
+    EXPECT_EQ(jpeg_reduction(1920, 640), 2);
+    EXPECT_EQ(jpeg_reduction(1920, 480), 4);
+    EXPECT_EQ(jpeg_reduction(1920, 240), 8);
+    EXPECT_EQ(jpeg_reduction(1920, 16), 8);
+    // rounded up: 1/8 of 1283 is 161 pixels wide
+    EXPECT_EQ(jpeg_reduction(1283, 161), 8);
+}
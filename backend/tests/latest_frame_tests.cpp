@@ -0,0 +1,81 @@
+#include "latest_frame.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+using yodau::backend::deliver_latest;
+using yodau::backend::frame;
+using yodau::backend::latest_frame;
+
+namespace {
+frame numbered(const int n) {
+    frame f;
+    f.width = n;
+    return f;
+}
+}
+
+TEST(LatestFrame, KeepsOnlyNewestFrame) {
+    latest_frame box;
+    std::stop_source src;
+
+    box.put(numbered(1));
+    box.put(numbered(2));
+    box.put(numbered(3));
+    EXPECT_EQ(box.dropped(), 2u);
+
+    frame f;
+    ASSERT_TRUE(box.take(f, src.get_token()));
+    EXPECT_EQ(f.width, 3);
+
+    box.put(numbered(4));
+    box.close();
+    ASSERT_TRUE(box.take(f, src.get_token()));
+    EXPECT_EQ(f.width, 4);
+    EXPECT_FALSE(box.take(f, src.get_token()));
+}
+
+TEST(LatestFrame, TakeStopsOnRequest) {
+    latest_frame box;
+    std::stop_source src;
+
+    std::jthread stopper([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        src.request_stop();
+    });
+    frame f;
+    EXPECT_FALSE(box.take(f, src.get_token()));
+}
+
+TEST(LatestFrame, SlowConsumerSeesNewestFrames) {
+    constexpr int total = 200;
+    int next = 0;
+    std::vector<int> seen;
+    std::stop_source src;
+
+    const auto dropped = deliver_latest(
+        [&](std::optional<frame>& out) {
+            if (next == total) {
+                return false;
+            }
+            out = numbered(++next);
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            return true;
+        },
+        [&](frame&& f) {
+            seen.push_back(f.width);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        },
+        src.get_token()
+    );
+
+    ASSERT_FALSE(seen.empty());
+    EXPECT_LT(seen.size(), static_cast<size_t>(total));
+    EXPECT_EQ(seen.back(), total);
+    for (size_t i = 1; i < seen.size(); ++i) {
+        EXPECT_GT(seen[i], seen[i - 1]);
+    }
+    EXPECT_EQ(dropped + seen.size(), static_cast<std::uint64_t>(total));
+}
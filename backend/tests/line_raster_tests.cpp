@@ -0,0 +1,166 @@
+#include "line_raster.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <optional>
+
+using yodau::backend::bit_mask;
+using yodau::backend::line_ptr;
+using yodau::backend::line_raster;
+using yodau::backend::line_set;
+using yodau::backend::make_line;
+using yodau::backend::point;
+
+namespace {
+float cross(const point& a, const point& b, const point& c) {
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+// proper intersection point of two segments, as the vector path computes it
+std::optional<point> intersect(
+    const point& p1, const point& p2, const point& q1, const point& q2
+) {
+    const float d1 = cross(q1, q2, p1);
+    const float d2 = cross(q1, q2, p2);
+    const float d3 = cross(p1, p2, q1);
+    const float d4 = cross(p1, p2, q2);
+    if ((d1 > 0) == (d2 > 0) || (d3 > 0) == (d4 > 0)) {
+        return {};
+    }
+    const float t = d1 / (d1 - d2);
+    return point { p1.x + t * (p2.x - p1.x), p1.y + t * (p2.y - p1.y) };
+}
+
+struct line_hit {
+    bool found { false };
+    float dist2 { 0.0f };
+    std::uint32_t segment { 0 };
+};
+
+// vector path: segment-vs-contour intersections, closest to the centroid
+std::vector<line_hit> vector_hits(
+    const line_set& set, const std::vector<point>& contour,
+    const point& centroid
+) {
+    std::vector<line_hit> out(set.line_count());
+    for (std::uint32_t s = 0; s < set.segment_count(); ++s) {
+        for (std::size_t j = 0; j < contour.size(); ++j) {
+            const auto& c1 = contour[j];
+            const auto& c2 = contour[(j + 1) % contour.size()];
+            const auto ip
+                = intersect(set.segment_a(s), set.segment_b(s), c1, c2);
+            if (!ip) {
+                continue;
+            }
+            const float dx = ip->x - centroid.x;
+            const float dy = ip->y - centroid.y;
+            auto& h = out[set.segment_line(s)];
+            if (!h.found || dx * dx + dy * dy < h.dist2) {
+                h = { true, dx * dx + dy * dy, s };
+            }
+        }
+    }
+    return out;
+}
+
+// raster path: line pixels inside the motion, closest to the centroid
+std::vector<line_hit> raster_hits(
+    const line_raster& raster, const std::vector<line_raster::hit>& hits,
+    const point& centroid
+) {
+    const auto& set = raster.lines();
+    std::vector<line_hit> out(set.line_count());
+    for (const auto& h : hits) {
+        const float x = (static_cast<float>(h.x) + 0.5f) * 100.0f
+            / static_cast<float>(raster.width());
+        const float y = (static_cast<float>(h.y) + 0.5f) * 100.0f
+            / static_cast<float>(raster.height());
+        const float dx = x - centroid.x;
+        const float dy = y - centroid.y;
+        auto& best = out[set.segment_line(h.segment)];
+        if (!best.found || dx * dx + dy * dy < best.dist2) {
+            best = { true, dx * dx + dy * dy, h.segment };
+        }
+    }
+    return out;
+}
+}
+
+TEST(LineRaster, RasterizesAndClipsSegments) {
+    const auto set = std::make_shared<const line_set>(std::vector<line_ptr> {
+        make_line({ { 10, 50 }, { 90, 50 } }, "h"),
+        make_line({ { -50, 20 }, { 150, 20 } }, "wide") });
+    const line_raster raster(set, 100, 100);
+    EXPECT_TRUE(raster.matches(set, 100, 100));
+    EXPECT_FALSE(raster.matches(set, 50, 100));
+    // 81 pixels of "h", a full row of the clipped "wide"
+    EXPECT_EQ(raster.pixel_count(), 81u + 100u);
+
+    std::vector<std::uint8_t> mask(100 * 100, 0);
+    mask[50 * 100 + 30] = 255;
+    mask[50 * 100 + 95] = 255;
+    mask[20 * 100 + 0] = 255;
+
+    std::vector<line_raster::hit> hits;
+    raster.hits(mask.data(), 100, 0, 0, 100, 100, hits);
+    ASSERT_EQ(hits.size(), 2u);
+    EXPECT_EQ(hits[0].segment, 1u);
+    EXPECT_EQ(hits[0].x, 0);
+    EXPECT_EQ(hits[1].segment, 0u);
+    EXPECT_EQ(hits[1].x, 30);
+    EXPECT_EQ(hits[1].y, 50);
+
+    // only pixels inside the queried area count
+    raster.hits(mask.data(), 100, 40, 0, 100, 100, hits);
+    EXPECT_TRUE(hits.empty());
+}
+
+TEST(LineRaster, MatchesVectorHitTesting) {
+    constexpr int w = 200;
+    constexpr int h = 100;
+    const auto set = std::make_shared<const line_set>(std::vector<line_ptr> {
+        make_line({ { 45, 10 }, { 45, 90 } }, "crossing"),
+        make_line({ { 80, 10 }, { 80, 90 } }, "beside"),
+        make_line({ { 10, 50 }, { 40, 50 }, { 40, 95 } }, "bent"),
+        make_line(
+            { { 10, 10 }, { 90, 10 }, { 90, 90 }, { 10, 90 } }, "around", true
+        ),
+        make_line({ { -50, 50 }, { 20, 50 } }, "outside"),
+        make_line({ { 0, 40 }, { 100, 40 } }, "through") });
+
+    // motion blob: pixels [60; 120) x [30; 70), traced as its outline
+    std::vector<std::uint8_t> mask(w * h, 0);
+    bit_mask packed(w, h);
+    for (int y = 30; y < 70; ++y) {
+        for (int x = 60; x < 120; ++x) {
+            mask[static_cast<std::size_t>(y * w + x)] = 255;
+            packed.set(x, y);
+        }
+    }
+    const std::vector<point> contour {
+        { 30, 30 }, { 59.5f, 30 }, { 59.5f, 69 }, { 30, 69 }
+    };
+    const point centroid { 45, 50 };
+
+    const line_raster raster(set, w, h);
+    std::vector<line_raster::hit> hits;
+    raster.hits(mask.data(), w, 60, 30, 120, 70, hits);
+    std::vector<line_raster::hit> packed_hits;
+    raster.hits(packed, 60, 30, 120, 70, packed_hits);
+    ASSERT_EQ(hits.size(), packed_hits.size());
+
+    const auto want = vector_hits(*set, contour, centroid);
+    const auto got = raster_hits(raster, hits, centroid);
+    ASSERT_EQ(got.size(), want.size());
+    for (std::size_t i = 0; i < want.size(); ++i) {
+        EXPECT_EQ(got[i].found, want[i].found) << set->line_at(i).name;
+        if (want[i].found) {
+            EXPECT_EQ(got[i].segment, want[i].segment) << set->line_at(i).name;
+        }
+    }
+    EXPECT_TRUE(got[0].found);
+    EXPECT_FALSE(got[1].found);
+    EXPECT_TRUE(got[2].found);
+    EXPECT_FALSE(got[3].found);
+}
@@ -0,0 +1,144 @@
+#include "line_set.hpp"
+#include "stream.hpp"
+#include "stream_manager.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <random>
+#include <thread>
+
+using yodau::backend::bbox;
+using yodau::backend::line_set;
+using yodau::backend::make_line;
+using yodau::backend::point;
+using yodau::backend::stream;
+using yodau::backend::stream_manager;
+using yodau::backend::tripwire_dir;
+
+TEST(LineSet, CompilesSegmentsAndBounds) {
+    const auto open = make_line({ { 10, 10 }, { 20, 10 }, { 20, 30 } }, "open");
+    const auto closed
+        = make_line({ { 50, 50 }, { 60, 50 }, { 60, 60 } }, "closed", true);
+    const auto single = make_line({ { 5, 5 } }, "single");
+
+    const line_set set({ open, nullptr, single, closed });
+    ASSERT_EQ(set.line_count(), 2u);
+    EXPECT_EQ(set.line_at(0).name, "open");
+    EXPECT_EQ(set.line_at(1).name, "closed");
+    // 2 segments + 3 with the closing one
+    ASSERT_EQ(set.segment_count(), 5u);
+    EXPECT_EQ(set.segment_line(1), 0u);
+    EXPECT_EQ(set.segment_line(2), 1u);
+
+    const auto& box = set.line_box(0);
+    EXPECT_FLOAT_EQ(box.min_x, 10.0f);
+    EXPECT_FLOAT_EQ(box.max_y, 30.0f);
+
+    std::vector<std::uint32_t> near;
+    set.query({ 55, 55, 70, 70 }, near);
+    for (const auto s : near) {
+        EXPECT_EQ(set.segment_line(s), 1u);
+    }
+    EXPECT_EQ(near.size(), 2u);
+
+    set.query({ 80, 80, 90, 90 }, near);
+    EXPECT_TRUE(near.empty());
+
+    line_set empty;
+    empty.query({ 0, 0, 100, 100 }, near);
+    EXPECT_TRUE(near.empty());
+}
+
+TEST(LineSet, QueryMatchesBruteForce) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(-5.0f, 105.0f);
+    std::uniform_int_distribution<int> count(2, 8);
+
+    std::vector<yodau::backend::line_ptr> lines;
+    for (int i = 0; i < 60; ++i) {
+        std::vector<point> pts;
+        const int n = count(rng);
+        for (int j = 0; j < n; ++j) {
+            pts.push_back({ coord(rng), coord(rng) });
+        }
+        lines.push_back(make_line(pts, "l" + std::to_string(i), i % 3 == 0));
+    }
+    const line_set set(lines);
+
+    std::vector<std::uint32_t> got;
+    for (int q = 0; q < 200; ++q) {
+        const float x0 = coord(rng);
+        const float y0 = coord(rng);
+        const bbox area { x0, y0, x0 + coord(rng) / 4.0f + 5.0f,
+                          y0 + coord(rng) / 4.0f + 5.0f };
+        set.query(area, got);
+
+        std::vector<std::uint32_t> want;
+        for (std::uint32_t s = 0; s < set.segment_count(); ++s) {
+            const auto a = set.segment_a(s);
+            const auto b = set.segment_b(s);
+            const bbox seg { std::min(a.x, b.x), std::min(a.y, b.y),
+                             std::max(a.x, b.x), std::max(a.y, b.y) };
+            if (seg.overlaps(area)) {
+                want.push_back(s);
+            }
+        }
+        EXPECT_EQ(got, want);
+    }
+}
+
+TEST(LineSet, StreamRecompilesOnlyWhenLinesChange) {
+    stream s("clip.mp4", "clip");
+    const auto first = s.compiled_lines();
+    ASSERT_TRUE(first);
+    EXPECT_TRUE(first->empty());
+    EXPECT_EQ(s.compiled_lines(), first);
+
+    s.connect_line(make_line({ { 0, 0 }, { 100, 100 } }, "diag"));
+    const auto second = s.compiled_lines();
+    EXPECT_NE(second, first);
+    EXPECT_EQ(second->segment_count(), 1u);
+    EXPECT_EQ(s.compiled_lines(), second);
+
+    // versions tell compilations apart; reconnecting a name changes nothing
+    EXPECT_EQ(first->version(), 0u);
+    EXPECT_EQ(second->version(), s.lines_version());
+    s.connect_line(make_line({ { 0, 100 }, { 100, 0 } }, "diag"));
+    EXPECT_EQ(s.compiled_lines(), second);
+    EXPECT_FALSE(s.replace_line(make_line({ { 0, 0 }, { 1, 1 } }, "none")));
+    EXPECT_EQ(s.lines_version(), second->version());
+}
+
+TEST(LineSet, LineEditsReachConnectedStreams) {
+    stream_manager mgr;
+    mgr.add_stream("a.mp4", "a", "file");
+    mgr.add_stream("b.mp4", "b", "file");
+    mgr.add_line("0,0;100,100", false, "door");
+    mgr.set_line("a", "door");
+    mgr.set_line("b", "door");
+
+    const auto a = mgr.find_stream("a");
+    const auto before = a->compiled_lines();
+    ASSERT_EQ(before->line_count(), 1u);
+
+    std::atomic<bool> stop { false };
+    std::thread reader([&] {
+        while (!stop.load()) {
+            const auto lines = a->compiled_lines();
+            ASSERT_EQ(lines->line_count(), 1u);
+        }
+    });
+    mgr.set_line_dir("door", tripwire_dir::pos_to_neg);
+    stop = true;
+    reader.join();
+
+    for (const auto* name : { "a", "b" }) {
+        const auto lines = mgr.find_stream(name)->compiled_lines();
+        ASSERT_EQ(lines->line_count(), 1u);
+        EXPECT_EQ(lines->line_at(0).dir, tripwire_dir::pos_to_neg);
+    }
+    EXPECT_GT(a->lines_version(), before->version());
+    // a reader holding the old set still sees the old line
+    EXPECT_EQ(before->line_at(0).dir, tripwire_dir::any);
+}
@@ -0,0 +1,139 @@
+#include "motion_heatmap.hpp"
+#include "stream_manager.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using yodau::backend::activity_grid;
+using yodau::backend::compact_event;
+using yodau::backend::event_batch;
+using yodau::backend::event_kind;
+using yodau::backend::frame;
+using yodau::backend::motion_heatmap;
+using yodau::backend::stream;
+using yodau::backend::stream_manager;
+
+namespace {
+activity_grid one_cell(const int index, const std::uint8_t level) {
+    activity_grid g;
+    g.cells[static_cast<std::size_t>(index)] = level;
+    return g;
+}
+} // namespace
+
+TEST(MotionHeatmap, DecaysByHalfLife) {
+    using namespace std::chrono_literals;
+    motion_heatmap map(10s);
+    const auto t0 = motion_heatmap::clock::time_point {} + 1h;
+    EXPECT_EQ(map.normalized().active_cells(), 0);
+
+    map.add(one_cell(0, 200), t0);
+    map.add(one_cell(1, 100), t0 + 10s);
+    EXPECT_EQ(map.samples(), 2);
+
+    const auto v = map.values(t0 + 10s);
+    EXPECT_NEAR(v[0], 100.0f, 0.01f);
+    EXPECT_NEAR(v[1], 100.0f, 0.01f);
+    EXPECT_NEAR(map.values(t0 + 20s)[1], 50.0f, 0.01f);
+
+    // both cells weigh the same now
+    const auto g = map.normalized();
+    EXPECT_EQ(g.cells[0], 255);
+    EXPECT_EQ(g.cells[1], 255);
+    EXPECT_EQ(g.active_cells(), 2);
+}
+
+TEST(MotionHeatmap, StaysAccurateOverLongRuns) {
+    using namespace std::chrono_literals;
+    motion_heatmap map(1min);
+    auto t = motion_heatmap::clock::time_point {} + 1h;
+
+    // a day of one sample per second in cell 5, then an hour in cell 6
+    for (int i = 0; i < 24 * 3600; ++i) {
+        map.add(one_cell(5, 255), t);
+        t += 1s;
+    }
+    for (int i = 0; i < 3600; ++i) {
+        map.add(one_cell(6, 255), t);
+        t += 1s;
+    }
+    const auto v = map.values(map.last_sample());
+    EXPECT_LT(v[5], 1.0f);
+    // steady state of 255 per second with a one minute half-life
+    EXPECT_NEAR(v[6], 255.0f / (1.0f - std::exp2(-1.0f / 60.0f)), 100.0f);
+    EXPECT_EQ(map.normalized().cells[6], 255);
+
+    // disabling decay keeps the values at the last sample
+    map.set_half_life(0s);
+    EXPECT_NEAR(map.values(t + 1h)[6], v[6], 100.0f);
+
+    std::ostringstream pgm;
+    map.write_pgm(pgm);
+    const auto header = std::string("P5\n32 18\n255\n");
+    const auto pixels = motion_heatmap::cols * motion_heatmap::rows;
+    ASSERT_EQ(pgm.str().size(), header.size() + pixels);
+    EXPECT_EQ(pgm.str().substr(0, header.size()), header);
+}
+
+TEST(MotionHeatmap, StreamManagerAccumulatesMotionGrids) {
+    stream_manager mgr;
+    mgr.add_stream("clip.mp4", "clip", "file");
+    mgr.set_batch_processor([](const stream&, const frame&, event_batch& out) {
+        compact_event e;
+        e.kind = event_kind::motion_grid;
+        e.grid = out.add_grid(one_cell(42, 128));
+        out.push_back(e);
+    });
+    EXPECT_EQ(mgr.heatmap("clip").samples(), 0);
+
+    mgr.process_frame("clip", frame {});
+    const auto map = mgr.heatmap("clip");
+    EXPECT_EQ(map.samples(), 1);
+    EXPECT_EQ(map.normalized().cells[42], 255);
+    EXPECT_EQ(map.get_half_life(), mgr.get_heatmap_half_life());
+
+    mgr.clear_heatmap("clip");
+    EXPECT_EQ(mgr.heatmap("clip").samples(), 0);
+}
+
+TEST(MotionHeatmap, StreamManagerAccumulatesEveryAnalyzedFrame) {
+    stream_manager mgr;
+    mgr.add_stream("clip.mp4", "clip", "file");
+
+    // small motion below any event cutoff on odd frames, an event with the
+    // same activity on even ones
+    int frames = 0;
+    mgr.set_batch_processor([&](const stream&, const frame&, event_batch& out) {
+        const auto now = std::chrono::steady_clock::now();
+        const auto g = one_cell(7, 10);
+        out.add_activity(g, now);
+        if (frames++ % 2 == 0) {
+            compact_event e;
+            e.kind = event_kind::motion_grid;
+            e.ts = now;
+            e.grid = out.add_grid(g);
+            out.push_back(e);
+        }
+    });
+
+    mgr.set_analysis_interval_ms(1);
+    event_batch out;
+    for (int i = 0; i < 4; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        mgr.process_frame("clip", frame {}, out);
+    }
+    // activity records are not events
+    EXPECT_EQ(out.size(), 2u);
+    EXPECT_EQ(out.activity().size(), 4u);
+    EXPECT_EQ(out.to_events().size(), 2u);
+
+    // every frame counts once, whether or not it produced a grid event
+    const auto map = mgr.heatmap("clip");
+    EXPECT_EQ(map.samples(), 4);
+    EXPECT_EQ(map.normalized().cells[7], 255);
+    EXPECT_EQ(map.normalized().active_cells(), 1);
+}
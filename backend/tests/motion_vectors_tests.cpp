@@ -0,0 +1,48 @@
+#include "motion_vectors.hpp"
+
+#include <gtest/gtest.h>
+
+using yodau::backend::motion_vector;
+using yodau::backend::moving_area;
+
+namespace {
+motion_vector block(const float dx, const float dy) {
+    motion_vector mv;
+    mv.x = 8;
+    mv.y = 8;
+    mv.dx = dx;
+    mv.dy = dy;
+    mv.w = 16;
+    mv.h = 16;
+    return mv;
+}
+}
+
+TEST(MotionVectors, StaticBlocksDoNotCount) {
+    // 64x48 frame = 12 blocks of 16x16
+    const std::vector mvs(12, block(0.0f, 0.0f));
+    EXPECT_DOUBLE_EQ(moving_area(mvs, 64, 48, 0.5f), 0.0);
+}
+
+TEST(MotionVectors, UncoveredAreaCountsAsIntra) {
+    const std::vector mvs(9, block(0.0f, 0.0f));
+    EXPECT_DOUBLE_EQ(moving_area(mvs, 64, 48, 0.5f), 3.0 / 12.0);
+    EXPECT_DOUBLE_EQ(moving_area({}, 64, 48, 0.5f), 1.0);
+}
+
+TEST(MotionVectors, MovingBlocksCoverTheirArea) {
+    std::vector mvs(12, block(0.0f, 0.0f));
+    mvs[0] = block(0.25f, -0.5f);
+    mvs[1] = block(3.0f, 4.0f);
+    mvs[2] = block(-0.25f, 0.25f);
+
+    EXPECT_DOUBLE_EQ(moving_area(mvs, 64, 48, 0.5f), 2.0 / 12.0);
+    EXPECT_DOUBLE_EQ(moving_area(mvs, 64, 48, 5.0f), 1.0 / 12.0);
+    EXPECT_DOUBLE_EQ(moving_area(mvs, 64, 48, 0.0f), 1.0);
+}
+
+TEST(MotionVectors, ClampsAndRejectsInvalidSize) {
+    const std::vector mvs(24, block(2.0f, 0.0f));
+    EXPECT_DOUBLE_EQ(moving_area(mvs, 64, 48, 1.0f), 1.0);
+    EXPECT_DOUBLE_EQ(moving_area(mvs, 0, 48, 1.0f), 0.0);
+}
@@ -0,0 +1,431 @@
+#ifdef YODAU_OPENCV
+
+#include "opencv_client.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using yodau::backend::event;
+using yodau::backend::event_kind;
+using yodau::backend::frame;
+using yodau::backend::make_line;
+using yodau::backend::occupancy_config;
+using yodau::backend::opencv_client;
+using yodau::backend::pixel_format;
+using yodau::backend::rate_rule;
+using yodau::backend::stream;
+
+namespace yodau::backend {
+// reaches the mask helpers of a client
+class opencv_client_test : public ::testing::Test {
+protected:
+    bool
+    full_mask(const std::string& name, const cv::Mat& gray, cv::Mat& mask) {
+        return client.full_motion_mask(name, gray, mask);
+    }
+
+    bool
+    pyramid_mask(const std::string& name, const cv::Mat& gray, cv::Mat& mask) {
+        return client.pyramid_motion_mask(name, gray, mask);
+    }
+
+    bool banded_mask(
+        const std::string& name, const cv::Mat& gray, cv::Mat& mask,
+        const int bands
+    ) {
+        return client.parallel_motion_mask(name, gray, mask, bands);
+    }
+
+    static void banded_morphology(cv::Mat& mask, const int bands) {
+        opencv_client::parallel_morphology(mask, bands);
+    }
+
+    int largest_component(
+        const cv::Mat& mask, const int bands,
+        std::vector<std::vector<cv::Point>>& contours
+    ) const {
+        return client.parallel_largest_component(mask, bands, contours);
+    }
+
+    // first row of band 1
+    static int first_border(const int rows, const int bands) {
+        return opencv_client::band_rows(rows, bands, 0).end;
+    }
+
+    opencv_client client;
+};
+} // namespace yodau::backend
+
+using OpencvClientMasks = yodau::backend::opencv_client_test;
+
+namespace {
+constexpr int frame_w = 160;
+constexpr int frame_h = 120;
+
+// flat gray frame with an optional bright block [x0; x1) x [y0; y1)
+frame block_frame(
+    const int x0 = 0, const int y0 = 0, const int x1 = 0, const int y1 = 0
+) {
+    frame f;
+    f.width = frame_w;
+    f.height = frame_h;
+    f.stride = frame_w;
+    f.format = pixel_format::gray8;
+    f.data.assign(static_cast<std::size_t>(frame_w * frame_h), 50);
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            f.data[static_cast<std::size_t>(y * frame_w + x)] = 200;
+        }
+    }
+    f.ts = std::chrono::steady_clock::now();
+    return f;
+}
+
+// flat gray image with an optional bright block
+cv::Mat scene(const cv::Size size, const int bg, const cv::Rect block = {}) {
+    cv::Mat gray(size, CV_8UC1, cv::Scalar(bg));
+    if (!block.empty()) {
+        gray(block).setTo(cv::Scalar(200));
+    }
+    return gray;
+}
+
+int differing(const cv::Mat& a, const cv::Mat& b) {
+    cv::Mat ne;
+    cv::compare(a, b, ne, cv::CMP_NE);
+    return cv::countNonZero(ne);
+}
+
+cv::Mat filled(
+    const std::vector<std::vector<cv::Point>>& contours, const cv::Size size
+) {
+    cv::Mat out = cv::Mat::zeros(size, CV_8UC1);
+    cv::drawContours(out, contours, -1, cv::Scalar(255), cv::FILLED);
+    return out;
+}
+
+// sparse single pixels (removed by erosion) plus a few solid blobs
+cv::Mat noisy_mask(const cv::Size size) {
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> px(0, size.width - 1);
+    std::uniform_int_distribution<int> py(0, size.height - 1);
+    cv::Mat out = cv::Mat::zeros(size, CV_8UC1);
+    for (int i = 0; i < 2000; ++i) {
+        out.at<std::uint8_t>(py(rng), px(rng)) = 255;
+    }
+    for (int i = 0; i < 12; ++i) {
+        const cv::Rect blob(px(rng), py(rng), 24, 16);
+        out(blob & cv::Rect(0, 0, size.width, size.height))
+            .setTo(cv::Scalar(255));
+    }
+    return out;
+}
+
+int count_roi(const std::vector<event>& events, const std::string& message) {
+    return static_cast<int>(
+        std::ranges::count_if(events, [&](const event& e) {
+            return e.kind == event_kind::roi && e.message == message;
+        })
+    );
+}
+} // namespace
+
+TEST(OpencvClient, RegionExitsWhenSceneTurnsStatic) {
+    opencv_client client;
+    occupancy_config cfg;
+    cfg.enter_frames = 2;
+    cfg.exit_frames = 3;
+    client.set_roi_config(cfg);
+
+    stream s("clip.mp4", "clip", "file");
+    s.connect_line(make_line(
+        { { 20, 20 }, { 60, 20 }, { 60, 60 }, { 20, 60 } }, "zone", true
+    ));
+
+    const frame empty = block_frame();
+    const frame block = block_frame(40, 30, 80, 70);
+
+    // the block appears and disappears: every frame has motion in the zone
+    std::vector<event> events;
+    for (const frame* f : { &empty, &block, &empty, &block }) {
+        const auto out = client.motion_processor(s, *f);
+        events.insert(events.end(), out.begin(), out.end());
+    }
+    EXPECT_EQ(count_roi(events, "enter"), 1);
+    EXPECT_EQ(count_roi(events, "exit"), 0);
+
+    // then it stays: identical frames are skipped as static, but still
+    // count as idle frames of the zone
+    events.clear();
+    for (int i = 0; i < cfg.exit_frames + 1; ++i) {
+        const auto out = client.motion_processor(s, block);
+        events.insert(events.end(), out.begin(), out.end());
+    }
+    EXPECT_GT(client.skipped_frames("clip"), 0u);
+    EXPECT_EQ(count_roi(events, "exit"), 1);
+}
+
+TEST(OpencvClient, RegionKeepsStateWhenLinesChange) {
+    opencv_client client;
+    occupancy_config cfg;
+    cfg.enter_frames = 2;
+    cfg.exit_frames = 3;
+    client.set_roi_config(cfg);
+
+    stream s("clip.mp4", "clip", "file");
+    s.connect_line(make_line(
+        { { 20, 20 }, { 60, 20 }, { 60, 60 }, { 20, 60 } }, "zone", true
+    ));
+
+    const frame empty = block_frame();
+    const frame block = block_frame(40, 30, 80, 70);
+
+    std::vector<event> events;
+    for (const frame* f : { &empty, &block, &empty, &block }) {
+        const auto out = client.motion_processor(s, *f);
+        events.insert(events.end(), out.begin(), out.end());
+    }
+    ASSERT_EQ(count_roi(events, "enter"), 1);
+
+    // publishing another line rebuilds the regions of the stream
+    s.connect_line(make_line({ { 90, 10 }, { 90, 90 } }, "door"));
+
+    events.clear();
+    for (int i = 0; i < cfg.exit_frames + 1; ++i) {
+        const auto out = client.motion_processor(s, block);
+        events.insert(events.end(), out.begin(), out.end());
+    }
+    EXPECT_EQ(count_roi(events, "enter"), 0);
+    EXPECT_EQ(count_roi(events, "exit"), 1);
+}
+
+TEST_F(OpencvClientMasks, PyramidMatchesFullModeOnMovingBlock) {
+    const cv::Size size(320, 240);
+    for (const int levels : { 1, 2, 3 }) {
+        client.set_pyramid_levels(levels);
+        const auto name = "levels" + std::to_string(levels);
+        for (int step = 0; step < 6; ++step) {
+            const auto gray
+                = scene(size, 50, cv::Rect(40 + step * 8, 100, 32, 32));
+            cv::Mat full;
+            cv::Mat pyramid;
+            const bool has_full = full_mask(name + "/full", gray, full);
+            const bool has_pyramid = pyramid_mask(name + "/pyr", gray, pyramid);
+            ASSERT_EQ(has_full, has_pyramid);
+            if (!has_full) {
+                continue;
+            }
+            EXPECT_GT(cv::countNonZero(full), 0);
+            EXPECT_EQ(differing(full, pyramid), 0)
+                << "levels=" << levels << " step=" << step;
+        }
+    }
+}
+
+TEST_F(OpencvClientMasks, PyramidStaticTilesStayEmptyUnderDrift) {
+    const cv::Size size(320, 240);
+    cv::Mat mask;
+    ASSERT_FALSE(pyramid_mask("drift", scene(size, 50), mask));
+
+    // lighting drifts by one level per frame, far below the threshold per
+    // frame but well above it in total
+    for (int i = 1; i <= 40; ++i) {
+        ASSERT_TRUE(pyramid_mask("drift", scene(size, 50 + i), mask));
+        EXPECT_EQ(cv::countNonZero(mask), 0) << "frame " << i;
+    }
+
+    // a block appearing refines its tiles: only the block itself shows up,
+    // not the accumulated drift of the tiles around it
+    const cv::Rect block(200, 120, 32, 32);
+    ASSERT_TRUE(pyramid_mask("drift", scene(size, 91, block), mask));
+    EXPECT_GT(cv::countNonZero(mask), 0);
+    const cv::Rect halo(
+        block.x - 3, block.y - 3, block.width + 6, block.height + 6
+    );
+    mask(halo).setTo(cv::Scalar(0));
+    EXPECT_EQ(cv::countNonZero(mask), 0);
+}
+
+TEST_F(OpencvClientMasks, PyramidActivationGatesRefinement) {
+    const cv::Size size(320, 240);
+    const cv::Rect block(100, 100, 12, 12);
+    cv::Mat mask;
+
+    // a small block changes only a part of its coarse tile
+    client.set_pyramid_activation(1.0);
+    ASSERT_FALSE(pyramid_mask("strict", scene(size, 50), mask));
+    ASSERT_TRUE(pyramid_mask("strict", scene(size, 50, block), mask));
+    EXPECT_EQ(cv::countNonZero(mask), 0);
+
+    client.set_pyramid_activation(0.02);
+    ASSERT_FALSE(pyramid_mask("default", scene(size, 50), mask));
+    ASSERT_TRUE(pyramid_mask("default", scene(size, 50, block), mask));
+    EXPECT_GT(cv::countNonZero(mask), 0);
+}
+
+TEST(OpencvClient, PyramidModeReportsSameMotion) {
+    opencv_client full;
+    opencv_client pyramid;
+    pyramid.set_detection_mode(opencv_client::detection_mode::pyramid);
+    for (auto* c : { &full, &pyramid }) {
+        c->set_rate_rule(
+            opencv_client::rate_target::motion, {}, {}, rate_rule {}
+        );
+    }
+    stream s("clip.mp4", "clip", "file");
+
+    int motions = 0;
+    for (int step = 0; step < 8; ++step) {
+        const auto f = block_frame(20 + step * 10, 40, 52 + step * 10, 72);
+        const auto a = full.motion_processor(s, f);
+        const auto b = pyramid.motion_processor(s, f);
+        ASSERT_EQ(a.size(), b.size()) << "step " << step;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            EXPECT_EQ(a[i].kind, b[i].kind);
+            if (a[i].kind == event_kind::motion) {
+                ++motions;
+                ASSERT_TRUE(a[i].pos_pct && b[i].pos_pct);
+                EXPECT_FLOAT_EQ(a[i].pos_pct->x, b[i].pos_pct->x);
+                EXPECT_FLOAT_EQ(a[i].pos_pct->y, b[i].pos_pct->y);
+            }
+            if (a[i].kind == event_kind::motion_grid) {
+                ASSERT_TRUE(a[i].grid && b[i].grid);
+                EXPECT_EQ(a[i].grid->cells, b[i].grid->cells);
+            }
+        }
+    }
+    EXPECT_GT(motions, 0);
+}
+
+namespace {
+// directions of the tripwire events of one line, in order
+std::vector<std::string>
+crossings(const std::vector<event>& events, const std::string& line) {
+    std::vector<std::string> out;
+    for (const auto& e : events) {
+        if (e.kind == event_kind::tripwire && e.line_name == line) {
+            out.push_back(e.message);
+        }
+    }
+    return out;
+}
+} // namespace
+
+TEST(OpencvClient, TripwireModesReportSameCrossings) {
+    opencv_client vector_mode;
+    opencv_client raster_mode;
+    stream s("clip.mp4", "clip", "file");
+    raster_mode.set_tripwire_mode(
+        s.get_name(), opencv_client::tripwire_mode::raster
+    );
+    for (auto* c : { &vector_mode, &raster_mode }) {
+        c->set_rate_rule(
+            opencv_client::rate_target::tripwire, {}, {}, rate_rule {}
+        );
+    }
+    s.connect_line(make_line({ { 50, 10 }, { 50, 90 } }, "crossing"));
+    // lies entirely inside the left block, never touching its outline
+    s.connect_line(make_line({ { 36, 45 }, { 40, 55 } }, "inside"));
+
+    // a block blinks left and right of the "crossing" line, overlapping it
+    const frame empty = block_frame();
+    const frame left = block_frame(50, 40, 90, 80);
+    const frame right = block_frame(75, 40, 115, 80);
+
+    std::vector<event> a;
+    std::vector<event> b;
+    for (int i = 0; i < 3; ++i) {
+        for (const frame* f : { &empty, &left, &empty, &right }) {
+            const auto va = vector_mode.motion_processor(s, *f);
+            const auto vb = raster_mode.motion_processor(s, *f);
+            a.insert(a.end(), va.begin(), va.end());
+            b.insert(b.end(), vb.begin(), vb.end());
+        }
+    }
+
+    // lines crossing the outline of the motion give the same events
+    const auto want = crossings(a, "crossing");
+    EXPECT_EQ(crossings(b, "crossing"), want);
+    EXPECT_TRUE(std::ranges::find(want, "neg_to_pos") != want.end());
+    EXPECT_TRUE(std::ranges::find(want, "pos_to_neg") != want.end());
+
+    // the one intended difference: raster mode also hits a line lying
+    // inside the motion, the vector path only sees outline intersections
+    EXPECT_TRUE(crossings(a, "inside").empty());
+    EXPECT_FALSE(crossings(b, "inside").empty());
+}
+
+TEST_F(OpencvClientMasks, BandedMaskMatchesSingleBand) {
+    const cv::Size size(640, 480);
+    for (int bands = 2; bands <= 7; ++bands) {
+        const int border = first_border(size.height, bands);
+        const auto name = "bands" + std::to_string(bands);
+        const auto before = scene(size, 50, cv::Rect(300, border - 40, 40, 40));
+        // moved down across the border between bands 0 and 1
+        const auto after = scene(size, 50, cv::Rect(300, border - 12, 40, 40));
+
+        cv::Mat single;
+        cv::Mat banded;
+        ASSERT_FALSE(full_mask(name + "/single", before, single));
+        ASSERT_FALSE(banded_mask(name + "/banded", before, banded, bands));
+        ASSERT_TRUE(full_mask(name + "/single", after, single));
+        ASSERT_TRUE(banded_mask(name + "/banded", after, banded, bands));
+
+        EXPECT_GT(cv::countNonZero(single), 0);
+        EXPECT_EQ(differing(single, banded), 0) << "bands=" << bands;
+    }
+}
+
+TEST_F(OpencvClientMasks, BandedMorphologyMatchesSingleBand) {
+    const auto mask = noisy_mask(cv::Size(640, 480));
+    cv::Mat single;
+    cv::erode(mask, single, cv::Mat(), cv::Point(-1, -1), 1);
+    cv::dilate(single, single, cv::Mat(), cv::Point(-1, -1), 2);
+    EXPECT_GT(cv::countNonZero(single), 0);
+
+    for (int bands = 2; bands <= 7; ++bands) {
+        cv::Mat banded = mask.clone();
+        banded_morphology(banded, bands);
+        EXPECT_EQ(differing(single, banded), 0) << "bands=" << bands;
+    }
+}
+
+TEST_F(OpencvClientMasks, BandedLargestComponentMatchesSingleBand) {
+    const cv::Size size(640, 480);
+    for (int bands = 2; bands <= 7; ++bands) {
+        const int border = first_border(size.height, bands);
+
+        // a U whose two bars are separate inside band 0 and only joined
+        // by its bottom in band 1, next to a blob larger than either bar
+        cv::Mat mask = cv::Mat::zeros(size, CV_8UC1);
+        const cv::Rect u(100, border - 40, 60, 50);
+        mask(cv::Rect(u.x, u.y, 10, 40)).setTo(cv::Scalar(255));
+        mask(cv::Rect(u.x + 50, u.y, 10, 40)).setTo(cv::Scalar(255));
+        mask(cv::Rect(u.x, border, 60, 10)).setTo(cv::Scalar(255));
+        mask(cv::Rect(400, border - 15, 30, 30)).setTo(cv::Scalar(255));
+        // and a diagonal step across the border
+        mask.at<std::uint8_t>(border - 1, 500) = 255;
+        mask.at<std::uint8_t>(border, 501) = 255;
+
+        std::vector<std::vector<cv::Point>> single;
+        std::vector<std::vector<cv::Point>> banded;
+        const int nz_single = largest_component(mask, 1, single);
+        const int nz_banded = largest_component(mask, bands, banded);
+
+        EXPECT_EQ(nz_single, cv::countNonZero(mask));
+        EXPECT_EQ(nz_banded, nz_single) << "bands=" << bands;
+        ASSERT_FALSE(single.empty());
+        ASSERT_FALSE(banded.empty()) << "bands=" << bands;
+
+        const auto single_px = filled(single, size);
+        EXPECT_EQ(cv::boundingRect(single_px), u);
+        EXPECT_EQ(differing(single_px, filled(banded, size)), 0)
+            << "bands=" << bands;
+    }
+}
+
+#endif // YODAU_OPENCV
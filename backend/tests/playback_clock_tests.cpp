@@ -0,0 +1,70 @@
+#include "playback_clock.hpp"
+
+#include <gtest/gtest.h>
+
+using yodau::backend::playback_clock;
+using namespace std::chrono_literals;
+
+TEST(PlaybackClock, FollowsPresentationTime) {
+    playback_clock pc(25.0);
+    const auto t0 = playback_clock::clock::now();
+
+    EXPECT_EQ(pc.due(1000.0, t0), t0);
+    EXPECT_EQ(pc.due(1040.0, t0), t0 + 40ms);
+    EXPECT_EQ(pc.due(1080.0, t0 + 10ms), t0 + 80ms);
+}
+
+TEST(PlaybackClock, FallsBackToFramePeriod) {
+    playback_clock pc(50.0);
+    const auto t0 = playback_clock::clock::now();
+
+    EXPECT_EQ(pc.frame_period(), 20ms);
+    EXPECT_EQ(pc.due(-1.0, t0), t0);
+    EXPECT_EQ(pc.due(-1.0, t0), t0 + 20ms);
+
+    playback_clock stuck(50.0);
+    stuck.due(500.0, t0);
+    // non-increasing timestamps are treated as unknown as well
+    EXPECT_EQ(stuck.due(500.0, t0), t0 + 20ms);
+    EXPECT_EQ(stuck.due(480.0, t0), t0 + 40ms);
+}
+
+TEST(PlaybackClock, RejectedTimestampsKeepOrder) {
+    playback_clock pc(50.0);
+    const auto t0 = playback_clock::clock::now();
+
+    pc.due(0.0, t0);
+    EXPECT_EQ(pc.due(100.0, t0), t0 + 100ms);
+    // a jump back is rejected and does not become the new reference
+    EXPECT_EQ(pc.due(10.0, t0), t0 + 120ms);
+    EXPECT_EQ(pc.due(20.0, t0), t0 + 140ms);
+    // a valid timestamp behind the extrapolated frames does not go back
+    EXPECT_EQ(pc.due(110.0, t0), t0 + 140ms);
+    EXPECT_EQ(pc.due(200.0, t0), t0 + 200ms);
+}
+
+TEST(PlaybackClock, RestartAndLagReanchor) {
+    playback_clock pc(0.0);
+    const auto t0 = playback_clock::clock::now();
+
+    pc.due(0.0, t0);
+    pc.due(100.0, t0);
+
+    const auto late = t0 + 5s;
+    EXPECT_EQ(pc.due(200.0, late), late);
+    EXPECT_EQ(pc.due(300.0, late), late + 100ms);
+
+    pc.restart();
+    const auto t1 = late + 1s;
+    EXPECT_EQ(pc.due(0.0, t1), t1);
+    EXPECT_EQ(pc.due(100.0, t1), t1 + 100ms);
+}
+
+TEST(PlaybackClock, SleepStopsOnRequest) {
+    std::stop_source src;
+    const auto now = playback_clock::clock::now();
+    EXPECT_TRUE(playback_clock::sleep_until(now, src.get_token()));
+
+    src.request_stop();
+    EXPECT_FALSE(playback_clock::sleep_until(now + 1h, src.get_token()));
+}
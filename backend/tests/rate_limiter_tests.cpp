@@ -0,0 +1,113 @@
+#include "rate_limiter.hpp"
+#include "stream_manager.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using yodau::backend::event;
+using yodau::backend::frame;
+using yodau::backend::rate_key;
+using yodau::backend::rate_limiter;
+using yodau::backend::rate_rule;
+using yodau::backend::stream;
+using yodau::backend::stream_manager;
+using yodau::backend::token_bucket;
+
+TEST(RateLimiter, TokenBucketAllowsBurstThenRate) {
+    using namespace std::chrono_literals;
+    const rate_rule rule { 100ms, 3 };
+    token_bucket b;
+    auto now = token_bucket::clock::time_point {} + 1h;
+
+    EXPECT_TRUE(b.take(rule, now));
+    EXPECT_TRUE(b.take(rule, now));
+    EXPECT_TRUE(b.take(rule, now));
+    EXPECT_FALSE(b.take(rule, now));
+
+    // one token per interval
+    now += 99ms;
+    EXPECT_FALSE(b.take(rule, now));
+    now += 1ms;
+    EXPECT_TRUE(b.take(rule, now));
+    EXPECT_FALSE(b.take(rule, now));
+
+    // refilled to the burst, not beyond
+    now += 10s;
+    EXPECT_LE(b.full_at(), now);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(b.take(rule, now));
+    }
+    EXPECT_FALSE(b.take(rule, now));
+
+    EXPECT_TRUE(b.take(rate_rule {}, now));
+}
+
+TEST(RateLimiter, CooldownPerKey) {
+    using namespace std::chrono_literals;
+    rate_limiter limiter;
+    const rate_rule cooldown { 1200ms, 1 };
+    const auto a = rate_key("cam", "door", 1);
+    const auto b = rate_key("cam", "door", 2);
+    EXPECT_NE(a, b);
+    EXPECT_NE(rate_key("cam", "", 0), rate_key("", "cam", 0));
+
+    auto now = rate_limiter::clock::time_point {} + 1h;
+    EXPECT_TRUE(limiter.allow(a, cooldown, now));
+    EXPECT_TRUE(limiter.allow(b, cooldown, now));
+    EXPECT_FALSE(limiter.allow(a, cooldown, now + 1s));
+    EXPECT_TRUE(limiter.allow(a, cooldown, now + 1200ms));
+    EXPECT_EQ(limiter.size(), 2u);
+}
+
+TEST(RateLimiter, ExpiresIdleKeys) {
+    using namespace std::chrono_literals;
+    // 8 slots of 10 ms: cooldowns longer than a revolution wrap around
+    rate_limiter limiter(10ms, 8);
+    const rate_rule cooldown { 200ms, 1 };
+    auto now = rate_limiter::clock::time_point {} + 1h;
+
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(limiter.allow(rate_key("cam", "line", i), cooldown, now));
+        now += 1ms;
+    }
+    // only keys of the last cooldown (plus one tick) are tracked
+    EXPECT_GE(limiter.size(), 200u);
+    EXPECT_LE(limiter.size(), 210u);
+
+    // an active key survives while the others expire
+    const auto hot = rate_key("cam", "hot", 0);
+    for (int i = 0; i < 35; ++i) {
+        limiter.allow(hot, cooldown, now);
+        now += 10ms;
+    }
+    EXPECT_FALSE(limiter.allow(hot, cooldown, now));
+    EXPECT_EQ(limiter.size(), 1u);
+
+    // a blocked key keeps its state until its bucket is full again
+    now += 30ms;
+    EXPECT_FALSE(limiter.allow(hot, cooldown, now));
+    now += 300ms;
+    EXPECT_TRUE(limiter.allow(rate_key("cam", "other", 0), cooldown, now));
+    EXPECT_EQ(limiter.size(), 1u);
+}
+
+TEST(RateLimiter, StreamManagerEventBudget) {
+    using namespace std::chrono_literals;
+    stream_manager mgr;
+    mgr.add_stream("clip.mp4", "clip", "file");
+    mgr.set_frame_processor([](const stream&, const frame&) {
+        return std::vector<event>(5);
+    });
+    std::vector<event> delivered;
+    mgr.set_event_batch_sink([&](const std::vector<event>& evs) {
+        delivered.insert(delivered.end(), evs.begin(), evs.end());
+    });
+
+    mgr.set_event_budget({ 1h, 3 });
+    EXPECT_EQ(mgr.get_event_budget().burst, 3);
+    mgr.push_frame("clip", frame {});
+    EXPECT_EQ(delivered.size(), 3u);
+    EXPECT_EQ(mgr.dropped_events(), 2u);
+}
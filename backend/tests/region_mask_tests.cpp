@@ -0,0 +1,147 @@
+#include "region_mask.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <random>
+
+using yodau::backend::bit_mask;
+using yodau::backend::line_ptr;
+using yodau::backend::line_set;
+using yodau::backend::make_line;
+using yodau::backend::occupancy_config;
+using yodau::backend::point;
+using yodau::backend::region_mask;
+using yodau::backend::region_occupancy;
+using yodau::backend::region_set;
+
+namespace {
+// even-odd point-in-polygon test
+bool contains(const std::vector<point>& poly, const point& p) {
+    bool in = false;
+    for (std::size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++) {
+        const auto& a = poly[i];
+        const auto& b = poly[j];
+        if ((a.y <= p.y) != (b.y <= p.y)
+            && p.x < a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y)) {
+            in = !in;
+        }
+    }
+    return in;
+}
+}
+
+TEST(RegionMask, RasterizesPolygonAtPixelCenters) {
+    const std::vector<point> square {
+        { 10, 10 }, { 50, 10 }, { 50, 50 }, { 10, 50 }
+    };
+    const region_mask mask(square, 100, 100);
+    EXPECT_EQ(mask.area(), 40 * 40);
+    EXPECT_NEAR(mask.centroid().x, 30.0f, 0.01f);
+    EXPECT_NEAR(mask.centroid().y, 30.0f, 0.01f);
+
+    bit_mask motion(100, 100);
+    std::vector<std::uint8_t> bytes(100 * 100, 0);
+    const auto set = [&](const int x, const int y) {
+        motion.set(x, y);
+        bytes[static_cast<std::size_t>(y * 100 + x)] = 255;
+    };
+    set(5, 5);
+    set(10, 10);
+    set(49, 49);
+    set(50, 20);
+    EXPECT_EQ(mask.count_in(motion), 2);
+    EXPECT_EQ(mask.count_in(bytes.data(), 100), 2);
+
+    EXPECT_EQ(mask.count_in(bit_mask(50, 50)), 0);
+    EXPECT_EQ(region_mask({ { 0, 0 }, { 10, 10 } }, 100, 100).area(), 0);
+}
+
+TEST(RegionMask, MatchesPointInPolygon) {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> coord(-10.0f, 110.0f);
+    std::bernoulli_distribution on(0.3);
+    constexpr int w = 160;
+    constexpr int h = 90;
+
+    for (int round = 0; round < 20; ++round) {
+        std::vector<point> poly;
+        const int n = 3 + round % 6;
+        for (int i = 0; i < n; ++i) {
+            poly.push_back({ coord(rng), coord(rng) });
+        }
+        const region_mask mask(poly, w, h);
+
+        bit_mask motion(w, h);
+        long long want_area = 0;
+        long long want_hits = 0;
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                const point c { (static_cast<float>(x) + 0.5f) * 100.0f / w,
+                                (static_cast<float>(y) + 0.5f) * 100.0f / h };
+                const bool moving = on(rng);
+                motion.set(x, y, moving);
+                if (contains(poly, c)) {
+                    ++want_area;
+                    want_hits += moving ? 1 : 0;
+                }
+            }
+        }
+        // pixel centers exactly on an edge may round either way
+        EXPECT_LE(std::llabs(mask.area() - want_area), 2 + want_area / 500);
+        EXPECT_LE(
+            std::llabs(mask.count_in(motion) - want_hits), 2 + want_hits / 500
+        );
+    }
+}
+
+TEST(RegionMask, RegionSetUsesClosedLinesOnly) {
+    const auto lines = std::make_shared<const line_set>(std::vector<line_ptr> {
+        make_line({ { 0, 0 }, { 100, 100 } }, "wire"),
+        make_line({ { 10, 10 }, { 90, 10 }, { 50, 90 } }, "zone", true),
+        make_line({ { 10, 10 }, { 90, 10 } }, "flat", true) });
+    const region_set regions(lines, 64, 48);
+    ASSERT_EQ(regions.size(), 1u);
+    EXPECT_EQ(regions.line_at(0).name, "zone");
+    EXPECT_GT(regions.mask_at(0).area(), 0);
+    EXPECT_TRUE(regions.matches(lines, 64, 48));
+    EXPECT_FALSE(regions.matches(lines, 32, 24));
+}
+
+TEST(RegionMask, OccupancyUsesHysteresis) {
+    using change = region_occupancy::change;
+    occupancy_config cfg;
+    cfg.enter_ratio = 0.1;
+    cfg.exit_ratio = 0.02;
+    cfg.enter_frames = 2;
+    cfg.exit_frames = 3;
+    cfg.report_interval = std::chrono::milliseconds(100);
+
+    region_occupancy occ;
+    auto now = std::chrono::steady_clock::time_point {};
+    const auto step = [&](const double ratio) {
+        now += std::chrono::milliseconds(40);
+        return occ.update(ratio, now, cfg);
+    };
+
+    // a single active frame is not enough
+    EXPECT_EQ(step(0.2), change::none);
+    EXPECT_EQ(step(0.0), change::none);
+    EXPECT_EQ(step(0.2), change::none);
+    EXPECT_EQ(step(0.2), change::enter);
+    EXPECT_TRUE(occ.occupied());
+
+    // between the thresholds the region stays occupied
+    EXPECT_EQ(step(0.05), change::none);
+    EXPECT_EQ(step(0.05), change::none);
+    EXPECT_EQ(step(0.05), change::occupied);
+
+    // idle frames must be consecutive to exit
+    EXPECT_EQ(step(0.0), change::none);
+    EXPECT_EQ(step(0.0), change::none);
+    EXPECT_EQ(step(0.05), change::occupied);
+    EXPECT_EQ(step(0.0), change::none);
+    EXPECT_EQ(step(0.0), change::none);
+    EXPECT_EQ(step(0.0), change::exit);
+    EXPECT_FALSE(occ.occupied());
+}
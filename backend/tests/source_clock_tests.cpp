@@ -0,0 +1,44 @@
+#include "source_clock.hpp"
+
+#include <gtest/gtest.h>
+
+using yodau::backend::source_clock;
+using namespace std::chrono_literals;
+
+TEST(SourceClock, KeepsFastestArrivalAsBaseline) {
+    source_clock sc;
+    const auto t0 = source_clock::clock::now();
+
+    EXPECT_EQ(sc.map(1000.0, t0), t0);
+    // arrives 30 ms late relative to the first frame: stamped on schedule
+    // (plus the drift allowance of 0.1% of 40 ms)
+    EXPECT_EQ(sc.map(1040.0, t0 + 70ms), t0 + 40ms + 40us);
+    // arrives early: becomes the new baseline
+    EXPECT_EQ(sc.map(1080.0, t0 + 70ms), t0 + 70ms);
+    EXPECT_EQ(sc.map(1120.0, t0 + 200ms), t0 + 110ms + 40us);
+}
+
+TEST(SourceClock, UnknownAndJumpingTimestamps) {
+    source_clock sc;
+    const auto t0 = source_clock::clock::now();
+
+    EXPECT_EQ(sc.map(-1.0, t0 + 5ms), t0 + 5ms);
+
+    sc.map(500.0, t0);
+    // source restarted: re-anchor on arrival
+    EXPECT_EQ(sc.map(0.0, t0 + 100ms), t0 + 100ms);
+    EXPECT_EQ(sc.map(60'000.0, t0 + 200ms), t0 + 200ms);
+
+    sc.reset();
+    EXPECT_EQ(sc.map(40.0, t0 + 300ms), t0 + 300ms);
+}
+
+TEST(SourceClock, ToleratesSlowDrift) {
+    source_clock sc;
+    const auto t0 = source_clock::clock::now();
+
+    sc.map(0.0, t0);
+    // local clock runs 0.05% faster than the source for 4 seconds
+    const auto ts = sc.map(4000.0, t0 + 4002ms);
+    EXPECT_EQ(ts, t0 + 4002ms);
+}
@@ -1,3 +1,253 @@
+#include "stream_manager.hpp"
+
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
 TEST(Test, TestTrue) { EXPECT_TRUE(true); }
+
+using yodau::backend::capture_format;
+using yodau::backend::event;
+using yodau::backend::frame;
+using yodau::backend::stream;
+using yodau::backend::stream_manager;
+
+TEST(StreamManager, WantsFrameFollowsAnalysisInterval) {
+    stream_manager mgr;
+    mgr.add_stream("clip.mp4", "clip", "file");
+
+    EXPECT_FALSE(mgr.wants_frame("clip"));
+
+    mgr.set_frame_processor([](const stream&, const frame&) {
+        return std::vector<event> {};
+    });
+    mgr.set_analysis_interval_ms(60'000);
+
+    EXPECT_TRUE(mgr.wants_frame("clip"));
+    EXPECT_FALSE(mgr.wants_frame("missing"));
+
+    mgr.process_frame("clip", frame {});
+    EXPECT_FALSE(mgr.wants_frame("clip"));
+
+    mgr.set_manual_push_hook([](const std::string&, frame&&) { });
+    EXPECT_TRUE(mgr.wants_frame("clip"));
+}
+
+TEST(StreamManager, MeasuresGlassToEventLatency) {
+    stream_manager mgr;
+    mgr.add_stream("clip.mp4", "clip", "file");
+    mgr.set_frame_processor([](const stream&, const frame&) {
+        return std::vector<event> {};
+    });
+    mgr.set_analysis_interval_ms(60'000);
+
+    // frames without a capture time are not measured
+    mgr.process_frame("clip", frame {});
+    EXPECT_EQ(mgr.latency("clip").samples, 0u);
+
+    stream_manager timed;
+    timed.add_stream("clip.mp4", "clip", "file");
+    timed.set_frame_processor([](const stream&, const frame&) {
+        return std::vector<event> {};
+    });
+    timed.set_analysis_interval_ms(60'000);
+
+    frame f;
+    f.ts = std::chrono::steady_clock::now() - std::chrono::milliseconds(40);
+    timed.process_frame("clip", std::move(f));
+
+    const auto lat = timed.latency("clip");
+    EXPECT_EQ(lat.samples, 1u);
+    EXPECT_GE(lat.last, std::chrono::milliseconds(40));
+    EXPECT_EQ(lat.average, lat.last);
+    EXPECT_EQ(lat.max, lat.last);
+
+    // throttled frames are not analyzed and not measured
+    frame late;
+    late.ts = std::chrono::steady_clock::now();
+    timed.process_frame("clip", std::move(late));
+    EXPECT_EQ(timed.latency("clip").samples, 1u);
+    EXPECT_EQ(timed.latency("missing").samples, 0u);
+}
+
+TEST(StreamManager, SharesCaptureOfIdenticalSources) {
+    stream_manager mgr;
+    mgr.add_stream("clip.mp4", "a", "file");
+    mgr.add_stream("clip.mp4", "b", "file");
+
+    std::atomic<int> starts { 0 };
+    std::atomic<bool> stopped { false };
+    mgr.set_daemon_start_hook([&](const stream&,
+                                  std::function<void(frame&&)> on_frame,
+                                  std::function<bool()> wants_frame,
+                                  std::stop_token st) {
+        ++starts;
+        while (!st.stop_requested()) {
+            if (wants_frame()) {
+                frame f;
+                f.data.assign(16, 7);
+                on_frame(std::move(f));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        stopped = true;
+    });
+
+    std::mutex seen_mtx;
+    std::vector<std::pair<std::string, const std::uint8_t*>> seen;
+    mgr.set_manual_push_hook([&](const std::string& name, frame&& f) {
+        std::scoped_lock lock(seen_mtx);
+        seen.emplace_back(name, f.bytes());
+    });
+
+    mgr.start_stream("a");
+    mgr.start_stream("b");
+    EXPECT_TRUE(mgr.is_stream_running("a"));
+    EXPECT_TRUE(mgr.is_stream_running("b"));
+
+    // both streams receive the same pixels from a single capture
+    const auto deadline
+        = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    bool shared = false;
+    while (!shared && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        std::scoped_lock lock(seen_mtx);
+        for (const auto& [name, bytes] : seen) {
+            if (name != "b") {
+                continue;
+            }
+            shared = shared
+                || std::ranges::any_of(seen, [&](const auto& other) {
+                       return other.first == "a" && other.second == bytes;
+                   });
+        }
+    }
+    EXPECT_TRUE(shared);
+    EXPECT_EQ(starts, 1);
+
+    mgr.stop_stream("a");
+    EXPECT_FALSE(mgr.is_stream_running("a"));
+    EXPECT_TRUE(mgr.is_stream_running("b"));
+    EXPECT_FALSE(stopped);
+
+    mgr.stop_stream("b");
+    EXPECT_TRUE(stopped);
+    EXPECT_EQ(starts, 1);
+}
+
+TEST(StreamManager, SharedCaptureKeepsOneFormat) {
+    const capture_format vga { 640, 480, 30.0, "MJPG" };
+    stream_manager mgr;
+    mgr.add_stream("rtsp://cam/1", "a", "url", true, vga);
+    mgr.add_stream("rtsp://cam/1", "b", "url", true, vga);
+    mgr.add_stream("rtsp://cam/1", "any", "url");
+    mgr.add_stream("rtsp://cam/1", "hd", "url", true, { 1280, 720, 0.0, {} });
+
+    std::atomic<bool> reported { false };
+    mgr.set_daemon_start_hook([&](const stream& s,
+                                  std::function<void(frame&&)> on_frame,
+                                  std::function<bool()>, std::stop_token st) {
+        capture_format got = s.requested_format();
+        got.fps = 25.0;
+        s.report_negotiated_format(got);
+        reported = true;
+        while (!st.stop_requested()) {
+            on_frame(frame {});
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    mgr.set_manual_push_hook([](const std::string&, frame&&) { });
+
+    mgr.start_stream("a");
+    const auto deadline
+        = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!reported && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(reported);
+
+    // a different format cannot be served by the running capture
+    EXPECT_THROW(mgr.start_stream("hd"), std::runtime_error);
+    EXPECT_FALSE(mgr.is_stream_running("hd"));
+
+    // the same or no requested format subscribes, and every subscriber sees
+    // the negotiated format
+    mgr.start_stream("b");
+    mgr.start_stream("any");
+    for (const auto* name : { "a", "b", "any" }) {
+        EXPECT_TRUE(mgr.is_stream_running(name)) << name;
+        const auto fmt = mgr.find_stream(name)->negotiated_format();
+        EXPECT_EQ(fmt.width, 640) << name;
+        EXPECT_DOUBLE_EQ(fmt.fps, 25.0) << name;
+    }
+}
+
+TEST(Frame, ShareKeepsPixelsInOneBuffer) {
+    frame f;
+    f.data = { 1, 2, 3 };
+    f.share();
+    EXPECT_TRUE(f.data.empty());
+    ASSERT_EQ(f.size(), 3u);
+    EXPECT_EQ(f.bytes()[2], 3);
+
+    const frame copy = f;
+    EXPECT_EQ(copy.bytes(), f.bytes());
+
+    const auto* before = f.bytes();
+    f.share();
+    EXPECT_EQ(f.bytes(), before);
+}
+
+TEST(Stream, CaptureFormatHelpers) {
+    int w = 0;
+    int h = 0;
+    EXPECT_TRUE(capture_format::parse_size("640x480", w, h));
+    EXPECT_EQ(w, 640);
+    EXPECT_EQ(h, 480);
+    EXPECT_FALSE(capture_format::parse_size("640", w, h));
+    EXPECT_FALSE(capture_format::parse_size("640x", w, h));
+    EXPECT_FALSE(capture_format::parse_size("0x480", w, h));
+    EXPECT_FALSE(capture_format::parse_size("640x480p", w, h));
+
+    capture_format fmt;
+    EXPECT_TRUE(fmt.empty());
+    fmt.fourcc = "MJPG";
+    EXPECT_FALSE(fmt.empty());
+    // same packing as v4l2_fourcc('M', 'J', 'P', 'G')
+    EXPECT_EQ(fmt.fourcc_code(), 0x47504A4Du);
+    EXPECT_EQ(capture_format::fourcc_name(fmt.fourcc_code()), "MJPG");
+    EXPECT_EQ(capture_format::fourcc_name(0), "");
+    fmt.fourcc = "MJPEG";
+    EXPECT_EQ(fmt.fourcc_code(), 0u);
+}
+
+TEST(Stream, ReportsRequestedAndNegotiatedFormat) {
+    stream_manager mgr;
+    capture_format want;
+    want.width = 640;
+    want.height = 480;
+    want.fps = 30.0;
+    want.fourcc = "MJPG";
+    const auto& s = mgr.add_stream("/dev/video7", "cam", "local", true, want);
+
+    EXPECT_EQ(s.requested_format().width, 640);
+    EXPECT_TRUE(s.negotiated_format().empty());
+
+    capture_format got = want;
+    got.fps = 15.0;
+    s.report_negotiated_format(got);
+    EXPECT_DOUBLE_EQ(s.negotiated_format().fps, 15.0);
+
+    std::ostringstream out;
+    s.dump(out);
+    EXPECT_NE(out.str().find("format=640x480@30fps MJPG"), std::string::npos);
+    EXPECT_NE(
+        out.str().find("negotiated=640x480@15fps MJPG"), std::string::npos
+    );
+}
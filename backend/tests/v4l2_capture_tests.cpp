@@ -0,0 +1,224 @@
+#ifdef __linux__
+
+#include "v4l2_capture.hpp"
+
+#include <gtest/gtest.h>
+
+#include <linux/videodev2.h>
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+using yodau::backend::frame;
+using yodau::backend::pixel_format;
+using yodau::backend::v4l2_capture;
+
+namespace {
+// in-memory capture device: buffers are plain vectors and every queued
+// buffer is immediately "filled"
+class fake_io final : public yodau::backend::v4l2_io {
+public:
+    int open(const char*, int) override {
+        ++opened;
+        return fd;
+    }
+
+    int close(const int) override {
+        ++closed;
+        return 0;
+    }
+
+    int ioctl(const int, const unsigned long request, void* arg) override {
+        switch (request) {
+        case VIDIOC_QUERYCAP: {
+            auto* cap = static_cast<v4l2_capability*>(arg);
+            cap->capabilities = V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_STREAMING;
+            return 0;
+        }
+        case VIDIOC_G_FMT:
+        case VIDIOC_S_FMT: {
+            auto* fmt = static_cast<v4l2_format*>(arg);
+            if (request == VIDIOC_S_FMT) {
+                width = fmt->fmt.pix.width;
+                height = fmt->fmt.pix.height;
+            }
+            fmt->fmt.pix.width = width;
+            fmt->fmt.pix.height = height;
+            fmt->fmt.pix.pixelformat = pixfmt;
+            fmt->fmt.pix.bytesperline = width * 2;
+            return 0;
+        }
+        case VIDIOC_G_PARM:
+        case VIDIOC_S_PARM: {
+            auto* parm = static_cast<v4l2_streamparm*>(arg);
+            parm->parm.capture.timeperframe.numerator = 1;
+            parm->parm.capture.timeperframe.denominator = 30;
+            return 0;
+        }
+        case VIDIOC_REQBUFS: {
+            auto* req = static_cast<v4l2_requestbuffers*>(arg);
+            buffers.assign(req->count, std::vector<std::uint8_t>(size()));
+            return 0;
+        }
+        case VIDIOC_QUERYBUF: {
+            auto* buf = static_cast<v4l2_buffer*>(arg);
+            buf->length = static_cast<std::uint32_t>(size());
+            buf->m.offset = buf->index * 4096;
+            return 0;
+        }
+        case VIDIOC_QBUF:
+            queued.push_back(static_cast<v4l2_buffer*>(arg)->index);
+            return 0;
+        case VIDIOC_DQBUF: {
+            if (queued.empty()) {
+                errno = EAGAIN;
+                return -1;
+            }
+            auto* buf = static_cast<v4l2_buffer*>(arg);
+            buf->index = queued.front();
+            buf->bytesused = static_cast<std::uint32_t>(size());
+            queued.pop_front();
+            return 0;
+        }
+        case VIDIOC_STREAMON:
+            streaming = true;
+            return 0;
+        case VIDIOC_STREAMOFF:
+            streaming = false;
+            queued.clear();
+            return 0;
+        default:
+            errno = EINVAL;
+            return -1;
+        }
+    }
+
+    void* mmap(void*, std::size_t, int, int, int, const off_t off) override {
+        return buffers[static_cast<std::size_t>(off / 4096)].data();
+    }
+
+    int munmap(void*, std::size_t) override {
+        ++unmapped;
+        return 0;
+    }
+
+    int poll(pollfd* fds, nfds_t, int) override {
+        if (queued.empty()) {
+            return 0;
+        }
+        fds[0].revents = POLLIN;
+        return 1;
+    }
+
+    std::size_t size() const {
+        return static_cast<std::size_t>(width) * height * 2;
+    }
+
+    bool owns(const std::uint8_t* p) const {
+        for (const auto& b : buffers) {
+            if (p >= b.data() && p < b.data() + b.size()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const int fd { 42 };
+    std::uint32_t width { 64 };
+    std::uint32_t height { 48 };
+    std::uint32_t pixfmt { V4L2_PIX_FMT_YUYV };
+    std::vector<std::vector<std::uint8_t>> buffers;
+    std::deque<unsigned> queued;
+    bool streaming { false };
+    int opened { 0 };
+    int closed { 0 };
+    int unmapped { 0 };
+};
+}
+
+TEST(V4l2Capture, ReadsZeroCopyFramesAndRequeues) {
+    auto io = std::make_shared<fake_io>();
+    v4l2_capture cap(io);
+
+    v4l2_capture::config cfg;
+    cfg.width = 32;
+    cfg.height = 16;
+    cfg.buffers = 3;
+    ASSERT_TRUE(cap.open("/dev/video0", cfg));
+    EXPECT_EQ(cap.width(), 32);
+    EXPECT_EQ(cap.height(), 16);
+    EXPECT_EQ(cap.stride(), 64);
+    EXPECT_DOUBLE_EQ(cap.fps(), 30.0);
+    EXPECT_EQ(io->queued.size(), 3u);
+
+    frame f;
+    ASSERT_EQ(cap.read(f, 0), v4l2_capture::read_result::ok);
+    EXPECT_EQ(f.format, pixel_format::yuyv422);
+    EXPECT_TRUE(f.data.empty());
+    EXPECT_FALSE(f.empty());
+    EXPECT_TRUE(io->owns(f.bytes()));
+    EXPECT_EQ(io->queued.size(), 2u);
+
+    frame copy = f;
+    f = frame {};
+    EXPECT_EQ(io->queued.size(), 2u);
+    copy = frame {};
+    EXPECT_EQ(io->queued.size(), 3u);
+
+    EXPECT_EQ(cap.drop(0), v4l2_capture::read_result::ok);
+    EXPECT_EQ(io->queued.size(), 3u);
+}
+
+TEST(V4l2Capture, RejectsUnsupportedFormat) {
+    auto io = std::make_shared<fake_io>();
+    io->pixfmt = V4L2_PIX_FMT_MJPEG;
+    v4l2_capture cap(io);
+
+    EXPECT_FALSE(cap.open("/dev/video0", {}));
+    EXPECT_FALSE(cap.is_open());
+    EXPECT_EQ(io->opened, 1);
+    EXPECT_EQ(io->closed, 1);
+
+    frame f;
+    EXPECT_EQ(cap.read(f, 0), v4l2_capture::read_result::error);
+}
+
+TEST(V4l2Capture, OutstandingFramesOutliveClose) {
+    auto io = std::make_shared<fake_io>();
+    frame f;
+    {
+        v4l2_capture cap(io);
+        ASSERT_TRUE(cap.open("/dev/video0", {}));
+        ASSERT_EQ(cap.read(f, 0), v4l2_capture::read_result::ok);
+    }
+    EXPECT_FALSE(io->streaming);
+    EXPECT_EQ(io->closed, 0);
+    EXPECT_EQ(io->unmapped, 0);
+
+    // released after STREAMOFF: nothing is queued back
+    f = frame {};
+    EXPECT_TRUE(io->queued.empty());
+    EXPECT_EQ(io->closed, 1);
+    EXPECT_EQ(io->unmapped, 4);
+}
+
+TEST(V4l2Capture, TimesOutWhenNothingIsQueued) {
+    auto io = std::make_shared<fake_io>();
+    v4l2_capture cap(io);
+    ASSERT_TRUE(cap.open("/dev/video0", {}));
+
+    std::vector<frame> held(4);
+    for (auto& f : held) {
+        ASSERT_EQ(cap.read(f, 0), v4l2_capture::read_result::ok);
+    }
+    frame f;
+    EXPECT_EQ(cap.read(f, 0), v4l2_capture::read_result::timeout);
+
+    held.clear();
+    EXPECT_EQ(cap.read(f, 0), v4l2_capture::read_result::ok);
+}
+
+#endif // __linux__
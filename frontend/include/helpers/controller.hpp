@@ -47,6 +47,8 @@ class settings_panel;
  * - Convert GUI frames to backend frames and push them for analysis.
  * - Receive backend events and reflect them visually:
  *   - motion events -> transient bubbles,
+ *   - motion grid events -> fading activity overlay (and the active
+ *     stream's long-term heatmap, when enabled),
  *   - tripwire events -> line highlight w/ hit position.
  * - Maintain in-memory line templates and per-stream line instances.
  * - Adapt repaint and analysis throttling based on number of visible streams.
@@ -271,6 +273,13 @@ private slots:
      */
     void on_active_labels_enabled_changed(bool on);
 
+    /**
+     * @brief Handler for toggling the motion heatmap in active view.
+     *
+     * @param on True to show the active stream's long-term heatmap.
+     */
+    void on_active_heatmap_enabled_changed(bool on);
+
 private:
     // setup
 
@@ -427,6 +436,22 @@ private:
      */
     void on_backend_events(const std::vector<yodau::backend::event>& evs);
 
+    /**
+     * @brief Convert a backend activity grid into a small grayscale image.
+     *
+     * One pixel per grid cell; the value is the cell activity level.
+     *
+     * @param g Activity grid from a motion grid event.
+     * @return Image of activity_grid::cols x activity_grid::rows pixels.
+     */
+    static QImage activity_image(const yodau::backend::activity_grid& g);
+
+    /**
+     * @brief Show or hide the active stream's long-term motion heatmap,
+     * according to @ref active_heatmap_enabled.
+     */
+    void update_active_heatmap();
+
     /**
      * @brief Choose repaint interval given number of visible streams.
      *
@@ -481,6 +506,9 @@ private:
     /** @brief Whether labels are enabled in active cell. */
     bool active_labels_enabled { true };
 
+    /** @brief Whether the motion heatmap is shown in active cell. */
+    bool active_heatmap_enabled { false };
+
     /** @brief Draft line name being edited. */
     QString draft_line_name;
 
@@ -334,6 +334,13 @@ signals:
      */
     void active_labels_enabled_changed(bool on);
 
+    /**
+     * @brief Emitted when motion heatmap toggle changes.
+     *
+     * @param on true to show the long-term motion heatmap in active view.
+     */
+    void active_heatmap_enabled_changed(bool on);
+
     /**
      * @brief Emitted when template selection changes.
      *
@@ -487,6 +494,7 @@ private:
     QWidget* active_tab { nullptr };
     QComboBox* active_combo { nullptr };
     QCheckBox* active_labels_cb = nullptr;
+    QCheckBox* active_heatmap_cb = nullptr;
 
     QGroupBox* active_mode_box = nullptr;
     QButtonGroup* active_mode_group { nullptr };
@@ -70,6 +70,8 @@ class QPainter;
  * - Draft line is drawn dashed.
  * - Hover point/coords and preview segments are shown while drawing.
  * - Recent events are drawn as fading circles.
+ * - The latest motion activity grid is drawn as a fading heatmap.
+ * - An optional long-term motion heatmap is drawn underneath it.
  * - Line highlights (by name and optional hit point) animate for a short TTL.
  */
 class stream_cell final : public QWidget {
@@ -271,6 +273,26 @@ public:
      */
     void add_event(const QPointF& pos_pct, const QColor& color);
 
+    /**
+     * @brief Replace the motion activity overlay.
+     *
+     * @p grid is a small 8-bit grayscale image (one pixel per activity cell)
+     * that is stretched over the whole cell and drawn as a fading heatmap.
+     *
+     * @param grid Activity image; null image clears the overlay.
+     */
+    void set_activity_overlay(const QImage& grid);
+
+    /**
+     * @brief Replace the long-term motion heatmap.
+     *
+     * Same image layout as @ref set_activity_overlay, but drawn until
+     * replaced, without fading.
+     *
+     * @param map Heatmap image; null image hides the heatmap.
+     */
+    void set_heatmap_overlay(const QImage& map);
+
     /**
      * @brief Set minimum repaint interval for video frame updates.
      *
@@ -419,6 +441,16 @@ private:
      */
     void draw_events(QPainter& p);
 
+    /**
+     * @brief Draw the motion activity overlay (if any and not expired).
+     */
+    void draw_activity(QPainter& p);
+
+    /**
+     * @brief Draw the long-term motion heatmap (if any).
+     */
+    void draw_heatmap(QPainter& p);
+
 private slots:
     /**
      * @brief Slot called when the video sink receives a new frame.
@@ -506,6 +538,15 @@ private:
     /** @brief Transient events currently displayed. */
     QVector<event_instance> events;
 
+    /** @brief Last motion activity overlay (one pixel per grid cell). */
+    QImage activity_overlay;
+
+    /** @brief Timestamp when @ref activity_overlay was set. */
+    QDateTime activity_ts;
+
+    /** @brief Long-term motion heatmap (one pixel per grid cell). */
+    QImage heatmap_overlay;
+
     /** @brief Timer throttling repaint frequency. */
     QElapsedTimer repaint_timer;
     /** @brief Minimum repaint interval in ms. */
@@ -37,9 +37,7 @@ controller::controller(
     if (stream_mgr) {
         stream_mgr->set_analysis_interval_ms(66);
 #ifdef YODAU_OPENCV
-        stream_mgr->set_frame_processor(
-            yodau::backend::opencv_motion_processor
-        );
+        stream_mgr->set_batch_processor(yodau::backend::opencv_batch_processor);
 #else
         stream_mgr->set_frame_processor([](const yodau::backend::stream& s,
                                            const yodau::backend::frame& f) {
@@ -218,6 +216,7 @@ void controller::on_active_stream_selected(const QString& name) {
 
     if (auto* cell = main_zone->active_cell()) {
         cell->set_labels_enabled(active_labels_enabled);
+        update_active_heatmap();
 
         cell->clear_draft();
         cell->set_drawing_enabled(drawing_new_mode);
@@ -436,6 +435,30 @@ void controller::on_active_labels_enabled_changed(bool on) {
     }
 }
 
+void controller::on_active_heatmap_enabled_changed(bool on) {
+    active_heatmap_enabled = on;
+    update_active_heatmap();
+}
+
+void controller::update_active_heatmap() {
+    if (!main_zone) {
+        return;
+    }
+
+    auto* cell = main_zone->active_cell();
+    if (!cell) {
+        return;
+    }
+
+    if (!active_heatmap_enabled || active_name.isEmpty() || !stream_mgr) {
+        cell->set_heatmap_overlay(QImage());
+        return;
+    }
+
+    const auto map = stream_mgr->heatmap(active_name.toStdString());
+    cell->set_heatmap_overlay(activity_image(map.normalized()));
+}
+
 void controller::setup_settings_connections() {
     if (!settings || !main_zone) {
         return;
@@ -485,6 +508,11 @@ void controller::setup_settings_connections() {
         settings, &settings_panel::active_labels_enabled_changed, this,
         &controller::on_active_labels_enabled_changed
     );
+
+    connect(
+        settings, &settings_panel::active_heatmap_enabled_changed, this,
+        &controller::on_active_heatmap_enabled_changed
+    );
 }
 
 void controller::setup_grid_connections() {
@@ -854,6 +882,20 @@ yodau::backend::frame controller::frame_from_image(const QImage& image) const {
     return f;
 }
 
+QImage controller::activity_image(const yodau::backend::activity_grid& g) {
+    constexpr int cols = yodau::backend::activity_grid::cols;
+    constexpr int rows = yodau::backend::activity_grid::rows;
+
+    QImage img(cols, rows, QImage::Format_Grayscale8);
+    for (int y = 0; y < rows; ++y) {
+        uchar* line = img.scanLine(y);
+        for (int x = 0; x < cols; ++x) {
+            line[x] = g.at(x, y);
+        }
+    }
+    return img;
+}
+
 void controller::on_gui_frame(const QString& stream_name, const QImage& image) {
     if (!stream_mgr) {
         return;
@@ -879,6 +921,17 @@ void controller::on_backend_event(const yodau::backend::event& e) {
         return;
     }
 
+    if (e.kind == yodau::backend::event_kind::motion_grid) {
+        if (e.grid.has_value()) {
+            tile->set_activity_overlay(activity_image(*e.grid));
+        }
+        // the heatmap has just taken this grid in
+        if (active_heatmap_enabled && name == active_name) {
+            update_active_heatmap();
+        }
+        return;
+    }
+
     if (!e.pos_pct.has_value()) {
         return;
     }
@@ -889,6 +942,11 @@ void controller::on_backend_event(const yodau::backend::event& e) {
             const auto& p = *e.pos_pct;
             tile->highlight_line_at(ln, QPointF(p.x, p.y));
         }
+    } else if (e.kind == yodau::backend::event_kind::roi) {
+        // regions light up while entered
+        if (!e.line_name.empty() && e.message != "exit") {
+            tile->highlight_line(QString::fromStdString(e.line_name));
+        }
     }
 
     const auto& p = *e.pos_pct;
@@ -518,6 +518,15 @@ QWidget* settings_panel::build_active_stream_box(QWidget* parent) {
         &settings_panel::active_labels_enabled_changed
     );
 
+    active_heatmap_cb = new QCheckBox(str_label("heatmap"), box);
+    active_heatmap_cb->setChecked(false);
+    box_layout->addWidget(active_heatmap_cb);
+
+    connect(
+        active_heatmap_cb, &QCheckBox::toggled, this,
+        &settings_panel::active_heatmap_enabled_changed
+    );
+
     connect(
         active_combo, &QComboBox::currentTextChanged, this,
         &settings_panel::on_active_combo_changed
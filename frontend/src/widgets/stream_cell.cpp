@@ -190,6 +190,17 @@ void stream_cell::add_event(const QPointF& pos_pct, const QColor& color) {
     update();
 }
 
+void stream_cell::set_activity_overlay(const QImage& grid) {
+    activity_overlay = grid;
+    activity_ts = QDateTime::currentDateTime();
+    update();
+}
+
+void stream_cell::set_heatmap_overlay(const QImage& map) {
+    heatmap_overlay = map;
+    update();
+}
+
 void stream_cell::set_repaint_interval_ms(const int ms) {
     if (ms <= 0) {
         return;
@@ -254,6 +265,8 @@ void stream_cell::paintEvent(QPaintEvent* event) {
         }
     }
 
+    draw_heatmap(p);
+    draw_activity(p);
     draw_events(p);
     draw_persistent(p);
     draw_draft(p);
@@ -711,6 +724,66 @@ void stream_cell::draw_events(QPainter& p) {
     events = std::move(alive);
 }
 
+void stream_cell::draw_activity(QPainter& p) {
+    if (activity_overlay.isNull()) {
+        return;
+    }
+
+    const int ttl_ms = 1000;
+    const int age = static_cast<int>(
+        activity_ts.msecsTo(QDateTime::currentDateTime())
+    );
+    if (age >= ttl_ms) {
+        activity_overlay = QImage();
+        return;
+    }
+
+    QImage tinted(
+        activity_overlay.size(), QImage::Format_ARGB32_Premultiplied
+    );
+    for (int y = 0; y < activity_overlay.height(); ++y) {
+        const uchar* src = activity_overlay.constScanLine(y);
+        auto* dst = reinterpret_cast<QRgb*>(tinted.scanLine(y));
+        for (int x = 0; x < activity_overlay.width(); ++x) {
+            const int a = std::min(255, src[x] * 3);
+            dst[x] = qPremultiply(qRgba(255, 140, 0, a));
+        }
+    }
+
+    const double k = 1.0 - static_cast<double>(age) / ttl_ms;
+
+    p.save();
+    p.setOpacity(0.6 * k);
+    p.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    p.drawImage(rect(), tinted);
+    p.restore();
+}
+
+void stream_cell::draw_heatmap(QPainter& p) {
+    if (heatmap_overlay.isNull()) {
+        return;
+    }
+
+    // blue (rare) to red (hottest); cells without motion stay transparent
+    QImage tinted(
+        heatmap_overlay.size(), QImage::Format_ARGB32_Premultiplied
+    );
+    for (int y = 0; y < heatmap_overlay.height(); ++y) {
+        const uchar* src = heatmap_overlay.constScanLine(y);
+        auto* dst = reinterpret_cast<QRgb*>(tinted.scanLine(y));
+        for (int x = 0; x < heatmap_overlay.width(); ++x) {
+            const int v = src[x];
+            const int a = v == 0 ? 0 : 60 + v * 140 / 255;
+            dst[x] = qPremultiply(qRgba(v, 0, 255 - v, a));
+        }
+    }
+
+    p.save();
+    p.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    p.drawImage(rect(), tinted);
+    p.restore();
+}
+
 void stream_cell::on_frame_changed(const QVideoFrame& frame) {
     if (!frame.isValid()) {
         return;